@@ -0,0 +1,286 @@
+// BenchmarkHarness.h - Lightweight in-repo micro-benchmark runner with JSON output and
+//                      baseline comparison (portable: MSVC and GCC/Clang on Linux).
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace XpressFormula::Benchmarks {
+
+/// Named numeric counter reported next to the timing (e.g. evaluations, vertices).
+struct BenchmarkCounter {
+    std::string name;
+    double      value = 0.0;
+};
+
+/// Result of one benchmark case after all repetitions.
+struct BenchmarkResult {
+    std::string name;
+    std::size_t iterations = 0;      // operations per repetition
+    double      nsPerOp = 0.0;       // median across repetitions
+    double      nsPerOpMin = 0.0;
+    double      nsPerItem = 0.0;     // nsPerOp / itemsPerOp (0 when itemsPerOp == 0)
+    double      itemsPerOp = 0.0;
+    std::vector<BenchmarkCounter> counters;
+};
+
+/// Runner options shared by all cases.
+struct BenchmarkOptions {
+    double      minTimeMs = 60.0;    // minimum wall time per repetition
+    int         repetitions = 5;
+    std::string filter;              // substring match on case name (empty = all)
+    std::string jsonPath;            // write results here when non-empty
+    std::string baselinePath;        // compare against this JSON when non-empty
+    double      thresholdPercent = 10.0;
+};
+
+/// Per-case state handed to each benchmark body.
+class BenchmarkState {
+public:
+    explicit BenchmarkState(const BenchmarkOptions& options) : m_options(options) {}
+
+    /// Time `op` until the minimum duration is reached, repeated `repetitions` times.
+    /// `itemsPerOp` is the number of logical work items (e.g. samples) one call processes.
+    template <typename Fn>
+    void measure(double itemsPerOp, Fn&& op) {
+        using Clock = std::chrono::steady_clock;
+
+        // Warm-up call, then grow the batch size until one batch lasts ~1/10th of the budget.
+        op();
+        std::size_t batch = 1;
+        const double targetBatchNs = m_options.minTimeMs * 1.0e6 * 0.1;
+        for (;;) {
+            const auto t0 = Clock::now();
+            for (std::size_t i = 0; i < batch; ++i) op();
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            if (ns >= targetBatchNs || batch >= (std::size_t{1} << 30)) break;
+            batch = (ns <= 0.0) ? batch * 10
+                                : std::max(batch + 1, static_cast<std::size_t>(batch * targetBatchNs / ns));
+        }
+
+        std::vector<double> samples;
+        samples.reserve(static_cast<std::size_t>(std::max(1, m_options.repetitions)));
+        for (int rep = 0; rep < std::max(1, m_options.repetitions); ++rep) {
+            std::size_t ops = 0;
+            const auto t0 = Clock::now();
+            double elapsedNs = 0.0;
+            do {
+                for (std::size_t i = 0; i < batch; ++i) op();
+                ops += batch;
+                elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            } while (elapsedNs < m_options.minTimeMs * 1.0e6);
+            samples.push_back(elapsedNs / static_cast<double>(ops));
+            m_result.iterations = ops;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        m_result.nsPerOp = samples[samples.size() / 2];
+        m_result.nsPerOpMin = samples.front();
+        m_result.itemsPerOp = itemsPerOp;
+        m_result.nsPerItem = (itemsPerOp > 0.0) ? m_result.nsPerOp / itemsPerOp : 0.0;
+    }
+
+    /// Attach an extra counter to the result (last value for a given name wins).
+    void counter(const std::string& name, double value) {
+        for (BenchmarkCounter& c : m_result.counters) {
+            if (c.name == name) { c.value = value; return; }
+        }
+        m_result.counters.push_back({ name, value });
+    }
+
+    /// Keep a computed value observable so the optimizer cannot drop the measured work.
+    void consume(double value) { m_sink = m_sink + value; }
+
+    BenchmarkResult& result() { return m_result; }
+
+private:
+    const BenchmarkOptions& m_options;
+    BenchmarkResult         m_result;
+    volatile double         m_sink = 0.0;
+};
+
+namespace Detail {
+
+inline std::string jsonEscape(std::string_view text) {
+    std::string out;
+    out.reserve(text.size() + 2);
+    for (char ch : text) {
+        switch (ch) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:   out.push_back(ch); break;
+        }
+    }
+    return out;
+}
+
+inline std::string formatNumber(double value) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.6g", value);
+    return buf;
+}
+
+// Reads the {"name": ..., "nsPerOp": ...} pairs written by writeJson(). This is intentionally
+// not a general JSON parser; it only needs to understand our own output format.
+inline std::vector<std::pair<std::string, double>> readBaseline(const std::string& json) {
+    std::vector<std::pair<std::string, double>> entries;
+    std::size_t pos = 0;
+    const std::string nameKey = "\"name\"";
+    const std::string nsKey = "\"nsPerOp\"";
+    while ((pos = json.find(nameKey, pos)) != std::string::npos) {
+        std::size_t q0 = json.find('"', json.find(':', pos + nameKey.size()) + 1);
+        if (q0 == std::string::npos) break;
+        std::string name;
+        std::size_t i = q0 + 1;
+        for (; i < json.size() && json[i] != '"'; ++i) {
+            if (json[i] == '\\' && i + 1 < json.size()) ++i;
+            name.push_back(json[i]);
+        }
+        const std::size_t nextName = json.find(nameKey, i);
+        const std::size_t nsPos = json.find(nsKey, i);
+        if (nsPos != std::string::npos && (nextName == std::string::npos || nsPos < nextName)) {
+            const std::size_t colon = json.find(':', nsPos + nsKey.size());
+            entries.emplace_back(name, std::strtod(json.c_str() + colon + 1, nullptr));
+        }
+        pos = i;
+    }
+    return entries;
+}
+
+} // namespace Detail
+
+/// Global registry of benchmark cases (mirrors the test registry in CppUnitTest.h).
+class BenchmarkRegistry {
+public:
+    struct BenchmarkCase {
+        std::string name;
+        std::function<void(BenchmarkState&)> run;
+    };
+
+    static BenchmarkRegistry& instance() {
+        static BenchmarkRegistry registry;
+        return registry;
+    }
+
+    void add(std::string name, std::function<void(BenchmarkState&)> run) {
+        m_cases.push_back({ std::move(name), std::move(run) });
+    }
+
+    /// Run all (filtered) cases, print a table, write JSON, and compare against a baseline.
+    /// Returns 0 on success, 1 if any case regressed beyond the threshold, 2 on I/O errors.
+    int runAll(const BenchmarkOptions& options) {
+        std::vector<BenchmarkResult> results;
+        std::printf("%-48s %14s %14s %12s\n", "benchmark", "ns/op", "ns/item", "iterations");
+        for (const BenchmarkCase& bench : m_cases) {
+            if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            BenchmarkState state(options);
+            state.result().name = bench.name;
+            bench.run(state);
+            const BenchmarkResult& r = state.result();
+            std::printf("%-48s %14.1f %14.2f %12zu", r.name.c_str(), r.nsPerOp, r.nsPerItem, r.iterations);
+            for (const BenchmarkCounter& c : r.counters) {
+                std::printf("  %s=%.6g", c.name.c_str(), c.value);
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+            results.push_back(r);
+        }
+
+        if (!options.jsonPath.empty() && !writeJson(options.jsonPath, results)) {
+            std::fprintf(stderr, "Could not write %s\n", options.jsonPath.c_str());
+            return 2;
+        }
+
+        if (options.baselinePath.empty()) {
+            return 0;
+        }
+
+        std::ifstream in(options.baselinePath, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "Could not read baseline %s\n", options.baselinePath.c_str());
+            return 2;
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const auto baseline = Detail::readBaseline(buffer.str());
+
+        int regressions = 0;
+        std::printf("\nComparison against %s (threshold %.1f%%)\n",
+                    options.baselinePath.c_str(), options.thresholdPercent);
+        for (const BenchmarkResult& r : results) {
+            const auto it = std::find_if(baseline.begin(), baseline.end(),
+                [&](const auto& entry) { return entry.first == r.name; });
+            if (it == baseline.end() || it->second <= 0.0) {
+                std::printf("  %-46s %10s\n", r.name.c_str(), "new");
+                continue;
+            }
+            const double deltaPercent = (r.nsPerOp / it->second - 1.0) * 100.0;
+            const char* verdict = "ok";
+            if (deltaPercent > options.thresholdPercent) {
+                verdict = "REGRESSION";
+                ++regressions;
+            } else if (deltaPercent < -options.thresholdPercent) {
+                verdict = "improved";
+            }
+            std::printf("  %-46s %+9.1f%%  %s\n", r.name.c_str(), deltaPercent, verdict);
+        }
+        std::printf("%d regression(s) beyond %.1f%%.\n", regressions, options.thresholdPercent);
+        return regressions > 0 ? 1 : 0;
+    }
+
+private:
+    static bool writeJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            out << "    {\"name\": \"" << Detail::jsonEscape(r.name) << "\""
+                << ", \"nsPerOp\": " << Detail::formatNumber(r.nsPerOp)
+                << ", \"nsPerOpMin\": " << Detail::formatNumber(r.nsPerOpMin)
+                << ", \"nsPerItem\": " << Detail::formatNumber(r.nsPerItem)
+                << ", \"itemsPerOp\": " << Detail::formatNumber(r.itemsPerOp)
+                << ", \"iterations\": " << r.iterations;
+            for (const BenchmarkCounter& c : r.counters) {
+                out << ", \"" << Detail::jsonEscape(c.name) << "\": " << Detail::formatNumber(c.value);
+            }
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    std::vector<BenchmarkCase> m_cases;
+};
+
+} // namespace XpressFormula::Benchmarks
+
+#define XF_BENCH_CONCAT_IMPL(a, b) a##b
+#define XF_BENCH_CONCAT(a, b) XF_BENCH_CONCAT_IMPL(a, b)
+
+#define BENCHMARK_CASE(benchName) \
+    static void benchName(::XpressFormula::Benchmarks::BenchmarkState& state); \
+    namespace { \
+    const bool XF_BENCH_CONCAT(benchName##_registered_, __LINE__) = []() { \
+        ::XpressFormula::Benchmarks::BenchmarkRegistry::instance().add(#benchName, &benchName); \
+        return true; \
+    }(); \
+    } \
+    static void benchName(::XpressFormula::Benchmarks::BenchmarkState& state)
@@ -0,0 +1,115 @@
+// CoreBenchmarks.cpp - Tokenize/parse latency and per-sample evaluation cost for the corpus.
+#include "BenchmarkHarness.h"
+#include "FormulaCorpus.h"
+#include "../XpressFormula/Core/Tokenizer.h"
+#include "../XpressFormula/Core/Parser.h"
+#include "../XpressFormula/Core/Evaluator.h"
+#include "../XpressFormula/Core/GridEvaluator.h"
+#include <vector>
+
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Benchmarks;
+
+namespace XpressFormulaBenchmarks {
+
+// Grid used by the evaluation benchmarks. 64x64 samples is small enough to keep each op short
+// while still amortizing the per-call overhead the way the renderer's sampling loops do.
+static constexpr int kGridSize = 64;
+
+static void benchTokenize(BenchmarkState& state, const std::string& text) {
+    state.measure(static_cast<double>(text.size()), [&]() {
+        Tokenizer tokenizer(text);
+        state.consume(static_cast<double>(tokenizer.tokenize().size()));
+    });
+    state.counter("chars", static_cast<double>(text.size()));
+}
+
+static void benchParse(BenchmarkState& state, const std::string& text) {
+    state.measure(1.0, [&]() {
+        auto result = Parser::parse(text);
+        state.consume(result.success() ? 1.0 : 0.0);
+    });
+    state.counter("chars", static_cast<double>(text.size()));
+}
+
+// Evaluates over an x/y grid (and a fixed z slice when the formula uses z), reporting the
+// per-sample cost as ns/item.
+static void benchEvaluateGrid(BenchmarkState& state, const std::string& text) {
+    const auto parsed = Parser::parse(text);
+    if (!parsed.success()) {
+        std::fprintf(stderr, "Corpus formula failed to parse: %s\n", parsed.error.c_str());
+        return;
+    }
+    Evaluator::Variables vars;
+    vars["z"] = 0.75;
+    const double items = static_cast<double>(kGridSize) * kGridSize;
+    state.measure(items, [&]() {
+        double sum = 0.0;
+        for (int iy = 0; iy < kGridSize; ++iy) {
+            vars["y"] = -8.0 + 16.0 * iy / (kGridSize - 1);
+            for (int ix = 0; ix < kGridSize; ++ix) {
+                vars["x"] = -8.0 + 16.0 * ix / (kGridSize - 1);
+                sum += Evaluator::evaluate(parsed.ast, vars);
+            }
+        }
+        state.consume(sum);
+    });
+}
+
+// Same grid and samples through GridEvaluator (separable subtrees hoisted to rows/columns).
+// The analysis runs inside the op, as the renderer builds one per draw call.
+static void benchGridEvaluator(BenchmarkState& state, const std::string& text) {
+    const auto parsed = Parser::parse(text);
+    if (!parsed.success()) {
+        std::fprintf(stderr, "Corpus formula failed to parse: %s\n", parsed.error.c_str());
+        return;
+    }
+    Evaluator::Variables vars;
+    vars["z"] = 0.75;
+    std::vector<double> axis(kGridSize);
+    for (int i = 0; i < kGridSize; ++i) {
+        axis[i] = -8.0 + 16.0 * i / (kGridSize - 1);
+    }
+    std::vector<double> out(static_cast<size_t>(kGridSize) * kGridSize);
+    const double items = static_cast<double>(kGridSize) * kGridSize;
+    state.measure(items, [&]() {
+        GridEvaluator(parsed.ast, vars).evaluate(axis.data(), kGridSize, axis.data(), kGridSize,
+                                                 out.data());
+        double sum = 0.0;
+        for (const double v : out) {
+            sum += v;
+        }
+        state.consume(sum);
+    });
+}
+
+// --- Tokenize ---
+BENCHMARK_CASE(Tokenize_Polynomial) { benchTokenize(state, Corpus::kPolynomial2D); }
+BENCHMARK_CASE(Tokenize_TrigHeavy)  { benchTokenize(state, Corpus::kTrigHeavy); }
+BENCHMARK_CASE(Tokenize_Nested)     { benchTokenize(state, Corpus::kNested); }
+BENCHMARK_CASE(Tokenize_Torus)      { benchTokenize(state, Corpus::kImplicitTorus); }
+BENCHMARK_CASE(Tokenize_MachineGenerated) { benchTokenize(state, Corpus::machineGenerated()); }
+
+// --- Parse (includes tokenization, as FormulaEntry::parse does) ---
+BENCHMARK_CASE(Parse_Polynomial) { benchParse(state, Corpus::kPolynomial2D); }
+BENCHMARK_CASE(Parse_TrigHeavy)  { benchParse(state, Corpus::kTrigHeavy); }
+BENCHMARK_CASE(Parse_Nested)     { benchParse(state, Corpus::kNested); }
+BENCHMARK_CASE(Parse_Torus)      { benchParse(state, Corpus::kImplicitTorus); }
+BENCHMARK_CASE(Parse_MachineGenerated) { benchParse(state, Corpus::machineGenerated()); }
+
+// --- Evaluate (ns/item = cost per sample) ---
+BENCHMARK_CASE(Evaluate_Polynomial1D) { benchEvaluateGrid(state, Corpus::kPolynomial1D); }
+BENCHMARK_CASE(Evaluate_Polynomial2D) { benchEvaluateGrid(state, Corpus::kPolynomial2D); }
+BENCHMARK_CASE(Evaluate_TrigHeavy)    { benchEvaluateGrid(state, Corpus::kTrigHeavy); }
+BENCHMARK_CASE(Evaluate_Nested)       { benchEvaluateGrid(state, Corpus::kNested); }
+BENCHMARK_CASE(Evaluate_Torus)        { benchEvaluateGrid(state, Corpus::kImplicitTorus); }
+BENCHMARK_CASE(Evaluate_MachineGenerated) { benchEvaluateGrid(state, Corpus::machineGenerated()); }
+
+// --- GridEvaluator over the same grid (compare with Evaluate_*) ---
+BENCHMARK_CASE(GridEvaluate_Polynomial2D) { benchGridEvaluator(state, Corpus::kPolynomial2D); }
+BENCHMARK_CASE(GridEvaluate_TrigHeavy)    { benchGridEvaluator(state, Corpus::kTrigHeavy); }
+BENCHMARK_CASE(GridEvaluate_Nested)       { benchGridEvaluator(state, Corpus::kNested); }
+BENCHMARK_CASE(GridEvaluate_Torus)        { benchGridEvaluator(state, Corpus::kImplicitTorus); }
+BENCHMARK_CASE(GridEvaluate_MachineGenerated) { benchGridEvaluator(state, Corpus::machineGenerated()); }
+
+} // namespace XpressFormulaBenchmarks
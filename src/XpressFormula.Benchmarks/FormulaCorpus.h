@@ -0,0 +1,50 @@
+// FormulaCorpus.h - Representative formulas shared by the benchmark cases.
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+namespace XpressFormula::Benchmarks::Corpus {
+
+// Polynomials (cheap arithmetic, Power-heavy).
+inline constexpr const char* kPolynomial1D = "3*x^4 - 2*x^3 + x^2 - 7*x + 5";
+inline constexpr const char* kPolynomial2D = "x^2 + y^2 - 0.5*x*y + 3*x - y";
+
+// Trig-heavy surfaces (transcendental cost dominates).
+inline constexpr const char* kTrigHeavy = "sin(x)*cos(y) + sin(2*x)*cos(3*y) + tan(x/5) - cos(x*y/4)";
+
+// Deeply nested function calls (call-dispatch cost dominates).
+inline constexpr const char* kNested = "exp(-abs(sin(cos(x + y)))) * sqrt(abs(log(abs(x*y) + 1))) + atan2(y, x)";
+
+// Implicit torus F(x,y,z)=0 written as a single expression (left - right of the equation).
+inline constexpr const char* kImplicitTorus = "(x^2+y^2+z^2+21)^2 - 100*(x^2+y^2)";
+
+/// Long machine-generated expression: a deterministic sum of `terms` trig/polynomial terms,
+/// similar to what exported fits or symbolic tools produce.
+inline std::string machineGenerated(int terms = 48) {
+    std::string text;
+    text.reserve(static_cast<std::size_t>(terms) * 40u);
+    unsigned int seed = 12345u;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast<double>((seed >> 8) & 0xFFFF) / 65535.0;
+    };
+    char buf[96];
+    for (int i = 0; i < terms; ++i) {
+        const double c = 0.1 + next() * 2.0;
+        const double a = 0.2 + next();
+        const double b = 0.2 + next();
+        switch (i % 3) {
+            case 0: std::snprintf(buf, sizeof(buf), "%.4f*sin(%.4f*x + %.4f*y)", c, a, b); break;
+            case 1: std::snprintf(buf, sizeof(buf), "%.4f*cos(%.4f*x - %.4f*y)", c, a, b); break;
+            default: std::snprintf(buf, sizeof(buf), "%.4f*(%.4f*x^2 - %.4f*y)", c, a, b); break;
+        }
+        if (i > 0) {
+            text += (i % 2 == 0) ? " + " : " - ";
+        }
+        text += buf;
+    }
+    return text;
+}
+
+} // namespace XpressFormula::Benchmarks::Corpus
@@ -0,0 +1,79 @@
+// HeadlessImGui.h - ImGui context without platform/renderer backends for renderer benchmarks.
+#pragma once
+
+#include "imgui.h"
+
+namespace XpressFormula::Benchmarks {
+
+/// Creates an ImGui context that never talks to a window or GPU. The font atlas is built
+/// on the CPU (the backend flags only tell ImGui what a renderer would support).
+/// Use beginDrawList() for single draw-call measurements, or newFrame()/render() to drive
+/// whole UI frames the way the application main loop does.
+class HeadlessImGui {
+public:
+    HeadlessImGui(float width = 1280.0f, float height = 720.0f) {
+        IMGUI_CHECKVERSION();
+        m_context = ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(width, height);
+        io.DeltaTime = 1.0f / 60.0f;
+        io.IniFilename = nullptr;
+        io.LogFilename = nullptr;
+        // Same renderer capabilities as the DX11 backend: large meshes are split into
+        // 16-bit-index chunks via ImDrawCmd::VtxOffset.
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures | ImGuiBackendFlags_RendererHasVtxOffset;
+    }
+
+    ~HeadlessImGui() {
+        delete m_drawList;
+        if (m_frameOpen) {
+            ImGui::EndFrame();
+        }
+        ImGui::DestroyContext(m_context);
+    }
+
+    HeadlessImGui(const HeadlessImGui&) = delete;
+    HeadlessImGui& operator=(const HeadlessImGui&) = delete;
+
+    /// Start a UI frame. Input events queued on ImGuiIO before this call are consumed by it.
+    void newFrame(float deltaTime) {
+        if (m_frameOpen) {
+            ImGui::EndFrame();
+        }
+        ImGui::GetIO().DeltaTime = deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
+        ImGui::NewFrame();
+        m_frameOpen = true;
+    }
+
+    /// Finish the current frame and return its draw data (nothing is submitted to a GPU).
+    ImDrawData* render() {
+        ImGui::Render();
+        m_frameOpen = false;
+        return ImGui::GetDrawData();
+    }
+
+    /// Clears the recorded draw list and prepares it exactly like ImGui does for a window
+    /// draw list at the start of a frame. A frame is kept open so the list can use the
+    /// shared font/white-pixel data.
+    ImDrawList* beginDrawList() {
+        if (!m_frameOpen) {
+            newFrame(1.0f / 60.0f);
+        }
+        if (!m_drawList) {
+            m_drawList = new ImDrawList(ImGui::GetDrawListSharedData());
+        }
+        m_drawList->_ResetForNewFrame();
+        m_drawList->PushTexture(ImGui::GetIO().Fonts->TexRef);
+        m_drawList->PushClipRectFullScreen();
+        return m_drawList;
+    }
+
+    ImDrawList* drawList() const { return m_drawList; }
+
+private:
+    ImGuiContext* m_context = nullptr;
+    ImDrawList*   m_drawList = nullptr;
+    bool          m_frameOpen = false;
+};
+
+} // namespace XpressFormula::Benchmarks
@@ -0,0 +1,181 @@
+// ImagingBenchmarks.cpp - Export post-processing cost: per-pixel conversions and resizing of
+//                         full-size images, with the SIMD kernels and with the scalar code, and
+//                         PNG encoding (against WIC on Windows).
+#include "BenchmarkHarness.h"
+#include "../XpressFormula/Imaging/PixelOps.h"
+#include "../XpressFormula/Imaging/PngEncoder.h"
+#include "../XpressFormula/Imaging/Resample.h"
+#include "../XpressFormula/Imaging/Simd.h"
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <wincodec.h>
+#pragma comment(lib, "windowscodecs.lib")
+#pragma comment(lib, "ole32.lib")
+#endif
+
+using namespace XpressFormula::Imaging;
+using namespace XpressFormula::Benchmarks;
+
+namespace XpressFormulaBenchmarks {
+
+// A rendered plot over a transparent target: mostly transparent, opaque strokes, and
+// antialiased edges with partial alpha.
+static std::vector<std::uint8_t> exportPixels(int width, int height) {
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4, 0);
+    for (std::size_t p = 0; p < pixels.size() / 4; ++p) {
+        const int kind = byte(rng) % 8;
+        const int a = (kind < 5) ? 0 : (kind < 7) ? 255 : byte(rng);
+        for (int c = 0; c < 3; ++c) pixels[p * 4 + c] = static_cast<std::uint8_t>(byte(rng) * a / 255);
+        pixels[p * 4 + 3] = static_cast<std::uint8_t>(a);
+    }
+    return pixels;
+}
+
+// Everything applyExportPostProcessing does to an unscaled 8192x8192 export (per pixel). The
+// conversions run in place every op; each keeps alpha, so later ops cost the same as the first.
+static void benchPostProcess8K(BenchmarkState& state, SimdLevel level) {
+    const int size = 8192;
+    std::vector<std::uint8_t> pixels = exportPixels(size, size);
+    const std::size_t count = pixels.size() / 4;
+    setSimdLevel(level);
+    state.measure(static_cast<double>(count), [&]() {
+        swapRedBlue(pixels.data(), count);
+        unpremultiply(pixels.data(), count);
+        toGrayscale(pixels.data(), count, ChannelOrder::Bgra);
+    });
+    state.counter("simd", static_cast<double>(simdLevel()));
+    setSimdLevel(SimdLevel::Avx2);
+}
+
+BENCHMARK_CASE(PostProcess_Export8K) {
+    benchPostProcess8K(state, SimdLevel::Avx2);
+}
+
+BENCHMARK_CASE(PostProcess_Export8K_Scalar) {
+    benchPostProcess8K(state, SimdLevel::Scalar);
+}
+
+// Resizing a capture (per output pixel).
+static void benchResize(BenchmarkState& state, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                        ResampleFilter filter, SimdLevel level) {
+    const std::vector<std::uint8_t> src = exportPixels(srcWidth, srcHeight);
+    std::vector<std::uint8_t> dst(static_cast<std::size_t>(dstWidth) * dstHeight * 4);
+    setSimdLevel(level);
+    state.measure(static_cast<double>(dstWidth) * dstHeight, [&]() {
+        resize(src.data(), srcWidth, srcHeight, dst.data(), dstWidth, dstHeight, filter);
+    });
+    state.counter("simd", static_cast<double>(simdLevel()));
+    setSimdLevel(SimdLevel::Avx2);
+}
+
+BENCHMARK_CASE(Resize_Bilinear_4Kto8K) {
+    benchResize(state, 4096, 4096, 8192, 8192, ResampleFilter::Bilinear, SimdLevel::Avx2);
+}
+
+BENCHMARK_CASE(Resize_Bilinear_4Kto8K_Scalar) {
+    benchResize(state, 4096, 4096, 8192, 8192, ResampleFilter::Bilinear, SimdLevel::Scalar);
+}
+
+BENCHMARK_CASE(Resize_Lanczos_8Kto2K) {
+    benchResize(state, 8192, 8192, 2048, 2048, ResampleFilter::Lanczos3, SimdLevel::Avx2);
+}
+
+BENCHMARK_CASE(Resize_Lanczos_8Kto2K_Scalar) {
+    benchResize(state, 8192, 8192, 2048, 2048, ResampleFilter::Lanczos3, SimdLevel::Scalar);
+}
+
+// An opaque plot as it is exported to PNG: flat background, grid lines, an antialiased curve
+// and a colour-mapped heat map in one corner.
+static std::vector<std::uint8_t> plotPixels(int width, int height) {
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::uint8_t* p = &pixels[(static_cast<std::size_t>(y) * width + x) * 4];
+            p[0] = 24; p[1] = 24; p[2] = 28; p[3] = 255;
+            if (x % 64 == 0 || y % 64 == 0) { p[0] = 64; p[1] = 64; p[2] = 72; }
+            const double d = std::abs(y - height * (0.5 + 0.3 * std::sin(x * 0.004)));
+            if (d < 2.0) {
+                const int a = static_cast<int>(255 * (1.0 - d / 2.0));
+                p[0] = static_cast<std::uint8_t>(p[0] + (255 - p[0]) * a / 255);
+                p[1] = static_cast<std::uint8_t>(p[1] + (140 - p[1]) * a / 255);
+            }
+            if (x < width / 4 && y < height / 4) {
+                const double v = 0.5 + 0.5 * std::sin(x * 0.02) * std::cos(y * 0.03);
+                p[0] = static_cast<std::uint8_t>(255 * v);
+                p[1] = static_cast<std::uint8_t>(255 * v * (1.0 - v) * 4.0);
+                p[2] = static_cast<std::uint8_t>(255 * (1.0 - v));
+            }
+        }
+    }
+    return pixels;
+}
+
+// Encoding a 4096x4096 export to PNG (per pixel). `ratio` is the file size over the raw pixels.
+static void benchPngEncode(BenchmarkState& state, PngLevel level) {
+    const int size = 4096;
+    const std::vector<std::uint8_t> pixels = plotPixels(size, size);
+    std::size_t bytes = 0;
+    state.measure(static_cast<double>(size) * size, [&]() {
+        bytes = encodePng(pixels.data(), size, size, ChannelOrder::Bgra, level).size();
+    });
+    state.counter("bytes", static_cast<double>(bytes));
+    state.counter("ratio", static_cast<double>(bytes) / static_cast<double>(pixels.size()));
+}
+
+BENCHMARK_CASE(PngEncode_Fast_4K) {
+    benchPngEncode(state, PngLevel::Fast);
+}
+
+BENCHMARK_CASE(PngEncode_Small_4K) {
+    benchPngEncode(state, PngLevel::Small);
+}
+
+#ifdef _WIN32
+// The same image through WIC's PNG encoder into memory, as exports were saved before.
+BENCHMARK_CASE(PngEncode_Wic_4K) {
+    const int size = 4096;
+    const std::vector<std::uint8_t> pixels = plotPixels(size, size);
+    const HRESULT init = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    IWICImagingFactory* factory = nullptr;
+    CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+    std::size_t bytes = 0;
+    state.measure(static_cast<double>(size) * size, [&]() {
+        IStream* stream = nullptr;
+        IWICBitmapEncoder* encoder = nullptr;
+        IWICBitmapFrameEncode* frame = nullptr;
+        if (!factory || FAILED(CreateStreamOnHGlobal(nullptr, TRUE, &stream))) return;
+        if (SUCCEEDED(factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder)) &&
+            SUCCEEDED(encoder->Initialize(stream, WICBitmapEncoderNoCache)) &&
+            SUCCEEDED(encoder->CreateNewFrame(&frame, nullptr)) && SUCCEEDED(frame->Initialize(nullptr)) &&
+            SUCCEEDED(frame->SetSize(size, size))) {
+            WICPixelFormatGUID format = GUID_WICPixelFormat32bppBGRA;
+            frame->SetPixelFormat(&format);
+            frame->WritePixels(size, size * 4, static_cast<UINT>(pixels.size()),
+                               const_cast<BYTE*>(pixels.data()));
+            frame->Commit();
+            encoder->Commit();
+            STATSTG stat{};
+            if (SUCCEEDED(stream->Stat(&stat, STATFLAG_NONAME))) bytes = static_cast<std::size_t>(stat.cbSize.QuadPart);
+        }
+        if (frame) frame->Release();
+        if (encoder) encoder->Release();
+        stream->Release();
+    });
+    if (factory) factory->Release();
+    if (SUCCEEDED(init)) CoUninitialize();
+    state.counter("bytes", static_cast<double>(bytes));
+    state.counter("ratio", static_cast<double>(bytes) / static_cast<double>(pixels.size()));
+}
+#endif
+
+} // namespace XpressFormulaBenchmarks
@@ -0,0 +1,220 @@
+// InteractionReplay.cpp - Headless replay of interaction recordings.
+#include "InteractionReplay.h"
+#include "BenchmarkHarness.h"
+#include "HeadlessImGui.h"
+#include "../XpressFormula/UI/PlotPanel.h"
+#include "../XpressFormula/Plotting/PlotRenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+
+namespace XpressFormula::Benchmarks {
+
+namespace {
+
+const char* renderKindName(UI::FormulaRenderKind kind) {
+    switch (kind) {
+        case UI::FormulaRenderKind::Curve2D:       return "Curve2D";
+        case UI::FormulaRenderKind::Surface3D:     return "Surface3D";
+        case UI::FormulaRenderKind::Implicit2D:    return "Implicit2D";
+        case UI::FormulaRenderKind::ScalarField3D: return "ScalarField3D";
+        case UI::FormulaRenderKind::DataSeries2D:  return "DataSeries2D";
+        case UI::FormulaRenderKind::Scatter2D:     return "Scatter2D";
+        case UI::FormulaRenderKind::Stream2D:      return "Stream2D";
+        default:                                   return "Invalid";
+    }
+}
+
+std::string describeVisibleFormulas(const std::vector<UI::FormulaEntry>& formulas) {
+    std::string text;
+    for (const UI::FormulaEntry& f : formulas) {
+        if (!f.visible || !f.isValid()) {
+            continue;
+        }
+        if (!text.empty()) {
+            text += '+';
+        }
+        text += renderKindName(f.renderKind);
+    }
+    return text.empty() ? std::string("none") : text;
+}
+
+// Replays one pass over the script. The plot window is placed at the origin with ImGui's
+// default padding, so recorded plot-relative mouse positions map to fixed screen positions.
+void replayPass(const UI::InteractionScript& script, std::vector<ReplayFrameSample>* samples) {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<UI::FormulaEntry> formulas;
+    UI::PlotSettings settings;
+    Core::ViewTransform vt = script.initialView;
+    UI::PlotPanel panel;
+
+    float plotWidth = 1280.0f;
+    float plotHeight = 720.0f;
+    if (!script.frames.empty()) {
+        plotWidth = std::max(1.0f, script.frames.front().input.plotWidth);
+        plotHeight = std::max(1.0f, script.frames.front().input.plotHeight);
+    }
+    HeadlessImGui imgui(plotWidth + 64.0f, plotHeight + 64.0f);
+    const ImVec2 padding = ImGui::GetStyle().WindowPadding;
+    Core::ViewTransform previousView = vt;
+
+    for (size_t i = 0; i < script.frames.size(); ++i) {
+        const UI::InteractionFrame& frame = script.frames[i];
+        UI::InteractionScript::applyFrameState(frame, formulas, settings);
+
+        const UI::InteractionInput& in = frame.input;
+        ImGuiIO& io = ImGui::GetIO();
+        io.AddKeyEvent(ImGuiMod_Ctrl, in.keyCtrl);
+        io.AddKeyEvent(ImGuiMod_Shift, in.keyShift);
+        io.AddMousePosEvent(padding.x + in.mouseX, padding.y + in.mouseY);
+        io.AddMouseButtonEvent(ImGuiMouseButton_Left, in.mouseLeft);
+        io.AddMouseButtonEvent(ImGuiMouseButton_Right, in.mouseRight);
+        if (in.wheel != 0.0f) {
+            io.AddMouseWheelEvent(0.0f, in.wheel);
+        }
+
+        const bool viewChanged = vt.centerX != previousView.centerX || vt.centerY != previousView.centerY ||
+                                 vt.scaleX != previousView.scaleX || vt.scaleY != previousView.scaleY;
+        previousView = vt;
+
+        const Plotting::PlotRenderer::RenderStats before = Plotting::PlotRenderer::stats();
+        const auto t0 = Clock::now();
+        imgui.newFrame(frame.deltaTime);
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(in.plotWidth + padding.x * 2.0f,
+                                        in.plotHeight + padding.y * 2.0f));
+        ImGui::Begin("##Plot", nullptr,
+                     ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+                     ImGuiWindowFlags_NoMove     | ImGuiWindowFlags_NoCollapse |
+                     ImGuiWindowFlags_NoScrollbar);
+        panel.render(formulas, vt, settings);
+        ImGui::End();
+        const ImDrawData* drawData = imgui.render();
+        const double cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        const Plotting::PlotRenderer::RenderStats after = Plotting::PlotRenderer::stats();
+
+        if (!samples) {
+            continue;
+        }
+        ReplayFrameSample sample;
+        sample.frame = static_cast<int>(i);
+        sample.timeSeconds = frame.timeSeconds;
+        sample.cpuMs = cpuMs;
+        sample.evaluations = after.evaluations - before.evaluations;
+        sample.meshCacheMisses = after.meshCacheMisses - before.meshCacheMisses;
+        sample.vertices = drawData ? drawData->TotalVtxCount : 0;
+        sample.dragging = in.mouseLeft;
+        sample.wheel = (in.wheel != 0.0f);
+        sample.stateChanged = !frame.formulaChanges.empty() || !frame.settingChanges.empty() ||
+                              frame.formulaCount >= 0;
+        sample.viewChanged = viewChanged;
+        sample.renderKinds = describeVisibleFormulas(formulas);
+        samples->push_back(std::move(sample));
+    }
+}
+
+} // namespace
+
+double InteractionReplay::percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const double rank = std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(values.size()));
+    const size_t index = static_cast<size_t>(std::max(1.0, rank)) - 1;
+    return values[std::min(index, values.size() - 1)];
+}
+
+ReplayReport InteractionReplay::run(const UI::InteractionScript& script, int warmupPasses) {
+    for (int pass = 0; pass < warmupPasses; ++pass) {
+        replayPass(script, nullptr);
+    }
+
+    ReplayReport report;
+    report.frames.reserve(script.frames.size());
+    replayPass(script, &report.frames);
+
+    std::vector<double> times;
+    times.reserve(report.frames.size());
+    for (const ReplayFrameSample& sample : report.frames) {
+        times.push_back(sample.cpuMs);
+    }
+    if (!times.empty()) {
+        report.totalMs = std::accumulate(times.begin(), times.end(), 0.0);
+        report.meanMs = report.totalMs / static_cast<double>(times.size());
+        report.maxMs = *std::max_element(times.begin(), times.end());
+        report.p50Ms = percentile(times, 50.0);
+        report.p95Ms = percentile(times, 95.0);
+        report.p99Ms = percentile(times, 99.0);
+    }
+    return report;
+}
+
+void InteractionReplay::printReport(const ReplayReport& report, int worstCount) {
+    std::printf("Replayed %zu frames, total %.1f ms\n", report.frames.size(), report.totalMs);
+    std::printf("  mean %.2f ms  p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms\n",
+                report.meanMs, report.p50Ms, report.p95Ms, report.p99Ms, report.maxMs);
+
+    std::vector<const ReplayFrameSample*> worst;
+    worst.reserve(report.frames.size());
+    for (const ReplayFrameSample& sample : report.frames) {
+        worst.push_back(&sample);
+    }
+    std::sort(worst.begin(), worst.end(), [](const ReplayFrameSample* a, const ReplayFrameSample* b) {
+        return a->cpuMs > b->cpuMs;
+    });
+    if (worst.size() > static_cast<size_t>(std::max(0, worstCount))) {
+        worst.resize(static_cast<size_t>(std::max(0, worstCount)));
+    }
+
+    std::printf("\nWorst frames:\n");
+    std::printf("  %6s %9s %9s %10s %7s %9s  %s\n",
+                "frame", "t (s)", "ms", "evals", "remesh", "vertices", "cause");
+    for (const ReplayFrameSample* s : worst) {
+        std::string cause = s->renderKinds;
+        if (s->dragging) cause += ", drag";
+        if (s->wheel) cause += ", wheel-zoom";
+        if (s->viewChanged) cause += ", view-change";
+        if (s->stateChanged) cause += ", edit";
+        std::printf("  %6d %9.3f %9.2f %10llu %7llu %9d  %s\n",
+                    s->frame, s->timeSeconds, s->cpuMs,
+                    static_cast<unsigned long long>(s->evaluations),
+                    static_cast<unsigned long long>(s->meshCacheMisses),
+                    s->vertices, cause.c_str());
+    }
+}
+
+bool InteractionReplay::writeJson(const std::string& path, const ReplayReport& report) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << "{\n  \"replay\": {"
+        << "\"frames\": " << report.frames.size()
+        << ", \"meanMs\": " << Detail::formatNumber(report.meanMs)
+        << ", \"p50Ms\": " << Detail::formatNumber(report.p50Ms)
+        << ", \"p95Ms\": " << Detail::formatNumber(report.p95Ms)
+        << ", \"p99Ms\": " << Detail::formatNumber(report.p99Ms)
+        << ", \"maxMs\": " << Detail::formatNumber(report.maxMs)
+        << "},\n  \"frames\": [\n";
+    for (size_t i = 0; i < report.frames.size(); ++i) {
+        const ReplayFrameSample& s = report.frames[i];
+        out << "    {\"frame\": " << s.frame
+            << ", \"ms\": " << Detail::formatNumber(s.cpuMs)
+            << ", \"evals\": " << s.evaluations
+            << ", \"remesh\": " << s.meshCacheMisses
+            << ", \"vertices\": " << s.vertices
+            << ", \"drag\": " << (s.dragging ? "true" : "false")
+            << ", \"wheel\": " << (s.wheel ? "true" : "false")
+            << ", \"kinds\": \"" << Detail::jsonEscape(s.renderKinds) << "\"}"
+            << (i + 1 < report.frames.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace XpressFormula::Benchmarks
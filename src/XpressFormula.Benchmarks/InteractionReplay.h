@@ -0,0 +1,52 @@
+// InteractionReplay.h - Drives PlotPanel::render headlessly from a recorded interaction script
+//                       and summarizes the frame-time distribution.
+#pragma once
+
+#include "../XpressFormula/UI/InteractionRecording.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Benchmarks {
+
+/// Per-frame measurement plus the context needed to attribute slow frames.
+struct ReplayFrameSample {
+    int           frame = 0;
+    double        timeSeconds = 0.0;  // script timestamp
+    double        cpuMs = 0.0;        // NewFrame..Render wall time
+    std::uint64_t evaluations = 0;
+    std::uint64_t meshCacheMisses = 0;
+    int           vertices = 0;
+    bool          dragging = false;
+    bool          wheel = false;
+    bool          stateChanged = false;  // formula/settings edits applied before this frame
+    bool          viewChanged = false;   // pan/zoom from the previous frame changed the domain
+    std::string   renderKinds;           // visible formula kinds, e.g. "Surface3D+Implicit2D"
+};
+
+struct ReplayReport {
+    std::vector<ReplayFrameSample> frames;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double meanMs = 0.0;
+    double totalMs = 0.0;
+};
+
+class InteractionReplay {
+public:
+    /// Replay every frame of `script` (after `warmupPasses` untimed passes over the whole script,
+    /// which lets caches reach the same state as in a second interactive run).
+    static ReplayReport run(const UI::InteractionScript& script, int warmupPasses = 0);
+
+    /// Nearest-rank percentile (p in [0,100]) of the frame times.
+    static double percentile(std::vector<double> values, double p);
+
+    /// Print the distribution and the `worstCount` slowest frames with attribution.
+    static void printReport(const ReplayReport& report, int worstCount = 5);
+
+    static bool writeJson(const std::string& path, const ReplayReport& report);
+};
+
+} // namespace XpressFormula::Benchmarks
@@ -0,0 +1,170 @@
+// PanelBenchmarks.cpp - Whole-plot frame cost through PlotPanel::render for multi-formula
+//                       sessions: serial vs. parallel formula building, and idle or
+//                       single-edit frames served from the retained geometry cache.
+#include "BenchmarkHarness.h"
+#include "FormulaCorpus.h"
+#include "HeadlessImGui.h"
+#include "../XpressFormula/UI/PlotPanel.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+using namespace XpressFormula;
+using namespace XpressFormula::Benchmarks;
+
+namespace XpressFormulaBenchmarks {
+
+static UI::FormulaEntry makePanelFormula(const std::string& text, int paletteIndex) {
+    UI::FormulaEntry entry;
+    std::snprintf(entry.inputBuffer, sizeof(entry.inputBuffer), "%s", text.c_str());
+    for (int i = 0; i < 4; ++i) {
+        entry.color[i] = UI::kDefaultPalette[paletteIndex % UI::kPaletteSize][i];
+    }
+    entry.parse();
+    return entry;
+}
+
+// Ten visible 2D formulas: curves, heat maps, a contour and a cross-section.
+static std::vector<UI::FormulaEntry> tenFormulas2D() {
+    const char* texts[] = {
+        Corpus::kPolynomial1D, "sin(x) * x", "cos(3*x) + 0.5*x", "sqrt(abs(x)) - 2",
+        "exp(-x^2) * 4", Corpus::kTrigHeavy, "x^2 + y^2 - 16 + sin(3*x)",
+        "x^2/9 + y^2/4 = 1", "x*y - 3 = 0", Corpus::kImplicitTorus
+    };
+    std::vector<UI::FormulaEntry> formulas;
+    for (int i = 0; i < 10; ++i) {
+        formulas.push_back(makePanelFormula(texts[i], i));
+    }
+    return formulas;
+}
+
+// A long session: the ten formulas above plus 990 curves and contours, half of them hidden and
+// the rest placed outside the default view.
+static std::vector<UI::FormulaEntry> thousandFormulas2D() {
+    std::vector<UI::FormulaEntry> formulas = tenFormulas2D();
+    for (int i = 10; i < 1000; ++i) {
+        const std::string text = (i % 3 == 0)
+            ? "(x - " + std::to_string(40 + i) + ")^2 + y^2 = 4"
+            : "sin(x) + " + std::to_string(20 + i);
+        formulas.push_back(makePanelFormula(text, i));
+        formulas.back().visible = (i % 2 == 0);
+    }
+    return formulas;
+}
+
+// Four z=f(x,y) surfaces in 3D mode.
+static std::vector<UI::FormulaEntry> fourSurfaces3D() {
+    const char* texts[] = {
+        Corpus::kTrigHeavy, Corpus::kPolynomial2D, "sin(x)*cos(y)*3", "exp(-(x^2+y^2)/8)*6"
+    };
+    std::vector<UI::FormulaEntry> formulas;
+    for (int i = 0; i < 4; ++i) {
+        formulas.push_back(makePanelFormula(texts[i], i));
+    }
+    return formulas;
+}
+
+// Order-sensitive checksum of the rendered vertices, so serial and parallel runs can be
+// compared for identical output.
+static double drawDataChecksum(const ImDrawData* drawData) {
+    double sum = 0.0;
+    double weight = 1.0;
+    for (const ImDrawList* list : drawData->CmdLists) {
+        for (const ImDrawVert& v : list->VtxBuffer) {
+            if (!std::isfinite(v.pos.x) || !std::isfinite(v.pos.y)) {
+                continue;
+            }
+            sum += weight * (v.pos.x + 3.0 * v.pos.y + static_cast<double>(v.col & 0xFF));
+            weight = (weight > 1.5) ? 1.0 : weight + 1.0e-3;
+        }
+    }
+    return sum;
+}
+
+enum class PanelFrames {
+    FullRedraw,  // geometry cache off: every formula is rebuilt each frame
+    Unchanged,   // cache on, nothing changes between frames
+    EditOne      // cache on, one formula's colour changes every frame
+};
+
+static void benchPanel(BenchmarkState& state, std::vector<UI::FormulaEntry> formulas,
+                       bool force3D, bool parallel, PanelFrames frames = PanelFrames::FullRedraw) {
+    HeadlessImGui imgui(1344.0f, 784.0f);
+    UI::PlotPanel panel;
+    UI::PlotSettings settings;
+    settings.parallelFormulas = parallel;
+    settings.optimizeRendering = (frames != PanelFrames::FullRedraw);
+    // Keep frames deterministic: no background volume sampling swapping in mid-measurement.
+    settings.cacheCrossSectionVolumes = false;
+    settings.xyRenderModePreference = force3D ? UI::XYRenderModePreference::Force3D
+                                              : UI::XYRenderModePreference::Force2D;
+    Core::ViewTransform vt;
+
+    const ImDrawData* drawData = nullptr;
+    auto frame = [&]() {
+        imgui.newFrame(1.0f / 60.0f);
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(ImVec2(1344.0f, 784.0f));
+        ImGui::Begin("##Plot", nullptr,
+                     ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+                     ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
+        panel.render(formulas, vt, settings);
+        ImGui::End();
+        drawData = imgui.render();
+    };
+    frame();
+
+    Plotting::PlotRenderer::resetStats();
+    std::uint64_t ops = 0;
+    state.measure(1.0, [&]() {
+        if (frames == PanelFrames::EditOne) {
+            formulas.front().color[0] = (formulas.front().color[0] > 0.5f) ? 0.25f : 0.75f;
+        }
+        frame();
+        state.consume(static_cast<double>(drawData->TotalVtxCount));
+        ++ops;
+    });
+    const double divisor = ops > 0 ? static_cast<double>(ops) : 1.0;
+    state.counter("evals", static_cast<double>(Plotting::PlotRenderer::stats().evaluations) / divisor);
+    state.counter("vtx", static_cast<double>(drawData->TotalVtxCount));
+    state.counter("checksum", drawDataChecksum(drawData));
+}
+
+BENCHMARK_CASE(Panel_TenFormulas2D_Serial) {
+    benchPanel(state, tenFormulas2D(), false, false);
+}
+
+BENCHMARK_CASE(Panel_TenFormulas2D_Parallel) {
+    benchPanel(state, tenFormulas2D(), false, true);
+}
+
+BENCHMARK_CASE(Panel_TenFormulas2D_Unchanged) {
+    benchPanel(state, tenFormulas2D(), false, false, PanelFrames::Unchanged);
+}
+
+BENCHMARK_CASE(Panel_TenFormulas2D_EditOne) {
+    benchPanel(state, tenFormulas2D(), false, false, PanelFrames::EditOne);
+}
+
+BENCHMARK_CASE(Panel_ThousandFormulas2D_Serial) {
+    benchPanel(state, thousandFormulas2D(), false, false);
+}
+
+BENCHMARK_CASE(Panel_ThousandFormulas2D_Unchanged) {
+    benchPanel(state, thousandFormulas2D(), false, false, PanelFrames::Unchanged);
+}
+
+BENCHMARK_CASE(Panel_FourSurfaces3D_Serial) {
+    benchPanel(state, fourSurfaces3D(), true, false);
+}
+
+BENCHMARK_CASE(Panel_FourSurfaces3D_Parallel) {
+    benchPanel(state, fourSurfaces3D(), true, true);
+}
+
+BENCHMARK_CASE(Panel_FourSurfaces3D_Unchanged) {
+    benchPanel(state, fourSurfaces3D(), true, false, PanelFrames::Unchanged);
+}
+
+} // namespace XpressFormulaBenchmarks
@@ -0,0 +1,669 @@
+// RendererBenchmarks.cpp - PlotRenderer draw-call cost over fixed scenes, measured against a
+//                          headless ImGui context (no window, no GPU).
+#include "BenchmarkHarness.h"
+#include "FormulaCorpus.h"
+#include "HeadlessImGui.h"
+#include "../XpressFormula/Core/EquationSolver.h"
+#include "../XpressFormula/Core/Parser.h"
+#include "../XpressFormula/Plotting/CurveAnalysis.h"
+#include "../XpressFormula/Plotting/CurveIndex.h"
+#include "../XpressFormula/Plotting/DataSeries.h"
+#include "../XpressFormula/Plotting/FrameArena.h"
+#include "../XpressFormula/Plotting/ImplicitSurfaceTracer.h"
+#include "../XpressFormula/Plotting/MeshBvh.h"
+#include "../XpressFormula/Plotting/PlotRenderer.h"
+#include "../XpressFormula/Plotting/ScatterDensity.h"
+#include "../XpressFormula/Plotting/StreamSeries.h"
+#include "../XpressFormula/Plotting/VolumeRaymarcher.h"
+#include "../XpressFormula/Core/TaskPool.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+using namespace XpressFormula::Benchmarks;
+
+namespace XpressFormulaBenchmarks {
+
+// Fixed scene shared by all renderer cases: a 1280x720 plot area at the default zoom,
+// and the default 3D camera.
+static ViewTransform sceneView() {
+    ViewTransform vt;
+    vt.screenOriginX = 0.0f;
+    vt.screenOriginY = 0.0f;
+    vt.screenWidth = 1280.0f;
+    vt.screenHeight = 720.0f;
+    return vt;
+}
+
+static ASTNodePtr parseOrReport(const std::string& text) {
+    const auto parsed = Parser::parse(text);
+    if (!parsed.success()) {
+        std::fprintf(stderr, "Scene formula failed to parse: %s\n", parsed.error.c_str());
+        return nullptr;
+    }
+    return parsed.ast;
+}
+
+static const float kColor[4] = { 0.25f, 0.55f, 0.95f, 1.0f };
+
+// Times `draw` into a freshly reset draw list and reports per-op evaluations and the
+// vertex/index counts of the recorded draw list (identical every op for a fixed scene).
+// Each op gets a reset frame arena, as PlotPanel does once per frame; `arenaKB` is its
+// high-water mark and `arenaBlocks` the blocks it had to add during timing (0 = its warm-up
+// capacity sufficed). Only the arena's growth is counted, not other heap allocations.
+template <typename DrawFn>
+static void benchDraw(BenchmarkState& state, DrawFn&& draw) {
+    HeadlessImGui imgui;
+    FrameArena arena;
+    draw(imgui.beginDrawList(), &arena);
+    arena.reset();
+
+    PlotRenderer::resetStats();
+    const std::uint64_t warmBlocks = arena.blockAllocations();
+    std::uint64_t ops = 0;
+    state.measure(1.0, [&]() {
+        arena.reset();
+        ImDrawList* dl = imgui.beginDrawList();
+        draw(dl, &arena);
+        state.consume(static_cast<double>(dl->VtxBuffer.Size));
+        ++ops;
+    });
+    const PlotRenderer::RenderStats stats = PlotRenderer::stats();
+
+    const ImDrawList* dl = imgui.drawList();
+    const double divisor = ops > 0 ? static_cast<double>(ops) : 1.0;
+    state.counter("evals", static_cast<double>(stats.evaluations) / divisor);
+    state.counter("vtx", static_cast<double>(dl->VtxBuffer.Size));
+    state.counter("idx", static_cast<double>(dl->IdxBuffer.Size));
+    state.counter("cmds", static_cast<double>(dl->CmdBuffer.Size));
+    state.counter("arenaKB", static_cast<double>(arena.highWaterMark()) / 1024.0);
+    state.counter("arenaBlocks", static_cast<double>(arena.blockAllocations() - warmBlocks));
+    if (stats.meshCacheHits + stats.meshCacheMisses > 0) {
+        state.counter("meshHitRate", static_cast<double>(stats.meshCacheHits) /
+            static_cast<double>(stats.meshCacheHits + stats.meshCacheMisses));
+    }
+}
+
+// --- Background layers ---
+BENCHMARK_CASE(Render_Grid) {
+    const ViewTransform vt = sceneView();
+    benchDraw(state, [&](ImDrawList* dl, FrameArena*) { PlotRenderer::drawGrid(dl, vt); });
+}
+
+BENCHMARK_CASE(Render_AxesAndLabels) {
+    const ViewTransform vt = sceneView();
+    benchDraw(state, [&](ImDrawList* dl, FrameArena*) {
+        PlotRenderer::drawAxes(dl, vt);
+        PlotRenderer::drawAxisLabels(dl, vt);
+    });
+}
+
+BENCHMARK_CASE(Render_Grid3DAndAxes3D) {
+    const ViewTransform vt = sceneView();
+    const PlotRenderer::Surface3DOptions options;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena*) {
+        PlotRenderer::drawGrid3D(dl, vt, options);
+        PlotRenderer::drawAxes3D(dl, vt, options);
+    });
+}
+
+// --- Formula layers ---
+BENCHMARK_CASE(Render_Curve2D_Polynomial) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kPolynomial1D);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawCurve2D(dl, vt, ast, kColor, 2.0f, arena);
+    });
+}
+
+// Alternates between two views a pixel apart, as a pan does, so every op also captures the
+// curve's hover segments instead of republishing the ones held for an unchanged view.
+BENCHMARK_CASE(Render_Curve2D_Polynomial_Pan) {
+    ViewTransform vt = sceneView();
+    const double panStep = 1.0 / vt.scaleX;
+    const ASTNodePtr ast = parseOrReport(Corpus::kPolynomial1D);
+    bool shifted = false;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        shifted = !shifted;
+        vt.centerX += shifted ? panStep : -panStep;
+        PlotRenderer::drawCurve2D(dl, vt, ast, kColor, 2.0f, arena);
+    });
+}
+
+BENCHMARK_CASE(Render_Heatmap_TrigHeavy) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kTrigHeavy);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawHeatmap(dl, vt, ast, kColor, 0.6f, 0, arena);
+    });
+}
+
+// The heat map plus 20 iso-lines traced from its own samples in one sweep. Compare with
+// Render_ImplicitContour2D_TrigHeavy_x20, the same lines as 20 separate F(x,y)-c=0 formulas.
+BENCHMARK_CASE(Render_Heatmap_TrigHeavy_Contours20) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kTrigHeavy);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawHeatmap(dl, vt, ast, kColor, 0.6f, 20, arena);
+    });
+}
+
+BENCHMARK_CASE(Render_CrossSection_Torus) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kImplicitTorus);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawCrossSection(dl, vt, ast, 0.5f, kColor, 0.6f, 0, arena);
+    });
+}
+
+// Scrubbing z over a volume sampled once up front: no formula evaluations per op.
+BENCHMARK_CASE(Render_CrossSection_Torus_Volume) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kImplicitTorus);
+    VolumeCache::Domain domain;
+    domain.xMin = vt.worldXMin();
+    domain.xMax = vt.worldXMax();
+    domain.yMin = vt.worldYMin();
+    domain.yMax = vt.worldYMax();
+    domain.nx = PlotRenderer::kCrossSectionResX;
+    domain.ny = PlotRenderer::kCrossSectionResY;
+    domain.nz = 81;
+    const auto volume = VolumeCache::sample(ast, domain);
+    float zSlice = 0.0f;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        zSlice = (zSlice > 9.0f) ? -9.0f : zSlice + 0.37f;
+        PlotRenderer::drawCrossSection(dl, vt, *volume, zSlice, kColor, 0.6f, 0, arena);
+    });
+}
+
+// Full progressive ray-march (coarse pass to converged) of the torus interior at half the scene
+// resolution, restarted every op by a camera change. The volume is sampled once up front.
+BENCHMARK_CASE(Render_VolumeRaymarch_Torus) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(std::string("-(") + Corpus::kImplicitTorus + ")");
+    VolumeCache::Domain domain;
+    domain.xMin = vt.worldXMin();
+    domain.xMax = vt.worldXMax();
+    domain.yMin = vt.worldYMin();
+    domain.yMax = vt.worldYMax();
+    domain.zMin = -10.0;
+    domain.zMax = 10.0;
+    domain.nx = 64;
+    domain.ny = 64;
+    domain.nz = 65;
+    const auto volume = VolumeCache::sample(ast, domain);
+
+    VolumeRaymarcher::Camera camera;
+    camera.azimuthDeg = 30.0f;
+    camera.elevationDeg = -60.0f;
+    camera.zScale = 1.5f;
+    const Vec2 origin = vt.worldToScreen(0.0, 0.0);
+    camera.originX = origin.x;
+    camera.originY = origin.y;
+    camera.scale = std::min(vt.scaleX, vt.scaleY);
+    camera.width = vt.screenWidth;
+    camera.height = vt.screenHeight;
+    VolumeRaymarcher::TransferFunction transfer;
+    for (size_t i = 0; i < transfer.palette.size(); ++i) {
+        transfer.palette[i] = PlotRenderer::heatColor(static_cast<double>(i) / 255.0, 0.0, 1.0, kColor, 1.0f);
+    }
+
+    VolumeRaymarcher raymarcher;
+    std::uint64_t samples = 0;
+    std::uint64_t ops = 0;
+    state.measure(1.0, [&]() {
+        camera.azimuthDeg = (camera.azimuthDeg > 180.0f) ? -180.0f : camera.azimuthDeg + 7.0f;
+        raymarcher.setScene(volume, camera, transfer, 640, 360);
+        int top = 0;
+        int bottom = 0;
+        while (!raymarcher.converged()) {
+            raymarcher.refine(TaskPool::shared(), 1e9, top, bottom);
+        }
+        samples += raymarcher.samplesTaken();
+        ++ops;
+        state.consume(static_cast<double>(raymarcher.pixels()[180 * 640 + 320] >> 24));
+    });
+    state.counter("samples", ops ? static_cast<double>(samples) / static_cast<double>(ops) : 0.0);
+    state.counter("workers", static_cast<double>(TaskPool::shared().workerCount()));
+}
+
+// Full progressive ray trace (coarse pass to converged) of the torus surface at a quarter of
+// the scene resolution per axis, restarted every op by a camera change. Compare with
+// Render_ImplicitSurface3D_Torus_Cold, which meshes the same box.
+BENCHMARK_CASE(Render_ImplicitTrace_Torus) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kImplicitTorus);
+    ImplicitSurfaceTracer::Bounds bounds;
+    bounds.xMin = vt.worldXMin();
+    bounds.xMax = vt.worldXMax();
+    bounds.yMin = vt.worldYMin();
+    bounds.yMax = vt.worldYMax();
+    PlotRenderer::implicitZRange(vt, 0.0f, bounds.zMin, bounds.zMax);
+
+    ImplicitSurfaceTracer::Camera camera;
+    camera.azimuthDeg = 30.0f;
+    camera.elevationDeg = -60.0f;
+    camera.zScale = 1.5f;
+    const Vec2 origin = vt.worldToScreen(0.0, 0.0);
+    camera.originX = origin.x;
+    camera.originY = origin.y;
+    camera.scale = std::min(vt.scaleX, vt.scaleY);
+    camera.width = vt.screenWidth;
+    camera.height = vt.screenHeight;
+    ImplicitSurfaceTracer::Shading shading;
+
+    ImplicitSurfaceTracer tracer;
+    std::uint64_t evaluations = 0;
+    std::uint64_t ops = 0;
+    state.measure(1.0, [&]() {
+        camera.azimuthDeg = (camera.azimuthDeg > 180.0f) ? -180.0f : camera.azimuthDeg + 7.0f;
+        tracer.setScene(ast, bounds, camera, shading, 320, 180);
+        int top = 0;
+        int bottom = 0;
+        while (!tracer.converged()) {
+            tracer.refine(TaskPool::shared(), 1e9, top, bottom);
+        }
+        evaluations += tracer.evaluations();
+        ++ops;
+        state.consume(static_cast<double>(tracer.pixels()[90 * 320 + 160] >> 24));
+    });
+    state.counter("evals/px", ops ? static_cast<double>(evaluations) / static_cast<double>(ops) / (320.0 * 180.0) : 0.0);
+    state.counter("workers", static_cast<double>(TaskPool::shared().workerCount()));
+}
+
+BENCHMARK_CASE(Render_Surface3D_TrigHeavy) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kTrigHeavy);
+    const PlotRenderer::Surface3DOptions options;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawSurface3D(dl, vt, ast, kColor, options, arena);
+    });
+}
+
+// Warm: the implicit mesh cache hits every op (camera-only cost: projection, sort, emit).
+BENCHMARK_CASE(Render_ImplicitSurface3D_Torus_Warm) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kImplicitTorus);
+    const PlotRenderer::Surface3DOptions options;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawImplicitSurface3D(dl, vt, ast, kColor, options, arena);
+    });
+}
+
+// Cold: the view alternates by a sub-pixel pan so every op samples and meshes the volume.
+BENCHMARK_CASE(Render_ImplicitSurface3D_Torus_Cold) {
+    ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(Corpus::kImplicitTorus);
+    PlotRenderer::Surface3DOptions options;
+    options.implicitResolution = 48;
+    bool flip = false;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        vt.centerX = flip ? 1.0e-4 : 0.0;
+        flip = !flip;
+        PlotRenderer::drawImplicitSurface3D(dl, vt, ast, kColor, options, arena);
+    });
+}
+
+// The sphere x^2 + y^2 + z^2 = 16 both ways: re-meshed implicitly every op, and solved for z
+// and drawn as two z=f(x,y) branches at the same x/y density (what PlotPanel does).
+static const char* kSphere = "x^2 + y^2 + z^2 - 16";
+
+BENCHMARK_CASE(Render_ImplicitSurface3D_Sphere_Cold) {
+    ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(kSphere);
+    PlotRenderer::Surface3DOptions options;
+    options.implicitResolution = 48;
+    bool flip = false;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        vt.centerX = flip ? 1.0e-4 : 0.0;
+        flip = !flip;
+        PlotRenderer::drawImplicitSurface3D(dl, vt, ast, kColor, options, arena);
+    });
+}
+
+// A box turned about z, so its edges and corners cut across the grid: surface nets at full
+// quality against dual contouring at a quarter of it, which keeps the edges as sharp.
+static const char* kSharpBox = "max(max(abs(x + 0.5*y), abs(y - 0.5*x)), abs(z)) - 3";
+
+BENCHMARK_CASE(Render_ImplicitSurface3D_Box_Nets64) {
+    ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(kSharpBox);
+    PlotRenderer::Surface3DOptions options;
+    options.implicitResolution = 64;
+    bool flip = false;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        vt.centerX = flip ? 1.0e-4 : 0.0;
+        flip = !flip;
+        PlotRenderer::drawImplicitSurface3D(dl, vt, ast, kColor, options, arena);
+    });
+}
+
+BENCHMARK_CASE(Render_ImplicitSurface3D_Box_DualContouring16) {
+    ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport(kSharpBox);
+    PlotRenderer::Surface3DOptions options;
+    options.implicitResolution = 16;
+    options.sharpFeatures = true;
+    bool flip = false;
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        vt.centerX = flip ? 1.0e-4 : 0.0;
+        flip = !flip;
+        PlotRenderer::drawImplicitSurface3D(dl, vt, ast, kColor, options, arena);
+    });
+}
+
+// Cursor picking on the torus meshed at the highest implicit resolution: building the
+// hierarchy (once per new mesh, on a background thread in the app) and one pick per mouse move,
+// over a 64x36 grid of screen points.
+static std::shared_ptr<const MeshBvh::Mesh> pickMesh(const ViewTransform& vt) {
+    HeadlessImGui imgui;
+    const ASTNodePtr ast = parseOrReport(Corpus::kImplicitTorus);
+    PlotRenderer::Surface3DOptions options;
+    options.implicitResolution = 96;
+    PlotRenderer::drawImplicitSurface3D(imgui.beginDrawList(), vt, ast, kColor, options);
+    return PlotRenderer::surfaceMesh(ast.get());
+}
+
+BENCHMARK_CASE(Pick_Torus_BuildBvh) {
+    const auto mesh = pickMesh(sceneView());
+    size_t nodes = 0;
+    state.measure(static_cast<double>(mesh->size()), [&]() {
+        nodes = MeshBvh::build(mesh)->nodeCount();
+    });
+    state.counter("triangles", static_cast<double>(mesh->size()));
+    state.counter("nodes", static_cast<double>(nodes));
+}
+
+BENCHMARK_CASE(Pick_Torus_ScreenRay) {
+    const ViewTransform vt = sceneView();
+    const auto bvh = MeshBvh::build(pickMesh(vt));
+    const PlotRenderer::Surface3DOptions options;
+    int next = 0;
+    std::uint64_t picks = 0;
+    std::uint64_t hits = 0;
+    state.measure(1.0, [&]() {
+        const float sx = vt.screenWidth * ((next % 64) + 0.5f) / 64.0f;
+        const float sy = vt.screenHeight * ((next / 64) + 0.5f) / 36.0f;
+        next = (next + 1) % (64 * 36);
+        MeshBvh::Vec3 origin{};
+        MeshBvh::Vec3 direction{};
+        PlotRenderer::pickRay3D(vt, options, sx, sy, origin, direction);
+        MeshBvh::Hit hit;
+        hits += bvh->intersect(origin, direction, hit) ? 1 : 0;
+        ++picks;
+    });
+    state.counter("triangles", static_cast<double>(bvh->mesh().size()));
+    state.counter("hitRate", picks > 0 ? static_cast<double>(hits) / static_cast<double>(picks) : 0.0);
+}
+
+// Hover lookups over a wiggly curve drawn for the scene view: through the grid index, and by
+// scanning every segment as the reference.
+static std::shared_ptr<const CurveIndex> hoverCurve(const ViewTransform& vt) {
+    HeadlessImGui imgui;
+    const ASTNodePtr ast = parseOrReport("3*sin(3*x) + x/2");
+    PlotRenderer::drawCurve2D(imgui.beginDrawList(), vt, ast, kColor);
+    return PlotRenderer::curveIndex(ast.get(), vt);
+}
+
+template <typename Query>
+static void hoverSweep(BenchmarkState& state, const ViewTransform& vt, Query&& query) {
+    int next = 0;
+    std::uint64_t picks = 0;
+    std::uint64_t hits = 0;
+    state.measure(1.0, [&]() {
+        const float sx = vt.screenOriginX + vt.screenWidth * ((next % 64) + 0.5f) / 64.0f;
+        const float sy = vt.screenOriginY + vt.screenHeight * ((next / 64) + 0.5f) / 36.0f;
+        next = (next + 1) % (64 * 36);
+        hits += query(sx, sy) ? 1 : 0;
+        ++picks;
+    });
+    state.counter("hitRate", picks > 0 ? static_cast<double>(hits) / static_cast<double>(picks) : 0.0);
+}
+
+BENCHMARK_CASE(Pick_Curve2D_Hover) {
+    const ViewTransform vt = sceneView();
+    const auto index = hoverCurve(vt);
+    hoverSweep(state, vt, [&](float sx, float sy) {
+        CurveIndex::Hit hit;
+        return index->nearest(sx, sy, 8.0f, hit);
+    });
+    state.counter("segments", static_cast<double>(index->segments().size()));
+}
+
+BENCHMARK_CASE(Pick_Curve2D_HoverScan) {
+    const ViewTransform vt = sceneView();
+    const auto index = hoverCurve(vt);
+    hoverSweep(state, vt, [&](float sx, float sy) {
+        float best = 8.0f * 8.0f;
+        bool found = false;
+        for (const CurveIndex::Segment& s : index->segments()) {
+            const float dx = s.x1 - s.x0;
+            const float dy = s.y1 - s.y0;
+            const float lengthSq = dx * dx + dy * dy;
+            const float t = lengthSq > 0.0f
+                ? std::clamp(((sx - s.x0) * dx + (sy - s.y0) * dy) / lengthSq, 0.0f, 1.0f)
+                : 0.0f;
+            const float ex = s.x0 + t * dx - sx;
+            const float ey = s.y0 + t * dy - sy;
+            if (ex * ex + ey * ey <= best) {
+                best = ex * ex + ey * ey;
+                found = true;
+            }
+        }
+        return found;
+    });
+    state.counter("segments", static_cast<double>(index->segments().size()));
+}
+
+// Roots, extrema and pairwise intersections of eight curves drawn for the scene view, from
+// their published samples (one full background pass, run synchronously).
+BENCHMARK_CASE(Analyze_Curves_Features) {
+    const ViewTransform vt = sceneView();
+    HeadlessImGui imgui;
+    ImDrawList* dl = imgui.beginDrawList();
+    std::vector<CurveAnalysis::Curve> curves;
+    for (int k = 1; k <= 8; ++k) {
+        const std::string formula = std::to_string(k) + "*sin(x + " + std::to_string(k) + ") - x/" +
+                                    std::to_string(k);
+        CurveAnalysis::Curve& curve = curves.emplace_back();
+        curve.branches.push_back(parseOrReport(formula));
+        PlotRenderer::drawCurve2D(dl, vt, curve.branches.front(), kColor, 2.0f, nullptr, true);
+        curve.samples = PlotRenderer::curveSamples(curve.branches.front().get(), vt);
+    }
+    size_t features = 0;
+    state.measure(1.0, [&]() {
+        features = CurveAnalysis::analyze(curves)->features.size();
+    });
+    state.counter("curves", static_cast<double>(curves.size()));
+    state.counter("features", static_cast<double>(features));
+}
+
+// A noisy random walk of `count` points across the scene view's x range.
+static std::shared_ptr<const DataSeries> randomWalk(const ViewTransform& vt, size_t count) {
+    std::mt19937 rng(5);
+    std::normal_distribution<double> step(0.0, 0.02);
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    double y = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = vt.worldXMin() + (vt.worldXMax() - vt.worldXMin()) * static_cast<double>(i) / count;
+        y = 0.999 * y + step(rng);
+        ys[i] = 2.0 * std::sin(xs[i]) + y;
+    }
+    return DataSeries::fromPoints(std::move(xs), std::move(ys));
+}
+
+// Drawing a series costs about two vertices per pixel column whatever its size: compare the
+// 100k and 10M point cases.
+BENCHMARK_CASE(Render_DataSeries_100k) {
+    const ViewTransform vt = sceneView();
+    const auto series = randomWalk(vt, 100000);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawDataSeries(dl, vt, *series, kColor, 1.5f, arena);
+    });
+}
+
+BENCHMARK_CASE(Render_DataSeries_10M) {
+    const ViewTransform vt = sceneView();
+    const auto series = randomWalk(vt, 10000000);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawDataSeries(dl, vt, *series, kColor, 1.5f, arena);
+    });
+}
+
+// Loading a 1M-line CSV: parallel parse of the mapped text plus the min/max pyramid.
+BENCHMARK_CASE(Load_DataSeries_Csv1M) {
+    const std::string path = (std::filesystem::temp_directory_path() / "xf_bench_series.csv").string();
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "x,y\n";
+        std::mt19937 rng(9);
+        std::uniform_real_distribution<double> value(-1.0, 1.0);
+        for (int i = 0; i < 1000000; ++i) {
+            out << i * 0.001 << ',' << value(rng) << '\n';
+        }
+    }
+    size_t points = 0;
+    state.measure(1000000.0, [&]() {
+        std::string error;
+        const auto series = DataSeries::load(path, error);
+        points = series ? series->size() : 0;
+    });
+    state.counter("points", static_cast<double>(points));
+    std::filesystem::remove(path);
+}
+
+// 10M points in two overlapping Gaussian blobs.
+static std::shared_ptr<const ScatterDensity> scatterCloud() {
+    std::mt19937 rng(13);
+    std::normal_distribution<double> coordinate(0.0, 1.5);
+    std::vector<double> records(2 * 10000000);
+    for (size_t i = 0; i < records.size(); i += 2) {
+        const double shift = (i % 4 == 0) ? -1.5 : 2.0;
+        records[i] = coordinate(rng) + shift;
+        records[i + 1] = 0.5 * coordinate(rng) + 0.3 * shift;
+    }
+    return ScatterDensity::fromRecords(std::move(records), false);
+}
+
+static ScatterDensity::Window scatterWindow(const ViewTransform& vt) {
+    return { vt.worldXMin(), vt.worldXMax(), vt.worldYMin(), vt.worldYMax(),
+             static_cast<int>(vt.screenWidth), static_cast<int>(vt.screenHeight) };
+}
+
+// Zoomed out, a view is resampled from the bin pyramid: cost follows the pixels, not the points.
+BENCHMARK_CASE(Aggregate_Scatter10M_Pyramid) {
+    ViewTransform vt = sceneView();
+    vt.scaleX = vt.scaleY = 20.0;
+    const auto points = scatterCloud();
+    const ScatterDensity::Window window = scatterWindow(vt);
+    std::array<std::uint32_t, 256> palette;
+    for (size_t i = 0; i < palette.size(); ++i) {
+        palette[i] = PlotRenderer::heatColor(static_cast<double>(i) / 255.0, 0.0, 1.0, kColor, 0.62f);
+    }
+    std::vector<std::uint32_t> pixels;
+    bool resolved = points->pyramidResolves(window);
+    state.measure(static_cast<double>(window.width) * window.height, [&]() {
+        const auto grid = points->aggregate(window);
+        points->colorize(*grid, palette, true, pixels);
+    });
+    state.counter("resolved", resolved ? 1.0 : 0.0);
+}
+
+// Zoomed in beyond the finest level, the view is binned from every point (in the background).
+BENCHMARK_CASE(Bin_Scatter10M_Exact) {
+    ViewTransform vt = sceneView();
+    vt.scaleX = vt.scaleY = 400.0;
+    const auto points = scatterCloud();
+    const ScatterDensity::Window window = scatterWindow(vt);
+    size_t binned = 0;
+    state.measure(static_cast<double>(points->size()), [&]() {
+        const auto grid = points->bin(window);
+        binned = static_cast<size_t>(grid->maxCount);
+    });
+    state.counter("resolved", points->pyramidResolves(window) ? 1.0 : 0.0);
+    state.counter("busiest", static_cast<double>(binned));
+}
+
+// Telemetry text for the scene's x range: one "x y" line per sample.
+static std::string telemetryText(const ViewTransform& vt, size_t count) {
+    std::string text;
+    text.reserve(count * 24);
+    char line[64];
+    for (size_t i = 0; i < count; ++i) {
+        const double x = vt.worldXMin() + (vt.worldXMax() - vt.worldXMin()) * static_cast<double>(i) / count;
+        const int length = std::snprintf(line, sizeof(line), "%.7f %.4f\n", x, std::sin(7.0 * x) + 0.01 * (i % 13));
+        text.append(line, static_cast<size_t>(length));
+    }
+    return text;
+}
+
+// Producer and consumer halves of a live series on one thread: parse 100k lines in 64 KB
+// reads into the queue, then move them into the window (per sample).
+BENCHMARK_CASE(Ingest_StreamSeries_100k) {
+    const ViewTransform vt = sceneView();
+    const std::string text = telemetryText(vt, 100000);
+    state.measure(100000.0, [&]() {
+        StreamSeries stream;
+        for (size_t offset = 0; offset < text.size(); offset += 65536) {
+            stream.feed(text.data() + offset, std::min<size_t>(65536, text.size() - offset));
+            stream.poll();
+        }
+    });
+}
+
+// A full 1M-sample window drawn every frame: two vertices per pixel column, like a DataSeries.
+BENCHMARK_CASE(Render_StreamSeries_1M) {
+    const ViewTransform vt = sceneView();
+    StreamSeries window(size_t(1) << 20);
+    // 5000 more samples than fit, so the window has wrapped.
+    const std::string text = telemetryText(vt, (size_t(1) << 20) + 5000);
+    for (size_t offset = 0; offset < text.size(); offset += 65536) {
+        window.feed(text.data() + offset, std::min<size_t>(65536, text.size() - offset));
+        window.poll();
+    }
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawStreamSeries(dl, vt, window, kColor, 1.5f, arena);
+    });
+    state.counter("samples", static_cast<double>(window.size()));
+}
+
+BENCHMARK_CASE(Render_SolvedSurface3D_Sphere) {
+    const ViewTransform vt = sceneView();
+    const EquationSolver::Solution solution = EquationSolver::solve(parseOrReport(kSphere), "z");
+    PlotRenderer::Surface3DOptions options;
+    options.resolution = 48;
+    PlotRenderer::implicitZRange(vt, 0.0f, options.zClipMin, options.zClipMax);
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawSurface3D(dl, vt, solution, kColor, options, arena);
+    });
+}
+
+BENCHMARK_CASE(Render_ImplicitContour2D_Circle) {
+    const ViewTransform vt = sceneView();
+    const ASTNodePtr ast = parseOrReport("x^2 + y^2 - 16 + sin(3*x)");
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        PlotRenderer::drawImplicitContour2D(dl, vt, ast, kColor, 2.0f, arena);
+    });
+}
+
+// Before heat-map contours, 20 iso-lines took 20 implicit formulas, each resampling the grid.
+BENCHMARK_CASE(Render_ImplicitContour2D_TrigHeavy_x20) {
+    const ViewTransform vt = sceneView();
+    std::vector<ASTNodePtr> asts;
+    for (int k = 0; k < 20; ++k) {
+        const double level = -2.5 + 5.0 * (k + 1) / 21.0;
+        asts.push_back(parseOrReport("(" + std::string(Corpus::kTrigHeavy) + ") - (" +
+                                     std::to_string(level) + ")"));
+    }
+    benchDraw(state, [&](ImDrawList* dl, FrameArena* arena) {
+        for (const ASTNodePtr& ast : asts) {
+            PlotRenderer::drawImplicitContour2D(dl, vt, ast, kColor, 1.0f, arena);
+        }
+    });
+}
+
+} // namespace XpressFormulaBenchmarks
@@ -0,0 +1,88 @@
+// ReplayBenchmarks.cpp - Frame-time distribution for a scripted interaction (drag, wheel zoom,
+//                        auto-rotate) replayed headlessly through PlotPanel::render.
+#include "BenchmarkHarness.h"
+#include "FormulaCorpus.h"
+#include "InteractionReplay.h"
+#include <cstdio>
+#include <sstream>
+
+using namespace XpressFormula;
+using namespace XpressFormula::Benchmarks;
+
+namespace XpressFormulaBenchmarks {
+
+static UI::FormulaEntry makeFormula(const std::string& text, int paletteIndex) {
+    UI::FormulaEntry entry;
+    std::snprintf(entry.inputBuffer, sizeof(entry.inputBuffer), "%s", text.c_str());
+    for (int i = 0; i < 4; ++i) {
+        entry.color[i] = UI::kDefaultPalette[paletteIndex % UI::kPaletteSize][i];
+    }
+    entry.parse();
+    return entry;
+}
+
+// Builds the same script a user would record: 1 s idle, 1 s left-drag, 0.5 s wheel zoom,
+// then 1 s of auto-rotation, at 60 fps over a 1000x700 plot.
+static UI::InteractionScript buildDragZoomRotateScript(const std::string& formula) {
+    const float dt = 1.0f / 60.0f;
+    Core::ViewTransform view;
+    std::vector<UI::FormulaEntry> formulas = { makeFormula(formula, 0) };
+    UI::PlotSettings settings;
+
+    UI::InteractionRecorder recorder;
+    recorder.start(view, formulas, settings);
+    UI::InteractionInput input;
+    input.plotWidth = 1000.0f;
+    input.plotHeight = 700.0f;
+    input.mouseX = 500.0f;
+    input.mouseY = 350.0f;
+
+    int frame = 0;
+    auto record = [&]() {
+        recorder.recordFrame(frame * dt, dt, input, formulas, settings);
+        ++frame;
+    };
+    for (int i = 0; i < 60; ++i) record();
+    input.mouseLeft = true;
+    for (int i = 0; i < 60; ++i) {
+        input.mouseX += 3.0f;
+        input.mouseY += (i % 2 == 0) ? 1.0f : -1.0f;
+        record();
+    }
+    input.mouseLeft = false;
+    for (int i = 0; i < 30; ++i) {
+        input.wheel = (i % 3 == 0) ? 1.0f : 0.0f;
+        record();
+    }
+    input.wheel = 0.0f;
+    settings.autoRotate = true;
+    for (int i = 0; i < 60; ++i) record();
+
+    std::istringstream in(recorder.text());
+    UI::InteractionScript script;
+    std::string error;
+    if (!UI::InteractionScript::read(in, script, error)) {
+        std::fprintf(stderr, "Synthetic script failed to load: %s\n", error.c_str());
+    }
+    return script;
+}
+
+static void benchReplay(BenchmarkState& state, const std::string& formula) {
+    const UI::InteractionScript script = buildDragZoomRotateScript(formula);
+    ReplayReport report;
+    state.measure(static_cast<double>(script.frames.size()), [&]() {
+        report = InteractionReplay::run(script);
+        state.consume(report.totalMs);
+    });
+    state.counter("p50Ms", report.p50Ms);
+    state.counter("p95Ms", report.p95Ms);
+    state.counter("p99Ms", report.p99Ms);
+    state.counter("maxMs", report.maxMs);
+}
+
+BENCHMARK_CASE(Replay_DragZoomRotate_Surface) { benchReplay(state, Corpus::kTrigHeavy); }
+BENCHMARK_CASE(Replay_DragZoomRotate_ImplicitTorus) {
+    benchReplay(state, std::string(Corpus::kImplicitTorus) + " = 0");
+}
+
+} // namespace XpressFormulaBenchmarks
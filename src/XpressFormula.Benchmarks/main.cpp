@@ -0,0 +1,79 @@
+// main.cpp - Benchmark runner entry point.
+//
+// Usage:
+//   XpressFormula.Benchmarks [--filter <text>] [--min-time-ms <ms>] [--repetitions <n>]
+//                            [--json <out.json>] [--baseline <baseline.json>] [--threshold <percent>]
+//   XpressFormula.Benchmarks --replay <recording.xfrec> [--warmup <passes>] [--json <out.json>]
+#include "BenchmarkHarness.h"
+#include "InteractionReplay.h"
+#include <cstring>
+
+namespace {
+
+void printUsage() {
+    std::printf(
+        "Usage: XpressFormula.Benchmarks [options]\n"
+        "  --filter <text>        run only cases whose name contains <text>\n"
+        "  --min-time-ms <ms>     minimum wall time per repetition (default 60)\n"
+        "  --repetitions <n>      repetitions per case; the median is reported (default 5)\n"
+        "  --json <path>          write results as JSON\n"
+        "  --baseline <path>      compare against a JSON file written by --json\n"
+        "  --threshold <percent>  regression threshold for --baseline (default 10)\n"
+        "  --replay <path>        replay an interaction recording (F9 in the app) and report\n"
+        "                         the frame-time distribution instead of running benchmarks\n"
+        "  --warmup <passes>      untimed replay passes before the measured one (default 0)\n");
+}
+
+int runReplay(const std::string& path, int warmupPasses, const std::string& jsonPath) {
+    using namespace XpressFormula;
+    UI::InteractionScript script;
+    std::string error;
+    if (!UI::InteractionScript::load(path, script, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+    const Benchmarks::ReplayReport report = Benchmarks::InteractionReplay::run(script, warmupPasses);
+    Benchmarks::InteractionReplay::printReport(report);
+    if (!jsonPath.empty() && !Benchmarks::InteractionReplay::writeJson(jsonPath, report)) {
+        std::fprintf(stderr, "Could not write %s\n", jsonPath.c_str());
+        return 2;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    XpressFormula::Benchmarks::BenchmarkOptions options;
+    std::string replayPath;
+    int warmupPasses = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(arg, "--min-time-ms") == 0 && hasValue) {
+            options.minTimeMs = std::max(1.0, std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--repetitions") == 0 && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0 && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (std::strcmp(arg, "--threshold") == 0 && hasValue) {
+            options.thresholdPercent = std::max(0.0, std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--replay") == 0 && hasValue) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(arg, "--warmup") == 0 && hasValue) {
+            warmupPasses = std::max(0, std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) ? 0 : 2;
+        }
+    }
+
+    if (!replayPath.empty()) {
+        return runReplay(replayPath, warmupPasses, options.jsonPath);
+    }
+    return XpressFormula::Benchmarks::BenchmarkRegistry::instance().runAll(options);
+}
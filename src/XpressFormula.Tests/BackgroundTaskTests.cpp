@@ -0,0 +1,54 @@
+// BackgroundTaskTests.cpp - Tests for the cancellable single-result worker.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/BackgroundTask.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+
+namespace XpressFormulaTests {
+
+TEST_CASE(BackgroundTask_HandsOverTheResultOnce) {
+    BackgroundTask<int> task;
+    Assert::IsFalse(task.finished());
+    task.start([](const std::atomic<bool>*) { return std::make_shared<const int>(42); });
+    while (!task.finished()) {
+        std::this_thread::yield();
+    }
+    auto result = task.take();
+    Assert::IsTrue(result != nullptr);
+    Assert::AreEqual(42, *result);
+    Assert::IsFalse(task.finished());
+}
+
+TEST_CASE(BackgroundTask_StartingAgainCancelsTheRunInFlight) {
+    BackgroundTask<int> task;
+    std::atomic<bool> sawCancel{ false };
+    task.start([&sawCancel](const std::atomic<bool>* cancel) -> std::shared_ptr<const int> {
+        while (!cancel->load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        sawCancel = true;
+        return nullptr;
+    });
+    task.start([](const std::atomic<bool>*) { return std::make_shared<const int>(7); });
+    Assert::IsTrue(sawCancel.load());
+    while (!task.finished()) {
+        std::this_thread::yield();
+    }
+    Assert::AreEqual(7, *task.take());
+
+    // Destroying a task joins the run it still owns.
+    BackgroundTask<int> abandoned;
+    abandoned.start([](const std::atomic<bool>* cancel) -> std::shared_ptr<const int> {
+        while (!cancel->load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        }
+        return nullptr;
+    });
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,113 @@
+// ContourLinesTests.cpp - Tests for multi-level marching squares and polyline stitching.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/ContourLines.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// Distance from the centre of an n*n grid.
+static std::vector<double> radialGrid(int n) {
+    std::vector<double> values(static_cast<size_t>(n) * n);
+    const double c = 0.5 * (n - 1);
+    for (int iy = 0; iy < n; ++iy) {
+        for (int ix = 0; ix < n; ++ix) {
+            values[iy * n + ix] = std::hypot(ix - c, iy - c);
+        }
+    }
+    return values;
+}
+
+TEST_CASE(ContourLines_RingsAreClosedLoopsAtTheirLevel) {
+    const std::vector<double> values = radialGrid(21);
+    const double levels[] = { 2.5, 5.5, 8.5 };
+    ContourLines contours;
+    contours.extract(values.data(), 21, 21, levels, 3);
+
+    Assert::AreEqual(size_t(3), contours.polylines().size());
+    bool seen[3] = {};
+    for (const ContourLines::Polyline& line : contours.polylines()) {
+        Assert::IsTrue(line.closed);
+        Assert::IsTrue(line.count >= 8u);
+        seen[line.level] = true;
+        for (std::uint32_t i = line.first; i < line.first + line.count; ++i) {
+            const auto& p = contours.points()[i];
+            const double r = std::hypot(p.x - 10.0, p.y - 10.0);
+            Assert::IsTrue(std::abs(r - levels[line.level]) < 0.1);
+        }
+    }
+    Assert::IsTrue(seen[0] && seen[1] && seen[2]);
+}
+
+TEST_CASE(ContourLines_OpenLinesSpanTheGridAndBreakAtGaps) {
+    // v = ix on a 5x6 grid: vertical lines at x = 0.5, 1.5, 2.5, one point per row.
+    const int nx = 5;
+    const int ny = 6;
+    std::vector<double> values(nx * ny);
+    for (int iy = 0; iy < ny; ++iy) {
+        for (int ix = 0; ix < nx; ++ix) {
+            values[iy * nx + ix] = ix;
+        }
+    }
+    const double levels[] = { -3.0, 0.5, 1.5, 2.5, 9.0 };
+    ContourLines contours;
+    contours.extract(values.data(), nx, ny, levels, 5);
+    Assert::AreEqual(size_t(3), contours.polylines().size());
+    for (const ContourLines::Polyline& line : contours.polylines()) {
+        Assert::IsFalse(line.closed);
+        Assert::AreEqual(std::uint32_t(ny), line.count);
+        for (std::uint32_t i = line.first; i < line.first + line.count; ++i) {
+            Assert::AreEqual(static_cast<float>(levels[line.level]), contours.points()[i].x);
+        }
+        // Stitched in order along the line.
+        const auto& a = contours.points()[line.first];
+        const auto& b = contours.points()[line.first + line.count - 1];
+        Assert::AreEqual(5.0f, std::abs(b.y - a.y));
+    }
+
+    // A NaN sample removes the four cells around it and splits the line through them.
+    values[2 * nx + 1] = std::numeric_limits<double>::quiet_NaN();
+    contours.extract(values.data(), nx, ny, &levels[2], 1);
+    Assert::AreEqual(size_t(2), contours.polylines().size());
+    Assert::AreEqual(std::uint32_t(2 + 3), contours.polylines()[0].count + contours.polylines()[1].count);
+}
+
+TEST_CASE(ContourLines_OneSweepMatchesSeparateLevels) {
+    // Saddles included: sin(x) * cos(y) over a few periods.
+    const int nx = 40;
+    const int ny = 30;
+    std::vector<double> values(nx * ny);
+    for (int iy = 0; iy < ny; ++iy) {
+        for (int ix = 0; ix < nx; ++ix) {
+            values[iy * nx + ix] = std::sin(ix * 0.4) * std::cos(iy * 0.5);
+        }
+    }
+    double levels[20];
+    ContourLines::evenLevels(-1.0, 1.0, 20, levels);
+    Assert::AreEqual(-1.0 + 2.0 / 21.0, levels[0]);
+
+    ContourLines all;
+    all.extract(values.data(), nx, ny, levels, 20);
+    size_t points = 0;
+    size_t lines = 0;
+    for (int k = 0; k < 20; ++k) {
+        ContourLines single;
+        single.extract(values.data(), nx, ny, &levels[k], 1);
+        lines += single.polylines().size();
+        points += single.points().size();
+        size_t matching = 0;
+        for (const ContourLines::Polyline& line : all.polylines()) {
+            matching += (line.level == k) ? 1u : 0u;
+        }
+        Assert::AreEqual(single.polylines().size(), matching);
+    }
+    Assert::AreEqual(lines, all.polylines().size());
+    Assert::AreEqual(points, all.points().size());
+    Assert::IsTrue(lines > 20u);
+}
+
+} // namespace XpressFormulaTests
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <stdexcept>
@@ -8,6 +9,21 @@
 #include <utility>
 #include <vector>
 
+#ifndef _MSC_VER
+// The tests use the MSVC bounds-checked string copy; this is enough of it for g++/clang builds.
+#ifndef _TRUNCATE
+#define _TRUNCATE (static_cast<std::size_t>(-1))
+#endif
+inline int strncpy_s(char* dest, std::size_t destSize, const char* src, std::size_t count) {
+    std::size_t length = std::strlen(src);
+    if (count != _TRUNCATE && count < length) length = count;
+    if (length >= destSize) length = destSize - 1;
+    std::memcpy(dest, src, length);
+    dest[length] = '\0';
+    return 0;
+}
+#endif
+
 namespace Microsoft::VisualStudio::CppUnitTestFramework {
 
 class TestFailure : public std::runtime_error {
@@ -0,0 +1,127 @@
+// CurveAnalysisTests.cpp - Tests for roots, extrema and intersections of sampled curves.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/Evaluator.h"
+#include "../XpressFormula/Core/Parser.h"
+#include "../XpressFormula/Plotting/CurveAnalysis.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// One-branch curve sampled like drawCurve2D: n + 1 samples over [xMin, xMax].
+static CurveAnalysis::Curve sampledCurve(const char* formula, double xMin, double xMax, int n) {
+    CurveAnalysis::Curve curve;
+    curve.branches.push_back(Parser::parse(formula).ast);
+    auto samples = std::make_shared<CurveAnalysis::Samples>();
+    samples->xMin = xMin;
+    samples->dx = (xMax - xMin) / n;
+    std::vector<double>& values = samples->branches.emplace_back(n + 1);
+    Evaluator::Variables vars;
+    for (int i = 0; i <= n; ++i) {
+        vars["x"] = xMin + i * samples->dx;
+        values[i] = Evaluator::evaluate(curve.branches.front(), vars);
+    }
+    curve.samples = samples;
+    return curve;
+}
+
+static std::vector<double> featureXs(const CurveAnalysis::Result& result, CurveAnalysis::Kind kind) {
+    std::vector<double> xs;
+    for (const CurveAnalysis::Feature& feature : result.features) {
+        if (feature.kind == kind) xs.push_back(feature.x);
+    }
+    std::sort(xs.begin(), xs.end());
+    return xs;
+}
+
+TEST_CASE(CurveAnalysis_BrentRefinesRootsAndMinimaBeyondTheSampleSpacing) {
+    auto cubic = [](double x) { return x * x * x - 2.0 * x - 5.0; };
+    const double root = CurveAnalysis::findRoot(cubic, 2.0, 3.0, cubic(2.0), cubic(3.0), 1e-14);
+    Assert::IsTrue(std::abs(root - 2.0945514815423265) < 1e-12);
+
+    auto bowl = [](double x) { return std::cos(x) + 0.1 * x; };
+    const double x = CurveAnalysis::findMinimum(bowl, 2.0, 4.5, 1e-12);
+    Assert::IsTrue(std::abs(x - (3.14159265358979 - std::asin(0.1))) < 1e-7);
+}
+
+TEST_CASE(CurveAnalysis_FindsRootsAndExtremaOfOneCurve) {
+    // sin(x) over [-7, 7]: roots at 0, +-pi, +-2pi; extrema at +-pi/2, +-3pi/2.
+    auto result = CurveAnalysis::analyze({ sampledCurve("sin(x)", -7.0, 7.0, 300) });
+    Assert::IsTrue(result != nullptr);
+    const double pi = 3.14159265358979323846;
+
+    const std::vector<double> roots = featureXs(*result, CurveAnalysis::Kind::Root);
+    Assert::AreEqual(size_t(5), roots.size());
+    for (int k = -2; k <= 2; ++k) {
+        Assert::IsTrue(std::abs(roots[k + 2] - k * pi) < 1e-9);
+    }
+    const std::vector<double> maxima = featureXs(*result, CurveAnalysis::Kind::Maximum);
+    const std::vector<double> minima = featureXs(*result, CurveAnalysis::Kind::Minimum);
+    Assert::AreEqual(size_t(2), maxima.size());
+    Assert::AreEqual(size_t(2), minima.size());
+    Assert::IsTrue(std::abs(maxima[0] + 1.5 * pi) < 1e-6 && std::abs(maxima[1] - 0.5 * pi) < 1e-6);
+    Assert::IsTrue(std::abs(minima[0] + 0.5 * pi) < 1e-6 && std::abs(minima[1] - 1.5 * pi) < 1e-6);
+    for (const CurveAnalysis::Feature& feature : result->features) {
+        if (feature.kind == CurveAnalysis::Kind::Maximum) {
+            Assert::IsTrue(std::abs(feature.y - 1.0) < 1e-9);
+        }
+    }
+}
+
+TEST_CASE(CurveAnalysis_IgnoresPoles) {
+    // tan(x) changes sign at its poles +-pi/2 and 1/x^2 peaks at its pole; neither is a feature.
+    auto tan = CurveAnalysis::analyze({ sampledCurve("tan(x)", -2.0, 2.0, 401) });
+    Assert::AreEqual(size_t(1), tan->features.size());
+    Assert::IsTrue(tan->features.front().kind == CurveAnalysis::Kind::Root);
+    Assert::IsTrue(std::abs(tan->features.front().x) < 1e-9);
+
+    auto pole = CurveAnalysis::analyze({ sampledCurve("1/x^2", -2.0, 2.0, 401) });
+    Assert::IsTrue(pole->features.empty());
+}
+
+TEST_CASE(CurveAnalysis_FindsIntersectionsBetweenCurves) {
+    // x^2 and x + 2 meet at x = -1 and x = 2.
+    auto result = CurveAnalysis::analyze({ sampledCurve("x^2", -5.0, 5.0, 333),
+                                           sampledCurve("x + 2", -5.0, 5.0, 333) });
+    const std::vector<double> xs = featureXs(*result, CurveAnalysis::Kind::Intersection);
+    Assert::AreEqual(size_t(2), xs.size());
+    Assert::IsTrue(std::abs(xs[0] + 1.0) < 1e-9 && std::abs(xs[1] - 2.0) < 1e-9);
+    for (const CurveAnalysis::Feature& feature : result->features) {
+        if (feature.kind == CurveAnalysis::Kind::Intersection) {
+            Assert::AreEqual(0, feature.curve);
+            Assert::AreEqual(1, feature.other);
+            Assert::IsTrue(std::abs(feature.y - feature.x * feature.x) < 1e-9);
+        }
+    }
+}
+
+TEST_CASE(CurveAnalysis_RunsInBackgroundAndKeepsResultsWhileTheViewMoves) {
+    CurveAnalysis analysis;
+    const CurveAnalysis::Curve curve = sampledCurve("x^2 - 1", -3.0, 3.0, 200);
+    std::shared_ptr<const CurveAnalysis::Result> result = analysis.request({ curve });
+    for (int i = 0; i < 2000 && analysis.pending(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        result = analysis.request({ curve });
+    }
+    Assert::IsFalse(analysis.pending());
+    Assert::IsTrue(result != nullptr);
+    Assert::AreEqual(size_t(3), result->features.size());  // two roots and the minimum
+
+    // New samples of the same formula (a pan): the previous result stands in meanwhile.
+    CurveAnalysis::Curve panned = sampledCurve("x^2 - 1", -2.0, 4.0, 200);
+    panned.branches = curve.branches;
+    Assert::IsTrue(analysis.request({ panned }) == result);
+    // A different formula has nothing to show until its own pass completes.
+    Assert::IsTrue(analysis.request({ sampledCurve("x", -2.0, 4.0, 200) }) == nullptr);
+    Assert::IsTrue(analysis.request({}) == nullptr);
+    Assert::IsFalse(analysis.pending());
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,85 @@
+// CurveIndexTests.cpp - Tests for the screen-space nearest-segment index of 2D curves.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/CurveIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// y = 300 + 200 sin(x / 40) over a 1000 x 600 screen, one segment per two pixels, as two
+// branches (the second shifted down by 150 pixels).
+static std::vector<CurveIndex::Segment> sineSegments() {
+    std::vector<CurveIndex::Segment> segments;
+    for (std::uint32_t branch = 0; branch < 2; ++branch) {
+        const float offset = 150.0f * static_cast<float>(branch);
+        for (int i = 0; i < 500; ++i) {
+            const float x0 = 2.0f * i;
+            const float x1 = x0 + 2.0f;
+            segments.push_back({ x0, 300.0f + offset + 200.0f * std::sin(x0 / 40.0f),
+                                 x1, 300.0f + offset + 200.0f * std::sin(x1 / 40.0f), branch });
+        }
+    }
+    return segments;
+}
+
+TEST_CASE(CurveIndex_FindsThePointOnTheCurve) {
+    CurveIndex index(sineSegments(), 0.0f, 0.0f, 1000.0f, 600.0f);
+    CurveIndex::Hit hit;
+    const float y = 300.0f + 200.0f * std::sin(101.0f / 40.0f);
+    Assert::IsTrue(index.nearest(101.0f, y, 8.0f, hit));
+    Assert::IsTrue(hit.distance < 0.5f);
+    Assert::IsTrue(std::abs(hit.x - 101.0f) < 1.0f);
+    Assert::AreEqual(0u, hit.branch);
+    // Nothing within the radius far from both branches.
+    Assert::IsFalse(index.nearest(500.0f, -200.0f, 8.0f, hit));
+}
+
+TEST_CASE(CurveIndex_MatchesBruteForceNearestSegment) {
+    const std::vector<CurveIndex::Segment> segments = sineSegments();
+    CurveIndex index(segments, 0.0f, 0.0f, 1000.0f, 600.0f);
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> sx(-20.0f, 1020.0f);
+    std::uniform_real_distribution<float> sy(-20.0f, 620.0f);
+    int hits = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const float x = sx(rng);
+        const float y = sy(rng);
+        const float radius = 24.0f;
+
+        float nearest = std::numeric_limits<float>::infinity();
+        for (const CurveIndex::Segment& s : segments) {
+            const float dx = s.x1 - s.x0;
+            const float dy = s.y1 - s.y0;
+            const float t = std::clamp(((x - s.x0) * dx + (y - s.y0) * dy) / (dx * dx + dy * dy), 0.0f, 1.0f);
+            nearest = std::min(nearest, std::hypot(s.x0 + t * dx - x, s.y0 + t * dy - y));
+        }
+
+        CurveIndex::Hit hit;
+        const bool found = index.nearest(x, y, radius, hit);
+        Assert::AreEqual(nearest <= radius, found);
+        if (found) {
+            ++hits;
+            Assert::IsTrue(std::abs(hit.distance - nearest) < 1e-3f);
+        }
+    }
+    Assert::IsTrue(hits > 100);
+}
+
+TEST_CASE(CurveIndex_KeepsSegmentsOutsideTheScreen) {
+    // A steep segment leaving the top of the screen is still found near its visible end.
+    std::vector<CurveIndex::Segment> segments{ { 10.0f, 50.0f, 12.0f, -900.0f, 0 } };
+    CurveIndex index(std::move(segments), 0.0f, 0.0f, 100.0f, 100.0f);
+    CurveIndex::Hit hit;
+    Assert::IsTrue(index.nearest(13.0f, 20.0f, 8.0f, hit));
+    Assert::IsTrue(hit.distance < 3.5f);
+    Assert::IsFalse(CurveIndex({}, 0.0f, 0.0f, 100.0f, 100.0f).nearest(10.0f, 10.0f, 8.0f, hit));
+}
+
+} // namespace XpressFormulaTests
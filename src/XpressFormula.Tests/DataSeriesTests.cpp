@@ -0,0 +1,198 @@
+// DataSeriesTests.cpp - Tests for measured data series: loading, min/max pyramid, decimation.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/DataSeries.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+static std::string tempSeriesPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static void writeFile(const std::string& path, const void* data, size_t size) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+// y = sin(x / 1000) + noise over x = 0 .. count - 1.
+static std::shared_ptr<const DataSeries> noisySine(size_t count) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.1);
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = static_cast<double>(i);
+        ys[i] = std::sin(static_cast<double>(i) / 1000.0) + noise(rng);
+    }
+    return DataSeries::fromPoints(std::move(xs), std::move(ys));
+}
+
+TEST_CASE(DataSeries_PyramidSummariesMatchBruteForce) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> value(-5.0, 5.0);
+    const size_t count = 5000;
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+    for (size_t i = 0; i < count; ++i) {
+        xs[i] = static_cast<double>(i);
+        ys[i] = (i % 97 == 5) ? std::numeric_limits<double>::quiet_NaN() : value(rng);
+    }
+    auto series = DataSeries::fromPoints(xs, ys);
+    Assert::AreEqual(count, series->size());
+
+    std::uniform_int_distribution<size_t> index(0, count);
+    for (int trial = 0; trial < 500; ++trial) {
+        size_t first = index(rng);
+        size_t last = index(rng);
+        if (first > last) std::swap(first, last);
+
+        double lo = std::numeric_limits<double>::infinity();
+        double hi = -lo;
+        size_t loAt = 0;
+        size_t hiAt = 0;
+        for (size_t i = first; i < last; ++i) {
+            if (std::isnan(ys[i])) continue;
+            if (ys[i] < lo) { lo = ys[i]; loAt = i; }
+            if (ys[i] > hi) { hi = ys[i]; hiAt = i; }
+        }
+        const DataSeries::Summary s = series->summarize(first, last);
+        Assert::AreEqual(lo, s.yMin);
+        Assert::AreEqual(hi, s.yMax);
+        if (!s.empty() && lo != hi) {
+            Assert::AreEqual(loAt < hiAt, s.minFirst);
+        }
+    }
+}
+
+TEST_CASE(DataSeries_DecimatesToTwoVerticesPerColumnWithTheColumnExtremes) {
+    auto series = noisySine(1000000);
+    ViewTransform vt;
+    vt.screenWidth = 800.0f;
+    vt.screenHeight = 600.0f;
+    vt.centerX = 500000.0;
+    vt.centerY = 0.0;
+    vt.scaleX = 800.0 / 1100000.0;  // the whole series and some margin
+    vt.scaleY = 100.0;
+
+    std::pmr::vector<Vec2> points;
+    series->decimate(vt, points);
+    Assert::IsTrue(points.size() <= 2 * 800 + 2);
+    Assert::IsTrue(points.size() > 800);
+
+    // Each column's two vertices span the y range of the points in that column.
+    const double xMin = vt.worldXMin();
+    for (int c = 0; c < 800; c += 37) {
+        const size_t first = series->lowerBound(xMin + c / vt.scaleX);
+        const size_t last = series->lowerBound(xMin + (c + 1) / vt.scaleX);
+        if (first == last) continue;
+        const DataSeries::Summary s = series->summarize(first, last);
+        const float sx = vt.screenOriginX + c + 0.5f;
+        float top = std::numeric_limits<float>::infinity();
+        float bottom = -top;
+        for (const Vec2& p : points) {
+            if (p.x == sx) {
+                top = std::min(top, p.y);
+                bottom = std::max(bottom, p.y);
+            }
+        }
+        Assert::IsTrue(std::abs(top - vt.worldToScreen(0.0, s.yMax).y) < 1e-3f);
+        Assert::IsTrue(std::abs(bottom - vt.worldToScreen(0.0, s.yMin).y) < 1e-3f);
+    }
+
+    // Zoomed in to a few points per column, the points themselves are drawn, plus one beyond
+    // each edge.
+    vt.centerX = 250000.0;
+    vt.scaleX = 4.0;
+    series->decimate(vt, points);
+    Assert::AreEqual(size_t(201 + 2), points.size());
+    Assert::IsTrue(points.front().x < vt.screenOriginX);
+    Assert::IsTrue(points.back().x > vt.screenOriginX + vt.screenWidth);
+}
+
+TEST_CASE(DataSeries_LoadsTextAndBinaryFiles) {
+    const std::string csvPath = tempSeriesPath("xf_series_test.csv");
+    const char csv[] = "time,value\r\n# comment\r\n3;30\r\n1, 10\r\n2\t20\r\nbad line\r\n4 nan\r\n";
+    writeFile(csvPath, csv, sizeof(csv) - 1);
+    std::string error;
+    auto text = DataSeries::load(csvPath, error);
+    Assert::IsTrue(text != nullptr);
+    Assert::AreEqual(size_t(4), text->size());
+    for (size_t i = 0; i < 3; ++i) {
+        Assert::AreEqual(static_cast<double>(i + 1), text->x(i));  // sorted by x
+        Assert::AreEqual(10.0 * (i + 1), text->y(i));
+    }
+    Assert::IsTrue(std::isnan(text->y(3)));
+    Assert::AreEqual(10.0, text->bounds().yMin);
+    Assert::AreEqual(30.0, text->bounds().yMax);
+
+    const std::string binPath = tempSeriesPath("xf_series_test.bin");
+    const double pairs[] = { 0.0, 1.0, 0.5, -2.0, 1.0, 4.0 };
+    writeFile(binPath, pairs, sizeof(pairs));
+    auto binary = DataSeries::load(binPath, error);
+    Assert::IsTrue(binary != nullptr);
+    Assert::AreEqual(size_t(3), binary->size());
+    Assert::AreEqual(0.5, binary->x(1));
+    Assert::AreEqual(-2.0, binary->y(1));
+
+    // The sorted file is read through its mapping; release it before rewriting the file.
+    binary.reset();
+    const double unsorted[] = { 2.0, 1.0, 0.0, 3.0 };
+    writeFile(binPath, unsorted, sizeof(unsorted));
+    binary = DataSeries::load(binPath, error);
+    Assert::AreEqual(0.0, binary->x(0));
+    Assert::AreEqual(3.0, binary->y(0));
+
+    writeFile(binPath, pairs, 20);
+    Assert::IsTrue(DataSeries::load(binPath, error) == nullptr);
+    Assert::IsFalse(error.empty());
+    error.clear();
+    Assert::IsTrue(DataSeries::load(tempSeriesPath("xf_missing_series.csv"), error) == nullptr);
+    Assert::IsFalse(error.empty());
+
+    std::remove(csvPath.c_str());
+    std::remove(binPath.c_str());
+}
+
+static std::shared_ptr<const DataSeriesLoader::Load> finished(std::shared_ptr<const DataSeriesLoader::Load> load) {
+    for (int attempt = 0; attempt < 5000 && !load->done.load(std::memory_order_acquire); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsTrue(load->done.load(std::memory_order_acquire));
+    return load;
+}
+
+TEST_CASE(DataSeriesLoader_KeepsTheSeriesWhileTheFileIsUnchanged) {
+    const std::string path = tempSeriesPath("xf_loader_test.csv");
+    writeFile(path, "0,1\n1,2\n", 8);
+    DataSeriesLoader loader;
+    auto first = finished(loader.request(path));
+    Assert::IsTrue(first->value != nullptr);
+    Assert::AreEqual(size_t(2), first->value->size());
+    Assert::IsTrue(loader.request(path) == first);
+
+    writeFile(path, "0,1\n1,2\n2,3\n", 12);
+    auto changed = finished(loader.request(path));
+    Assert::IsTrue(changed != first);
+    Assert::AreEqual(size_t(3), changed->value->size());
+    std::remove(path.c_str());
+
+    auto missing = finished(loader.request(tempSeriesPath("xf_missing_loader.csv")));
+    Assert::IsTrue(missing->value == nullptr);
+    Assert::IsFalse(missing->error.empty());
+}
+
+} // namespace XpressFormulaTests
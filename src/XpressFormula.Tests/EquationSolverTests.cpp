@@ -0,0 +1,89 @@
+// EquationSolverTests.cpp - Tests for isolating y or z in linear and quadratic equations.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/EquationSolver.h"
+#include "../XpressFormula/Core/Evaluator.h"
+#include "../XpressFormula/Core/Parser.h"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+
+namespace XpressFormulaTests {
+
+static EquationSolver::Solution solveFor(const char* formula, const char* variable) {
+    return EquationSolver::solve(Parser::parse(formula).ast, variable);
+}
+
+// True when every branch value v at (x, y) satisfies F(x, y, v) = 0.
+static bool branchesSatisfy(const char* formula, const char* variable, double x, double y) {
+    const ASTNodePtr equation = Parser::parse(formula).ast;
+    const EquationSolver::Solution solution = EquationSolver::solve(equation, variable);
+    for (const ASTNodePtr& branch : solution.branches) {
+        Evaluator::Variables vars = { { "x", x }, { "y", y } };
+        const double v = Evaluator::evaluate(branch, vars);
+        vars[variable] = v;
+        if (!std::isfinite(v) || std::abs(Evaluator::evaluate(equation, vars)) > 1e-9) {
+            return false;
+        }
+    }
+    return solution.solved();
+}
+
+TEST_CASE(EquationSolver_SolvesLinearEquations) {
+    const auto plane = solveFor("x^2 + y^2 + z - 1", "z");
+    Assert::AreEqual(1, plane.degree);
+    Assert::AreEqual(static_cast<size_t>(1), plane.branches.size());
+    Assert::IsTrue(plane.discriminant == nullptr);
+
+    Assert::IsTrue(branchesSatisfy("x^2 + y^2 + z - 1", "z", 0.5, -1.5));
+    Assert::IsTrue(branchesSatisfy("2*z - sin(x)", "z", 1.25, 0.0));
+    Assert::IsTrue(branchesSatisfy("-(3*z - x*y) / 4 + 2", "z", -2.0, 3.0));
+    Assert::IsTrue(branchesSatisfy("y - x^2", "y", 1.5, 0.0));
+}
+
+TEST_CASE(EquationSolver_SolvesQuadraticBranches) {
+    const auto sphere = solveFor("z^2 + x^2 + y^2 - 9", "z");
+    Assert::AreEqual(2, sphere.degree);
+    Assert::AreEqual(static_cast<size_t>(2), sphere.branches.size());
+    Assert::IsTrue(sphere.discriminant != nullptr);
+
+    const Evaluator::Variables inside = { { "x", 1.0 }, { "y", 2.0 } };
+    Assert::AreEqual(2.0, Evaluator::evaluate(sphere.branches[0], inside));
+    Assert::AreEqual(-2.0, Evaluator::evaluate(sphere.branches[1], inside));
+
+    // Outside the circle the discriminant is negative and both branches are NaN.
+    const Evaluator::Variables outside = { { "x", 3.0 }, { "y", 3.0 } };
+    Assert::IsTrue(Evaluator::evaluate(sphere.discriminant, outside) < 0.0);
+    Assert::IsTrue(std::isnan(Evaluator::evaluate(sphere.branches[0], outside)));
+
+    Assert::IsTrue(branchesSatisfy("z^2 + x*z + y - 4", "z", 1.0, -2.0));
+    Assert::IsTrue(branchesSatisfy("x^2 + y^2 - 25", "y", 3.0, 0.0));
+    Assert::IsTrue(branchesSatisfy("(2*y - x)^2 - 1", "y", 0.5, 0.0));
+}
+
+TEST_CASE(EquationSolver_ConstantDiscriminantGivesParallelBranches) {
+    // (z - 1)^2 = 4 -> z = 3 and z = -1 everywhere: no rim to trim.
+    const auto planes = solveFor("(z - 1)^2 - 4", "z");
+    Assert::AreEqual(static_cast<size_t>(2), planes.branches.size());
+    Assert::IsTrue(planes.discriminant == nullptr);
+    Assert::AreEqual(3.0, Evaluator::evaluate(planes.branches[0], {}));
+    Assert::AreEqual(-1.0, Evaluator::evaluate(planes.branches[1], {}));
+
+    const auto doubleRoot = solveFor("z^2", "z");
+    Assert::AreEqual(static_cast<size_t>(1), doubleRoot.branches.size());
+    Assert::AreEqual(0.0, Evaluator::evaluate(doubleRoot.branches[0], {}));
+
+    Assert::IsFalse(solveFor("z^2 + 1", "z").solved());
+}
+
+TEST_CASE(EquationSolver_RejectsUnsolvableEquations) {
+    Assert::IsFalse(solveFor("sin(z) - x", "z").solved());       // inside a function
+    Assert::IsFalse(solveFor("z^3 - x", "z").solved());          // cubic
+    Assert::IsFalse(solveFor("2^z - x", "z").solved());          // in an exponent
+    Assert::IsFalse(solveFor("x / z - 1", "z").solved());        // in a denominator
+    Assert::IsFalse(solveFor("x*z - 1", "z").solved());          // leading coefficient varies
+    Assert::IsFalse(solveFor("z - z + x", "z").solved());        // cancels out
+    Assert::IsFalse(solveFor("x + y", "z").solved());            // absent
+}
+
+} // namespace XpressFormulaTests
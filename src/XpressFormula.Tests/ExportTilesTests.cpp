@@ -0,0 +1,91 @@
+// ExportTilesTests.cpp - Tests for the tile and band layout of large plot exports.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/ViewTransform.h"
+#include "../XpressFormula/UI/ExportTiles.h"
+#include <cmath>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::UI;
+
+namespace XpressFormulaTests {
+
+TEST_CASE(ExportTiles_CoverTheImageOnceInRowOrder) {
+    const ExportTiles layout(10000, 2500, 4096, 1024);
+    Assert::AreEqual(3, layout.bandCount());
+
+    std::vector<int> covered(static_cast<size_t>(10000) * 2500, 0);
+    int nextRow = 0;
+    for (int b = 0; b < layout.bandCount(); ++b) {
+        const ExportTiles::Tile band = layout.band(b);
+        Assert::AreEqual(nextRow, band.y);
+        Assert::AreEqual(10000, band.width);
+        nextRow += band.height;
+
+        const std::vector<ExportTiles::Tile> tiles = layout.tiles(b);
+        Assert::AreEqual(size_t(3), tiles.size());
+        int nextColumn = 0;
+        for (const ExportTiles::Tile& tile : tiles) {
+            Assert::AreEqual(nextColumn, tile.x);
+            Assert::AreEqual(band.y, tile.y);
+            Assert::AreEqual(band.height, tile.height);
+            Assert::IsTrue(tile.width <= layout.tileWidth() && tile.height <= layout.tileHeight());
+            nextColumn += tile.width;
+            for (int y = tile.y; y < tile.y + tile.height; ++y) {
+                for (int x = tile.x; x < tile.x + tile.width; ++x) {
+                    ++covered[static_cast<size_t>(y) * 10000 + x];
+                }
+            }
+        }
+        Assert::AreEqual(10000, nextColumn);
+    }
+    Assert::AreEqual(2500, nextRow);
+    Assert::AreEqual(1024, layout.band(1).height);
+    Assert::AreEqual(452, layout.band(2).height);  // the last band is shorter
+    Assert::AreEqual(1808, layout.tiles(0).back().width);
+    for (int count : covered) {
+        Assert::AreEqual(1, count);
+    }
+}
+
+TEST_CASE(ExportTiles_SmallExportIsOneTile) {
+    const ExportTiles layout(800, 600);
+    Assert::AreEqual(800, layout.tileWidth());  // the render target shrinks to the image
+    Assert::AreEqual(600, layout.tileHeight());
+    Assert::AreEqual(1, layout.bandCount());
+    const std::vector<ExportTiles::Tile> tiles = layout.tiles(0);
+    Assert::AreEqual(size_t(1), tiles.size());
+    Assert::AreEqual(800, tiles[0].width);
+    Assert::AreEqual(600, tiles[0].height);
+}
+
+TEST_CASE(ExportTiles_ShiftedTransformContinuesAcrossTiles) {
+    // PlotPanel renders a tile with the whole export's transform moved so the tile's corner
+    // lands on the window origin: geometry lines up exactly at the tile seams.
+    XpressFormula::Core::ViewTransform whole;
+    whole.centerX = 1.25;
+    whole.centerY = -0.5;
+    whole.scaleX = 3000.0;
+    whole.scaleY = 2500.0;
+    whole.screenWidth = 40000.0f;
+    whole.screenHeight = 30000.0f;
+
+    const ExportTiles layout(40000, 30000);
+    for (const ExportTiles::Tile& tile : { layout.tiles(0).front(), layout.tiles(17).back() }) {
+        XpressFormula::Core::ViewTransform tiled = whole;
+        tiled.screenOriginX = -static_cast<float>(tile.x);
+        tiled.screenOriginY = -static_cast<float>(tile.y);
+        Assert::AreEqual(whole.worldXMin(), tiled.worldXMin());
+        Assert::AreEqual(whole.worldYMax(), tiled.worldYMax());
+        for (double wx : { -5.0, 0.0, 1.3, 7.9 }) {
+            for (double wy : { -6.0, 0.0, 2.2 }) {
+                const auto a = whole.worldToScreen(wx, wy);
+                const auto b = tiled.worldToScreen(wx, wy);
+                Assert::IsTrue(std::abs((a.x - tile.x) - b.x) < 0.02f);
+                Assert::IsTrue(std::abs((a.y - tile.y) - b.y) < 0.02f);
+            }
+        }
+    }
+}
+
+} // namespace XpressFormulaTests
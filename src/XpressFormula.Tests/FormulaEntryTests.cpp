@@ -1,9 +1,15 @@
 // FormulaEntryTests.cpp - Tests for formula parsing and render-mode classification.
 #include "CppUnitTest.h"
 #include "../XpressFormula/UI/FormulaEntry.h"
+#include "../XpressFormula/Plotting/StreamSeries.h"
 #include "../XpressFormula/Core/Evaluator.h"
+#include <chrono>
 #include <cstring>
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace XpressFormula::UI;
@@ -243,6 +249,44 @@ TEST_CASE(FormulaEntry_Uses3DSurface) {
 
     FormulaEntry scalarEq = parseFormula("x^2 + y^2 + z^2 = 4");
     Assert::IsTrue(scalarEq.uses3DSurface());
+
+    // f(x,y,z) is a 2D cross-section unless it is volume rendered.
+    FormulaEntry scalarField = parseFormula("x*y*z");
+    Assert::IsFalse(scalarField.uses3DSurface());
+    Assert::IsTrue(scalarField.uses3DSurface(true));
+    Assert::IsFalse(curve.uses3DSurface(true));
+}
+
+TEST_CASE(FormulaEntry_ImplicitEquationsKeepSolvedBranches) {
+    // Classification is unchanged; the solved branches ride along for the explicit draw paths.
+    FormulaEntry sphere = parseFormula("z^2 + x^2 + y^2 = 9");
+    Assert::IsTrue(sphere.renderKind == FormulaRenderKind::ScalarField3D);
+    Assert::AreEqual(static_cast<size_t>(2), sphere.solution.branches.size());
+
+    FormulaEntry parabola = parseFormula("y - x^2 = 0");
+    Assert::IsTrue(parabola.renderKind == FormulaRenderKind::Implicit2D);
+    Assert::AreEqual(static_cast<size_t>(1), parabola.solution.branches.size());
+
+    FormulaEntry transcendental = parseFormula("sin(y) = x");
+    Assert::IsTrue(transcendental.renderKind == FormulaRenderKind::Implicit2D);
+    Assert::IsFalse(transcendental.solution.solved());
+
+    // Linear in z: classified exactly like z = f(x,y).
+    FormulaEntry plane = parseFormula("2*z = sin(x)");
+    Assert::IsTrue(plane.isValid());
+    Assert::IsTrue(plane.renderKind == FormulaRenderKind::Surface3D);
+    Assert::AreEqual(2, plane.variableCount);
+    Evaluator::Variables vars = { { "x", 1.0 }, { "y", 0.0 } };
+    Assert::IsTrue(std::abs(Evaluator::evaluate(plane.ast, vars) - std::sin(1.0) / 2.0) < 1e-12);
+
+    FormulaEntry paraboloid = parseFormula("x^2 + y^2 + z - 1 = 0");
+    Assert::IsTrue(paraboloid.renderKind == FormulaRenderKind::Surface3D);
+    Assert::IsFalse(paraboloid.solution.solved());
+
+    // Re-parsing into another kind drops a stale solution.
+    strncpy_s(sphere.inputBuffer, sizeof(sphere.inputBuffer), "x + y + z", _TRUNCATE);
+    sphere.parse();
+    Assert::IsFalse(sphere.solution.solved());
 }
 
 TEST_CASE(FormulaEntry_UnsupportedVarInEquation) {
@@ -272,4 +316,102 @@ TEST_CASE(FormulaEntry_EquationSolvedForZ_RightSide) {
     Assert::IsTrue(std::abs(value - 25.0) < 1e-9);
 }
 
+TEST_CASE(FormulaEntry_DataPrefixLoadsASeries) {
+    const std::string path = (std::filesystem::temp_directory_path() / "xf_entry_series.csv").string();
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "x,y\n0,1\n1,3\n2,2\n";
+    }
+    FormulaEntry entry = parseFormula(("data: \"" + path + "\"").c_str());
+    // The series loads in the background.
+    Assert::IsTrue(entry.renderKind == FormulaRenderKind::DataSeries2D);
+    for (int attempt = 0; attempt < 5000 && !entry.updateData(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsTrue(entry.dataLoad == nullptr);
+    Assert::IsTrue(entry.isValid());
+    Assert::IsTrue(entry.renderKind == FormulaRenderKind::DataSeries2D);
+    Assert::IsTrue(entry.ast == nullptr);
+    Assert::AreEqual(size_t(3), entry.data->size());
+    Assert::IsFalse(entry.uses3DSurface());
+
+    FormulaEntry missing = parseFormula("data:");
+    Assert::IsFalse(missing.isValid());
+    Assert::IsFalse(missing.error.empty());
+    FormulaEntry missingPoints = parseFormula("scatter:");
+    Assert::IsFalse(missingPoints.isValid());
+    Assert::IsTrue(missingPoints.error.find("scatter:") != std::string::npos);
+
+    // Switching back to a formula drops the series.
+    strncpy_s(entry.inputBuffer, sizeof(entry.inputBuffer), "sin(x)", _TRUNCATE);
+    entry.parse();
+    Assert::IsTrue(entry.data == nullptr);
+    Assert::IsTrue(entry.renderKind == FormulaRenderKind::Curve2D);
+    std::remove(path.c_str());
+}
+
+TEST_CASE(FormulaEntry_PreviewsNeverOpenStreams) {
+    const std::string path = (std::filesystem::temp_directory_path() / "xf_entry_stream.txt").string();
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "0 1\n";
+    }
+    FormulaEntry preview;
+    preview.openSources = false;
+    strncpy_s(preview.inputBuffer, sizeof(preview.inputBuffer), ("stream: " + path).c_str(), _TRUNCATE);
+    preview.parse();
+    Assert::IsTrue(preview.stream == nullptr);
+    Assert::IsTrue(preview.renderKind == FormulaRenderKind::Stream2D);
+    Assert::IsTrue(preview.error.empty());
+
+    // The row's series is shared when the source is unchanged.
+    FormulaEntry row = parseFormula(("stream: " + path).c_str());
+    Assert::IsTrue(row.stream != nullptr);
+    FormulaEntry shared;
+    shared.openSources = false;
+    shared.stream = row.stream;
+    strncpy_s(shared.inputBuffer, sizeof(shared.inputBuffer), ("stream:  \"" + path + "\"").c_str(), _TRUNCATE);
+    shared.parse();
+    Assert::IsTrue(shared.stream == row.stream);
+    Assert::IsTrue(shared.isValid());
+    row.stream->close();
+    std::remove(path.c_str());
+}
+
+TEST_CASE(FormulaEntry_ScatterPrefixLoadsInTheBackgroundButNotInPreviews) {
+    const std::string path = (std::filesystem::temp_directory_path() / "xf_entry_points.bin").string();
+    {
+        const double pairs[] = { 0.0, 0.0, 1.0, 2.0, -1.0, 4.0 };
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(pairs), sizeof(pairs));
+    }
+    // The editor preview validates the path but does not read the points.
+    FormulaEntry preview;
+    preview.openSources = false;
+    strncpy_s(preview.inputBuffer, sizeof(preview.inputBuffer), ("scatter: " + path).c_str(), _TRUNCATE);
+    preview.parse();
+    Assert::IsFalse(preview.loading());
+    Assert::IsTrue(preview.scatter == nullptr);
+    Assert::IsTrue(preview.renderKind == FormulaRenderKind::Scatter2D);
+    Assert::IsTrue(preview.error.empty());
+
+    FormulaEntry entry = parseFormula(("scatter: " + path).c_str());
+    Assert::IsTrue(entry.renderKind == FormulaRenderKind::Scatter2D);
+    for (int attempt = 0; attempt < 5000 && !entry.updateData(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsFalse(entry.loading());
+    Assert::IsTrue(entry.isValid());
+    Assert::AreEqual(size_t(3), entry.scatter->size());
+
+    FormulaEntry missing = parseFormula("scatter: xf_missing_points.bin");
+    for (int attempt = 0; attempt < 5000 && !missing.updateData(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsFalse(missing.isValid());
+    Assert::IsFalse(missing.error.empty());
+    Assert::IsTrue(missing.renderKind == FormulaRenderKind::Invalid);
+    std::remove(path.c_str());
+}
+
 } // namespace XpressFormulaTests
@@ -0,0 +1,65 @@
+// FrameArenaTests.cpp - Tests for the per-frame renderer scratch arena.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/FrameArena.h"
+#include <cstdint>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+TEST_CASE(FrameArena_AllocationsAreAlignedAndDistinct) {
+    FrameArena arena(1024);
+    void* a = arena.allocate(3, 1);
+    void* b = arena.allocate(sizeof(double), alignof(double));
+    void* c = arena.allocate(64, 64);
+    Assert::IsTrue(a != b && b != c);
+    Assert::IsTrue(reinterpret_cast<std::uintptr_t>(b) % alignof(double) == 0);
+    Assert::IsTrue(reinterpret_cast<std::uintptr_t>(c) % 64 == 0);
+    Assert::IsTrue(arena.bytesInUse() >= 3 + sizeof(double) + 64);
+}
+
+TEST_CASE(FrameArena_ResetReusesMemoryWithoutNewBlocks) {
+    FrameArena arena(4096);
+    void* first = arena.allocate(256, 16);
+    arena.reset();
+    Assert::AreEqual(static_cast<size_t>(0), arena.bytesInUse());
+    Assert::IsTrue(first == arena.allocate(256, 16));
+    Assert::AreEqual(static_cast<std::uint64_t>(1), arena.blockAllocations());
+}
+
+TEST_CASE(FrameArena_OverflowCoalescesToHighWaterMark) {
+    FrameArena arena(4096);
+    for (int i = 0; i < 10; ++i) {
+        (void)arena.allocate(2048, 16);
+    }
+    Assert::IsTrue(arena.blockAllocations() > 1);
+    const size_t peak = arena.highWaterMark();
+    Assert::IsTrue(peak >= 10 * 2048);
+
+    // After one reset the working set fits a single block, so replaying the same frame is
+    // served without touching the heap.
+    arena.reset();
+    Assert::IsTrue(arena.capacity() >= peak);
+    const std::uint64_t blocks = arena.blockAllocations();
+    for (int frame = 0; frame < 3; ++frame) {
+        for (int i = 0; i < 10; ++i) {
+            (void)arena.allocate(2048, 16);
+        }
+        arena.reset();
+    }
+    Assert::AreEqual(blocks, arena.blockAllocations());
+    Assert::AreEqual(peak, arena.highWaterMark());
+}
+
+TEST_CASE(FrameArena_BacksPmrContainers) {
+    FrameArena arena;
+    std::pmr::vector<double> values(1000, 1.5, &arena);
+    values.push_back(2.5);
+    Assert::AreEqual(static_cast<size_t>(1001), values.size());
+    Assert::AreEqual(2.5, values.back());
+    Assert::IsTrue(arena.bytesInUse() >= 1001 * sizeof(double));
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,112 @@
+// ImplicitSurfaceTracerTests.cpp - Tests for the progressive per-pixel implicit surface tracer.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/ImplicitSurfaceTracer.h"
+#include "../XpressFormula/Core/Parser.h"
+#include "../XpressFormula/Core/TaskPool.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// The box [-2,2]^3 viewed from straight above (elevation 0 looks down the z axis) at
+// 10 px/unit with the origin in the middle of a 64x64 image.
+static ImplicitSurfaceTracer::Bounds cube() {
+    ImplicitSurfaceTracer::Bounds bounds;
+    bounds.xMin = bounds.yMin = bounds.zMin = -2.0;
+    bounds.xMax = bounds.yMax = bounds.zMax = 2.0;
+    return bounds;
+}
+
+static ImplicitSurfaceTracer::Camera topView() {
+    ImplicitSurfaceTracer::Camera camera;
+    camera.azimuthDeg = 0.0f;
+    camera.elevationDeg = 0.0f;
+    camera.zScale = 1.0f;
+    camera.originX = 32.0;
+    camera.originY = 32.0;
+    camera.scale = 10.0;
+    camera.width = 64.0f;
+    camera.height = 64.0f;
+    return camera;
+}
+
+static void traceToCompletion(ImplicitSurfaceTracer& tracer) {
+    TaskPool pool(0);
+    int top = 0;
+    int bottom = 0;
+    for (int i = 0; i < 100 && !tracer.converged(); ++i) {
+        tracer.refine(pool, 1000.0, top, bottom);
+    }
+}
+
+static unsigned int alphaAt(const ImplicitSurfaceTracer& tracer, int x, int y) {
+    return static_cast<unsigned int>(tracer.pixels()[y * tracer.width() + x] >> 24);
+}
+
+TEST_CASE(ImplicitSurfaceTracer_HitsTheSphereAndMissesOutsideIt) {
+    // Radius 1.5 = 15 px around the image centre.
+    ImplicitSurfaceTracer tracer;
+    tracer.setScene(Parser::parse("x^2 + y^2 + z^2 - 2.25").ast, cube(), topView(),
+                    ImplicitSurfaceTracer::Shading{}, 64, 64);
+    traceToCompletion(tracer);
+    Assert::IsTrue(tracer.converged());
+    Assert::IsTrue(tracer.hasImage());
+
+    Assert::AreEqual(0xFFu, alphaAt(tracer, 32, 32));
+    Assert::AreEqual(0xFFu, alphaAt(tracer, 32 + 13, 32));
+    Assert::AreEqual(0u, alphaAt(tracer, 32 + 17, 32));
+    Assert::AreEqual(0u, alphaAt(tracer, 2, 2));
+
+    // Facing the viewer, the top of the sphere is lit more than its rim.
+    const std::uint32_t centre = tracer.pixels()[32 * 64 + 32];
+    const std::uint32_t rim = tracer.pixels()[32 * 64 + 32 + 14];
+    Assert::IsTrue((centre & 0xFFu) != (rim & 0xFFu));
+}
+
+TEST_CASE(ImplicitSurfaceTracer_SkipsEmptySpaceWithIntervalBounds) {
+    // The plane z = 1.9 near the top of the box is found right away; the same plane near the
+    // bottom is reached only after skipping the empty part of each ray, in a handful of
+    // interval tests rather than one per half pixel.
+    ImplicitSurfaceTracer nearPlane;
+    nearPlane.setScene(Parser::parse("z - 1.9").ast, cube(), topView(), ImplicitSurfaceTracer::Shading{}, 64, 64);
+    traceToCompletion(nearPlane);
+    ImplicitSurfaceTracer farPlane;
+    farPlane.setScene(Parser::parse("z + 1.9").ast, cube(), topView(), ImplicitSurfaceTracer::Shading{}, 64, 64);
+    traceToCompletion(farPlane);
+
+    Assert::AreEqual(0xFFu, alphaAt(farPlane, 20, 40));
+    const std::uint64_t pixels = 64u * 64u;
+    Assert::IsTrue(farPlane.evaluations() < pixels * 40u);
+    Assert::IsTrue(farPlane.evaluations() < nearPlane.evaluations() * 3u);
+}
+
+TEST_CASE(ImplicitSurfaceTracer_RefinesProgressivelyAndRestartsOnCameraChange) {
+    ImplicitSurfaceTracer tracer;
+    const ASTNodePtr ast = Parser::parse("x^2 + y^2 + z^2 - 2.25").ast;
+    tracer.setScene(ast, cube(), topView(), ImplicitSurfaceTracer::Shading{}, 64, 64);
+    Assert::IsFalse(tracer.hasImage());
+
+    TaskPool pool(0);
+    int top = 0;
+    int bottom = 0;
+    Assert::IsTrue(tracer.refine(pool, 0.0, top, bottom));
+    Assert::AreEqual(0, top);
+    Assert::IsFalse(tracer.converged());
+
+    traceToCompletion(tracer);
+    Assert::IsTrue(tracer.converged());
+    tracer.setScene(ast, cube(), topView(), ImplicitSurfaceTracer::Shading{}, 64, 64);
+    Assert::IsTrue(tracer.converged());
+
+    ImplicitSurfaceTracer::Camera rotated = topView();
+    rotated.elevationDeg = -60.0f;
+    tracer.setScene(ast, cube(), rotated, ImplicitSurfaceTracer::Shading{}, 64, 64);
+    Assert::IsFalse(tracer.converged());
+    Assert::IsTrue(tracer.hasImage());
+    traceToCompletion(tracer);
+    Assert::AreEqual(0xFFu, alphaAt(tracer, 32, 32));
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,122 @@
+// InteractionRecordingTests.cpp - Tests for interaction recording serialization and replay state.
+#include "CppUnitTest.h"
+#include "../XpressFormula/UI/InteractionRecording.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::UI;
+
+namespace XpressFormulaTests {
+
+static void assertClose(double expected, double actual, double tol = 1e-6) {
+    Assert::IsTrue(std::abs(expected - actual) < tol,
+        (std::to_wstring(expected) + L" != " + std::to_wstring(actual)).c_str());
+}
+
+static FormulaEntry makeFormula(const char* text) {
+    FormulaEntry entry;
+    std::snprintf(entry.inputBuffer, sizeof(entry.inputBuffer), "%s", text);
+    entry.parse();
+    return entry;
+}
+
+TEST_CASE(InteractionRecording_RoundTripFramesAndInput) {
+    XpressFormula::Core::ViewTransform view;
+    view.centerX = 1.5;
+    view.scaleY = 42.0;
+    std::vector<FormulaEntry> formulas = { makeFormula("sin(x)") };
+    PlotSettings settings;
+
+    InteractionRecorder recorder;
+    recorder.start(view, formulas, settings);
+    InteractionInput input;
+    input.plotWidth = 800.0f;
+    input.plotHeight = 600.0f;
+    input.mouseX = 120.5f;
+    input.mouseY = 64.0f;
+    input.mouseLeft = true;
+    input.wheel = -1.0f;
+    input.keyShift = true;
+    recorder.recordFrame(0.016, 0.016f, input, formulas, settings);
+    recorder.recordFrame(0.033, 0.017f, InteractionInput{}, formulas, settings);
+    Assert::AreEqual(static_cast<size_t>(2), recorder.frameCount());
+
+    std::istringstream in(recorder.text());
+    InteractionScript script;
+    std::string error;
+    Assert::IsTrue(InteractionScript::read(in, script, error));
+    Assert::AreEqual(static_cast<size_t>(2), script.frames.size());
+    assertClose(1.5, script.initialView.centerX);
+    assertClose(42.0, script.initialView.scaleY);
+
+    const InteractionFrame& first = script.frames[0];
+    assertClose(800.0f, first.input.plotWidth);
+    assertClose(120.5f, first.input.mouseX);
+    Assert::IsTrue(first.input.mouseLeft);
+    Assert::IsFalse(first.input.mouseRight);
+    assertClose(-1.0f, first.input.wheel);
+    Assert::IsTrue(first.input.keyShift);
+    Assert::IsFalse(first.input.keyCtrl);
+    assertClose(0.017f, script.frames[1].deltaTime);
+}
+
+TEST_CASE(InteractionRecording_OnlyChangesAreRecordedAndReplayed) {
+    XpressFormula::Core::ViewTransform view;
+    std::vector<FormulaEntry> formulas = { makeFormula("x^2 + y^2") };
+    PlotSettings settings;
+
+    InteractionRecorder recorder;
+    recorder.start(view, formulas, settings);
+    recorder.recordFrame(0.0, 0.016f, InteractionInput{}, formulas, settings);
+
+    settings.azimuthDeg = 75.0f;
+    formulas.push_back(makeFormula("x^2 + y^2 + z^2 = 9"));
+    formulas[1].visible = false;
+    recorder.recordFrame(0.1, 0.016f, InteractionInput{}, formulas, settings);
+
+    std::istringstream in(recorder.text());
+    InteractionScript script;
+    std::string error;
+    Assert::IsTrue(InteractionScript::read(in, script, error));
+    Assert::AreEqual(static_cast<size_t>(2), script.frames.size());
+    Assert::AreEqual(static_cast<size_t>(1), script.frames[1].settingChanges.size());
+    Assert::AreEqual(std::string("azimuthDeg"), script.frames[1].settingChanges[0].first);
+
+    std::vector<FormulaEntry> replayFormulas;
+    PlotSettings replaySettings;
+    for (const InteractionFrame& frame : script.frames) {
+        InteractionScript::applyFrameState(frame, replayFormulas, replaySettings);
+    }
+    Assert::AreEqual(static_cast<size_t>(2), replayFormulas.size());
+    assertClose(75.0f, replaySettings.azimuthDeg);
+    Assert::IsTrue(replayFormulas[1].renderKind == FormulaRenderKind::ScalarField3D);
+    Assert::IsFalse(replayFormulas[1].visible);
+    Assert::IsTrue(replayFormulas[0].isValid());
+}
+
+TEST_CASE(InteractionRecording_MalformedScriptReportsLine) {
+    std::istringstream in("xfrec 1\nframe 0.1 oops\n");
+    InteractionScript script;
+    std::string error;
+    Assert::IsFalse(InteractionScript::read(in, script, error));
+    Assert::IsTrue(error.find("Line 2") != std::string::npos);
+
+    std::istringstream noHeader("frame 0 0 1 1 0 0 0 0 0\n");
+    Assert::IsFalse(InteractionScript::read(noHeader, script, error));
+
+    // Formula indices past the declared list, or any huge count, never reach a resize.
+    std::istringstream pastDeclared("xfrec 1\nformulas 2\nformula 2 1 1 1 1 1 0 x\n");
+    Assert::IsFalse(InteractionScript::read(pastDeclared, script, error));
+    Assert::IsTrue(error.find("Line 3: malformed 'formula' record.") != std::string::npos);
+    std::istringstream huge("xfrec 1\nformula 2000000000 1 1 1 1 1 0 x\n");
+    Assert::IsFalse(InteractionScript::read(huge, script, error));
+    Assert::IsTrue(error.find("malformed 'formula' record.") != std::string::npos);
+    std::istringstream hugeCount("xfrec 1\nformulas 2000000000\n");
+    Assert::IsFalse(InteractionScript::read(hugeCount, script, error));
+    Assert::IsTrue(error.find("malformed 'formulas' record.") != std::string::npos);
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,120 @@
+// IntervalEvaluatorTests.cpp - Tests for point and interval evaluation over x/y/z boxes.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/IntervalEvaluator.h"
+#include "../XpressFormula/Core/Parser.h"
+#include <cmath>
+#include <cstdint>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+
+namespace XpressFormulaTests {
+
+static const char* const kBoundedFormulas[] = {
+    "(x^2+y^2+z^2+21)^2 - 100*(x^2+y^2)",
+    "sin(x)*cos(y) + sin(2*x)*cos(3*y) + tan(x/5) - cos(x*y/4)",
+    "sqrt(x) - log(y + 2) / z",
+    "x^3 - y^-2 + 1 / (y - z)",
+    "abs(x) * cosh(y) - mod(x, 0.7) + sign(z) * floor(y)",
+    "pow(abs(x), 1.5) + atan2(y, x) - min(x, y) * max(z, 1)",
+    "asin(x / 4) + acos(y / 5) - exp(z) + cbrt(x - y) * tanh(z)",
+    "min(10, sqrt(x)) - max(-3, log(y)) + max(z, x / y)",
+};
+
+// Deterministic uniform values in [lo, hi).
+static double uniform(std::uint32_t& state, double lo, double hi) {
+    state = state * 1664525u + 1013904223u;
+    return lo + (hi - lo) * static_cast<double>(state >> 8) / 16777216.0;
+}
+
+TEST_CASE(IntervalEvaluator_PointValuesMatchEvaluator) {
+    IntervalEvaluator::Scratch scratch;
+    for (const char* formula : kBoundedFormulas) {
+        const ASTNodePtr ast = Parser::parse(formula).ast;
+        const IntervalEvaluator evaluator(ast);
+        std::uint32_t state = 7u;
+        for (int i = 0; i < 50; ++i) {
+            const double x = uniform(state, -4.0, 4.0);
+            const double y = uniform(state, -4.0, 4.0);
+            const double z = uniform(state, -4.0, 4.0);
+            const double expected = Evaluator::evaluate(ast, { { "x", x }, { "y", y }, { "z", z } });
+            const double actual = evaluator.evaluate(x, y, z, scratch);
+            Assert::IsTrue(std::isnan(expected) ? std::isnan(actual) : expected == actual);
+        }
+    }
+}
+
+TEST_CASE(IntervalEvaluator_BoundsContainEveryValueInTheBox) {
+    IntervalEvaluator::Scratch scratch;
+    std::uint32_t state = 11u;
+    for (const char* formula : kBoundedFormulas) {
+        const IntervalEvaluator evaluator(Parser::parse(formula).ast);
+        for (int box = 0; box < 40; ++box) {
+            Interval axes[3];
+            for (Interval& axis : axes) {
+                const double a = uniform(state, -5.0, 5.0);
+                const double b = a + uniform(state, 0.0, (box % 2) ? 0.2 : 4.0);
+                axis = { a, b };
+            }
+            const Interval range = evaluator.evaluate(axes[0], axes[1], axes[2], scratch);
+            for (int i = 0; i < 40; ++i) {
+                const double v = evaluator.evaluate(uniform(state, axes[0].lo, axes[0].hi),
+                                                    uniform(state, axes[1].lo, axes[1].hi),
+                                                    uniform(state, axes[2].lo, axes[2].hi), scratch);
+                if (std::isfinite(v)) {
+                    const double slack = 1e-9 * (1.0 + std::abs(v));
+                    Assert::IsTrue(range.lo - slack <= v && v <= range.hi + slack);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(IntervalEvaluator_RulesStayTight) {
+    IntervalEvaluator::Scratch scratch;
+    const Interval x = { -1.0, 2.0 };
+    const Interval unit = { 0.0, 0.5 };
+
+    const Interval square = IntervalEvaluator(Parser::parse("x^2").ast).evaluate(x, unit, unit, scratch);
+    Assert::AreEqual(0.0, square.lo);
+    Assert::AreEqual(4.0, square.hi);
+
+    // sin(x) + cos(y) over [0, 0.5]^2 stays above zero: no root in the box.
+    const Interval trig = IntervalEvaluator(Parser::parse("sin(x) + cos(y)").ast).evaluate(unit, unit, unit, scratch);
+    Assert::IsTrue(trig.lo > 0.8 && trig.hi < 1.5);
+    Assert::IsFalse(trig.contains(0.0));
+
+    const Interval reciprocal = IntervalEvaluator(Parser::parse("1 / x").ast)
+        .evaluate({ 1.0, 2.0 }, unit, unit, scratch);
+    Assert::AreEqual(0.5, reciprocal.lo);
+    Assert::AreEqual(1.0, reciprocal.hi);
+
+    // Undefined everywhere in the box, or unknown functions: empty.
+    Assert::IsTrue(IntervalEvaluator(Parser::parse("sqrt(x)").ast)
+                       .evaluate({ -4.0, -1.0 }, unit, unit, scratch).isEmpty());
+    Assert::IsTrue(IntervalEvaluator(Parser::parse("foo(x)").ast).evaluate(x, unit, unit, scratch).isEmpty());
+    // Dividing by a range through zero is unbounded.
+    const Interval pole = IntervalEvaluator(Parser::parse("1 / x").ast).evaluate(x, unit, unit, scratch);
+    Assert::IsTrue(std::isinf(pole.lo) && std::isinf(pole.hi));
+}
+
+TEST_CASE(IntervalEvaluator_MinMaxCoverAnUndefinedSecondArgument) {
+    // min(a, NaN) = a: where sqrt(x) is undefined the curve sits at 10, not inside [0, 2].
+    IntervalEvaluator::Scratch scratch;
+    const Interval x = { -4.0, 4.0 };
+    const Interval zero = Interval::point(0.0);
+    const Interval low = IntervalEvaluator(Parser::parse("min(10, sqrt(x))").ast).evaluate(x, zero, zero, scratch);
+    Assert::AreEqual(0.0, low.lo);
+    Assert::AreEqual(10.0, low.hi);
+    const Interval high = IntervalEvaluator(Parser::parse("max(-10, -sqrt(x))").ast).evaluate(x, zero, zero, scratch);
+    Assert::AreEqual(-10.0, high.lo);
+    Assert::AreEqual(0.0, high.hi);
+
+    // A second argument defined everywhere keeps both bounds tight.
+    const Interval tight = IntervalEvaluator(Parser::parse("min(10, 2 * sin(x) + x)").ast)
+        .evaluate({ 0.0, 1.0 }, zero, zero, scratch);
+    Assert::IsTrue(std::abs(tight.lo) < 1e-12);
+    Assert::IsTrue(tight.hi < 3.0);
+}
+
+} // namespace XpressFormulaTests
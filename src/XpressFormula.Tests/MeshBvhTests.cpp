@@ -0,0 +1,147 @@
+// MeshBvhTests.cpp - Tests for the ray-picking hierarchy over surface meshes.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/MeshBvh.h"
+#include "../XpressFormula/Plotting/MeshBvhCache.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// z = x^2 + y^2 sampled like a z=f(x,y) surface: two triangles per cell of an n x n grid.
+static std::shared_ptr<const MeshBvh::Mesh> paraboloid(int n) {
+    auto mesh = std::make_shared<MeshBvh::Mesh>();
+    auto vertex = [n](int ix, int iy) {
+        const double x = -2.0 + 4.0 * ix / n;
+        const double y = -2.0 + 4.0 * iy / n;
+        return MeshBvh::Vec3{ x, y, x * x + y * y };
+    };
+    for (int iy = 0; iy < n; ++iy) {
+        for (int ix = 0; ix < n; ++ix) {
+            mesh->push_back({ vertex(ix, iy), vertex(ix + 1, iy), vertex(ix + 1, iy + 1) });
+            mesh->push_back({ vertex(ix, iy), vertex(ix + 1, iy + 1), vertex(ix, iy + 1) });
+        }
+    }
+    return mesh;
+}
+
+TEST_CASE(MeshBvh_VerticalRayHitsTheSurfaceUnderIt) {
+    auto bvh = MeshBvh::build(paraboloid(64));
+    Assert::IsTrue(bvh != nullptr);
+    MeshBvh::Hit hit;
+    // Looking down from z = 10: the hit lies on the surface, near the exact paraboloid.
+    Assert::IsTrue(bvh->intersect({ 0.7, -0.4, 10.0 }, { 0.0, 0.0, -1.0 }, hit));
+    Assert::IsTrue(std::abs(hit.point.x - 0.7) < 1e-12 && std::abs(hit.point.y + 0.4) < 1e-12);
+    Assert::IsTrue(std::abs(hit.point.z - 0.65) < 0.01);
+    Assert::IsTrue(std::abs(hit.t - (10.0 - hit.point.z)) < 1e-12);
+    // Outside the sampled square there is nothing to hit.
+    Assert::IsFalse(bvh->intersect({ 2.5, 0.0, 10.0 }, { 0.0, 0.0, -1.0 }, hit));
+}
+
+TEST_CASE(MeshBvh_MatchesBruteForceNearestHit) {
+    auto mesh = paraboloid(40);
+    auto bvh = MeshBvh::build(mesh);
+    Assert::IsTrue(bvh != nullptr);
+    Assert::IsTrue(bvh->nodeCount() < 2 * mesh->size());
+
+    // Reference: every triangle on its own.
+    std::vector<std::shared_ptr<const MeshBvh>> singles;
+    for (const MeshBvh::Triangle& triangle : *mesh) {
+        singles.push_back(MeshBvh::build(std::make_shared<const MeshBvh::Mesh>(1, triangle)));
+    }
+
+    // Oblique rays cross the bowl twice; the hierarchy must return the nearer crossing, with
+    // the origin anywhere along the ray (t may be negative).
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coord(-2.5, 2.5);
+    int hits = 0;
+    for (int i = 0; i < 300; ++i) {
+        const MeshBvh::Vec3 origin{ coord(rng), coord(rng), coord(rng) + 3.0 };
+        const MeshBvh::Vec3 direction{ coord(rng) * 0.3, coord(rng) * 0.3, -1.0 };
+
+        double nearest = std::numeric_limits<double>::infinity();
+        for (const auto& one : singles) {
+            MeshBvh::Hit h;
+            if (one->intersect(origin, direction, h)) {
+                nearest = std::min(nearest, h.t);
+            }
+        }
+
+        MeshBvh::Hit hit;
+        const bool found = bvh->intersect(origin, direction, hit);
+        Assert::AreEqual(std::isfinite(nearest), found);
+        if (found) {
+            ++hits;
+            Assert::IsTrue(std::abs(hit.t - nearest) < 1e-9);
+        }
+    }
+    Assert::IsTrue(hits > 50);
+}
+
+TEST_CASE(MeshBvh_EmptyOrCancelledBuildReturnsNull) {
+    Assert::IsTrue(MeshBvh::build(nullptr) == nullptr);
+    Assert::IsTrue(MeshBvh::build(std::make_shared<const MeshBvh::Mesh>()) == nullptr);
+    std::atomic<bool> cancel{ true };
+    Assert::IsTrue(MeshBvh::build(paraboloid(64), &cancel) == nullptr);
+}
+
+TEST_CASE(MeshBvhCache_BuildsInBackgroundAndRestartsOnNewMesh) {
+    MeshBvhCache cache;
+    auto mesh = paraboloid(32);
+    std::shared_ptr<const MeshBvh> bvh = cache.request(mesh);
+    for (int i = 0; i < 2000 && !bvh; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        bvh = cache.request(mesh);
+    }
+    Assert::IsTrue(bvh != nullptr);
+    Assert::IsFalse(cache.pending());
+    Assert::IsTrue(&bvh->mesh() == mesh.get());
+
+    Assert::IsTrue(cache.request(paraboloid(16)) == nullptr);
+    Assert::IsTrue(cache.pending());
+    Assert::IsTrue(cache.request(std::shared_ptr<const MeshBvh::Mesh>()) == nullptr);
+    Assert::IsFalse(cache.pending());
+}
+
+TEST_CASE(MeshBvh_HeightGridMatchesTheDrawnCellsAndPicksInBackground) {
+    // The same paraboloid as a sampled grid, then with an undefined corner sample and a z
+    // window that drops the four cells around the minimum.
+    auto grid = std::make_shared<MeshBvh::HeightGrid>();
+    grid->xMin = grid->yMin = -2.0;
+    grid->xMax = grid->yMax = 2.0;
+    grid->nx = grid->ny = 8;
+    grid->layers = 1;
+    for (int iy = 0; iy <= 8; ++iy) {
+        for (int ix = 0; ix <= 8; ++ix) {
+            const double x = -2.0 + 0.5 * ix;
+            const double y = -2.0 + 0.5 * iy;
+            grid->values.push_back(x * x + y * y);
+        }
+    }
+    Assert::AreEqual(static_cast<size_t>(128), grid->triangulate().size());
+    Assert::IsTrue(grid->triangulate()[0].p1.x == -1.5);
+
+    grid->values[0] = std::numeric_limits<double>::quiet_NaN();  // (-2, -2): one cell
+    grid->zClipMin = 0.6;                                       // z <= 0.5 around (0, 0)
+    Assert::AreEqual(static_cast<size_t>(128 - 2 - 8), grid->triangulate().size());
+
+    MeshBvhCache cache;
+    std::shared_ptr<const MeshBvh> bvh = cache.request(std::shared_ptr<const MeshBvh::HeightGrid>(grid));
+    for (int i = 0; i < 2000 && !bvh; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        bvh = cache.request(std::shared_ptr<const MeshBvh::HeightGrid>(grid));
+    }
+    Assert::IsTrue(bvh != nullptr);
+    MeshBvh::Hit hit;
+    Assert::IsTrue(bvh->intersect({ 1.2, 0.7, 10.0 }, { 0.0, 0.0, -1.0 }, hit));
+    Assert::IsTrue(std::abs(hit.point.z - (1.2 * 1.2 + 0.7 * 0.7)) < 0.2);
+    Assert::IsFalse(bvh->intersect({ 0.1, 0.1, 10.0 }, { 0.0, 0.0, -1.0 }, hit));
+}
+
+} // namespace XpressFormulaTests
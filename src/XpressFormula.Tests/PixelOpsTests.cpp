@@ -0,0 +1,95 @@
+// PixelOpsTests.cpp - Tests for the per-pixel conversions and their SIMD kernels.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Imaging/PixelOps.h"
+#include "../XpressFormula/Imaging/Simd.h"
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Imaging;
+
+namespace XpressFormulaTests {
+
+// Random premultiplied-looking pixels: colour mostly at or below alpha, with some opaque and
+// some fully transparent runs so every kernel branch is taken.
+static std::vector<std::uint8_t> randomPixels(std::size_t count) {
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> pixels(count * 4);
+    for (std::size_t i = 0; i < count; ++i) {
+        int a = byte(rng);
+        if ((i / 16) % 5 == 0) a = 255;
+        if ((i / 16) % 7 == 0) a = 0;
+        for (int c = 0; c < 3; ++c) {
+            const int value = byte(rng);
+            pixels[i * 4 + c] = static_cast<std::uint8_t>(i % 13 == 0 ? value : value * a / 255);
+        }
+        pixels[i * 4 + 3] = static_cast<std::uint8_t>(a);
+    }
+    return pixels;
+}
+
+// Output of `op` at every instruction set up to the supported one equals the scalar output.
+static void assertKernelsMatchScalar(const std::function<void(std::vector<std::uint8_t>&)>& op) {
+    // Spans several parallel bands and ends in a partial vector.
+    const std::vector<std::uint8_t> input = randomPixels((std::size_t(1) << 17) + 37);
+    setSimdLevel(SimdLevel::Scalar);
+    std::vector<std::uint8_t> expected = input;
+    op(expected);
+    for (SimdLevel level : { SimdLevel::Sse2, SimdLevel::Avx2 }) {
+        setSimdLevel(level);
+        std::vector<std::uint8_t> actual = input;
+        op(actual);
+        Assert::IsTrue(actual == expected);
+    }
+    setSimdLevel(SimdLevel::Avx2);
+}
+
+TEST_CASE(PixelOps_KernelsMatchScalarCode) {
+    assertKernelsMatchScalar([](std::vector<std::uint8_t>& p) { swapRedBlue(p.data(), p.size() / 4); });
+    assertKernelsMatchScalar([](std::vector<std::uint8_t>& p) { unpremultiply(p.data(), p.size() / 4); });
+    assertKernelsMatchScalar([](std::vector<std::uint8_t>& p) {
+        toGrayscale(p.data(), p.size() / 4, ChannelOrder::Rgba);
+    });
+    assertKernelsMatchScalar([](std::vector<std::uint8_t>& p) {
+        toGrayscale(p.data(), p.size() / 4, ChannelOrder::Bgra);
+    });
+}
+
+TEST_CASE(PixelOps_ConvertsKnownPixels) {
+    std::vector<std::uint8_t> pixels = {
+        64, 32, 0, 128,     // half transparent
+        10, 20, 30, 0,      // transparent: becomes black
+        1, 2, 3, 255,       // opaque: unchanged
+        200, 50, 100, 100,  // colour above alpha: clamped
+        255, 0, 0, 7,
+    };
+    swapRedBlue(pixels.data(), 5);
+    Assert::AreEqual(0, static_cast<int>(pixels[0]));
+    Assert::AreEqual(64, static_cast<int>(pixels[2]));
+    swapRedBlue(pixels.data(), 5);
+
+    unpremultiply(pixels.data(), 5);
+    const std::vector<std::uint8_t> straight = {
+        128, 64, 0, 128,
+        0, 0, 0, 0,
+        1, 2, 3, 255,
+        255, 128, 255, 100,
+        255, 0, 0, 7,
+    };
+    Assert::IsTrue(pixels == straight);
+
+    std::vector<std::uint8_t> gray = { 255, 0, 0, 7, 255, 255, 255, 9 };
+    toGrayscale(gray.data(), 2, ChannelOrder::Rgba);
+    Assert::AreEqual(76, static_cast<int>(gray[0]));   // 0.299 * 255
+    Assert::AreEqual(76, static_cast<int>(gray[2]));
+    Assert::AreEqual(7, static_cast<int>(gray[3]));
+    Assert::AreEqual(255, static_cast<int>(gray[4]));  // the weights sum to one
+    gray = { 255, 0, 0, 7 };
+    toGrayscale(gray.data(), 1, ChannelOrder::Bgra);
+    Assert::AreEqual(29, static_cast<int>(gray[1]));   // 0.114 * 255
+}
+
+} // namespace XpressFormulaTests
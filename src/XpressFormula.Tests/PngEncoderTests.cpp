@@ -0,0 +1,403 @@
+// PngEncoderTests.cpp - Tests for the PNG encoder: files decode back to the input pixels.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Imaging/PngEncoder.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Imaging;
+
+namespace XpressFormulaTests {
+
+// ---- A small, strict PNG reader (after RFC 1950/1951 and PNG 9.2) to check the output ----
+
+class Inflater {
+public:
+    explicit Inflater(const std::vector<std::uint8_t>& in) : m_in(in) {}
+
+    bool run(std::vector<std::uint8_t>& out) {
+        if (m_in.size() < 6 || ((m_in[0] << 8) | m_in[1]) % 31 != 0 || (m_in[0] & 0x0F) != 8) return false;
+        m_pos = 2;
+        for (bool last = false; !last;) {
+            last = bits(1) == 1;
+            const int type = bits(2);
+            bool ok = false;
+            if (type == 0) ok = stored(out);
+            else if (type == 1) ok = fixed(out);
+            else if (type == 2) ok = dynamic(out);
+            if (!ok || m_error) return false;
+        }
+        m_bitCount = 0;
+        if (m_pos + 4 != m_in.size()) return false;
+        const std::uint32_t expected = (static_cast<std::uint32_t>(m_in[m_pos]) << 24) |
+                                       (m_in[m_pos + 1] << 16) | (m_in[m_pos + 2] << 8) | m_in[m_pos + 3];
+        return adler32(1, out.data(), out.size()) == expected;
+    }
+
+private:
+    struct Huffman {
+        std::array<int, 16> count{};
+        std::vector<int> symbol;
+    };
+
+    int bits(int n) {
+        int value = 0;
+        for (int i = 0; i < n; ++i) {
+            if (m_bitCount == 0) {
+                if (m_pos >= m_in.size()) {
+                    m_error = true;
+                    return 0;
+                }
+                m_bitBuffer = m_in[m_pos++];
+                m_bitCount = 8;
+            }
+            value |= (m_bitBuffer & 1) << i;
+            m_bitBuffer >>= 1;
+            --m_bitCount;
+        }
+        return value;
+    }
+
+    // Fails for over-subscribed or incomplete codes (a single-code distance table is allowed).
+    static bool build(Huffman& h, const int* lengths, int n, bool allowSingle) {
+        h.count.fill(0);
+        for (int s = 0; s < n; ++s) h.count[lengths[s]]++;
+        int used = n - h.count[0];
+        int left = 1;
+        for (int len = 1; len < 16; ++len) {
+            left = left * 2 - h.count[len];
+            if (left < 0) return false;
+        }
+        if (left > 0 && !(allowSingle && used == 1)) return false;
+        std::array<int, 16> offset{};
+        for (int len = 1; len < 15; ++len) offset[len + 1] = offset[len] + h.count[len];
+        h.symbol.assign(static_cast<std::size_t>(n), 0);
+        for (int s = 0; s < n; ++s) {
+            if (lengths[s] != 0) h.symbol[offset[lengths[s]]++] = s;
+        }
+        return true;
+    }
+
+    int decode(const Huffman& h) {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len < 16; ++len) {
+            code |= bits(1);
+            const int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        m_error = true;
+        return -1;
+    }
+
+    bool stored(std::vector<std::uint8_t>& out) {
+        m_bitCount = 0;
+        if (m_pos + 4 > m_in.size()) return false;
+        const int len = m_in[m_pos] | (m_in[m_pos + 1] << 8);
+        const int nlen = m_in[m_pos + 2] | (m_in[m_pos + 3] << 8);
+        m_pos += 4;
+        if (len != (~nlen & 0xFFFF) || m_pos + len > m_in.size()) return false;
+        out.insert(out.end(), m_in.begin() + static_cast<std::ptrdiff_t>(m_pos),
+                   m_in.begin() + static_cast<std::ptrdiff_t>(m_pos + len));
+        m_pos += len;
+        return true;
+    }
+
+    bool codes(std::vector<std::uint8_t>& out, const Huffman& lit, const Huffman& dist) {
+        static const int lbase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                                       67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const int lext[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const int dbase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                       1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const int dext[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        for (;;) {
+            int symbol = decode(lit);
+            if (m_error || symbol < 0) return false;
+            if (symbol < 256) {
+                out.push_back(static_cast<std::uint8_t>(symbol));
+            } else if (symbol == 256) {
+                return true;
+            } else {
+                symbol -= 257;
+                if (symbol >= 29) return false;
+                const int len = lbase[symbol] + bits(lext[symbol]);
+                const int d = decode(dist);
+                if (d < 0 || d >= 30) return false;
+                const std::size_t distance = static_cast<std::size_t>(dbase[d] + bits(dext[d]));
+                if (distance > out.size() || distance > 32768) return false;
+                for (int i = 0; i < len; ++i) out.push_back(out[out.size() - distance]);
+            }
+        }
+    }
+
+    bool fixed(std::vector<std::uint8_t>& out) {
+        int lengths[288];
+        for (int s = 0; s < 288; ++s) lengths[s] = s < 144 ? 8 : s < 256 ? 9 : s < 280 ? 7 : 8;
+        int dlengths[32];  // 30 and 31 complete the code but never occur
+        std::fill(dlengths, dlengths + 32, 5);
+        Huffman lit;
+        Huffman dist;
+        build(lit, lengths, 288, false);
+        build(dist, dlengths, 32, false);
+        return codes(out, lit, dist);
+    }
+
+    bool dynamic(std::vector<std::uint8_t>& out) {
+        static const int order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        const int nlen = bits(5) + 257;
+        const int ndist = bits(5) + 1;
+        const int ncode = bits(4) + 4;
+        if (nlen > 286 || ndist > 30) return false;
+        int lengths[320] = {};
+        for (int i = 0; i < ncode; ++i) lengths[order[i]] = bits(3);
+        Huffman lencode;
+        if (!build(lencode, lengths, 19, false)) return false;
+        int index = 0;
+        while (index < nlen + ndist) {
+            int symbol = decode(lencode);
+            if (m_error || symbol < 0) return false;
+            if (symbol < 16) {
+                lengths[index++] = symbol;
+                continue;
+            }
+            int value = 0;
+            int repeat = 0;
+            if (symbol == 16) {
+                if (index == 0) return false;
+                value = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (index + repeat > nlen + ndist) return false;
+            while (repeat--) lengths[index++] = value;
+        }
+        if (lengths[256] == 0) return false;
+        Huffman lit;
+        Huffman dist;
+        if (!build(lit, lengths, nlen, false) || !build(dist, lengths + nlen, ndist, true)) return false;
+        return codes(out, lit, dist);
+    }
+
+    const std::vector<std::uint8_t>& m_in;
+    std::size_t m_pos = 0;
+    int m_bitBuffer = 0;
+    int m_bitCount = 0;
+    bool m_error = false;
+};
+
+static std::uint32_t readBigEndian(const std::vector<std::uint8_t>& data, std::size_t at) {
+    return (static_cast<std::uint32_t>(data[at]) << 24) | (data[at + 1] << 16) | (data[at + 2] << 8) | data[at + 3];
+}
+
+// Decode an 8-bit RGBA PNG to RGBA pixels, checking the framing, every CRC, the zlib stream and
+// the filters. Returns false on any error. `idatChunks` receives the number of IDAT chunks.
+static bool decodePng(const std::vector<std::uint8_t>& file, std::vector<std::uint8_t>& pixels,
+                      int& width, int& height, int* idatChunks = nullptr) {
+    static const std::uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (file.size() < 8 || std::memcmp(file.data(), kSignature, 8) != 0) return false;
+    std::vector<std::uint8_t> zlib;
+    std::size_t at = 8;
+    bool ended = false;
+    int idats = 0;
+    while (at + 12 <= file.size() && !ended) {
+        const std::uint32_t size = readBigEndian(file, at);
+        if (at + 12 + size > file.size()) return false;
+        const std::string type(file.begin() + static_cast<std::ptrdiff_t>(at + 4),
+                               file.begin() + static_cast<std::ptrdiff_t>(at + 8));
+        if (crc32(0, file.data() + at + 4, size + 4) != readBigEndian(file, at + 8 + size)) return false;
+        const std::uint8_t* data = file.data() + at + 8;
+        if (type == "IHDR") {
+            if (size != 13 || data[8] != 8 || data[9] != 6 || data[10] != 0 || data[11] != 0 || data[12] != 0) return false;
+            width = static_cast<int>(readBigEndian(file, at + 8));
+            height = static_cast<int>(readBigEndian(file, at + 12));
+        } else if (type == "IDAT") {
+            zlib.insert(zlib.end(), data, data + size);
+            ++idats;
+        } else if (type == "IEND") {
+            ended = true;
+        }
+        at += 12 + size;
+    }
+    if (!ended || at != file.size()) return false;
+    if (idatChunks) *idatChunks = idats;
+
+    std::vector<std::uint8_t> filtered;
+    if (!Inflater(zlib).run(filtered)) return false;
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * 4;
+    if (filtered.size() != (rowBytes + 1) * static_cast<std::size_t>(height)) return false;
+    pixels.assign(rowBytes * static_cast<std::size_t>(height), 0);
+    for (int y = 0; y < height; ++y) {
+        const std::uint8_t* line = filtered.data() + static_cast<std::size_t>(y) * (rowBytes + 1);
+        std::uint8_t* row = pixels.data() + static_cast<std::size_t>(y) * rowBytes;
+        const std::uint8_t* above = (y > 0) ? row - rowBytes : nullptr;
+        for (std::size_t i = 0; i < rowBytes; ++i) {
+            const int a = (i >= 4) ? row[i - 4] : 0;
+            const int b = above ? above[i] : 0;
+            const int c = (above && i >= 4) ? above[i - 4] : 0;
+            int predicted = 0;
+            switch (line[0]) {
+                case 0: predicted = 0; break;
+                case 1: predicted = a; break;
+                case 2: predicted = b; break;
+                case 3: predicted = (a + b) / 2; break;
+                case 4: {
+                    const int p = a + b - c;
+                    const int pa = std::abs(p - a);
+                    const int pb = std::abs(p - b);
+                    const int pc = std::abs(p - c);
+                    predicted = (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+                    break;
+                }
+                default: return false;
+            }
+            row[i] = static_cast<std::uint8_t>(line[1 + i] + predicted);
+        }
+    }
+    return true;
+}
+
+// A plot-like RGBA image: flat background, grid lines, an antialiased curve, a gradient band
+// and a noisy patch, so every filter and both match-heavy and literal-heavy data occur.
+static std::vector<std::uint8_t> plotImage(int width, int height) {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::uint8_t* p = &pixels[(static_cast<std::size_t>(y) * width + x) * 4];
+            p[0] = 25; p[1] = 25; p[2] = 30; p[3] = 255;
+            if (x % 40 == 0 || y % 40 == 0) { p[0] = 60; p[1] = 60; p[2] = 70; }
+            const double curve = height * 0.5 + height * 0.3 * std::sin(x * 0.05);
+            const double d = std::abs(y - curve);
+            if (d < 2.0) {
+                const int a = static_cast<int>(255 * (1.0 - d / 2.0));
+                p[0] = static_cast<std::uint8_t>(p[0] + (255 - p[0]) * a / 255);
+                p[1] = static_cast<std::uint8_t>(p[1] + (120 - p[1]) * a / 255);
+            }
+            if (y < height / 6) { p[0] = static_cast<std::uint8_t>(x * 255 / width); p[3] = static_cast<std::uint8_t>(y * 6); }
+            if (x < width / 8 && y > height * 3 / 4) { p[0] = static_cast<std::uint8_t>(byte(rng)); p[2] = static_cast<std::uint8_t>(byte(rng)); }
+        }
+    }
+    return pixels;
+}
+
+TEST_CASE(PngEncoder_FilesDecodeToTheInputPixels) {
+    // 300 rows of 2404 bytes span several deflate chunks of one band.
+    const int width = 601;
+    const int height = 300;
+    const std::vector<std::uint8_t> rgba = plotImage(width, height);
+    std::vector<std::uint8_t> bgra = rgba;
+    for (std::size_t i = 0; i < bgra.size(); i += 4) std::swap(bgra[i], bgra[i + 2]);
+
+    for (PngLevel level : { PngLevel::Fast, PngLevel::Small }) {
+        for (ChannelOrder order : { ChannelOrder::Rgba, ChannelOrder::Bgra }) {
+            const auto& input = (order == ChannelOrder::Rgba) ? rgba : bgra;
+            const std::vector<std::uint8_t> file = encodePng(input.data(), width, height, order, level);
+            std::vector<std::uint8_t> decoded;
+            int w = 0;
+            int h = 0;
+            int idats = 0;
+            Assert::IsTrue(decodePng(file, decoded, w, h, &idats));
+            Assert::AreEqual(width, w);
+            Assert::AreEqual(height, h);
+            Assert::IsTrue(idats > 2);  // chunks deflated independently, plus the stream's end
+            Assert::IsTrue(decoded == rgba);
+            Assert::IsTrue(file.size() < rgba.size() / 4);
+        }
+    }
+
+    // Flat images collapse to almost nothing; tiny and one-pixel images still round-trip.
+    const std::vector<std::uint8_t> flat(static_cast<std::size_t>(512) * 512 * 4, 200);
+    const auto flatFile = encodePng(flat.data(), 512, 512, ChannelOrder::Rgba, PngLevel::Fast);
+    Assert::IsTrue(flatFile.size() < 4000);
+    for (const auto& size : { std::array<int, 2>{ 1, 1 }, std::array<int, 2>{ 3, 7 }, std::array<int, 2>{ 70000, 1 } }) {
+        const std::vector<std::uint8_t> small = plotImage(size[0], size[1]);
+        std::vector<std::uint8_t> decoded;
+        int w = 0;
+        int h = 0;
+        Assert::IsTrue(decodePng(encodePng(small.data(), size[0], size[1], ChannelOrder::Rgba, PngLevel::Small),
+                                 decoded, w, h));
+        Assert::IsTrue(decoded == small);
+    }
+}
+
+TEST_CASE(PngEncoder_StreamsBandsIntoOneImage) {
+    const int width = 257;
+    const int height = 400;
+    const std::vector<std::uint8_t> rgba = plotImage(width, height);
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * 4;
+
+    std::vector<std::uint8_t> file;
+    PngEncoder encoder(width, height, ChannelOrder::Rgba, PngLevel::Fast,
+                       [&](const std::uint8_t* data, std::size_t size) {
+                           file.insert(file.end(), data, data + size);
+                           return true;
+                       });
+    int row = 0;
+    for (int band : { 1, 63, 200, 136 }) {
+        Assert::IsTrue(encoder.writeRows(rgba.data() + static_cast<std::size_t>(row) * rowBytes, band));
+        row += band;
+    }
+    Assert::IsTrue(encoder.finish());
+    std::vector<std::uint8_t> decoded;
+    int w = 0;
+    int h = 0;
+    Assert::IsTrue(decodePng(file, decoded, w, h));
+    Assert::IsTrue(decoded == rgba);
+
+    // Banding changes where chunks start, but costs little compression.
+    const auto whole = encodePng(rgba.data(), width, height, ChannelOrder::Rgba, PngLevel::Fast);
+    Assert::IsTrue(file.size() < whole.size() + whole.size() / 10);
+
+    // Too many rows, too few rows, and a failing sink are reported.
+    PngEncoder overfull(4, 2, ChannelOrder::Rgba, PngLevel::Fast, [](const std::uint8_t*, std::size_t) { return true; });
+    Assert::IsFalse(overfull.writeRows(rgba.data(), 3));
+    PngEncoder unfinished(4, 2, ChannelOrder::Rgba, PngLevel::Fast, [](const std::uint8_t*, std::size_t) { return true; });
+    Assert::IsTrue(unfinished.writeRows(rgba.data(), 1));
+    Assert::IsFalse(unfinished.finish());
+    PngEncoder refused(4, 2, ChannelOrder::Rgba, PngLevel::Fast, [](const std::uint8_t*, std::size_t) { return false; });
+    Assert::IsFalse(refused.writeRows(rgba.data(), 2));
+}
+
+TEST_CASE(PngEncoder_SmallLevelCompressesBetter) {
+    const int width = 800;
+    const int height = 600;
+    const std::vector<std::uint8_t> rgba = plotImage(width, height);
+    const auto fast = encodePng(rgba.data(), width, height, ChannelOrder::Rgba, PngLevel::Fast);
+    const auto small = encodePng(rgba.data(), width, height, ChannelOrder::Rgba, PngLevel::Small);
+    Assert::IsTrue(small.size() < fast.size());
+}
+
+TEST_CASE(PngEncoder_ChecksumsMatchReferenceValues) {
+    const std::string text = "123456789";
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(text.data());
+    Assert::AreEqual(0xCBF43926u, crc32(0, bytes, text.size()));
+    Assert::AreEqual(0x091E01DEu, adler32(1, bytes, text.size()));
+
+    // Checksums of parts combine into the checksum of the whole, for any split.
+    std::vector<std::uint8_t> data(200000);
+    std::mt19937 rng(9);
+    for (std::uint8_t& b : data) b = static_cast<std::uint8_t>(rng());
+    const std::uint32_t whole = adler32(1, data.data(), data.size());
+    for (std::size_t split : { std::size_t(0), std::size_t(1), std::size_t(65521), std::size_t(123457), data.size() }) {
+        const std::uint32_t first = adler32(1, data.data(), split);
+        const std::uint32_t second = adler32(1, data.data() + split, data.size() - split);
+        Assert::AreEqual(whole, adler32Combine(first, second, data.size() - split));
+    }
+}
+
+} // namespace XpressFormulaTests
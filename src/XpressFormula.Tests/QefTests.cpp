@@ -0,0 +1,55 @@
+// QefTests.cpp - Tests for the dual-contouring vertex solve.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/Qef.h"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+static bool near(const Qef::Vec3& p, double x, double y, double z) {
+    return std::abs(p[0] - x) < 1e-9 && std::abs(p[1] - y) < 1e-9 && std::abs(p[2] - z) < 1e-9;
+}
+
+TEST_CASE(Qef_ThreePlanesMeetAtTheCorner) {
+    // Crossings on the three faces of the box max(|x|, |y|, |z|) = 1 around the corner (1, 1, 1),
+    // as a cell straddling the corner sees them.
+    Qef qef;
+    qef.add({ 1.0, 0.8, 0.9 }, { 1.0, 0.0, 0.0 });
+    qef.add({ 0.7, 1.0, 0.95 }, { 0.0, 2.0, 0.0 });  // normals need not be unit length
+    qef.add({ 0.85, 0.9, 1.0 }, { 0.0, 0.0, 1.0 });
+    qef.add({ 1.0, 0.9, 0.8 }, { 1.0, 0.0, 0.0 });
+    Assert::AreEqual(4, qef.count());
+    Assert::IsTrue(near(qef.solve(), 1.0, 1.0, 1.0));
+    // The average the surface-nets vertex uses sits inside the box, off the corner.
+    Assert::IsTrue(qef.massPoint()[0] < 0.9);
+}
+
+TEST_CASE(Qef_CreaseKeepsTheFreeDirectionAtTheMean) {
+    // Two planes x = 1 and y = 1: every point of the line x = y = 1 fits, the mean's z is kept.
+    Qef qef;
+    qef.add({ 1.0, 0.6, 0.2 }, { 1.0, 0.0, 0.0 });
+    qef.add({ 0.6, 1.0, 0.4 }, { 0.0, 1.0, 0.0 });
+    Assert::IsTrue(near(qef.solve(), 1.0, 1.0, 0.3));
+
+    // Nearly parallel normals on a smooth patch are treated as one plane, so the vertex does
+    // not run off along the badly conditioned direction.
+    Qef smooth;
+    smooth.add({ 0.0, 0.0, 1.0 }, { 0.0, 0.01, 1.0 });
+    smooth.add({ 0.0, 1.0, 1.0 }, { 0.0, -0.01, 1.0 });
+    const Qef::Vec3 p = smooth.solve();
+    Assert::IsTrue(std::abs(p[1] - 0.5) < 1e-6 && std::abs(p[2] - 1.0) < 1e-2);
+}
+
+TEST_CASE(Qef_IgnoresUnusablePlanes) {
+    Qef qef;
+    Assert::IsTrue(near(qef.solve(), 0.0, 0.0, 0.0));
+    qef.add({ 1.0, 2.0, 3.0 }, { 0.0, 0.0, 0.0 });
+    qef.add({ 1.0, 2.0, 3.0 }, { std::nan(""), 1.0, 0.0 });
+    Assert::AreEqual(0, qef.count());
+    qef.add({ 1.0, 2.0, 3.0 }, { 0.0, 0.0, 1.0 });
+    Assert::IsTrue(near(qef.solve(), 1.0, 2.0, 3.0));
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,95 @@
+// QualityGovernorTests.cpp - Tests for frame-budget driven quality selection.
+#include "CppUnitTest.h"
+#include "../XpressFormula/UI/QualityGovernor.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::UI;
+
+namespace XpressFormulaTests {
+
+static int s_formulaA = 0; // identity keys only (the governor never dereferences them)
+static int s_formulaB = 0;
+
+// Simulates one frame where the formula's draw cost follows cost(res) = fullCost * (res/full)^2.
+static int runSurfaceFrame(QualityGovernor& governor, double now, bool interacting,
+                           double fullCostMs, int fullRes = 60, float budgetMs = 8.0f) {
+    governor.beginFrame(now, interacting, budgetMs);
+    const int res = governor.surfaceResolution(&s_formulaA, fullRes);
+    const double ratio = static_cast<double>(res) / fullRes;
+    governor.addCost(&s_formulaA, QualityGovernor::CostModel::Surface, fullCostMs * ratio * ratio);
+    governor.endFrame();
+    return res;
+}
+
+TEST_CASE(QualityGovernor_IdleUsesFullQuality) {
+    QualityGovernor governor;
+    for (int i = 0; i < 5; ++i) {
+        Assert::AreEqual(60, runSurfaceFrame(governor, i * 0.016, false, 100.0));
+    }
+    Assert::IsFalse(governor.isGoverning());
+    Assert::IsTrue(governor.wiresAllowed(&s_formulaA));
+}
+
+TEST_CASE(QualityGovernor_DowngradesExpensiveFormulaToBudget) {
+    QualityGovernor governor;
+    // Full quality costs 32 ms against an 8 ms budget: expect ~half resolution (cost ~ res^2).
+    runSurfaceFrame(governor, 0.0, true, 32.0);
+    const int res = runSurfaceFrame(governor, 0.016, true, 32.0);
+    Assert::IsTrue(res >= 28 && res <= 32);
+    Assert::IsFalse(governor.wiresAllowed(&s_formulaA));
+    Assert::IsTrue(governor.isDegraded());
+}
+
+TEST_CASE(QualityGovernor_ImplicitCostModelIsCubic) {
+    QualityGovernor governor;
+    governor.beginFrame(0.0, true, 8.0f);
+    governor.implicitResolution(&s_formulaB, 64);
+    governor.addCost(&s_formulaB, QualityGovernor::CostModel::Implicit, 64.0);
+    governor.endFrame();
+    governor.beginFrame(0.016, true, 8.0f);
+    // 8x over budget with cubic cost => half resolution.
+    Assert::AreEqual(32, governor.implicitResolution(&s_formulaB, 64));
+}
+
+TEST_CASE(QualityGovernor_HysteresisDelaysUpgrades) {
+    QualityGovernor governor;
+    runSurfaceFrame(governor, 0.0, true, 32.0);
+    const int degraded = runSurfaceFrame(governor, 0.016, true, 32.0);
+
+    // The formula becomes cheap: resolution must not jump back on the very next frame.
+    const int next = runSurfaceFrame(governor, 0.032, true, 1.0);
+    Assert::AreEqual(degraded, next);
+
+    int res = next;
+    for (int i = 0; i < QualityGovernor::kUpgradeStableFrames * 8; ++i) {
+        res = runSurfaceFrame(governor, 0.048 + i * 0.016, true, 1.0);
+    }
+    Assert::AreEqual(60, res);
+    Assert::IsTrue(governor.wiresAllowed(&s_formulaA));
+}
+
+TEST_CASE(QualityGovernor_StableCostDoesNotOscillate) {
+    QualityGovernor governor;
+    runSurfaceFrame(governor, 0.0, true, 20.0);
+    const int settled = runSurfaceFrame(governor, 0.016, true, 20.0);
+    for (int i = 0; i < 50; ++i) {
+        Assert::AreEqual(settled, runSurfaceFrame(governor, 0.032 + i * 0.016, true, 20.0));
+    }
+}
+
+TEST_CASE(QualityGovernor_RestoresFullQualityAfterIdleGrace) {
+    QualityGovernor governor;
+    runSurfaceFrame(governor, 0.0, true, 32.0);
+    Assert::IsTrue(runSurfaceFrame(governor, 0.016, true, 32.0) < 60);
+
+    // Still inside the grace period: keep the degraded level (and keep rendering).
+    Assert::IsTrue(runSurfaceFrame(governor, 0.1, false, 32.0) < 60);
+    Assert::IsTrue(governor.isGoverning());
+
+    const double afterGrace = 0.016 + QualityGovernor::kIdleGraceSeconds + 0.01;
+    Assert::AreEqual(60, runSurfaceFrame(governor, afterGrace, false, 32.0));
+    Assert::IsFalse(governor.isGoverning());
+    Assert::IsFalse(governor.isDegraded());
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,124 @@
+// ResampleTests.cpp - Tests for bilinear and Lanczos image resizing and their SIMD kernels.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Imaging/Resample.h"
+#include "../XpressFormula/Imaging/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Imaging;
+
+namespace XpressFormulaTests {
+
+static std::vector<std::uint8_t> resized(const std::vector<std::uint8_t>& src, int srcWidth, int srcHeight,
+                                         int dstWidth, int dstHeight, ResampleFilter filter) {
+    std::vector<std::uint8_t> dst(static_cast<std::size_t>(dstWidth) * dstHeight * 4);
+    resize(src.data(), srcWidth, srcHeight, dst.data(), dstWidth, dstHeight, filter);
+    return dst;
+}
+
+TEST_CASE(Resample_KernelsMatchScalarCode) {
+    const int width = 97;
+    const int height = 61;
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> src(static_cast<std::size_t>(width) * height * 4);
+    for (std::uint8_t& value : src) value = static_cast<std::uint8_t>(byte(rng));
+
+    const int sizes[][2] = { { 150, 40 }, { 31, 200 }, { 97, 30 }, { 40, 61 }, { 1, 1 } };
+    for (ResampleFilter filter : { ResampleFilter::Bilinear, ResampleFilter::Lanczos3 }) {
+        for (const auto& size : sizes) {
+            setSimdLevel(SimdLevel::Scalar);
+            const auto expected = resized(src, width, height, size[0], size[1], filter);
+            for (SimdLevel level : { SimdLevel::Sse2, SimdLevel::Avx2 }) {
+                setSimdLevel(level);
+                Assert::IsTrue(resized(src, width, height, size[0], size[1], filter) == expected);
+            }
+        }
+    }
+    setSimdLevel(SimdLevel::Avx2);
+}
+
+TEST_CASE(Resample_BilinearMatchesExactInterpolation) {
+    const int width = 20;
+    const int height = 9;
+    std::vector<std::uint8_t> src(static_cast<std::size_t>(width) * height * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::uint8_t* p = &src[(static_cast<std::size_t>(y) * width + x) * 4];
+            p[0] = static_cast<std::uint8_t>(x * 13);
+            p[1] = static_cast<std::uint8_t>(y * 29);
+            p[2] = static_cast<std::uint8_t>((x * y * 7) % 256);
+            p[3] = 255;
+        }
+    }
+    const int dstWidth = 53;
+    const int dstHeight = 4;
+    const auto dst = resized(src, width, height, dstWidth, dstHeight, ResampleFilter::Bilinear);
+    int worst = 0;
+    for (int y = 0; y < dstHeight; ++y) {
+        const double sy = (y + 0.5) * height / dstHeight - 0.5;
+        const int y0 = static_cast<int>(std::floor(sy));
+        const double fy = sy - y0;
+        for (int x = 0; x < dstWidth; ++x) {
+            const double sx = (x + 0.5) * width / dstWidth - 0.5;
+            const int x0 = static_cast<int>(std::floor(sx));
+            const double fx = sx - x0;
+            auto at = [&](int px, int py, int c) {
+                px = std::clamp(px, 0, width - 1);
+                py = std::clamp(py, 0, height - 1);
+                return static_cast<double>(src[(static_cast<std::size_t>(py) * width + px) * 4 + c]);
+            };
+            for (int c = 0; c < 4; ++c) {
+                const double top = at(x0, y0, c) + (at(x0 + 1, y0, c) - at(x0, y0, c)) * fx;
+                const double bottom = at(x0, y0 + 1, c) + (at(x0 + 1, y0 + 1, c) - at(x0, y0 + 1, c)) * fx;
+                const long exact = std::lround(top + (bottom - top) * fy);
+                const int actual = dst[(static_cast<std::size_t>(y) * dstWidth + x) * 4 + c];
+                worst = std::max(worst, std::abs(actual - static_cast<int>(exact)));
+            }
+        }
+    }
+    Assert::IsTrue(worst <= 1);
+}
+
+TEST_CASE(Resample_LanczosKeepsFlatAreasAndFiltersDetail) {
+    // A flat colour stays exactly flat at any size: the weights sum to one.
+    std::vector<std::uint8_t> flat(64 * 48 * 4);
+    for (std::size_t i = 0; i < flat.size(); i += 4) {
+        flat[i + 0] = 200;
+        flat[i + 1] = 17;
+        flat[i + 2] = 99;
+        flat[i + 3] = 255;
+    }
+    for (const auto& size : { std::pair{ 17, 100 }, std::pair{ 300, 13 }, std::pair{ 64, 5 } }) {
+        const auto out = resized(flat, 64, 48, size.first, size.second, ResampleFilter::Lanczos3);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            Assert::AreEqual(static_cast<int>(flat[i % 4]), static_cast<int>(out[i]));
+        }
+    }
+
+    // Single-pixel stripes shrunk 4x average out instead of aliasing into bands. Near the left
+    // and right edge the window is cut off, so only the interior is checked.
+    std::vector<std::uint8_t> stripes(64 * 8 * 4);
+    for (std::size_t p = 0; p < 64 * 8; ++p) {
+        const std::uint8_t value = (p % 2 == 0) ? 255 : 0;
+        stripes[p * 4 + 0] = stripes[p * 4 + 1] = stripes[p * 4 + 2] = stripes[p * 4 + 3] = value;
+    }
+    const auto shrunk = resized(stripes, 64, 8, 16, 2, ResampleFilter::Lanczos3);
+    for (std::size_t i = 0; i < shrunk.size(); ++i) {
+        const std::size_t column = (i / 4) % 16;
+        if (column >= 2 && column < 14) {
+            Assert::IsTrue(std::abs(static_cast<int>(shrunk[i]) - 128) <= 2);
+        }
+    }
+
+    // Same size copies the image.
+    Assert::IsTrue(resized(stripes, 64, 8, 64, 8, ResampleFilter::Lanczos3) == stripes);
+}
+
+} // namespace XpressFormulaTests
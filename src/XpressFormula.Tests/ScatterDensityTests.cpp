@@ -0,0 +1,206 @@
+// ScatterDensityTests.cpp - Tests for point-cloud density binning, the bin pyramid and loading.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/ScatterDensity.h"
+#include "../XpressFormula/Core/TaskPool.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// Gaussian blob of (x, y, value) records around the origin, value = x + y.
+static std::vector<double> gaussianRecords(size_t count, bool withValues) {
+    std::mt19937 rng(5);
+    std::normal_distribution<double> coordinate(0.0, 1.0);
+    std::vector<double> records;
+    records.reserve(count * 3);
+    for (size_t i = 0; i < count; ++i) {
+        const double x = coordinate(rng);
+        const double y = coordinate(rng);
+        records.push_back(x);
+        records.push_back(y);
+        if (withValues) records.push_back(x + y);
+    }
+    return records;
+}
+
+static double total(const std::vector<float>& values) {
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+TEST_CASE(ScatterDensity_ExactBinningMatchesBruteForce) {
+    std::vector<double> records = gaussianRecords(20000, true);
+    records[3] = std::numeric_limits<double>::quiet_NaN();  // second record is ignored
+    auto points = ScatterDensity::fromRecords(records, true);
+    Assert::AreEqual(size_t(20000), points->size());
+    Assert::IsTrue(points->hasValues());
+
+    const ScatterDensity::Window window{ -1.5, 2.5, -0.5, 1.5, 40, 25 };
+    auto grid = points->bin(window);
+    Assert::IsTrue(grid != nullptr);
+    Assert::IsTrue(grid->exact);
+
+    std::vector<double> counts(40 * 25, 0.0);
+    std::vector<double> sums(40 * 25, 0.0);
+    for (size_t i = 0; i < 20000; ++i) {
+        const double* r = &records[i * 3];
+        if (std::isnan(r[0]) || r[0] < window.xMin || r[0] > window.xMax ||
+            r[1] < window.yMin || r[1] > window.yMax) {
+            continue;
+        }
+        const int ix = std::min(39, static_cast<int>((r[0] - window.xMin) * 10.0));
+        const int iy = std::min(24, static_cast<int>((window.yMax - r[1]) * 12.5));
+        counts[iy * 40 + ix] += 1.0;
+        sums[iy * 40 + ix] += r[2];
+    }
+    float busiest = 0.0f;
+    for (size_t c = 0; c < counts.size(); ++c) {
+        Assert::AreEqual(counts[c], static_cast<double>(grid->counts[c]));
+        Assert::IsTrue(std::abs(sums[c] - grid->sums[c]) < 1e-3);
+        busiest = std::max(busiest, grid->counts[c]);
+    }
+    Assert::AreEqual(busiest, grid->maxCount);
+}
+
+TEST_CASE(ScatterDensity_PyramidAggregatesMatchExactBinningWhenResolved) {
+    const size_t count = 200000;
+    auto points = ScatterDensity::fromRecords(gaussianRecords(count, false), false);
+
+    // Zoomed out: the whole cloud in a quarter of the view, finest bins well under a pixel.
+    const ScatterDensity::Window wide{ -20.0, 20.0, -20.0, 20.0, 160, 160 };
+    Assert::IsTrue(points->pyramidResolves(wide));
+    auto coarse = points->aggregate(wide);
+    auto exact = points->bin(wide);
+    Assert::IsFalse(coarse->exact);
+    Assert::IsTrue(std::abs(total(coarse->counts) - static_cast<double>(count)) < 1.0);
+    double difference = 0.0;
+    for (size_t c = 0; c < exact->counts.size(); ++c) {
+        difference += std::abs(coarse->counts[c] - exact->counts[c]);
+    }
+    // Only bins straddling a pixel edge are shared with a neighbour.
+    Assert::IsTrue(difference < 0.1 * static_cast<double>(count));
+
+    // Zoomed in beyond the finest level: a blurred preview, still exact in total.
+    const ScatterDensity::Window close{ -0.01, 0.01, -0.01, 0.01, 200, 200 };
+    Assert::IsFalse(points->pyramidResolves(close));
+    auto preview = points->aggregate(close);
+    auto binned = points->bin(close);
+    Assert::IsTrue(total(preview->counts) > 0.0);
+    Assert::IsTrue(std::abs(total(preview->counts) - total(binned->counts)) <
+                   0.5 * total(binned->counts) + 2.0);
+}
+
+TEST_CASE(ScatterDensity_ColorizesThroughThePalette) {
+    auto points = ScatterDensity::fromRecords({ 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.9, 0.9 }, false);
+    auto grid = points->bin({ 0.0, 1.0, 0.0, 1.0, 2, 2 });
+    Assert::AreEqual(3.0f, grid->maxCount);
+
+    std::array<std::uint32_t, 256> palette;
+    for (size_t i = 0; i < palette.size(); ++i) palette[i] = static_cast<std::uint32_t>(i) + 1u;
+    std::vector<std::uint32_t> pixels;
+    points->colorize(*grid, palette, false, pixels);
+    Assert::AreEqual(size_t(4), pixels.size());
+    Assert::AreEqual(256u, pixels[2]);                   // bottom left: the busiest pixel
+    Assert::AreEqual(static_cast<std::uint32_t>(86), pixels[1]);  // top right: 1/3 of the scale
+    Assert::AreEqual(0u, pixels[0]);                     // empty pixels are transparent
+    points->colorize(*grid, palette, true, pixels);
+    Assert::AreEqual(256u, pixels[2]);
+    Assert::IsTrue(pixels[1] > 86u);                     // log scale lifts sparse pixels
+}
+
+TEST_CASE(ScatterDensity_LoadsBinaryRecordsAndBinsInTheBackground) {
+    const std::string pairsPath = (std::filesystem::temp_directory_path() / "xf_scatter_test.bin").string();
+    const std::string triplesPath = (std::filesystem::temp_directory_path() / "xf_scatter_test.xyv").string();
+    {
+        const double pairs[] = { 0.0, 0.0, 1.0, 2.0, std::numeric_limits<double>::infinity(), 1.0, -1.0, 4.0 };
+        std::ofstream out(pairsPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(pairs), sizeof(pairs));
+        const double triples[] = { 0.0, 0.0, 5.0, 1.0, 1.0, 7.0 };
+        std::ofstream outValues(triplesPath, std::ios::binary | std::ios::trunc);
+        outValues.write(reinterpret_cast<const char*>(triples), sizeof(triples));
+    }
+    std::string error;
+    auto pairs = ScatterDensity::load(pairsPath, error);
+    Assert::IsTrue(pairs != nullptr);
+    Assert::AreEqual(size_t(4), pairs->size());
+    Assert::AreEqual(-1.0, pairs->xMin());
+    Assert::AreEqual(1.0, pairs->xMax());
+    Assert::AreEqual(4.0, pairs->yMax());
+    auto triples = ScatterDensity::load(triplesPath, error);
+    Assert::IsTrue(triples != nullptr && triples->hasValues());
+    Assert::AreEqual(5.0, triples->valueMin());
+    Assert::AreEqual(7.0, triples->valueMax());
+
+    ScatterDensityCache cache;
+    const ScatterDensity::Window window{ -2.0, 2.0, -1.0, 5.0, 8, 8 };
+    Assert::IsTrue(cache.request(pairs, window) == nullptr);
+    Assert::IsTrue(cache.pending());
+    std::shared_ptr<const ScatterDensity::Grid> grid;
+    for (int attempt = 0; attempt < 1000 && !grid; ++attempt) {
+        grid = cache.request(pairs, window);
+        if (!grid) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsTrue(grid != nullptr);
+    Assert::IsFalse(cache.pending());
+    Assert::AreEqual(3.0, total(grid->counts));
+    cache.request(pairs, { -2.0, 2.0, -1.0, 5.0, 4, 4 });
+    cache.cancel();
+    Assert::IsFalse(cache.pending());
+
+    // Mappings are released before the files are rewritten.
+    pairs.reset();
+    triples.reset();
+    {
+        const double partial[] = { 0.0, 1.0, 2.0 };
+        std::ofstream out(pairsPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(partial), sizeof(partial));
+    }
+    Assert::IsTrue(ScatterDensity::load(pairsPath, error) == nullptr);
+    Assert::IsFalse(error.empty());
+    error.clear();
+    Assert::IsTrue(ScatterDensity::load("points.csv", error) == nullptr);
+    Assert::IsFalse(error.empty());
+
+    std::remove(pairsPath.c_str());
+    std::remove(triplesPath.c_str());
+}
+
+TEST_CASE(ScatterDensity_UiLoopsRunWhileAnExactPassIsInFlight) {
+    // Enough points that the exact pass outlasts a short loop on the calling (UI) thread.
+    const size_t count = 4000000;
+    std::vector<double> records(count * 2);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i] = static_cast<double>((i * 2654435761u) % 1000003u) / 1000003.0;
+    }
+    auto points = ScatterDensity::fromRecords(std::move(records), false);
+    const ScatterDensity::Window close{ 0.4, 0.4001, 0.4, 0.4001, 64, 64 };
+    Assert::IsFalse(points->pyramidResolves(close));
+
+    ScatterDensityCache cache;
+    Assert::IsTrue(cache.request(points, close) == nullptr);
+    std::atomic<int> visited{ 0 };
+    XpressFormula::Core::TaskPool::shared().parallelFor(64, [&](size_t) { visited.fetch_add(1); });
+    Assert::AreEqual(64, visited.load());
+    Assert::IsTrue(cache.request(points, close) == nullptr);  // the pass is still binning
+
+    std::shared_ptr<const ScatterDensity::Grid> grid;
+    for (int attempt = 0; attempt < 10000 && !grid; ++attempt) {
+        grid = cache.request(points, close);
+        if (!grid) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsTrue(grid != nullptr && grid->exact);
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,70 @@
+// SpscRingTests.cpp - Tests for the lock-free single-producer single-consumer ring.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/SpscRing.h"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+
+namespace XpressFormulaTests {
+
+TEST_CASE(SpscRing_PushesWhatFitsAndPopsInOrder) {
+    SpscRing<int> ring(5);
+    Assert::AreEqual(size_t(8), ring.capacity());
+
+    const int values[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    Assert::AreEqual(size_t(8), ring.push(values, 10));
+    Assert::AreEqual(size_t(0), ring.push(values, 1));
+
+    int out[10] = {};
+    Assert::AreEqual(size_t(3), ring.pop(out, 3));
+    Assert::AreEqual(1, out[0]);
+    Assert::AreEqual(3, out[2]);
+    // The freed slots are reused across the wrap.
+    Assert::AreEqual(size_t(3), ring.push(values + 8, 2) + ring.push(values, 1));
+    Assert::AreEqual(size_t(8), ring.pop(out, 10));
+    const int expected[] = { 4, 5, 6, 7, 8, 9, 10, 1 };
+    for (int i = 0; i < 8; ++i) {
+        Assert::AreEqual(expected[i], out[i]);
+    }
+    Assert::AreEqual(size_t(0), ring.pop(out, 10));
+}
+
+TEST_CASE(SpscRing_TransfersEveryItemBetweenThreads) {
+    SpscRing<std::uint64_t> ring(1024);
+    const std::uint64_t count = 2000000;
+    std::thread producer([&]() {
+        std::vector<std::uint64_t> batch(97);
+        std::uint64_t next = 0;
+        while (next < count) {
+            const size_t n = static_cast<size_t>(std::min<std::uint64_t>(batch.size(), count - next));
+            for (size_t i = 0; i < n; ++i) batch[i] = next + i;
+            size_t sent = 0;
+            while (sent < n) {
+                sent += ring.push(batch.data() + sent, n - sent);
+                if (sent < n) std::this_thread::yield();
+            }
+            next += n;
+        }
+    });
+
+    std::vector<std::uint64_t> out(61);
+    std::uint64_t expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        const size_t n = ring.pop(out.data(), out.size());
+        for (size_t i = 0; i < n; ++i) {
+            ordered = ordered && out[i] == expected;
+            ++expected;
+        }
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+    Assert::IsTrue(ordered);
+    Assert::AreEqual(size_t(0), ring.pop(out.data(), out.size()));
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,191 @@
+// StreamSeriesTests.cpp - Tests for live series: line parsing, the sliding window, decimation.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/StreamSeries.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+static void feedText(StreamSeries& stream, const std::string& text) {
+    stream.feed(text.data(), text.size());
+}
+
+TEST_CASE(StreamSeries_ParsesLinesAcrossReads) {
+    StreamSeries stream(256);
+    feedText(stream, "time,value\n1, 10\n2;2");
+    feedText(stream, "0\n3\t30\r\n# note\n2 99\n4 nan\n");
+    Assert::AreEqual(size_t(4), stream.poll());
+    Assert::AreEqual(size_t(0), stream.poll());
+
+    Assert::AreEqual(size_t(4), stream.size());
+    Assert::AreEqual(2.0, stream.x(1));
+    Assert::AreEqual(20.0, stream.y(1));  // the line split between the two reads
+    Assert::IsTrue(std::isnan(stream.y(3)));
+    Assert::AreEqual(std::uint64_t(1), stream.dropped());  // "2 99" went back in x
+    Assert::AreEqual(std::uint64_t(4), stream.revision());
+    const StreamSeries::Summary s = stream.summarize(0, 4);
+    Assert::AreEqual(10.0, s.yMin);
+    Assert::AreEqual(30.0, s.yMax);
+
+    // Lone values are plotted at the seconds since the stream was opened.
+    StreamSeries values(256);
+    feedText(values, "5\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    feedText(values, "6\n");
+    Assert::AreEqual(size_t(2), values.poll());
+    Assert::AreEqual(5.0, values.y(0));
+    Assert::AreEqual(6.0, values.y(1));
+    Assert::IsTrue(values.x(0) >= 0.0 && values.x(0) < values.x(1));
+}
+
+TEST_CASE(StreamSeries_WindowKeepsTheLatestSamplesAndSummarizesAcrossTheWrap) {
+    StreamSeries stream(256);
+    Assert::AreEqual(size_t(256), stream.capacity());
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    std::vector<double> ys;
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        ys.push_back(value(rng));
+        text += std::to_string(i) + " " + std::to_string(ys.back()) + "\n";
+        if (i % 37 == 0) {
+            feedText(stream, text);
+            stream.poll();
+            text.clear();
+        }
+    }
+    feedText(stream, text);
+    stream.poll();
+
+    Assert::AreEqual(size_t(256), stream.size());
+    Assert::AreEqual(744.0, stream.x(0));
+    Assert::AreEqual(999.0, stream.x(255));
+    std::uniform_int_distribution<size_t> index(0, 256);
+    for (int trial = 0; trial < 300; ++trial) {
+        size_t first = index(rng);
+        size_t last = index(rng);
+        if (first > last) std::swap(first, last);
+        double lo = std::numeric_limits<double>::infinity();
+        double hi = -lo;
+        for (size_t i = first; i < last; ++i) {
+            lo = std::min(lo, stream.y(i));
+            hi = std::max(hi, stream.y(i));
+        }
+        const StreamSeries::Summary s = stream.summarize(first, last);
+        Assert::AreEqual(lo, s.yMin);
+        Assert::AreEqual(hi, s.yMax);
+    }
+}
+
+TEST_CASE(StreamSeries_DecimatesTheWindowPerPixelColumn) {
+    StreamSeries stream(1 << 16);
+    std::string text;
+    for (int i = 0; i < 100000; ++i) {
+        text += std::to_string(i * 0.01) + "," + std::to_string(std::sin(i * 0.001) + ((i % 2) ? 0.1 : -0.1)) + "\n";
+        if (text.size() > 60000) {
+            feedText(stream, text);
+            stream.poll();
+            text.clear();
+        }
+    }
+    feedText(stream, text);
+    stream.poll();
+    Assert::AreEqual(size_t(1 << 16), stream.size());
+
+    ViewTransform vt;
+    vt.screenWidth = 400.0f;
+    vt.screenHeight = 300.0f;
+    vt.centerX = 650.0;
+    vt.scaleX = 400.0 / 800.0;
+    vt.scaleY = 100.0;
+    std::pmr::vector<Vec2> points;
+    stream.decimate(vt, points);
+    Assert::IsTrue(points.size() <= 2 * 400 + 2);
+    Assert::IsTrue(points.size() > 400);
+    for (const Vec2& p : points) {
+        Assert::IsTrue(std::isfinite(p.x) && std::isfinite(p.y));
+    }
+}
+
+TEST_CASE(StreamSeries_ReadsASourceOnTheReaderThread) {
+    const std::string path = (std::filesystem::temp_directory_path() / "xf_stream_test.txt").string();
+    {
+        std::ofstream out(path, std::ios::trunc);
+        for (int i = 0; i < 5000; ++i) out << i << ' ' << (i % 7) << '\n';
+    }
+    StreamSeries stream;
+    std::string error;
+    Assert::IsTrue(stream.open(path, error));
+    // A plain file ends the stream once read.
+    for (int attempt = 0; attempt < 2000 && stream.connected(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Assert::IsFalse(stream.connected());
+    stream.poll();
+    Assert::AreEqual(size_t(5000), stream.size());
+    Assert::AreEqual(6.0, stream.summarize(0, stream.size()).yMax);
+    stream.close();
+    std::remove(path.c_str());
+
+    StreamSeries missing;
+    Assert::IsFalse(missing.open(path, error));
+    Assert::IsFalse(error.empty());
+    error.clear();
+    Assert::IsFalse(missing.open("unix:", error));
+    Assert::IsFalse(error.empty());
+}
+
+TEST_CASE(StreamSeries_CloseDoesNotWaitForTheReaderAndReopeningKeepsTheWindow) {
+    StreamSeries stream;
+    feedText(stream, "1 10\n2 20\n");
+    stream.poll();
+    std::string error;
+#ifndef _WIN32
+    // A FIFO without a writer leaves the reader waiting in its poll.
+    const std::string fifo = (std::filesystem::temp_directory_path() / "xf_stream_test.fifo").string();
+    std::remove(fifo.c_str());
+    Assert::IsTrue(::mkfifo(fifo.c_str(), 0600) == 0);
+    Assert::IsTrue(stream.open(fifo, error));
+    Assert::IsTrue(stream.connected());
+    Assert::AreEqual(fifo, stream.source());
+    const auto before = std::chrono::steady_clock::now();
+    stream.close();
+    Assert::IsTrue(std::chrono::steady_clock::now() - before < std::chrono::milliseconds(50));
+    Assert::IsFalse(stream.connected());
+    std::remove(fifo.c_str());
+#endif
+    const std::string path = (std::filesystem::temp_directory_path() / "xf_stream_reopen.txt").string();
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "3 30\n4 40\n";
+    }
+    feedText(stream, "2.5 25\n");  // still queued when the source is reopened
+    Assert::IsTrue(stream.open(path, error));
+    for (int attempt = 0; attempt < 2000 && stream.connected(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stream.poll();
+    Assert::AreEqual(size_t(5), stream.size());
+    Assert::AreEqual(10.0, stream.summarize(0, stream.size()).yMin);
+    Assert::AreEqual(40.0, stream.summarize(0, stream.size()).yMax);
+    stream.close();
+    std::remove(path.c_str());
+}
+
+} // namespace XpressFormulaTests
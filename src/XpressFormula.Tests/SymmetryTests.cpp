@@ -0,0 +1,82 @@
+// SymmetryTests.cpp - Tests for parity proofs and mirrored grid sampling.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/GridEvaluator.h"
+#include "../XpressFormula/Core/Parser.h"
+#include "../XpressFormula/Core/Symmetry.h"
+#include <cmath>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+
+namespace XpressFormulaTests {
+
+static Parity parityOf(const char* formula, const char* variable) {
+    return Symmetry::parity(Parser::parse(formula).ast, variable);
+}
+
+TEST_CASE(Symmetry_ProvesParityPerVariable) {
+    Assert::IsTrue(parityOf("x^2 + y^2 + z^2 - 1", "x") == Parity::Even);
+    Assert::IsTrue(parityOf("x^2 + y^2 + z^2 - 1", "z") == Parity::Even);
+    Assert::IsTrue(parityOf("cos(x) * cos(y)", "y") == Parity::Even);
+    Assert::IsTrue(parityOf("abs(x) + y^4", "x") == Parity::Even);
+    Assert::IsTrue(parityOf("abs(x) + y^4", "y") == Parity::Even);
+    Assert::IsTrue(parityOf("sin(x*y)", "x") == Parity::Odd);
+    Assert::IsTrue(parityOf("x^3 - 2*x", "x") == Parity::Odd);
+    Assert::IsTrue(parityOf("tan(x) / x", "x") == Parity::Even);
+    Assert::IsTrue(parityOf("atan2(y, x^2)", "y") == Parity::Odd);
+    Assert::IsTrue(parityOf("exp(-x^2)", "x") == Parity::Even);
+
+    // Not provable: mixed parities, one-sided domains, non-integer powers of odd bases.
+    Assert::IsTrue(parityOf("x + 1", "x") == Parity::None);
+    Assert::IsTrue(parityOf("sqrt(x)", "x") == Parity::None);
+    Assert::IsTrue(parityOf("exp(x)", "x") == Parity::None);
+    Assert::IsTrue(parityOf("x^2.5", "x") == Parity::None);
+    Assert::IsTrue(parityOf("atan2(y, x)", "x") == Parity::None);
+}
+
+TEST_CASE(Symmetry_MirrorsSamplesAboutZero) {
+    const double centred[] = { -2.0, -1.0, 0.0, 1.0, 2.0 };
+    int source[5] = {};
+    Assert::AreEqual(3, Symmetry::mirrorSamples(centred, 5, source));
+    Assert::AreEqual(4, source[0]);
+    Assert::AreEqual(3, source[1]);
+    Assert::AreEqual(2, source[2]);
+    Assert::AreEqual(4, source[4]);
+
+    // Off-centre: only the overlap with its own mirror image is paired.
+    const double panned[] = { -1.0, 0.0, 1.0, 2.0, 3.0 };
+    Assert::AreEqual(4, Symmetry::mirrorSamples(panned, 5, source));
+    Assert::AreEqual(2, source[0]);
+    Assert::AreEqual(3, source[3]);
+
+    const double unsorted[] = { 1.0, -1.0 };
+    Assert::AreEqual(2, Symmetry::mirrorSamples(unsorted, 2, source));
+    Assert::AreEqual(0, source[0]);
+}
+
+TEST_CASE(GridEvaluator_MirrorsSymmetricGrids) {
+    std::vector<double> axis;
+    for (int i = 0; i <= 20; ++i) {
+        axis.push_back(-5.0 + 0.5 * i);
+    }
+    const int n = static_cast<int>(axis.size());
+    for (const char* formula : { "cos(x) * cos(y)", "sin(x*y) + x^3*y", "sqrt(x) + y^2" }) {
+        const ASTNodePtr ast = Parser::parse(formula).ast;
+        std::vector<double> grid(axis.size() * axis.size());
+        GridEvaluator(ast).evaluate(axis.data(), n, axis.data(), n, grid.data());
+        bool matches = true;
+        for (int iy = 0; iy < n; ++iy) {
+            for (int ix = 0; ix < n; ++ix) {
+                const double expected = Evaluator::evaluate(ast, { { "x", axis[ix] }, { "y", axis[iy] } });
+                const double actual = grid[static_cast<size_t>(iy) * n + ix];
+                matches = matches && (std::isnan(expected) ? std::isnan(actual)
+                                                           : std::abs(expected - actual) <= 1e-12);
+            }
+        }
+        Assert::IsTrue(matches);
+    }
+    Assert::IsTrue(GridEvaluator(Parser::parse("sin(x*y)").ast).parityY() == Parity::Odd);
+}
+
+} // namespace XpressFormulaTests
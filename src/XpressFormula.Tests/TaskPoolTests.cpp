@@ -0,0 +1,80 @@
+// TaskPoolTests.cpp - Tests for the fork/join worker pool.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Core/TaskPool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+
+namespace XpressFormulaTests {
+
+TEST_CASE(TaskPool_ParallelForVisitsEveryIndexOnce) {
+    TaskPool pool(3);
+    for (int round = 0; round < 20; ++round) {
+        std::vector<std::atomic<int>> hits(257);
+        pool.parallelFor(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+        for (const auto& hit : hits) {
+            Assert::AreEqual(1, hit.load());
+        }
+    }
+}
+
+TEST_CASE(TaskPool_ZeroWorkersRunsSeriallyInOrder) {
+    TaskPool pool(0);
+    std::vector<size_t> order;
+    pool.parallelFor(5, [&](size_t i) { order.push_back(i); });
+    Assert::AreEqual(static_cast<size_t>(5), order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        Assert::AreEqual(i, order[i]);
+    }
+}
+
+TEST_CASE(TaskPool_NestedParallelForCompletes) {
+    TaskPool pool(2);
+    std::atomic<int> total{ 0 };
+    pool.parallelFor(4, [&](size_t) {
+        pool.parallelFor(8, [&](size_t) { total.fetch_add(1); });
+    });
+    Assert::AreEqual(32, total.load());
+}
+
+TEST_CASE(TaskPool_LoopsFromSeveralThreadsRunConcurrently) {
+    // A background loop whose tasks block must not hold up a loop issued from another thread.
+    TaskPool pool(2);
+    std::atomic<bool> release{ false };
+    std::atomic<int> started{ 0 };
+    std::atomic<bool> timedOut{ false };
+    std::thread background([&]() {
+        pool.parallelFor(4, [&](size_t) {
+            started.fetch_add(1);
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!release.load()) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    timedOut.store(true);  // the loop below waited for this one
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    });
+    while (started.load() == 0) {
+        std::this_thread::yield();
+    }
+
+    std::vector<std::atomic<int>> hits(100);
+    pool.parallelFor(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+    const bool finishedFirst = !timedOut.load();
+    release.store(true);
+    background.join();
+
+    Assert::IsTrue(finishedFirst);
+    for (const auto& hit : hits) {
+        Assert::AreEqual(1, hit.load());
+    }
+    Assert::AreEqual(4, started.load());
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,69 @@
+// VirtualListTests.cpp - Tests for variable-height row virtualisation of the formula list.
+#include "CppUnitTest.h"
+#include "../XpressFormula/UI/VirtualList.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::UI;
+
+namespace XpressFormulaTests {
+
+TEST_CASE(VirtualList_UnmeasuredRowsUseTheDefaultHeight) {
+    VirtualList list;
+    list.setDefaultHeight(20.0f);
+    list.resize(1000);
+    Assert::AreEqual(20000.0f, list.totalHeight());
+
+    // Rows 50..54 fill a 100-pixel viewport scrolled to 1000.
+    const VirtualList::Range range = list.visibleRange(1000.0f, 100.0f);
+    Assert::AreEqual(size_t(50), range.first);
+    Assert::AreEqual(size_t(55), range.last);
+    Assert::AreEqual(1000.0f, range.before);
+    Assert::AreEqual(20000.0f - 1100.0f, range.after);
+
+    // A partly visible row at either edge is included.
+    const VirtualList::Range partial = list.visibleRange(1010.0f, 100.0f);
+    Assert::AreEqual(size_t(50), partial.first);
+    Assert::AreEqual(size_t(56), partial.last);
+}
+
+TEST_CASE(VirtualList_MeasuredHeightsMoveTheRowsBelow) {
+    VirtualList list;
+    list.setDefaultHeight(20.0f);
+    list.resize(10);
+    list.setHeight(2, 50.0f);  // a row showing an error message
+    Assert::AreEqual(230.0f, list.totalHeight());
+
+    // Row 3 now starts at 90.
+    VirtualList::Range range = list.visibleRange(90.0f, 20.0f);
+    Assert::AreEqual(size_t(3), range.first);
+    Assert::AreEqual(size_t(4), range.last);
+    Assert::AreEqual(90.0f, range.before);
+    Assert::AreEqual(120.0f, range.after);
+
+    // Erasing the tall row shifts the later heights up with it.
+    list.erase(2);
+    Assert::AreEqual(size_t(9), list.size());
+    Assert::AreEqual(180.0f, list.totalHeight());
+    range = list.visibleRange(40.0f, 20.0f);
+    Assert::AreEqual(size_t(2), range.first);
+    Assert::AreEqual(size_t(3), range.last);
+}
+
+TEST_CASE(VirtualList_HandlesEmptyListsAndScrollingPastTheEnd) {
+    VirtualList list;
+    VirtualList::Range range = list.visibleRange(0.0f, 100.0f);
+    Assert::AreEqual(size_t(0), range.first);
+    Assert::AreEqual(size_t(0), range.last);
+    Assert::AreEqual(0.0f, list.totalHeight());
+
+    list.setDefaultHeight(10.0f);
+    list.resize(5);
+    range = list.visibleRange(500.0f, 100.0f);
+    Assert::AreEqual(range.first, range.last);
+    Assert::AreEqual(50.0f, range.before + range.after);
+    range = list.visibleRange(0.0f, 1000.0f);
+    Assert::AreEqual(size_t(0), range.first);
+    Assert::AreEqual(size_t(5), range.last);
+}
+
+} // namespace XpressFormulaTests
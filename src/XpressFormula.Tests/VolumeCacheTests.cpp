@@ -0,0 +1,101 @@
+// VolumeCacheTests.cpp - Tests for the background-sampled cross-section volume.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/VolumeCache.h"
+#include "../XpressFormula/Core/Parser.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+static VolumeCache::Domain smallDomain() {
+    VolumeCache::Domain domain;
+    domain.xMin = 0.0;
+    domain.xMax = 4.0;  // x samples at 0.5, 1.5, 2.5, 3.5
+    domain.yMin = 0.0;
+    domain.yMax = 2.0;  // y samples at 0.5, 1.5
+    domain.zMin = -2.0;
+    domain.zMax = 2.0;  // z planes at -2, 0, 2
+    domain.nx = 4;
+    domain.ny = 2;
+    domain.nz = 3;
+    return domain;
+}
+
+TEST_CASE(VolumeCache_SliceOnPlaneMatchesFormula) {
+    auto volume = VolumeCache::sample(Parser::parse("x + 10*y + 100*z").ast, smallDomain());
+    Assert::IsTrue(volume != nullptr);
+    std::vector<double> slice(8);
+    volume->slice(2.0, slice.data());
+    Assert::AreEqual(205.5, slice[0]);
+    Assert::AreEqual(218.5, slice[7]);
+}
+
+TEST_CASE(VolumeCache_SliceInterpolatesBetweenPlanesWithGlobalRange) {
+    auto volume = VolumeCache::sample(Parser::parse("z").ast, smallDomain());
+    Assert::IsTrue(volume != nullptr);
+    std::vector<double> slice(8);
+    volume->slice(1.0, slice.data());
+    Assert::AreEqual(1.0, slice[3]);
+    // A constant slice still reports the whole volume's range.
+    Assert::AreEqual(-2.0, volume->lo);
+    Assert::AreEqual(2.0, volume->hi);
+    Assert::IsFalse(volume->containsZ(2.5));
+}
+
+TEST_CASE(VolumeCache_MirrorsPlanesOfSymmetricFields) {
+    // Odd in z: the z = -2 plane is copied from z = 2 with its sign flipped.
+    auto odd = VolumeCache::sample(Parser::parse("x * z^3").ast, smallDomain());
+    Assert::IsTrue(odd != nullptr);
+    std::vector<double> slice(8);
+    odd->slice(-2.0, slice.data());
+    Assert::AreEqual(-4.0, slice[0]);
+    Assert::AreEqual(-28.0, slice[3]);
+    Assert::AreEqual(-28.0, odd->lo);
+    Assert::AreEqual(28.0, odd->hi);
+
+    auto even = VolumeCache::sample(Parser::parse("y + z^2").ast, smallDomain());
+    even->slice(-2.0, slice.data());
+    Assert::AreEqual(5.5, slice[7]);
+}
+
+TEST_CASE(VolumeCache_RequestCompletesInBackground) {
+    VolumeCache cache;
+    const ASTNodePtr ast = Parser::parse("x*y*z").ast;
+    std::shared_ptr<const VolumeCache::Volume> volume = cache.request(ast, smallDomain());
+    for (int i = 0; i < 2000 && !volume; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        volume = cache.request(ast, smallDomain());
+    }
+    Assert::IsTrue(volume != nullptr);
+    Assert::IsFalse(cache.pending());
+
+    // A different domain starts over.
+    VolumeCache::Domain wider = smallDomain();
+    wider.xMax = 8.0;
+    Assert::IsTrue(cache.request(ast, wider) == nullptr);
+    Assert::IsTrue(cache.pending());
+}
+
+TEST_CASE(VolumeCache_EmptyDomainStopsPending) {
+    VolumeCache cache;
+    const ASTNodePtr ast = Parser::parse("x*y*z").ast;
+    VolumeCache::Domain empty = smallDomain();
+    empty.zMax = empty.zMin;  // nothing to sample: the pass finishes without a volume
+    Assert::IsTrue(cache.request(ast, empty) == nullptr);
+    for (int i = 0; i < 2000 && cache.pending(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        Assert::IsTrue(cache.request(ast, empty) == nullptr);
+    }
+    Assert::IsFalse(cache.pending());
+
+    // A valid domain afterwards samples normally.
+    Assert::IsTrue(cache.request(ast, smallDomain()) == nullptr);
+    Assert::IsTrue(cache.pending());
+}
+
+} // namespace XpressFormulaTests
@@ -0,0 +1,124 @@
+// VolumeRaymarcherTests.cpp - Tests for the progressive CPU volume ray-marcher.
+#include "CppUnitTest.h"
+#include "../XpressFormula/Plotting/VolumeRaymarcher.h"
+#include "../XpressFormula/Core/Parser.h"
+#include "../XpressFormula/Core/TaskPool.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace XpressFormula::Core;
+using namespace XpressFormula::Plotting;
+
+namespace XpressFormulaTests {
+
+// The box [-2,2]^3 sampled on 16^3 nodes, viewed from straight above (elevation 0 looks down
+// the z axis) at 10 px/unit with the origin in the middle of a 64x64 image.
+static std::shared_ptr<const VolumeCache::Volume> sampleCube(const char* formula) {
+    VolumeCache::Domain domain;
+    domain.xMin = -2.0;
+    domain.xMax = 2.0;
+    domain.yMin = -2.0;
+    domain.yMax = 2.0;
+    domain.zMin = -2.0;
+    domain.zMax = 2.0;
+    domain.nx = 16;
+    domain.ny = 16;
+    domain.nz = 16;
+    return VolumeCache::sample(Parser::parse(formula).ast, domain);
+}
+
+static VolumeRaymarcher::Camera topView() {
+    VolumeRaymarcher::Camera camera;
+    camera.azimuthDeg = 0.0f;
+    camera.elevationDeg = 0.0f;
+    camera.zScale = 1.0f;
+    camera.originX = 32.0;
+    camera.originY = 32.0;
+    camera.scale = 10.0;
+    camera.width = 64.0f;
+    camera.height = 64.0f;
+    return camera;
+}
+
+static VolumeRaymarcher::TransferFunction whiteTransfer(float threshold) {
+    VolumeRaymarcher::TransferFunction transfer;
+    transfer.threshold = threshold;
+    transfer.density = 8.0f;
+    transfer.palette.fill(0xFFFFFFFFu);
+    return transfer;
+}
+
+static void renderToCompletion(VolumeRaymarcher& raymarcher) {
+    TaskPool pool(0);
+    int top = 0;
+    int bottom = 0;
+    for (int i = 0; i < 100 && !raymarcher.converged(); ++i) {
+        raymarcher.refine(pool, 1000.0, top, bottom);
+    }
+}
+
+TEST_CASE(VolumeRaymarcher_DenseCentreIsOpaqueAndOutsideIsClear) {
+    // Largest at the centre: the ball r < ~1.4 is above the threshold.
+    VolumeRaymarcher raymarcher;
+    raymarcher.setScene(sampleCube("-(x^2 + y^2 + z^2)"), topView(), whiteTransfer(0.75f), 64, 64);
+    renderToCompletion(raymarcher);
+    Assert::IsTrue(raymarcher.converged());
+    Assert::IsTrue(raymarcher.hasImage());
+
+    const std::uint32_t centre = raymarcher.pixels()[32 * 64 + 32];
+    Assert::AreEqual(0xFFu, static_cast<unsigned int>(centre >> 24));
+    Assert::AreEqual(0xFFu, static_cast<unsigned int>(centre & 0xFFu));
+    // (2, 2) is outside the sampled box.
+    Assert::AreEqual(0u, static_cast<unsigned int>(raymarcher.pixels()[2 * 64 + 2]));
+}
+
+TEST_CASE(VolumeRaymarcher_EmptySpaceIsSkippedWithoutSampling) {
+    // Nearly transparent, so rays are never terminated early. At threshold 0.999 only the brick
+    // holding the (xMax, yMax, zMax) corner can contribute; every other brick is jumped over.
+    auto volume = sampleCube("x + y + z");
+    VolumeRaymarcher::TransferFunction everything = whiteTransfer(0.0f);
+    everything.density = 0.01f;
+    VolumeRaymarcher::TransferFunction cornerOnly = everything;
+    cornerOnly.threshold = 0.999f;
+
+    VolumeRaymarcher full;
+    full.setScene(volume, topView(), everything, 64, 64);
+    renderToCompletion(full);
+    VolumeRaymarcher skipped;
+    skipped.setScene(volume, topView(), cornerOnly, 64, 64);
+    renderToCompletion(skipped);
+
+    Assert::IsTrue(skipped.converged());
+    Assert::IsTrue(skipped.samplesTaken() * 4 < full.samplesTaken());
+    Assert::AreEqual(0u, static_cast<unsigned int>(skipped.pixels()[32 * 64 + 16]));
+}
+
+TEST_CASE(VolumeRaymarcher_RefinesProgressivelyAndRestartsOnCameraChange) {
+    VolumeRaymarcher raymarcher;
+    auto volume = sampleCube("-(x^2 + y^2 + z^2)");
+    raymarcher.setScene(volume, topView(), whiteTransfer(0.75f), 64, 64);
+    Assert::IsFalse(raymarcher.hasImage());
+
+    // A zero budget still traces one batch of rows per call.
+    TaskPool pool(0);
+    int top = 0;
+    int bottom = 0;
+    Assert::IsTrue(raymarcher.refine(pool, 0.0, top, bottom));
+    Assert::AreEqual(0, top);
+    Assert::IsTrue(bottom > 0);
+    Assert::IsFalse(raymarcher.converged());
+
+    renderToCompletion(raymarcher);
+    Assert::IsTrue(raymarcher.converged());
+    Assert::IsFalse(raymarcher.refine(pool, 1000.0, top, bottom));
+
+    // The same scene is a no-op; a new camera keeps the image but starts refining again.
+    raymarcher.setScene(volume, topView(), whiteTransfer(0.75f), 64, 64);
+    Assert::IsTrue(raymarcher.converged());
+    VolumeRaymarcher::Camera rotated = topView();
+    rotated.azimuthDeg = 45.0f;
+    raymarcher.setScene(volume, rotated, whiteTransfer(0.75f), 64, 64);
+    Assert::IsFalse(raymarcher.converged());
+    Assert::IsTrue(raymarcher.hasImage());
+}
+
+} // namespace XpressFormulaTests
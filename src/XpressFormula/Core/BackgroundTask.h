@@ -0,0 +1,62 @@
+// BackgroundTask.h - One cancellable computation running on its own worker thread.
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace XpressFormula::Core {
+
+/// Runs a single computation producing a shared result on a dedicated thread, for the caches
+/// that rebuild one expensive value when their request changes. Starting a new run cancels and
+/// joins the previous one; the computation polls the cancel flag it is handed and returns null
+/// when it gives up. Only the owning (UI) thread calls the member functions.
+template <typename T>
+class BackgroundTask {
+public:
+    BackgroundTask() = default;
+    ~BackgroundTask() { cancel(); }
+    BackgroundTask(const BackgroundTask&) = delete;
+    BackgroundTask& operator=(const BackgroundTask&) = delete;
+
+    /// Cancel the run in flight, if any, and start `compute(const std::atomic<bool>* cancel)` on
+    /// a new thread. The callable must own its inputs: it can outlive the request that made it.
+    template <typename Compute>
+    void start(Compute compute) {
+        cancel();
+        m_cancel.store(false, std::memory_order_relaxed);
+        m_done.store(false, std::memory_order_relaxed);
+        m_worker = std::thread([this, compute = std::move(compute)]() {
+            m_result = compute(&m_cancel);
+            m_done.store(true, std::memory_order_release);
+        });
+    }
+
+    /// True once the started run has finished and its result has not been taken yet.
+    bool finished() const { return m_worker.joinable() && m_done.load(std::memory_order_acquire); }
+
+    /// Join the started run, waiting for it if it is still in progress, and hand over its
+    /// result (null when it was cancelled or failed).
+    std::shared_ptr<const T> take() {
+        m_worker.join();
+        return std::move(m_result);
+    }
+
+    /// Stop the run in flight, if any, and drop its result.
+    void cancel() {
+        if (m_worker.joinable()) {
+            m_cancel.store(true, std::memory_order_relaxed);
+            m_worker.join();
+        }
+        m_result.reset();
+    }
+
+private:
+    std::thread m_worker;
+    std::atomic<bool> m_cancel{ false };
+    std::atomic<bool> m_done{ false };
+    std::shared_ptr<const T> m_result;  // written by the worker before m_done is set
+};
+
+} // namespace XpressFormula::Core
@@ -0,0 +1,279 @@
+// EquationSolver.cpp - Isolates one variable of F = 0 when F is linear or quadratic in it.
+#include "EquationSolver.h"
+#include "Evaluator.h"
+#include <cmath>
+
+namespace XpressFormula::Core {
+
+namespace {
+
+// Coefficients c[0] + c[1]*v + c[2]*v^2 of a subtree. A null coefficient is zero.
+struct Polynomial {
+    ASTNodePtr c[3];
+    int degree = 0;
+};
+
+bool mentions(const ASTNodePtr& node, const std::string& variable) {
+    if (!node) {
+        return false;
+    }
+    switch (node->type()) {
+        case NodeType::Number:
+            return false;
+        case NodeType::Variable:
+            return static_cast<const VariableNode*>(node.get())->name == variable;
+        case NodeType::BinaryOp: {
+            const auto* bin = static_cast<const BinaryOpNode*>(node.get());
+            return mentions(bin->left, variable) || mentions(bin->right, variable);
+        }
+        case NodeType::UnaryOp:
+            return mentions(static_cast<const UnaryOpNode*>(node.get())->operand, variable);
+        case NodeType::FunctionCall:
+            for (const ASTNodePtr& arg : static_cast<const FunctionCallNode*>(node.get())->arguments) {
+                if (mentions(arg, variable)) {
+                    return true;
+                }
+            }
+            return false;
+    }
+    return false;
+}
+
+bool isNumber(const ASTNodePtr& node, double* value = nullptr) {
+    if (!node || node->type() != NodeType::Number) {
+        return false;
+    }
+    if (value) {
+        *value = static_cast<const NumberNode*>(node.get())->value;
+    }
+    return true;
+}
+
+// Node builders that fold numeric literals and drop zero terms, so solved branches stay as
+// small as the user's own formula.
+ASTNodePtr number(double value) {
+    return (value == 0.0) ? nullptr : std::make_shared<NumberNode>(value);
+}
+
+ASTNodePtr negate(const ASTNodePtr& a) {
+    double va = 0.0;
+    if (!a) return nullptr;
+    if (isNumber(a, &va)) return number(-va);
+    return std::make_shared<UnaryOpNode>(UnaryOperator::Negate, a);
+}
+
+ASTNodePtr add(const ASTNodePtr& a, const ASTNodePtr& b) {
+    double va = 0.0, vb = 0.0;
+    if (!a) return b;
+    if (!b) return a;
+    if (isNumber(a, &va) && isNumber(b, &vb)) return number(va + vb);
+    return std::make_shared<BinaryOpNode>(BinaryOperator::Add, a, b);
+}
+
+ASTNodePtr subtract(const ASTNodePtr& a, const ASTNodePtr& b) {
+    double va = 0.0, vb = 0.0;
+    if (!b) return a;
+    if (!a) return negate(b);
+    if (isNumber(a, &va) && isNumber(b, &vb)) return number(va - vb);
+    return std::make_shared<BinaryOpNode>(BinaryOperator::Subtract, a, b);
+}
+
+ASTNodePtr multiply(const ASTNodePtr& a, const ASTNodePtr& b) {
+    double va = 0.0, vb = 0.0;
+    if (!a || !b) return nullptr;
+    const bool numA = isNumber(a, &va);
+    const bool numB = isNumber(b, &vb);
+    if (numA && numB) return number(va * vb);
+    if (numA && va == 1.0) return b;
+    if (numB && vb == 1.0) return a;
+    if (numA && va == -1.0) return negate(b);
+    if (numB && vb == -1.0) return negate(a);
+    return std::make_shared<BinaryOpNode>(BinaryOperator::Multiply, a, b);
+}
+
+ASTNodePtr divide(const ASTNodePtr& a, const ASTNodePtr& b) {
+    double va = 0.0, vb = 0.0;
+    if (!a) return nullptr;
+    const bool numB = isNumber(b, &vb);
+    if (numB && vb == 1.0) return a;
+    if (numB && vb == -1.0) return negate(a);
+    if (numB && isNumber(a, &va)) return number(va / vb);
+    return std::make_shared<BinaryOpNode>(BinaryOperator::Divide, a, b);
+}
+
+ASTNodePtr squareRoot(const ASTNodePtr& a) {
+    return std::make_shared<FunctionCallNode>("sqrt", std::vector<ASTNodePtr>{ a ? a : number(0.0) });
+}
+
+int degreeOf(const Polynomial& p) {
+    return p.c[2] ? 2 : p.c[1] ? 1 : 0;
+}
+
+Polynomial constant(const ASTNodePtr& node) {
+    Polynomial p;
+    p.c[0] = node;
+    return p;
+}
+
+// Rewrites `node` as a polynomial of degree <= 2 in `variable`. Returns false when the
+// variable appears anywhere the rewrite cannot follow.
+bool collect(const ASTNodePtr& node, const std::string& variable, Polynomial& out) {
+    if (!node) {
+        return false;
+    }
+    if (!mentions(node, variable)) {
+        out = constant(node);
+        return true;
+    }
+
+    switch (node->type()) {
+        case NodeType::Variable:
+            out = Polynomial{};
+            out.c[1] = std::make_shared<NumberNode>(1.0);
+            out.degree = 1;
+            return true;
+
+        case NodeType::UnaryOp: {
+            const auto* un = static_cast<const UnaryOpNode*>(node.get());
+            if (!collect(un->operand, variable, out)) {
+                return false;
+            }
+            if (un->op == UnaryOperator::Negate) {
+                for (ASTNodePtr& c : out.c) {
+                    c = negate(c);
+                }
+            }
+            return true;
+        }
+
+        case NodeType::BinaryOp: {
+            const auto* bin = static_cast<const BinaryOpNode*>(node.get());
+            Polynomial l;
+            Polynomial r;
+            switch (bin->op) {
+                case BinaryOperator::Add:
+                case BinaryOperator::Subtract:
+                    if (!collect(bin->left, variable, l) || !collect(bin->right, variable, r)) {
+                        return false;
+                    }
+                    for (int i = 0; i < 3; ++i) {
+                        out.c[i] = (bin->op == BinaryOperator::Add) ? add(l.c[i], r.c[i])
+                                                                    : subtract(l.c[i], r.c[i]);
+                    }
+                    break;
+
+                case BinaryOperator::Multiply:
+                    if (!collect(bin->left, variable, l) || !collect(bin->right, variable, r) ||
+                        l.degree + r.degree > 2) {
+                        return false;
+                    }
+                    for (int i = 0; i < 3; ++i) {
+                        ASTNodePtr sum;
+                        for (int j = 0; j <= i; ++j) {
+                            sum = add(sum, multiply(l.c[j], r.c[i - j]));
+                        }
+                        out.c[i] = sum;
+                    }
+                    break;
+
+                case BinaryOperator::Divide:
+                    if (mentions(bin->right, variable) || !collect(bin->left, variable, l)) {
+                        return false;
+                    }
+                    for (int i = 0; i < 3; ++i) {
+                        out.c[i] = divide(l.c[i], bin->right);
+                    }
+                    break;
+
+                case BinaryOperator::Power: {
+                    double exponent = 0.0;
+                    if (!isNumber(bin->right, &exponent) || !collect(bin->left, variable, l)) {
+                        return false;
+                    }
+                    if (exponent == 0.0) {
+                        out = constant(std::make_shared<NumberNode>(1.0));
+                    } else if (exponent == 1.0) {
+                        out = l;
+                    } else if (exponent == 2.0 && l.degree <= 1) {
+                        out = Polynomial{};
+                        out.c[0] = multiply(l.c[0], l.c[0]);
+                        out.c[1] = add(multiply(l.c[0], l.c[1]), multiply(l.c[1], l.c[0]));
+                        out.c[2] = multiply(l.c[1], l.c[1]);
+                    } else {
+                        return false;
+                    }
+                    break;
+                }
+            }
+            out.degree = degreeOf(out);
+            return true;
+        }
+
+        case NodeType::Number:
+        case NodeType::FunctionCall:
+            break;
+    }
+    return false;
+}
+
+// Value of a coefficient that must not depend on any variable; NaN otherwise.
+double constantValue(const ASTNodePtr& node) {
+    return node ? Evaluator::evaluate(node, {}) : 0.0;
+}
+
+} // namespace
+
+EquationSolver::Solution EquationSolver::solve(const ASTNodePtr& expression, const std::string& variable) {
+    Solution solution;
+    Polynomial p;
+    if (!collect(expression, variable, p) || p.degree == 0) {
+        return solution;
+    }
+
+    const double a = constantValue(p.c[p.degree]);
+    if (!std::isfinite(a) || a == 0.0) {
+        return solution;
+    }
+
+    if (p.degree == 1) {
+        solution.branches.push_back(divide(negate(p.c[0]), p.c[1]));
+        solution.degree = 1;
+    } else {
+        // Without a linear term the vertex is at v = 0: v = +/-sqrt(-c/a).
+        const ASTNodePtr& b = p.c[1];
+        const ASTNodePtr discriminant = b
+            ? subtract(multiply(b, b), multiply(number(4.0 * a), p.c[0]))
+            : divide(negate(p.c[0]), number(a));
+        const ASTNodePtr vertex = divide(negate(b), number(2.0 * a));
+        const ASTNodePtr halfWidth = b ? divide(squareRoot(discriminant), number(2.0 * a))
+                                       : squareRoot(discriminant);
+
+        double d = 0.0;
+        if (!discriminant || isNumber(discriminant, &d)) {
+            // Constant discriminant: one double root, two parallel branches, or no real root.
+            if (d < 0.0) {
+                return solution;
+            }
+            solution.branches.push_back(d == 0.0 ? (vertex ? vertex : std::make_shared<NumberNode>(0.0))
+                                                 : add(vertex, halfWidth));
+            if (d > 0.0) {
+                solution.branches.push_back(subtract(vertex, halfWidth));
+            }
+        } else {
+            solution.branches.push_back(add(vertex, halfWidth));
+            solution.branches.push_back(subtract(vertex, halfWidth));
+            solution.discriminant = discriminant;
+        }
+        solution.degree = 2;
+    }
+
+    // A fully cancelled branch (v = 0) folds to null; keep it as a literal.
+    for (ASTNodePtr& branch : solution.branches) {
+        if (!branch) {
+            branch = std::make_shared<NumberNode>(0.0);
+        }
+    }
+    return solution;
+}
+
+} // namespace XpressFormula::Core
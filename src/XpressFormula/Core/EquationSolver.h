@@ -0,0 +1,41 @@
+// EquationSolver.h - Isolates one variable of F = 0 when F is linear or quadratic in it.
+#pragma once
+
+#include "ASTNode.h"
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Core {
+
+/// Symbolic solver for equations of the form F = 0.
+///
+/// F is rewritten as a*v^2 + b*v + c in the chosen variable v, where a, b and c are
+/// expressions that do not mention v. The rewrite follows +, -, *, / by v-free expressions,
+/// unary signs and non-negative integer powers; v inside a function call (sin(z), sqrt(z))
+/// or in an exponent is not solvable. The leading coefficient must be a non-zero constant so
+/// the solution has the same shape everywhere in the plane:
+///
+/// - linear:    v = -c / b
+/// - quadratic: v = (-b +/- sqrt(b^2 - 4ac)) / (2a), one branch per sign
+///
+/// For example `x^2 + y^2 + z^2 - 9` solved for z gives the two hemispheres
+/// +/-sqrt(-(x^2 + y^2 - 9)), and `y - x^2` solved for y gives x^2.
+class EquationSolver {
+public:
+    struct Solution {
+        /// Explicit v = g(...) branches; empty when the equation was not solved.
+        std::vector<ASTNodePtr> branches;
+        /// Quadratic only: the branches are real where this is >= 0 (null when they are real
+        /// everywhere). Renderers use it to close the rim where two branches meet.
+        ASTNodePtr discriminant;
+        /// Degree of F in the solved variable (1 or 2), 0 when not solved.
+        int degree = 0;
+
+        bool solved() const { return !branches.empty(); }
+    };
+
+    /// Solve `expression` = 0 for `variable`.
+    static Solution solve(const ASTNodePtr& expression, const std::string& variable);
+};
+
+} // namespace XpressFormula::Core
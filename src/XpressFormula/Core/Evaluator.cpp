@@ -27,27 +27,12 @@ double Evaluator::evaluate(const ASTNodePtr& node, const Variables& vars) {
             auto* bin = static_cast<BinaryOpNode*>(node.get());
             double l = evaluate(bin->left,  vars);
             double r = evaluate(bin->right, vars);
-            switch (bin->op) {
-                case BinaryOperator::Add:      return l + r;
-                case BinaryOperator::Subtract: return l - r;
-                case BinaryOperator::Multiply: return l * r;
-                case BinaryOperator::Divide:
-                    // Keep undefined operations explicit for renderer-side filtering.
-                    return (r == 0.0) ? NaN : l / r;
-                case BinaryOperator::Power:
-                    return std::pow(l, r);
-            }
-            return NaN;
+            return applyBinary(bin->op, l, r);
         }
 
         case NodeType::UnaryOp: {
             auto* un = static_cast<UnaryOpNode*>(node.get());
-            double val = evaluate(un->operand, vars);
-            switch (un->op) {
-                case UnaryOperator::Negate: return -val;
-                case UnaryOperator::Plus:   return val;
-            }
-            return NaN;
+            return applyUnary(un->op, evaluate(un->operand, vars));
         }
 
         case NodeType::FunctionCall: {
@@ -62,6 +47,28 @@ double Evaluator::evaluate(const ASTNodePtr& node, const Variables& vars) {
     return NaN;
 }
 
+double Evaluator::applyBinary(BinaryOperator op, double l, double r) {
+    switch (op) {
+        case BinaryOperator::Add:      return l + r;
+        case BinaryOperator::Subtract: return l - r;
+        case BinaryOperator::Multiply: return l * r;
+        case BinaryOperator::Divide:
+            // Keep undefined operations explicit for renderer-side filtering.
+            return (r == 0.0) ? NaN : l / r;
+        case BinaryOperator::Power:
+            return std::pow(l, r);
+    }
+    return NaN;
+}
+
+double Evaluator::applyUnary(UnaryOperator op, double value) {
+    switch (op) {
+        case UnaryOperator::Negate: return -value;
+        case UnaryOperator::Plus:   return value;
+    }
+    return NaN;
+}
+
 double Evaluator::evaluateFunction(const std::string& name,
                                    const std::vector<double>& args) {
     if (args.empty()) return NaN;
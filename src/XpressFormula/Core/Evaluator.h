@@ -14,7 +14,10 @@ public:
     /// Evaluate the AST with the given variable values. Returns NaN on error.
     static double evaluate(const ASTNodePtr& node, const Variables& vars);
 
-private:
+    /// Apply a single operator or built-in function to already evaluated operands, with the
+    /// same rules as evaluate() (used by evaluators that hoist parts of the tree).
+    static double applyBinary(BinaryOperator op, double l, double r);
+    static double applyUnary(UnaryOperator op, double value);
     static double evaluateFunction(const std::string& name,
                                    const std::vector<double>& args);
 };
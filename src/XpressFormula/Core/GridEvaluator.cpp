@@ -0,0 +1,262 @@
+// GridEvaluator.cpp - Evaluates an AST over an x/y grid, hoisting separable subtrees.
+#include "GridEvaluator.h"
+#include <algorithm>
+
+namespace XpressFormula::Core {
+
+namespace {
+
+constexpr unsigned kDependsOnX = 1u;
+constexpr unsigned kDependsOnY = 2u;
+constexpr unsigned kDependsOnXY = kDependsOnX | kDependsOnY;
+
+// Which grid axes a subtree reads.
+unsigned dependencies(const ASTNodePtr& node) {
+    if (!node) {
+        return 0u;
+    }
+    switch (node->type()) {
+        case NodeType::Number:
+            return 0u;
+        case NodeType::Variable: {
+            const std::string& name = static_cast<const VariableNode*>(node.get())->name;
+            return (name == "x") ? kDependsOnX : (name == "y") ? kDependsOnY : 0u;
+        }
+        case NodeType::BinaryOp: {
+            const auto* bin = static_cast<const BinaryOpNode*>(node.get());
+            return dependencies(bin->left) | dependencies(bin->right);
+        }
+        case NodeType::UnaryOp:
+            return dependencies(static_cast<const UnaryOpNode*>(node.get())->operand);
+        case NodeType::FunctionCall: {
+            unsigned mask = 0u;
+            for (const ASTNodePtr& arg : static_cast<const FunctionCallNode*>(node.get())->arguments) {
+                mask |= dependencies(arg);
+            }
+            return mask;
+        }
+    }
+    return 0u;
+}
+
+} // namespace
+
+GridEvaluator::GridEvaluator(const ASTNodePtr& ast, const Evaluator::Variables& fixed)
+    : m_ast(ast), m_vars(fixed) {
+    m_vars.erase("x");
+    m_vars.erase("y");
+
+    int height = 0;
+    compile(ast, height);
+    m_parityX = Symmetry::parity(ast, "x");
+    m_parityY = Symmetry::parity(ast, "y");
+
+    switch (dependencies(ast)) {
+        case 0u:          m_form = Form::Constant; break;
+        case kDependsOnX: m_form = Form::OnlyX; break;
+        case kDependsOnY: m_form = Form::OnlyY; break;
+        default: {
+            m_form = Form::General;
+            if (ast->type() == NodeType::BinaryOp) {
+                const auto* bin = static_cast<const BinaryOpNode*>(ast.get());
+                if (dependencies(bin->left) != kDependsOnXY && dependencies(bin->right) != kDependsOnXY) {
+                    const bool additive = bin->op == BinaryOperator::Add || bin->op == BinaryOperator::Subtract;
+                    const bool multiplicative = bin->op == BinaryOperator::Multiply || bin->op == BinaryOperator::Divide;
+                    m_form = additive ? Form::Sum : multiplicative ? Form::Product : Form::General;
+                }
+            }
+            break;
+        }
+    }
+}
+
+void GridEvaluator::compile(const ASTNodePtr& node, int& height) {
+    Instruction instruction;
+    switch (dependencies(node)) {
+        case 0u:
+            instruction.op = Instruction::Op::Constant;
+            instruction.value = Evaluator::evaluate(node, m_vars);
+            break;
+        case kDependsOnX:
+            instruction.op = Instruction::Op::Column;
+            instruction.index = static_cast<int>(m_columnTerms.size());
+            m_columnTerms.push_back(node);
+            break;
+        case kDependsOnY:
+            instruction.op = Instruction::Op::Row;
+            instruction.index = static_cast<int>(m_rowTerms.size());
+            m_rowTerms.push_back(node);
+            break;
+        default:
+            // Mixed subtree: emit its operands, then the operator joining them.
+            switch (node->type()) {
+                case NodeType::BinaryOp: {
+                    const auto* bin = static_cast<const BinaryOpNode*>(node.get());
+                    compile(bin->left, height);
+                    compile(bin->right, height);
+                    instruction.op = Instruction::Op::Binary;
+                    instruction.code = static_cast<std::uint8_t>(bin->op);
+                    m_program.push_back(instruction);
+                    --height;
+                    return;
+                }
+                case NodeType::UnaryOp: {
+                    const auto* un = static_cast<const UnaryOpNode*>(node.get());
+                    compile(un->operand, height);
+                    instruction.op = Instruction::Op::Unary;
+                    instruction.code = static_cast<std::uint8_t>(un->op);
+                    m_program.push_back(instruction);
+                    return;
+                }
+                case NodeType::FunctionCall: {
+                    const auto* fn = static_cast<const FunctionCallNode*>(node.get());
+                    for (const ASTNodePtr& arg : fn->arguments) {
+                        compile(arg, height);
+                    }
+                    instruction.op = Instruction::Op::Call;
+                    instruction.index = static_cast<int>(fn->arguments.size());
+                    instruction.function = &fn->name;
+                    m_program.push_back(instruction);
+                    height -= instruction.index - 1;
+                    return;
+                }
+                default:
+                    return;  // leaves never depend on both axes
+            }
+    }
+    m_program.push_back(instruction);
+    ++height;
+    m_stackSize = std::max(m_stackSize, height);
+}
+
+void GridEvaluator::evaluate(const double* xs, int nx, const double* ys, int ny, double* out,
+                             std::pmr::memory_resource* scratch) const {
+    if (nx <= 0 || ny <= 0) {
+        return;
+    }
+
+    // Samples whose mirror partner is evaluated instead (identity on asymmetric axes).
+    std::pmr::vector<int> xSource(static_cast<size_t>(nx), scratch);
+    std::pmr::vector<int> ySource(static_cast<size_t>(ny), scratch);
+    const int cx = (m_parityX != Parity::None) ? Symmetry::mirrorSamples(xs, nx, xSource.data()) : nx;
+    const int cy = (m_parityY != Parity::None) ? Symmetry::mirrorSamples(ys, ny, ySource.data()) : ny;
+    if (cx == nx && cy == ny) {
+        evaluateAll(xs, nx, ys, ny, out, scratch);
+        return;
+    }
+    if (cx == nx) {
+        for (int ix = 0; ix < nx; ++ix) xSource[ix] = ix;
+    }
+    if (cy == ny) {
+        for (int iy = 0; iy < ny; ++iy) ySource[iy] = iy;
+    }
+
+    // Evaluate the fundamental region, then fill every sample from its source.
+    std::pmr::vector<double> reducedXs(scratch);
+    std::pmr::vector<double> reducedYs(scratch);
+    std::pmr::vector<int> xSlot(static_cast<size_t>(nx), scratch);
+    std::pmr::vector<int> ySlot(static_cast<size_t>(ny), scratch);
+    reducedXs.reserve(static_cast<size_t>(cx));
+    reducedYs.reserve(static_cast<size_t>(cy));
+    for (int ix = 0; ix < nx; ++ix) {
+        if (xSource[ix] == ix) {
+            xSlot[ix] = static_cast<int>(reducedXs.size());
+            reducedXs.push_back(xs[ix]);
+        }
+    }
+    for (int iy = 0; iy < ny; ++iy) {
+        if (ySource[iy] == iy) {
+            ySlot[iy] = static_cast<int>(reducedYs.size());
+            reducedYs.push_back(ys[iy]);
+        }
+    }
+    std::pmr::vector<double> reduced(static_cast<size_t>(cx) * cy, scratch);
+    evaluateAll(reducedXs.data(), cx, reducedYs.data(), cy, reduced.data(), scratch);
+
+    for (int iy = 0; iy < ny; ++iy) {
+        const double* row = reduced.data() + static_cast<size_t>(ySlot[ySource[iy]]) * cx;
+        const bool flipY = (m_parityY == Parity::Odd) && ySource[iy] != iy;
+        double* dst = out + static_cast<size_t>(iy) * nx;
+        for (int ix = 0; ix < nx; ++ix) {
+            const double value = row[xSlot[xSource[ix]]];
+            const bool flipX = (m_parityX == Parity::Odd) && xSource[ix] != ix;
+            dst[ix] = (flipX != flipY) ? -value : value;
+        }
+    }
+}
+
+void GridEvaluator::evaluateAll(const double* xs, int nx, const double* ys, int ny, double* out,
+                                std::pmr::memory_resource* scratch) const {
+
+    // Hoisted terms: one evaluation per column / row.
+    std::pmr::vector<double> columns(m_columnTerms.size() * static_cast<size_t>(nx), scratch);
+    std::pmr::vector<double> rows(m_rowTerms.size() * static_cast<size_t>(ny), scratch);
+    Evaluator::Variables vars = m_vars;
+    for (size_t t = 0; t < m_columnTerms.size(); ++t) {
+        for (int ix = 0; ix < nx; ++ix) {
+            vars["x"] = xs[ix];
+            columns[t * nx + ix] = Evaluator::evaluate(m_columnTerms[t], vars);
+        }
+    }
+    vars.erase("x");
+    for (size_t t = 0; t < m_rowTerms.size(); ++t) {
+        for (int iy = 0; iy < ny; ++iy) {
+            vars["y"] = ys[iy];
+            rows[t * ny + iy] = Evaluator::evaluate(m_rowTerms[t], vars);
+        }
+    }
+
+    // The whole formula is a single term: copy it out.
+    if (m_program.size() == 1) {
+        const Instruction& only = m_program.front();
+        for (int iy = 0; iy < ny; ++iy) {
+            double* dst = out + static_cast<size_t>(iy) * nx;
+            for (int ix = 0; ix < nx; ++ix) {
+                dst[ix] = (only.op == Instruction::Op::Column) ? columns[ix]
+                        : (only.op == Instruction::Op::Row)    ? rows[iy]
+                                                               : only.value;
+            }
+        }
+        return;
+    }
+
+    std::pmr::vector<double> stack(static_cast<size_t>(m_stackSize), scratch);
+    std::vector<double> args;
+    for (int iy = 0; iy < ny; ++iy) {
+        double* dst = out + static_cast<size_t>(iy) * nx;
+        for (int ix = 0; ix < nx; ++ix) {
+            size_t top = 0;
+            for (const Instruction& instruction : m_program) {
+                switch (instruction.op) {
+                    case Instruction::Op::Constant:
+                        stack[top++] = instruction.value;
+                        break;
+                    case Instruction::Op::Column:
+                        stack[top++] = columns[static_cast<size_t>(instruction.index) * nx + ix];
+                        break;
+                    case Instruction::Op::Row:
+                        stack[top++] = rows[static_cast<size_t>(instruction.index) * ny + iy];
+                        break;
+                    case Instruction::Op::Unary:
+                        stack[top - 1] = Evaluator::applyUnary(
+                            static_cast<UnaryOperator>(instruction.code), stack[top - 1]);
+                        break;
+                    case Instruction::Op::Binary:
+                        --top;
+                        stack[top - 1] = Evaluator::applyBinary(
+                            static_cast<BinaryOperator>(instruction.code), stack[top - 1], stack[top]);
+                        break;
+                    case Instruction::Op::Call:
+                        top -= static_cast<size_t>(instruction.index);
+                        args.assign(stack.begin() + static_cast<std::ptrdiff_t>(top),
+                                    stack.begin() + static_cast<std::ptrdiff_t>(top + instruction.index));
+                        stack[top++] = Evaluator::evaluateFunction(*instruction.function, args);
+                        break;
+                }
+            }
+            dst[ix] = stack[0];
+        }
+    }
+}
+
+} // namespace XpressFormula::Core
@@ -0,0 +1,86 @@
+// GridEvaluator.h - Evaluates an AST over an x/y grid, hoisting separable subtrees.
+#pragma once
+
+#include "ASTNode.h"
+#include "Evaluator.h"
+#include "Symmetry.h"
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Core {
+
+/// Evaluates a formula at every point of a rectilinear grid xs[0..nx) x ys[0..ny).
+///
+/// The tree is analysed once: a subtree that depends on x only (such as `sin(x)` in
+/// `sin(x) + cos(y)`, or `x^2` in `x^2 * exp(-y)`) is evaluated once per column, a subtree that
+/// depends on y only once per row, and a subtree that depends on neither once in total. Only
+/// the operators joining them are applied per point. Transcendental work for additively or
+/// multiplicatively separable formulas therefore drops from O(nx*ny) to O(nx+ny), and separable
+/// parts of larger expressions benefit the same way.
+///
+/// The formula's parity in x and y is proven up front as well (see Symmetry). On an axis whose
+/// samples mirror each other about zero, only the non-negative half is evaluated and the other
+/// half is copied (negated for odd formulas), so a view centred on the origin costs a quarter
+/// of the work for formulas such as cos(x)*cos(y).
+///
+/// The per-point operators are applied exactly as Evaluator does, so every output is identical
+/// to Evaluator::evaluate() at that point, except that mirrored samples carry the value of
+/// their partner (which may sit a rounding error away from the exact mirror position).
+class GridEvaluator {
+public:
+    /// How the whole formula splits over the grid axes (diagnostics and tests).
+    enum class Form {
+        Constant,  // depends on neither x nor y
+        OnlyX,
+        OnlyY,
+        Sum,       // g(x) +/- h(y)
+        Product,   // g(x) * h(y) or g(x) / h(y)
+        General    // x and y meet inside at least one non-separable subtree
+    };
+
+    /// Analyse `ast` for grids over x and y. Other variables (such as z) take their values from
+    /// `fixed`; bindings for x or y in `fixed` are ignored.
+    explicit GridEvaluator(const ASTNodePtr& ast, const Evaluator::Variables& fixed = {});
+
+    Form form() const { return m_form; }
+    Parity parityX() const { return m_parityX; }
+    Parity parityY() const { return m_parityY; }
+
+    /// Subtrees evaluated once per column (x) and once per row (y).
+    int columnTerms() const { return static_cast<int>(m_columnTerms.size()); }
+    int rowTerms() const { return static_cast<int>(m_rowTerms.size()); }
+
+    /// Write f(xs[ix], ys[iy]) to out[iy * nx + ix]. Temporaries come from `scratch`.
+    void evaluate(const double* xs, int nx, const double* ys, int ny, double* out,
+                  std::pmr::memory_resource* scratch = std::pmr::get_default_resource()) const;
+
+private:
+    // Per-point program over the non-separable part of the tree, in postfix order.
+    struct Instruction {
+        enum class Op : std::uint8_t { Constant, Column, Row, Unary, Binary, Call };
+        Op op = Op::Constant;
+        std::uint8_t code = 0;  // UnaryOperator / BinaryOperator
+        int index = 0;          // column/row term, or argument count of a call
+        double value = 0.0;
+        const std::string* function = nullptr;
+    };
+
+    void compile(const ASTNodePtr& node, int& height);
+    // evaluate() without mirroring.
+    void evaluateAll(const double* xs, int nx, const double* ys, int ny, double* out,
+                     std::pmr::memory_resource* scratch) const;
+
+    ASTNodePtr m_ast;  // keeps the nodes the program points into alive
+    Evaluator::Variables m_vars;
+    std::vector<ASTNodePtr> m_columnTerms;
+    std::vector<ASTNodePtr> m_rowTerms;
+    std::vector<Instruction> m_program;
+    int m_stackSize = 0;
+    Form m_form = Form::Constant;
+    Parity m_parityX = Parity::None;
+    Parity m_parityY = Parity::None;
+};
+
+} // namespace XpressFormula::Core
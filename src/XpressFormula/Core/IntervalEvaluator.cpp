@@ -0,0 +1,429 @@
+// IntervalEvaluator.cpp - Bounds a formula over an x/y/z box with interval arithmetic.
+#include "IntervalEvaluator.h"
+#include "MathConstants.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace XpressFormula::Core {
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// inf - inf and similar cancel to NaN; the bound is then unknown.
+Interval unbounded(Interval r) {
+    if (std::isnan(r.lo)) r.lo = -kInf;
+    if (std::isnan(r.hi)) r.hi = kInf;
+    return r;
+}
+
+// 0 * inf is the limit of 0 * (large finite value).
+double product(double a, double b) {
+    const double p = a * b;
+    return std::isnan(p) ? 0.0 : p;
+}
+
+Interval multiply(const Interval& l, const Interval& r) {
+    const double p[4] = { product(l.lo, r.lo), product(l.lo, r.hi),
+                          product(l.hi, r.lo), product(l.hi, r.hi) };
+    return { *std::min_element(p, p + 4), *std::max_element(p, p + 4) };
+}
+
+Interval divide(const Interval& l, const Interval& r) {
+    if (r.lo == 0.0 && r.hi == 0.0) {
+        return Interval::empty();  // x / 0 is NaN
+    }
+    if (r.lo > 0.0 || r.hi < 0.0) {
+        return multiply(l, { 1.0 / r.hi, 1.0 / r.lo });
+    }
+    if (r.lo == 0.0) {
+        return multiply(l, { 1.0 / r.hi, kInf });
+    }
+    if (r.hi == 0.0) {
+        return multiply(l, { -kInf, 1.0 / r.lo });
+    }
+    return Interval::whole();
+}
+
+bool isInteger(double v) {
+    return std::isfinite(v) && v == std::floor(v);
+}
+
+// v^n for a positive integer n by repeated squaring; std::pow for large exponents. Bounds
+// only need to be right to a rounding error, and this is much cheaper than pow.
+double integerPower(double v, double n) {
+    if (n > 64.0) {
+        return std::pow(v, n);
+    }
+    double result = 1.0;
+    for (auto e = static_cast<unsigned int>(n); e != 0u; e >>= 1u) {
+        if (e & 1u) result *= v;
+        v *= v;
+    }
+    return result;
+}
+
+Interval power(const Interval& base, const Interval& exponent) {
+    if (exponent.lo == exponent.hi && isInteger(exponent.lo)) {
+        const double n = exponent.lo;
+        if (n == 0.0) {
+            return Interval::point(1.0);
+        }
+        if (n < 0.0) {
+            return divide(Interval::point(1.0), power(base, Interval::point(-n)));
+        }
+        const double pLo = integerPower(base.lo, n);
+        const double pHi = integerPower(base.hi, n);
+        const bool odd = (n <= 64.0) ? (static_cast<unsigned int>(n) & 1u) != 0u
+                                     : std::fmod(n, 2.0) != 0.0;
+        if (odd || base.lo >= 0.0) {
+            return { pLo, pHi };
+        }
+        if (base.hi <= 0.0) {
+            return { pHi, pLo };
+        }
+        return { 0.0, std::max(pLo, pHi) };
+    }
+
+    // Real exponents: negative bases only give values for integer exponents; don't bound them.
+    if (base.lo < 0.0) {
+        return Interval::whole();
+    }
+    // pow is monotone in each argument for a positive base, so the extremes are at corners.
+    const double p[4] = { std::pow(base.lo, exponent.lo), std::pow(base.lo, exponent.hi),
+                          std::pow(base.hi, exponent.lo), std::pow(base.hi, exponent.hi) };
+    for (const double v : p) {
+        if (std::isnan(v)) {
+            return Interval::whole();
+        }
+    }
+    return { *std::min_element(p, p + 4), *std::max_element(p, p + 4) };
+}
+
+Interval increasing(const Interval& a, double (*f)(double)) {
+    return unbounded({ f(a.lo), f(a.hi) });
+}
+
+Interval absolute(const Interval& a) {
+    if (a.lo >= 0.0) return a;
+    if (a.hi <= 0.0) return { -a.hi, -a.lo };
+    return { 0.0, std::max(-a.lo, a.hi) };
+}
+
+Interval cosine(const Interval& a) {
+    const double period = 2.0 * PI;
+    if (!std::isfinite(a.lo) || !std::isfinite(a.hi) || a.hi - a.lo >= period) {
+        return { -1.0, 1.0 };
+    }
+    double lo = std::min(std::cos(a.lo), std::cos(a.hi));
+    double hi = std::max(std::cos(a.lo), std::cos(a.hi));
+    if (std::ceil(a.lo / period) * period <= a.hi) {
+        hi = 1.0;   // contains a maximum at 2k*pi
+    }
+    if (std::ceil((a.lo - PI) / period) * period + PI <= a.hi) {
+        lo = -1.0;  // contains a minimum at (2k+1)*pi
+    }
+    return { lo, hi };
+}
+
+Interval tangent(const Interval& a) {
+    if (!std::isfinite(a.lo) || !std::isfinite(a.hi) || a.hi - a.lo >= PI ||
+        std::ceil((a.lo - 0.5 * PI) / PI) * PI + 0.5 * PI <= a.hi) {
+        return Interval::whole();  // spans an asymptote
+    }
+    return { std::tan(a.lo), std::tan(a.hi) };
+}
+
+// Restricts `a` to a function's domain [lo, hi]; empty when they do not overlap.
+Interval clampDomain(const Interval& a, double lo, double hi) {
+    const Interval r = { std::max(a.lo, lo), std::min(a.hi, hi) };
+    return r.isEmpty() ? Interval::empty() : r;
+}
+
+Interval logarithm(const Interval& a, double (*f)(double)) {
+    if (!(a.hi > 0.0)) {
+        return Interval::empty();
+    }
+    return { (a.lo > 0.0) ? f(a.lo) : -kInf, f(a.hi) };
+}
+
+double roundValue(double v) { return std::round(v); }
+double signValue(double v) { return (v > 0.0) ? 1.0 : (v < 0.0) ? -1.0 : 0.0; }
+
+Interval unaryFunction(const std::string& name, const Interval& a) {
+    if (a.isEmpty()) {
+        return Interval::empty();
+    }
+    if (name == "sin")   return cosine({ a.lo - 0.5 * PI, a.hi - 0.5 * PI });
+    if (name == "cos")   return cosine(a);
+    if (name == "tan")   return tangent(a);
+    if (name == "asin") {
+        const Interval d = clampDomain(a, -1.0, 1.0);
+        return d.isEmpty() ? d : Interval{ std::asin(d.lo), std::asin(d.hi) };
+    }
+    if (name == "acos") {
+        const Interval d = clampDomain(a, -1.0, 1.0);
+        return d.isEmpty() ? d : Interval{ std::acos(d.hi), std::acos(d.lo) };
+    }
+    if (name == "atan")  return increasing(a, [](double v) { return std::atan(v); });
+    if (name == "sinh")  return increasing(a, [](double v) { return std::sinh(v); });
+    if (name == "cosh")  return increasing(absolute(a), [](double v) { return std::cosh(v); });
+    if (name == "tanh")  return increasing(a, [](double v) { return std::tanh(v); });
+    if (name == "sqrt") {
+        const Interval d = clampDomain(a, 0.0, kInf);
+        return d.isEmpty() ? d : Interval{ std::sqrt(d.lo), std::sqrt(d.hi) };
+    }
+    if (name == "cbrt")  return increasing(a, [](double v) { return std::cbrt(v); });
+    if (name == "abs")   return absolute(a);
+    if (name == "ceil")  return increasing(a, [](double v) { return std::ceil(v); });
+    if (name == "floor") return increasing(a, [](double v) { return std::floor(v); });
+    if (name == "round") return increasing(a, roundValue);
+    if (name == "log")   return logarithm(a, [](double v) { return std::log(v); });
+    if (name == "log2")  return logarithm(a, [](double v) { return std::log2(v); });
+    if (name == "log10") return logarithm(a, [](double v) { return std::log10(v); });
+    if (name == "exp")   return increasing(a, [](double v) { return std::exp(v); });
+    if (name == "sign")  return increasing(a, signValue);
+    return Interval::empty();  // unknown functions evaluate to NaN
+}
+
+bool isBinaryFunction(const std::string& name) {
+    return name == "atan2" || name == "pow" || name == "min" ||
+           name == "max" || name == "mod" || name == "log";
+}
+
+Interval binaryFunction(const std::string& name, const Interval& a, const Interval& b,
+                        bool bMayBeUndefined) {
+    // min/max return their first argument when the second is NaN, like std::min/std::max. So
+    // where b may be undefined in part of the box, the result can reach anywhere in a, and
+    // min(10, sqrt(x)) over x in [-4, 4] is [0, 10], not [0, 2].
+    if (name == "min" || name == "max") {
+        if (a.isEmpty() || b.isEmpty()) return a.isEmpty() ? Interval::empty() : a;
+        if (name == "min") {
+            return { std::min(a.lo, b.lo), bMayBeUndefined ? a.hi : std::min(a.hi, b.hi) };
+        }
+        return { bMayBeUndefined ? a.lo : std::max(a.lo, b.lo), std::max(a.hi, b.hi) };
+    }
+    if (name == "pow" && b.lo == 0.0 && b.hi == 0.0) {
+        return Interval::point(1.0);  // pow(NaN, 0) = 1
+    }
+    if (a.isEmpty() || b.isEmpty()) {
+        return Interval::empty();
+    }
+    if (name == "pow") {
+        return power(a, b);
+    }
+    if (name == "atan2") {
+        return { -PI, PI };
+    }
+    if (name == "mod") {
+        if (b.lo == 0.0 && b.hi == 0.0) return Interval::empty();
+        // fmod keeps the sign of a and is smaller than |b| in magnitude.
+        const double m = std::max(std::abs(b.lo), std::abs(b.hi));
+        if (a.lo >= 0.0) return { 0.0, std::min(a.hi, m) };
+        if (a.hi <= 0.0) return { std::max(a.lo, -m), 0.0 };
+        return { -m, m };
+    }
+    return Interval::whole();  // log(base, value)
+}
+
+} // namespace
+
+IntervalEvaluator::IntervalEvaluator(const ASTNodePtr& ast, const Evaluator::Variables& fixed)
+    : m_ast(ast), m_fixed(fixed) {
+    int height = 0;
+    compile(ast, height);
+}
+
+void IntervalEvaluator::compile(const ASTNodePtr& node, int& height) {
+    Instruction instruction;
+    if (!node) {
+        instruction.value = std::numeric_limits<double>::quiet_NaN();
+    } else {
+        switch (node->type()) {
+            case NodeType::Number:
+                instruction.value = static_cast<const NumberNode*>(node.get())->value;
+                break;
+            case NodeType::Variable: {
+                const std::string& name = static_cast<const VariableNode*>(node.get())->name;
+                if (name == "x") {
+                    instruction.op = Instruction::Op::X;
+                } else if (name == "y") {
+                    instruction.op = Instruction::Op::Y;
+                } else if (name == "z") {
+                    instruction.op = Instruction::Op::Z;
+                } else {
+                    const auto it = m_fixed.find(name);
+                    instruction.value = (it != m_fixed.end()) ? it->second
+                                                              : std::numeric_limits<double>::quiet_NaN();
+                }
+                break;
+            }
+            case NodeType::BinaryOp: {
+                const auto* bin = static_cast<const BinaryOpNode*>(node.get());
+                compile(bin->left, height);
+                compile(bin->right, height);
+                instruction.op = Instruction::Op::Binary;
+                instruction.code = static_cast<std::uint8_t>(bin->op);
+                m_program.push_back(instruction);
+                --height;
+                return;
+            }
+            case NodeType::UnaryOp: {
+                const auto* un = static_cast<const UnaryOpNode*>(node.get());
+                compile(un->operand, height);
+                instruction.op = Instruction::Op::Unary;
+                instruction.code = static_cast<std::uint8_t>(un->op);
+                m_program.push_back(instruction);
+                return;
+            }
+            case NodeType::FunctionCall: {
+                const auto* fn = static_cast<const FunctionCallNode*>(node.get());
+                for (const ASTNodePtr& arg : fn->arguments) {
+                    compile(arg, height);
+                }
+                instruction.op = Instruction::Op::Call;
+                instruction.count = static_cast<int>(fn->arguments.size());
+                instruction.code = (fn->arguments.size() >= 2 && !alwaysDefined(fn->arguments[1])) ? 1 : 0;
+                instruction.function = &fn->name;
+                m_program.push_back(instruction);
+                height -= instruction.count - 1;
+                return;
+            }
+        }
+    }
+    m_program.push_back(instruction);
+    ++height;
+    m_stackSize = std::max(m_stackSize, height);
+}
+
+bool IntervalEvaluator::alwaysDefined(const ASTNodePtr& node) const {
+    if (!node) {
+        return false;
+    }
+    switch (node->type()) {
+        case NodeType::Number:
+            return !std::isnan(static_cast<const NumberNode*>(node.get())->value);
+        case NodeType::Variable: {
+            const std::string& name = static_cast<const VariableNode*>(node.get())->name;
+            if (name == "x" || name == "y" || name == "z") return true;
+            const auto it = m_fixed.find(name);
+            return it != m_fixed.end() && !std::isnan(it->second);
+        }
+        case NodeType::UnaryOp:
+            return alwaysDefined(static_cast<const UnaryOpNode*>(node.get())->operand);
+        case NodeType::BinaryOp: {
+            // Division and powers are undefined at 0/0 and for negative bases.
+            const auto* bin = static_cast<const BinaryOpNode*>(node.get());
+            return (bin->op == BinaryOperator::Add || bin->op == BinaryOperator::Subtract ||
+                    bin->op == BinaryOperator::Multiply) &&
+                   alwaysDefined(bin->left) && alwaysDefined(bin->right);
+        }
+        case NodeType::FunctionCall: {
+            // Functions that are finite for every finite argument.
+            static const char* const kTotal[] = { "sin", "cos", "atan", "tanh", "cbrt", "abs", "ceil",
+                                                  "floor", "round", "sign", "min", "max", "atan2" };
+            const auto* fn = static_cast<const FunctionCallNode*>(node.get());
+            if (fn->arguments.empty() ||
+                std::find(std::begin(kTotal), std::end(kTotal), fn->name) == std::end(kTotal)) {
+                return false;
+            }
+            return std::all_of(fn->arguments.begin(), fn->arguments.end(),
+                               [this](const ASTNodePtr& arg) { return alwaysDefined(arg); });
+        }
+    }
+    return false;
+}
+
+double IntervalEvaluator::evaluate(double x, double y, double z, Scratch& scratch) const {
+    std::vector<double>& stack = scratch.values;
+    stack.resize(std::max(stack.size(), static_cast<size_t>(m_stackSize) + 1));
+    size_t top = 0;
+    for (const Instruction& instruction : m_program) {
+        switch (instruction.op) {
+            case Instruction::Op::Constant: stack[top++] = instruction.value; break;
+            case Instruction::Op::X:        stack[top++] = x; break;
+            case Instruction::Op::Y:        stack[top++] = y; break;
+            case Instruction::Op::Z:        stack[top++] = z; break;
+            case Instruction::Op::Unary:
+                stack[top - 1] = Evaluator::applyUnary(static_cast<UnaryOperator>(instruction.code),
+                                                       stack[top - 1]);
+                break;
+            case Instruction::Op::Binary:
+                --top;
+                stack[top - 1] = Evaluator::applyBinary(static_cast<BinaryOperator>(instruction.code),
+                                                        stack[top - 1], stack[top]);
+                break;
+            case Instruction::Op::Call:
+                top -= static_cast<size_t>(instruction.count);
+                scratch.args.assign(stack.begin() + static_cast<std::ptrdiff_t>(top),
+                                    stack.begin() + static_cast<std::ptrdiff_t>(top + instruction.count));
+                stack[top++] = Evaluator::evaluateFunction(*instruction.function, scratch.args);
+                break;
+        }
+    }
+    return (top == 1) ? stack[0] : std::numeric_limits<double>::quiet_NaN();
+}
+
+Interval IntervalEvaluator::evaluate(const Interval& x, const Interval& y, const Interval& z,
+                                     Scratch& scratch) const {
+    std::vector<Interval>& stack = scratch.intervals;
+    stack.resize(std::max(stack.size(), static_cast<size_t>(m_stackSize) + 1));
+    size_t top = 0;
+    for (const Instruction& instruction : m_program) {
+        switch (instruction.op) {
+            case Instruction::Op::Constant: stack[top++] = Interval::point(instruction.value); break;
+            case Instruction::Op::X:        stack[top++] = x; break;
+            case Instruction::Op::Y:        stack[top++] = y; break;
+            case Instruction::Op::Z:        stack[top++] = z; break;
+            case Instruction::Op::Unary:
+                if (static_cast<UnaryOperator>(instruction.code) == UnaryOperator::Negate) {
+                    stack[top - 1] = { -stack[top - 1].hi, -stack[top - 1].lo };
+                }
+                break;
+            case Instruction::Op::Binary:
+                --top;
+                stack[top - 1] = applyBinary(static_cast<BinaryOperator>(instruction.code),
+                                             stack[top - 1], stack[top]);
+                break;
+            case Instruction::Op::Call:
+                top -= static_cast<size_t>(instruction.count);
+                stack[top] = evaluateFunction(*instruction.function, &stack[top], instruction.count,
+                                              instruction.code != 0);
+                ++top;
+                break;
+        }
+    }
+    return (top == 1) ? stack[0] : Interval::empty();
+}
+
+Interval IntervalEvaluator::applyBinary(BinaryOperator op, const Interval& l, const Interval& r) {
+    if (op == BinaryOperator::Power && r.lo == 0.0 && r.hi == 0.0) {
+        return Interval::point(1.0);  // pow(NaN, 0) = 1
+    }
+    if (l.isEmpty() || r.isEmpty()) {
+        return Interval::empty();
+    }
+    switch (op) {
+        case BinaryOperator::Add:      return unbounded({ l.lo + r.lo, l.hi + r.hi });
+        case BinaryOperator::Subtract: return unbounded({ l.lo - r.hi, l.hi - r.lo });
+        case BinaryOperator::Multiply: return multiply(l, r);
+        case BinaryOperator::Divide:   return divide(l, r);
+        case BinaryOperator::Power:    return power(l, r);
+    }
+    return Interval::empty();
+}
+
+Interval IntervalEvaluator::evaluateFunction(const std::string& name, const Interval* args, int count,
+                                             bool secondMayBeUndefined) {
+    // Same arity rules as Evaluator::evaluateFunction: extra arguments are ignored.
+    if (count <= 0) {
+        return Interval::empty();
+    }
+    if (count >= 2 && isBinaryFunction(name)) {
+        return binaryFunction(name, args[0], args[1], secondMayBeUndefined);
+    }
+    return unaryFunction(name, args[0]);
+}
+
+} // namespace XpressFormula::Core
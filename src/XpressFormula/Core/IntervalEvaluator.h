@@ -0,0 +1,86 @@
+// IntervalEvaluator.h - Bounds a formula over an x/y/z box with interval arithmetic.
+#pragma once
+
+#include "ASTNode.h"
+#include "Evaluator.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Core {
+
+/// Closed range [lo, hi]. lo > hi is the empty range: the formula is undefined (NaN)
+/// everywhere in the box.
+struct Interval {
+    double lo = 0.0;
+    double hi = 0.0;
+
+    static Interval point(double v) { return { v, v }; }
+    static Interval whole() {
+        return { -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+    }
+    static Interval empty() {
+        return { std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+    }
+
+    bool isEmpty() const { return !(lo <= hi); }
+    bool contains(double v) const { return lo <= v && v <= hi; }
+};
+
+/// Evaluates a formula of x, y and z both at points and over boxes.
+///
+/// The AST is compiled once into a flat postfix program. Point evaluation applies Evaluator's
+/// operators (same results as Evaluator::evaluate). Interval evaluation returns a range that
+/// contains every finite value the formula takes in the box, which lets a caller discard a
+/// whole region at once when the range excludes zero:
+///
+/// - sin(x) + cos(y) over x, y in [0, 0.5] gives [0.878, 1.479], so there is no root there
+/// - x^2 over [-1, 2] gives [0, 4]; constant integer powers are exact, not x*x = [-2, 4]
+///
+/// The bounds are conservative, not tight: a variable used twice is treated as two
+/// independent ranges, and functions without a cheap rule give the whole real line. They are
+/// not outward-rounded, so they can be off by a rounding error.
+class IntervalEvaluator {
+public:
+    /// Variables other than x, y and z take their values from `fixed`.
+    explicit IntervalEvaluator(const ASTNodePtr& ast, const Evaluator::Variables& fixed = {});
+
+    /// Reusable stacks, so evaluation does not allocate. One per thread.
+    struct Scratch {
+        std::vector<double> values;
+        std::vector<Interval> intervals;
+        std::vector<double> args;
+    };
+
+    double evaluate(double x, double y, double z, Scratch& scratch) const;
+    Interval evaluate(const Interval& x, const Interval& y, const Interval& z, Scratch& scratch) const;
+
+    /// Interval rules for single operators (exposed for tests).
+    static Interval applyBinary(BinaryOperator op, const Interval& l, const Interval& r);
+    /// `secondMayBeUndefined` is false only when the second argument is defined everywhere in
+    /// the box, which lets min/max keep both of their bounds.
+    static Interval evaluateFunction(const std::string& name, const Interval* args, int count,
+                                     bool secondMayBeUndefined = true);
+
+private:
+    struct Instruction {
+        enum class Op : std::uint8_t { Constant, X, Y, Z, Unary, Binary, Call };
+        Op op = Op::Constant;
+        std::uint8_t code = 0;   // operator for Unary/Binary; for Call, 1 if argument 2 may be NaN
+        int count = 0;           // argument count for Call
+        double value = 0.0;      // Constant
+        const std::string* function = nullptr;  // Call; points into the AST
+    };
+
+    void compile(const ASTNodePtr& node, int& height);
+    // True when the subtree is defined (not NaN) at every finite x, y and z, overflow aside.
+    bool alwaysDefined(const ASTNodePtr& node) const;
+
+    ASTNodePtr m_ast;  // keeps the nodes the program points into alive
+    Evaluator::Variables m_fixed;
+    std::vector<Instruction> m_program;
+    int m_stackSize = 0;
+};
+
+} // namespace XpressFormula::Core
@@ -0,0 +1,36 @@
+// MappedFile.h - Read-only memory mapping of a whole file.
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace XpressFormula::Core {
+
+/// Maps a file read-only into the address space. Pages are read on first access, so opening a
+/// file of several gigabytes is immediate and only the parts actually read cost memory; the
+/// operating system can drop them again under pressure instead of swapping.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Map the file at `path` (UTF-8), replacing any previous mapping. Returns false and sets
+    /// `error` when the file cannot be opened or mapped. An empty file maps to size() == 0.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const unsigned char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;     // HANDLE
+    void* m_mapping = nullptr;  // HANDLE
+#endif
+};
+
+} // namespace XpressFormula::Core
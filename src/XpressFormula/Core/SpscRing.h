@@ -0,0 +1,66 @@
+// SpscRing.h - Lock-free single-producer single-consumer ring buffer.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace XpressFormula::Core {
+
+/// Bounded FIFO between exactly one producer thread and one consumer thread. Neither side ever
+/// waits: push() stores what fits and pop() takes what is there. Each index is written by one
+/// side only, and each side keeps a cached copy of the other's index, so the shared cache
+/// lines are touched once per batch rather than once per item.
+template <typename T>
+class SpscRing {
+public:
+    /// Room for `capacity` items, rounded up to a power of two.
+    explicit SpscRing(std::size_t capacity)
+        : m_items(std::bit_ceil(std::max<std::size_t>(capacity, 2))), m_mask(m_items.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return m_items.size(); }
+
+    /// Producer: append up to `count` items. Returns how many fit.
+    std::size_t push(const T* items, std::size_t count) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cachedTail + count > m_items.size()) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+        const std::size_t n = std::min(count, m_items.size() - (head - m_cachedTail));
+        for (std::size_t i = 0; i < n; ++i) {
+            m_items[(head + i) & m_mask] = items[i];
+        }
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Consumer: remove up to `max` items into `out`, oldest first. Returns how many.
+    std::size_t pop(T* out, std::size_t max) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_cachedHead - tail < max) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+        }
+        const std::size_t n = std::min(max, m_cachedHead - tail);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = m_items[(tail + i) & m_mask];
+        }
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<T> m_items;
+    std::size_t m_mask;
+    // Indices only grow (wrapping through size_t), so head - tail is the fill level.
+    alignas(64) std::atomic<std::size_t> m_head{ 0 };  // written by the producer
+    std::size_t m_cachedTail = 0;                      // producer's last view of m_tail
+    alignas(64) std::atomic<std::size_t> m_tail{ 0 };  // written by the consumer
+    std::size_t m_cachedHead = 0;                      // consumer's last view of m_head
+};
+
+} // namespace XpressFormula::Core
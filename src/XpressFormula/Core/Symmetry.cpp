@@ -0,0 +1,143 @@
+// Symmetry.cpp - Proves even/odd symmetry of a formula in one variable from its AST.
+#include "Symmetry.h"
+#include <cmath>
+
+namespace XpressFormula::Core {
+
+namespace {
+
+// Parity of a sum or difference.
+Parity combineAdditive(Parity a, Parity b) {
+    return (a == b) ? a : Parity::None;
+}
+
+// Parity of a product or quotient: like signs give even, unlike signs odd.
+Parity combineMultiplicative(Parity a, Parity b) {
+    if (a == Parity::None || b == Parity::None) {
+        return Parity::None;
+    }
+    return (a == b) ? Parity::Even : Parity::Odd;
+}
+
+// base^exponent. An odd base keeps a sign only for integer literal exponents.
+Parity power(Parity base, Parity exponent, const ASTNodePtr& exponentNode) {
+    if (base == Parity::Even && exponent == Parity::Even) {
+        return Parity::Even;
+    }
+    if (base == Parity::Odd && exponentNode && exponentNode->type() == NodeType::Number) {
+        const double n = static_cast<const NumberNode*>(exponentNode.get())->value;
+        if (std::isfinite(n) && n == std::floor(n)) {
+            return (std::fmod(n, 2.0) == 0.0) ? Parity::Even : Parity::Odd;
+        }
+    }
+    return Parity::None;
+}
+
+bool isOddFunction(const std::string& name) {
+    return name == "sin" || name == "tan" || name == "asin" || name == "atan" ||
+           name == "sinh" || name == "tanh" || name == "cbrt" || name == "sign" ||
+           name == "round";
+}
+
+bool isEvenFunction(const std::string& name) {
+    return name == "cos" || name == "cosh" || name == "abs";
+}
+
+} // namespace
+
+Parity Symmetry::parity(const ASTNodePtr& ast, const std::string& variable) {
+    if (!ast) {
+        return Parity::None;
+    }
+    switch (ast->type()) {
+        case NodeType::Number:
+            return Parity::Even;
+
+        case NodeType::Variable:
+            return (static_cast<const VariableNode*>(ast.get())->name == variable) ? Parity::Odd
+                                                                                   : Parity::Even;
+
+        case NodeType::UnaryOp:
+            return parity(static_cast<const UnaryOpNode*>(ast.get())->operand, variable);
+
+        case NodeType::BinaryOp: {
+            const auto* bin = static_cast<const BinaryOpNode*>(ast.get());
+            const Parity l = parity(bin->left, variable);
+            const Parity r = parity(bin->right, variable);
+            switch (bin->op) {
+                case BinaryOperator::Add:
+                case BinaryOperator::Subtract:
+                    return combineAdditive(l, r);
+                case BinaryOperator::Multiply:
+                case BinaryOperator::Divide:
+                    return combineMultiplicative(l, r);
+                case BinaryOperator::Power:
+                    return power(l, r, bin->right);
+            }
+            return Parity::None;
+        }
+
+        case NodeType::FunctionCall: {
+            const auto* fn = static_cast<const FunctionCallNode*>(ast.get());
+            if (fn->arguments.empty()) {
+                return Parity::Even;
+            }
+            const Parity first = parity(fn->arguments[0], variable);
+            if (fn->arguments.size() == 1) {
+                if (first == Parity::Odd && isOddFunction(fn->name)) return Parity::Odd;
+                if (first == Parity::Odd && isEvenFunction(fn->name)) return Parity::Even;
+                return (first == Parity::Even) ? Parity::Even : Parity::None;
+            }
+            bool restEven = true;
+            for (size_t i = 1; i < fn->arguments.size(); ++i) {
+                restEven = restEven && parity(fn->arguments[i], variable) == Parity::Even;
+            }
+            if (fn->arguments.size() == 2 && fn->name == "pow") {
+                return power(first, parity(fn->arguments[1], variable), fn->arguments[1]);
+            }
+            // atan2(-a, b) = -atan2(a, b) and fmod(-a, b) = -fmod(a, b).
+            if (fn->arguments.size() == 2 && restEven && first == Parity::Odd &&
+                (fn->name == "atan2" || fn->name == "mod")) {
+                return Parity::Odd;
+            }
+            return (first == Parity::Even && restEven) ? Parity::Even : Parity::None;
+        }
+    }
+    return Parity::None;
+}
+
+int Symmetry::mirrorSamples(const double* samples, int count, int* source) {
+    for (int i = 0; i < count; ++i) {
+        source[i] = i;
+    }
+    if (count < 2) {
+        return count;
+    }
+    for (int i = 1; i < count; ++i) {
+        if (!(samples[i] > samples[i - 1])) {
+            return count;
+        }
+    }
+
+    // Two pointers from both ends of the sorted axis meet at zero.
+    const double tolerance = 1e-9 * (samples[count - 1] - samples[0]);
+    int evaluated = count;
+    int lo = 0;
+    int hi = count - 1;
+    while (lo < hi) {
+        const double sum = samples[lo] + samples[hi];
+        if (std::abs(sum) <= tolerance) {
+            source[lo] = hi;
+            --evaluated;
+            ++lo;
+            --hi;
+        } else if (sum < 0.0) {
+            ++lo;
+        } else {
+            --hi;
+        }
+    }
+    return evaluated;
+}
+
+} // namespace XpressFormula::Core
@@ -0,0 +1,35 @@
+// Symmetry.h - Proves even/odd symmetry of a formula in one variable from its AST.
+#pragma once
+
+#include "ASTNode.h"
+#include <string>
+
+namespace XpressFormula::Core {
+
+/// Behaviour of f under v -> -v with every other variable held fixed.
+enum class Parity {
+    Even,  // f(-v) = f(v), including formulas that do not use v
+    Odd,   // f(-v) = -f(v)
+    None   // no symmetry could be proven
+};
+
+/// Structural parity analysis used by the samplers to evaluate only one side of a domain that
+/// is symmetric about zero and mirror the other side.
+///
+/// The proof follows the usual rules (even*odd is odd, odd+odd is odd, cos(odd) is even,
+/// odd^2 is even, ...). It is conservative: `None` means "not proven", not "asymmetric".
+/// NaN results (sqrt of a negative, division by zero) mirror the same way as values do, so a
+/// proven parity holds for the formula's domain as well.
+class Symmetry {
+public:
+    static Parity parity(const ASTNodePtr& ast, const std::string& variable);
+
+    /// Pairs the samples of an ascending axis that mirror each other about zero (within a
+    /// tiny fraction of the axis span). `source[i]` receives the index whose value stands in
+    /// for sample i: its non-negative mirror partner, or i itself. Returns the number of
+    /// samples with source[i] == i, i.e. the ones that still have to be evaluated. Axes that
+    /// are not ascending get no pairs.
+    static int mirrorSamples(const double* samples, int count, int* source);
+};
+
+} // namespace XpressFormula::Core
@@ -0,0 +1,116 @@
+// TaskPool.cpp - Fixed worker pool implementation.
+#include "TaskPool.h"
+#include <algorithm>
+
+namespace XpressFormula::Core {
+
+namespace {
+
+// Set while a thread executes loop bodies (pool workers always, the submitting thread during
+// its own parallelFor) so nested parallelFor calls run inline instead of deadlocking.
+thread_local bool t_insideLoop = false;
+
+} // namespace
+
+TaskPool::TaskPool(unsigned workerCount) {
+    m_workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+TaskPool& TaskPool::shared() {
+    static TaskPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1u);
+    return pool;
+}
+
+void TaskPool::runIndices(Loop& loop) {
+    std::size_t processed = 0;
+    for (;;) {
+        const std::size_t index = loop.next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= loop.count) {
+            break;
+        }
+        (*loop.body)(index);
+        ++processed;
+    }
+    if (processed > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        loop.completed += processed;
+    }
+}
+
+TaskPool::Loop* TaskPool::openLoop() const {
+    for (auto it = m_loops.rbegin(); it != m_loops.rend(); ++it) {
+        if ((*it)->next.load(std::memory_order_relaxed) < (*it)->count) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+void TaskPool::workerLoop() {
+    t_insideLoop = true;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        // Indices are only ever claimed, never added back, so a wake-up per new loop suffices.
+        Loop* loop = nullptr;
+        m_wake.wait(lock, [&]() { return m_stopping || (loop = openLoop()) != nullptr; });
+        if (m_stopping) {
+            return;
+        }
+        ++loop->active;
+        lock.unlock();
+
+        runIndices(*loop);
+
+        lock.lock();
+        --loop->active;
+        if (loop->active == 0 && loop->completed == loop->count) {
+            m_done.notify_all();
+        }
+    }
+}
+
+void TaskPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (m_workers.empty() || count == 1 || t_insideLoop) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    Loop loop;
+    loop.body = &body;
+    loop.count = count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_loops.push_back(&loop);
+    }
+    m_wake.notify_all();
+
+    t_insideLoop = true;
+    runIndices(loop);
+    t_insideLoop = false;
+
+    // Workers still inside the loop hold a pointer to it until they leave runIndices().
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&]() { return loop.completed == loop.count && loop.active == 0; });
+    m_loops.erase(std::find(m_loops.begin(), m_loops.end(), &loop));
+}
+
+} // namespace XpressFormula::Core
@@ -0,0 +1,61 @@
+// TaskPool.h - Fixed worker pool for fork/join data-parallel loops.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace XpressFormula::Core {
+
+/// A small persistent thread pool exposing a blocking parallelFor. The calling thread works on
+/// the loop too, so a pool with zero workers degrades to a plain serial loop. Loops issued from
+/// inside a pool task (nested parallelism) run serially on the calling worker.
+///
+/// Several threads may run loops at once. Idle workers join the newest loop first, and every
+/// caller keeps working on its own loop, so a short loop on the UI thread never waits for a long
+/// one issued by a background thread.
+class TaskPool {
+public:
+    /// Create a pool with `workerCount` background threads (0 = serial execution).
+    explicit TaskPool(unsigned workerCount);
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /// Process-wide pool sized to hardware_concurrency() - 1 workers.
+    static TaskPool& shared();
+
+    unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+    /// Invoke body(i) for every i in [0, count), distributing indices over the workers and the
+    /// calling thread. Returns once every index has completed. `body` must not throw.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+private:
+    // One parallelFor call, owned by the caller's stack frame.
+    struct Loop {
+        const std::function<void(std::size_t)>* body = nullptr;
+        std::size_t count = 0;
+        std::atomic<std::size_t> next{ 0 };
+        std::size_t completed = 0;  // guarded by m_mutex
+        unsigned active = 0;        // workers inside runIndices(), guarded by m_mutex
+    };
+
+    void workerLoop();
+    void runIndices(Loop& loop);
+    Loop* openLoop() const;  // newest loop with unclaimed indices; m_mutex held
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<Loop*> m_loops;  // loops in flight, oldest first
+    bool m_stopping = false;
+};
+
+} // namespace XpressFormula::Core
@@ -57,6 +57,8 @@ public:
     double gridSpacingX() const;
     double gridSpacingY() const;
 
+    bool operator==(const ViewTransform&) const = default;
+
 private:
     double niceGridSpacing(double pixelsPerUnit) const;
     static constexpr double DEFAULT_SCALE = 60.0;
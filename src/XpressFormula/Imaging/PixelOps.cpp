@@ -0,0 +1,258 @@
+// PixelOps.cpp - Scalar, SSE2 and AVX2 kernels for the per-pixel conversions.
+#include "PixelOps.h"
+#include "Simd.h"
+#include "../Core/TaskPool.h"
+#include <algorithm>
+
+namespace XpressFormula::Imaging {
+
+namespace {
+
+constexpr std::size_t kPixelsPerTask = std::size_t(1) << 16;
+
+// Rec. 601 luma weights in 14-bit fixed point; they sum to 1 << kLumaBits.
+constexpr int kLumaBits = 14;
+constexpr int kLumaR = 4899;
+constexpr int kLumaG = 9617;
+constexpr int kLumaB = 1868;
+
+// Apply `kernel(first, n)` to bands of at most kPixelsPerTask pixels, in parallel.
+template <typename Kernel>
+void forEachBand(std::uint8_t* pixels, std::size_t count, const Kernel& kernel) {
+    const std::size_t tasks = (count + kPixelsPerTask - 1) / kPixelsPerTask;
+    if (tasks <= 1) {
+        kernel(pixels, count);
+        return;
+    }
+    Core::TaskPool::shared().parallelFor(tasks, [&](std::size_t t) {
+        const std::size_t first = t * kPixelsPerTask;
+        kernel(pixels + first * 4, std::min(kPixelsPerTask, count - first));
+    });
+}
+
+// ---- Scalar: the reference every kernel matches, and the tail after the last full vector ----
+
+void swapRedBlueScalar(std::uint8_t* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i, p += 4) {
+        std::swap(p[0], p[2]);
+    }
+}
+
+void unpremultiplyScalar(std::uint8_t* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i, p += 4) {
+        const int a = p[3];
+        if (a == 0) {
+            p[0] = p[1] = p[2] = 0;
+            continue;
+        }
+        if (a == 255) {
+            continue;
+        }
+        const float scale = 255.0f / static_cast<float>(a);
+        for (int c = 0; c < 3; ++c) {
+            const int value = static_cast<int>(static_cast<float>(p[c]) * scale + 0.5f);
+            p[c] = static_cast<std::uint8_t>(std::min(value, 255));
+        }
+    }
+}
+
+void toGrayscaleScalar(std::uint8_t* p, std::size_t n, ChannelOrder order) {
+    const int w0 = (order == ChannelOrder::Rgba) ? kLumaR : kLumaB;
+    const int w2 = (order == ChannelOrder::Rgba) ? kLumaB : kLumaR;
+    for (std::size_t i = 0; i < n; ++i, p += 4) {
+        const int sum = p[0] * w0 + p[1] * kLumaG + p[2] * w2;
+        const auto gray = static_cast<std::uint8_t>((sum + (1 << (kLumaBits - 1))) >> kLumaBits);
+        p[0] = p[1] = p[2] = gray;
+    }
+}
+
+#ifdef XF_IMAGING_SSE2
+
+// The vector kernels process whole vectors of pixels and return how many they covered; the
+// scalar code finishes the rest.
+
+std::size_t swapRedBlueSse2(std::uint8_t* p, std::size_t n) {
+    const __m128i keep = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i low = _mm_set1_epi32(0xFF);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto* at = reinterpret_cast<__m128i*>(p + i * 4);
+        const __m128i px = _mm_loadu_si128(at);
+        const __m128i first = _mm_slli_epi32(_mm_and_si128(px, low), 16);
+        const __m128i third = _mm_and_si128(_mm_srli_epi32(px, 16), low);
+        _mm_storeu_si128(at, _mm_or_si128(_mm_and_si128(px, keep), _mm_or_si128(first, third)));
+    }
+    return i;
+}
+
+XF_TARGET_AVX2 std::size_t swapRedBlueAvx2(std::uint8_t* p, std::size_t n) {
+    const __m256i order = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                           2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto* at = reinterpret_cast<__m256i*>(p + i * 4);
+        _mm256_storeu_si256(at, _mm256_shuffle_epi8(_mm256_loadu_si256(at), order));
+    }
+    return i;
+}
+
+// Each float vector holds one pixel [c0, c1, c2, a]. Dividing [255, 255, 255, a] by a gives the
+// colour scale with 1 in the alpha lane, so alpha passes through; a zero alpha is masked to 0.
+std::size_t unpremultiplySse2(std::uint8_t* p, std::size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128 colourLanes = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 numerator = _mm_and_ps(colourLanes, _mm_set1_ps(255.0f));
+    const __m128 half = _mm_set1_ps(0.5f);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto* at = reinterpret_cast<__m128i*>(p + i * 4);
+        const __m128i px = _mm_loadu_si128(at);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(px, alphaBits), alphaBits)) == 0xFFFF) {
+            continue;  // all opaque
+        }
+        const __m128i lo = _mm_unpacklo_epi8(px, zero);
+        const __m128i hi = _mm_unpackhi_epi8(px, zero);
+        const __m128i wide[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                                  _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+        __m128i out[4];
+        for (int k = 0; k < 4; ++k) {
+            const __m128 f = _mm_cvtepi32_ps(wide[k]);
+            const __m128 a = _mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128 scale = _mm_div_ps(_mm_or_ps(numerator, _mm_andnot_ps(colourLanes, f)), a);
+            const __m128i value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(f, scale), half));
+            out[k] = _mm_and_si128(value, _mm_castps_si128(_mm_cmpneq_ps(a, _mm_setzero_ps())));
+        }
+        _mm_storeu_si128(at, _mm_packus_epi16(_mm_packs_epi32(out[0], out[1]),
+                                              _mm_packs_epi32(out[2], out[3])));
+    }
+    return i;
+}
+
+XF_TARGET_AVX2 std::size_t unpremultiplyAvx2(std::uint8_t* p, std::size_t n) {
+    const __m256i alphaBits = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256 k255 = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    // packs/packus interleave the 128-bit lanes: this puts the pixels back in order.
+    const __m256i pixelOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto* at = reinterpret_cast<__m256i*>(p + i * 4);
+        const __m256i px = _mm256_loadu_si256(at);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(px, alphaBits), alphaBits)) == -1) {
+            continue;  // all opaque
+        }
+        __m256i out[4];
+        for (int k = 0; k < 4; ++k) {
+            const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + (i + 2 * k) * 4));
+            const __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(pair));
+            const __m256 a = _mm256_permute_ps(f, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m256 scale = _mm256_div_ps(_mm256_blend_ps(k255, f, 0x88), a);
+            const __m256i value = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(f, scale), half));
+            const __m256 nonzero = _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+            out[k] = _mm256_and_si256(value, _mm256_castps_si256(nonzero));
+        }
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(out[0], out[1]),
+                                                   _mm256_packs_epi32(out[2], out[3]));
+        _mm256_storeu_si256(at, _mm256_permutevar8x32_epi32(packed, pixelOrder));
+    }
+    return i;
+}
+
+// Lanes hold whole pixels. Masking with 0x00FF00FF leaves the first and third channel as the two
+// 16-bit halves of each lane, so one madd weighs both; the second channel gets its own madd.
+std::size_t toGrayscaleSse2(std::uint8_t* p, std::size_t n, ChannelOrder order) {
+    const int w0 = (order == ChannelOrder::Rgba) ? kLumaR : kLumaB;
+    const int w2 = (order == ChannelOrder::Rgba) ? kLumaB : kLumaR;
+    const __m128i outerWeights = _mm_set1_epi32((w2 << 16) | w0);
+    const __m128i middleWeight = _mm_set1_epi32(kLumaG);
+    const __m128i outerChannels = _mm_set1_epi32(0x00FF00FF);
+    const __m128i low = _mm_set1_epi32(0xFF);
+    const __m128i alphaBits = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m128i round = _mm_set1_epi32(1 << (kLumaBits - 1));
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto* at = reinterpret_cast<__m128i*>(p + i * 4);
+        const __m128i px = _mm_loadu_si128(at);
+        const __m128i sum = _mm_add_epi32(
+            _mm_madd_epi16(_mm_and_si128(px, outerChannels), outerWeights),
+            _mm_madd_epi16(_mm_and_si128(_mm_srli_epi32(px, 8), low), middleWeight));
+        const __m128i gray = _mm_srli_epi32(_mm_add_epi32(sum, round), kLumaBits);
+        const __m128i colour = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16)));
+        _mm_storeu_si128(at, _mm_or_si128(_mm_and_si128(px, alphaBits), colour));
+    }
+    return i;
+}
+
+XF_TARGET_AVX2 std::size_t toGrayscaleAvx2(std::uint8_t* p, std::size_t n, ChannelOrder order) {
+    const int w0 = (order == ChannelOrder::Rgba) ? kLumaR : kLumaB;
+    const int w2 = (order == ChannelOrder::Rgba) ? kLumaB : kLumaR;
+    const __m256i outerWeights = _mm256_set1_epi32((w2 << 16) | w0);
+    const __m256i middleWeight = _mm256_set1_epi32(kLumaG);
+    const __m256i outerChannels = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    const __m256i alphaBits = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    const __m256i round = _mm256_set1_epi32(1 << (kLumaBits - 1));
+    // Multiplying the gray value by 0x010101 copies it into the three colour bytes.
+    const __m256i spread = _mm256_set1_epi32(0x010101);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto* at = reinterpret_cast<__m256i*>(p + i * 4);
+        const __m256i px = _mm256_loadu_si256(at);
+        const __m256i sum = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_and_si256(px, outerChannels), outerWeights),
+            _mm256_madd_epi16(_mm256_and_si256(_mm256_srli_epi32(px, 8), low), middleWeight));
+        const __m256i gray = _mm256_srli_epi32(_mm256_add_epi32(sum, round), kLumaBits);
+        _mm256_storeu_si256(at, _mm256_or_si256(_mm256_and_si256(px, alphaBits),
+                                                _mm256_mullo_epi32(gray, spread)));
+    }
+    return i;
+}
+
+#endif // XF_IMAGING_SSE2
+
+} // namespace
+
+void swapRedBlue(std::uint8_t* pixels, std::size_t count) {
+    const SimdLevel level = simdLevel();
+    forEachBand(pixels, count, [level](std::uint8_t* p, std::size_t n) {
+        std::size_t done = 0;
+#ifdef XF_IMAGING_SSE2
+        if (level == SimdLevel::Avx2) done = swapRedBlueAvx2(p, n);
+        else if (level == SimdLevel::Sse2) done = swapRedBlueSse2(p, n);
+#else
+        (void)level;
+#endif
+        swapRedBlueScalar(p + done * 4, n - done);
+    });
+}
+
+void unpremultiply(std::uint8_t* pixels, std::size_t count) {
+    const SimdLevel level = simdLevel();
+    forEachBand(pixels, count, [level](std::uint8_t* p, std::size_t n) {
+        std::size_t done = 0;
+#ifdef XF_IMAGING_SSE2
+        if (level == SimdLevel::Avx2) done = unpremultiplyAvx2(p, n);
+        else if (level == SimdLevel::Sse2) done = unpremultiplySse2(p, n);
+#else
+        (void)level;
+#endif
+        unpremultiplyScalar(p + done * 4, n - done);
+    });
+}
+
+void toGrayscale(std::uint8_t* pixels, std::size_t count, ChannelOrder order) {
+    const SimdLevel level = simdLevel();
+    forEachBand(pixels, count, [level, order](std::uint8_t* p, std::size_t n) {
+        std::size_t done = 0;
+#ifdef XF_IMAGING_SSE2
+        if (level == SimdLevel::Avx2) done = toGrayscaleAvx2(p, n, order);
+        else if (level == SimdLevel::Sse2) done = toGrayscaleSse2(p, n, order);
+#else
+        (void)level;
+#endif
+        toGrayscaleScalar(p + done * 4, n - done, order);
+    });
+}
+
+} // namespace XpressFormula::Imaging
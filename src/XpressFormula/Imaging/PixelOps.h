@@ -0,0 +1,30 @@
+// PixelOps.h - In-place per-pixel conversions of 8-bit, 4-channel images.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace XpressFormula::Imaging {
+
+/// Byte order of a 4-channel pixel; alpha is always last.
+enum class ChannelOrder {
+    Rgba,
+    Bgra,
+};
+
+/// The conversions below work on `count` consecutive pixels of 4 bytes each, in place. Large
+/// images are split into bands processed on Core::TaskPool::shared(), and each band runs the
+/// widest kernel simdLevel() allows. Every kernel computes exactly what the scalar code does.
+
+/// Exchange the first and third channel of every pixel (RGBA <-> BGRA).
+void swapRedBlue(std::uint8_t* pixels, std::size_t count);
+
+/// Premultiplied to straight alpha: colour channels become c * 255 / alpha, rounded and clamped
+/// to 255. Pixels with zero alpha become transparent black; opaque pixels are unchanged.
+void unpremultiply(std::uint8_t* pixels, std::size_t count);
+
+/// Replace the colour channels with the Rec. 601 luma (0.299 R + 0.587 G + 0.114 B, in 14-bit
+/// fixed point). Alpha is kept.
+void toGrayscale(std::uint8_t* pixels, std::size_t count, ChannelOrder order);
+
+} // namespace XpressFormula::Imaging
@@ -0,0 +1,771 @@
+// PngEncoder.cpp - Scanline filtering, chunked deflate and PNG framing.
+#include "PngEncoder.h"
+#include "../Core/TaskPool.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <utility>
+
+namespace XpressFormula::Imaging {
+
+namespace {
+
+constexpr std::size_t kChunkBytes = std::size_t(1) << 18;  // filtered bytes per deflate chunk
+constexpr std::size_t kWindow = 32768;                     // deflate's match distance limit
+constexpr int kMinMatch = 3;
+constexpr int kMaxMatch = 258;
+constexpr int kHashBits = 15;
+constexpr std::size_t kBlockSymbols = std::size_t(1) << 15;  // symbols per deflate block
+
+struct LevelParams {
+    int maxChain;    // hash-chain candidates tried per position
+    int niceLength;  // stop searching at a match this long
+    bool lazy;       // defer a match when the next position has a longer one
+};
+
+LevelParams levelParams(PngLevel level) {
+    return (level == PngLevel::Fast) ? LevelParams{ 8, 32, false } : LevelParams{ 192, kMaxMatch, true };
+}
+
+// ---- Checksums ----
+
+struct CrcTable {
+    std::array<std::uint32_t, 256> entries{};
+    CrcTable() {
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            entries[n] = c;
+        }
+    }
+};
+
+const CrcTable& crcTable() {
+    static const CrcTable table;
+    return table;
+}
+
+// ---- Deflate tables (RFC 1951, 3.2.5) ----
+
+constexpr std::array<int, 29> kLengthBase = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+                                              31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+constexpr std::array<int, 29> kLengthExtra = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                               2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+constexpr std::array<int, 30> kDistBase = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                            8193, 12289, 16385, 24577 };
+constexpr std::array<int, 30> kDistExtra = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                             7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+constexpr std::array<int, 19> kCodeLengthOrder = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+constexpr int kLitLenCodes = 286;
+constexpr int kDistCodes = 30;
+constexpr int kEndOfBlock = 256;
+
+struct CodeTables {
+    std::array<std::uint8_t, kMaxMatch + 1> lengthCode{};  // match length -> code - 257
+    std::array<std::uint8_t, 512> distCode{};              // see distanceCode()
+    CodeTables() {
+        for (int code = 0; code < 29; ++code) {
+            const int last = (code + 1 < 29) ? kLengthBase[code + 1] : kMaxMatch + 1;
+            for (int length = kLengthBase[code]; length < last; ++length) {
+                lengthCode[length] = static_cast<std::uint8_t>(code);
+            }
+        }
+        lengthCode[kMaxMatch] = 28;
+        // Distances 1..256 directly, longer ones by (distance - 1) >> 7.
+        for (int code = 0; code < kDistCodes; ++code) {
+            const int last = (code + 1 < kDistCodes) ? kDistBase[code + 1] : 32769;
+            for (int d = kDistBase[code]; d < last; ++d) {
+                if (d <= 256) {
+                    distCode[d - 1] = static_cast<std::uint8_t>(code);
+                } else {
+                    distCode[256 + ((d - 1) >> 7)] = static_cast<std::uint8_t>(code);
+                }
+            }
+        }
+    }
+    int distanceCode(int distance) const {
+        return (distance <= 256) ? distCode[distance - 1] : distCode[256 + ((distance - 1) >> 7)];
+    }
+};
+
+const CodeTables& codeTables() {
+    static const CodeTables tables;
+    return tables;
+}
+
+// ---- Bit output ----
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& out) : m_out(out) {}
+
+    // Append the low `count` bits of `value`, least significant first (count <= 32).
+    void put(std::uint32_t value, int count) {
+        m_bits |= static_cast<std::uint64_t>(value) << m_count;
+        m_count += count;
+        while (m_count >= 8) {
+            m_out.push_back(static_cast<std::uint8_t>(m_bits));
+            m_bits >>= 8;
+            m_count -= 8;
+        }
+    }
+    void align() {
+        if (m_count > 0) {
+            m_out.push_back(static_cast<std::uint8_t>(m_bits));
+            m_bits = 0;
+            m_count = 0;
+        }
+    }
+
+private:
+    std::vector<std::uint8_t>& m_out;
+    std::uint64_t m_bits = 0;
+    int m_count = 0;
+};
+
+// ---- Huffman codes ----
+
+// Code lengths of a Huffman code for `freq`, none longer than `limit`. Frequencies are halved
+// until the tree is shallow enough, which costs little on real data. Unused symbols get 0. A
+// single used symbol is paired with an unused one, since inflaters reject incomplete codes.
+void buildLengths(const std::uint32_t* freq, int count, int limit, std::uint8_t* lengths) {
+    std::vector<std::uint32_t> weights(freq, freq + count);
+    for (;;) {
+        std::fill(lengths, lengths + count, std::uint8_t(0));
+        struct Node {
+            std::uint64_t weight;
+            int parent;
+        };
+        std::vector<Node> nodes;
+        using Entry = std::pair<std::uint64_t, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        std::vector<int> leafNode(static_cast<std::size_t>(count), -1);
+        for (int s = 0; s < count; ++s) {
+            if (weights[s] > 0) {
+                leafNode[s] = static_cast<int>(nodes.size());
+                heap.push({ weights[s], static_cast<int>(nodes.size()) });
+                nodes.push_back({ weights[s], -1 });
+            }
+        }
+        if (nodes.empty()) {
+            return;
+        }
+        if (nodes.size() == 1) {
+            for (int s = 0; s < count; ++s) {
+                if (leafNode[s] >= 0) {
+                    lengths[s] = 1;
+                    lengths[s == 0 ? 1 : 0] = 1;
+                }
+            }
+            return;
+        }
+        while (heap.size() > 1) {
+            const Entry a = heap.top();
+            heap.pop();
+            const Entry b = heap.top();
+            heap.pop();
+            const int parent = static_cast<int>(nodes.size());
+            nodes.push_back({ a.first + b.first, -1 });
+            nodes[a.second].parent = parent;
+            nodes[b.second].parent = parent;
+            heap.push({ a.first + b.first, parent });
+        }
+        int deepest = 0;
+        for (int s = 0; s < count; ++s) {
+            if (leafNode[s] < 0) continue;
+            int depth = 0;
+            for (int n = leafNode[s]; nodes[n].parent >= 0; n = nodes[n].parent) ++depth;
+            lengths[s] = static_cast<std::uint8_t>(std::min(depth, 255));
+            deepest = std::max(deepest, depth);
+        }
+        if (deepest <= limit) {
+            return;
+        }
+        for (std::uint32_t& w : weights) {
+            if (w > 0) w = (w + 1) / 2;
+        }
+    }
+}
+
+// Canonical codes for `lengths`, bit-reversed so BitWriter can send them LSB first.
+void buildCodes(const std::uint8_t* lengths, int count, std::uint16_t* codes) {
+    std::array<int, 16> lengthCount{};
+    for (int s = 0; s < count; ++s) lengthCount[lengths[s]]++;
+    lengthCount[0] = 0;
+    std::array<int, 16> next{};
+    int code = 0;
+    for (int bits = 1; bits < 16; ++bits) {
+        code = (code + lengthCount[bits - 1]) << 1;
+        next[bits] = code;
+    }
+    for (int s = 0; s < count; ++s) {
+        const int length = lengths[s];
+        if (length == 0) {
+            codes[s] = 0;
+            continue;
+        }
+        const int value = next[length]++;
+        int reversed = 0;
+        for (int b = 0; b < length; ++b) {
+            reversed |= ((value >> b) & 1) << (length - 1 - b);
+        }
+        codes[s] = static_cast<std::uint16_t>(reversed);
+    }
+}
+
+// ---- Deflate ----
+
+// One LZ77 symbol: a literal byte (distance 0) or a match.
+struct Symbol {
+    std::uint16_t lengthOrLiteral;
+    std::uint16_t distance;
+};
+
+std::uint32_t hash3(const std::uint8_t* p) {
+    const std::uint32_t v = static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+                            (static_cast<std::uint32_t>(p[2]) << 16);
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+int matchLength(const std::uint8_t* a, const std::uint8_t* b, int limit) {
+    int length = 0;
+    while (length + 8 <= limit) {
+        std::uint64_t x = 0;
+        std::uint64_t y = 0;
+        std::memcpy(&x, a + length, 8);
+        std::memcpy(&y, b + length, 8);
+        const std::uint64_t diff = x ^ y;
+        if (diff != 0) {
+            return length + std::countr_zero(diff) / 8;  // little-endian byte order
+        }
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) ++length;
+    return length;
+}
+
+class Deflater {
+public:
+    Deflater(const LevelParams& params, std::vector<std::uint8_t>& out) : m_params(params), m_bits(out) {}
+
+    // Compress data[start, size) as a sequence of non-final blocks that may refer back into
+    // data[0, start), then byte-align the stream with an empty stored block.
+    void compress(const std::uint8_t* data, std::size_t start, std::size_t size) {
+        m_head.assign(std::size_t(1) << kHashBits, -1);
+        m_prev.assign(size, -1);
+        for (std::size_t p = 0; p < start && p + kMinMatch <= size; ++p) insert(data, p);
+
+        std::size_t blockStart = start;
+        std::size_t pos = start;
+        bool haveNext = false;
+        int nextLength = 0;
+        int nextDistance = 0;
+        while (pos < size) {
+            int length = 0;
+            int distance = 0;
+            if (haveNext) {
+                length = nextLength;
+                distance = nextDistance;
+                haveNext = false;
+            } else {
+                findMatch(data, pos, size, length, distance);
+            }
+            if (pos + kMinMatch <= size) insert(data, pos);
+
+            if (m_params.lazy && length >= kMinMatch && length < m_params.niceLength && pos + 1 < size) {
+                findMatch(data, pos + 1, size, nextLength, nextDistance);
+                if (nextLength > length) {
+                    haveNext = true;
+                    length = 0;
+                }
+            }
+
+            if (length >= kMinMatch) {
+                m_symbols.push_back({ static_cast<std::uint16_t>(length), static_cast<std::uint16_t>(distance) });
+                for (std::size_t p = pos + 1; p < pos + static_cast<std::size_t>(length); ++p) {
+                    if (p + kMinMatch <= size) insert(data, p);
+                }
+                pos += static_cast<std::size_t>(length);
+            } else {
+                m_symbols.push_back({ data[pos], 0 });
+                ++pos;
+            }
+            if (m_symbols.size() >= kBlockSymbols) {
+                writeBlock(data + blockStart, pos - blockStart);
+                blockStart = pos;
+            }
+        }
+        if (!m_symbols.empty()) {
+            writeBlock(data + blockStart, pos - blockStart);
+        }
+        // Empty stored block: BFINAL 0, BTYPE 00, then LEN 0 and NLEN 0xFFFF after alignment.
+        m_bits.put(0, 3);
+        m_bits.align();
+        m_bits.put(0, 16);
+        m_bits.put(0xFFFF, 16);
+    }
+
+private:
+    void insert(const std::uint8_t* data, std::size_t p) {
+        const std::uint32_t h = hash3(data + p);
+        m_prev[p] = m_head[h];
+        m_head[h] = static_cast<std::int32_t>(p);
+    }
+
+    void findMatch(const std::uint8_t* data, std::size_t pos, std::size_t size, int& length, int& distance) const {
+        length = 0;
+        distance = 0;
+        if (pos + kMinMatch > size) return;
+        const int limit = static_cast<int>(std::min<std::size_t>(kMaxMatch, size - pos));
+        int best = kMinMatch - 1;
+        int chain = m_params.maxChain;
+        for (std::int32_t candidate = m_head[hash3(data + pos)];
+             candidate >= 0 && pos - static_cast<std::size_t>(candidate) <= kWindow && chain-- > 0;
+             candidate = m_prev[static_cast<std::size_t>(candidate)]) {
+            const std::uint8_t* c = data + candidate;
+            if (c[best] != data[pos + best]) continue;
+            const int n = matchLength(c, data + pos, limit);
+            if (n > best) {
+                best = n;
+                distance = static_cast<int>(pos - static_cast<std::size_t>(candidate));
+                if (n >= m_params.niceLength || n == limit) break;
+            }
+        }
+        if (best >= kMinMatch) length = best;
+    }
+
+    // Emit m_symbols (covering raw[0, rawSize)) as the cheapest of a stored, fixed-Huffman or
+    // dynamic-Huffman block.
+    void writeBlock(const std::uint8_t* raw, std::size_t rawSize) {
+        const CodeTables& tables = codeTables();
+        std::array<std::uint32_t, kLitLenCodes> litFreq{};
+        std::array<std::uint32_t, kDistCodes> distFreq{};
+        std::uint64_t extraBits = 0;
+        for (const Symbol& s : m_symbols) {
+            if (s.distance == 0) {
+                litFreq[s.lengthOrLiteral]++;
+            } else {
+                const int lc = tables.lengthCode[s.lengthOrLiteral];
+                const int dc = tables.distanceCode(s.distance);
+                litFreq[257 + lc]++;
+                distFreq[dc]++;
+                extraBits += static_cast<std::uint64_t>(kLengthExtra[lc] + kDistExtra[dc]);
+            }
+        }
+        litFreq[kEndOfBlock] = 1;
+        // Inflaters want at least one distance code, even in a block without matches.
+        if (std::all_of(distFreq.begin(), distFreq.end(), [](std::uint32_t f) { return f == 0; })) {
+            distFreq[0] = 1;
+        }
+
+        std::array<std::uint8_t, kLitLenCodes> litLengths{};
+        std::array<std::uint8_t, kDistCodes> distLengths{};
+        buildLengths(litFreq.data(), kLitLenCodes, 15, litLengths.data());
+        buildLengths(distFreq.data(), kDistCodes, 15, distLengths.data());
+
+        int hlit = kLitLenCodes;
+        while (hlit > 257 && litLengths[hlit - 1] == 0) --hlit;
+        int hdist = kDistCodes;
+        while (hdist > 1 && distLengths[hdist - 1] == 0) --hdist;
+
+        // Run-length code the two length tables as one sequence (codes 16, 17, 18).
+        std::vector<std::uint8_t> sequence(litLengths.begin(), litLengths.begin() + hlit);
+        sequence.insert(sequence.end(), distLengths.begin(), distLengths.begin() + hdist);
+        struct Run {
+            std::uint8_t symbol;
+            std::uint8_t extra;
+        };
+        std::vector<Run> runs;
+        std::array<std::uint32_t, 19> clFreq{};
+        for (std::size_t i = 0; i < sequence.size();) {
+            const std::uint8_t value = sequence[i];
+            std::size_t run = 1;
+            while (i + run < sequence.size() && sequence[i + run] == value) ++run;
+            std::size_t left = run;
+            if (value == 0) {
+                while (left >= 11) {
+                    const std::size_t n = std::min<std::size_t>(left, 138);
+                    runs.push_back({ 18, static_cast<std::uint8_t>(n - 11) });
+                    left -= n;
+                }
+                if (left >= 3) {
+                    runs.push_back({ 17, static_cast<std::uint8_t>(left - 3) });
+                    left = 0;
+                }
+            } else if (left >= 4) {
+                runs.push_back({ value, 0 });
+                --left;
+                while (left >= 3) {
+                    const std::size_t n = std::min<std::size_t>(left, 6);
+                    runs.push_back({ 16, static_cast<std::uint8_t>(n - 3) });
+                    left -= n;
+                }
+            }
+            for (; left > 0; --left) runs.push_back({ value, 0 });
+            i += run;
+        }
+        for (const Run& r : runs) clFreq[r.symbol]++;
+        std::array<std::uint8_t, 19> clLengths{};
+        buildLengths(clFreq.data(), 19, 7, clLengths.data());
+        int hclen = 19;
+        while (hclen > 4 && clLengths[kCodeLengthOrder[hclen - 1]] == 0) --hclen;
+
+        // Sizes of the three encodings, in bits.
+        std::uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * static_cast<std::uint64_t>(hclen) + extraBits;
+        for (const Run& r : runs) {
+            dynamicBits += clLengths[r.symbol] + (r.symbol == 16 ? 2 : r.symbol == 17 ? 3 : r.symbol == 18 ? 7 : 0);
+        }
+        std::uint64_t fixedBits = 3 + extraBits;
+        for (int s = 0; s < kLitLenCodes; ++s) {
+            dynamicBits += static_cast<std::uint64_t>(litFreq[s]) * litLengths[s];
+            fixedBits += static_cast<std::uint64_t>(litFreq[s]) * fixedLitLength(s);
+        }
+        for (int d = 0; d < kDistCodes; ++d) {
+            if (m_symbols.empty() || distFreq[d] == 0) continue;
+            dynamicBits += static_cast<std::uint64_t>(distFreq[d]) * distLengths[d];
+            fixedBits += static_cast<std::uint64_t>(distFreq[d]) * 5;
+        }
+        const std::uint64_t storedBits = (rawSize + 5 * ((rawSize + 65534) / 65535)) * 8 + 7;
+
+        if (storedBits < dynamicBits && storedBits < fixedBits) {
+            for (std::size_t offset = 0; offset < rawSize;) {
+                const std::size_t n = std::min<std::size_t>(rawSize - offset, 65535);
+                m_bits.put(0, 3);
+                m_bits.align();
+                m_bits.put(static_cast<std::uint32_t>(n), 16);
+                m_bits.put(static_cast<std::uint32_t>(~n & 0xFFFF), 16);
+                for (std::size_t i = 0; i < n; ++i) m_bits.put(raw[offset + i], 8);
+                offset += n;
+            }
+        } else if (fixedBits <= dynamicBits) {
+            std::array<std::uint8_t, 288> fixedLit{};
+            for (int s = 0; s < 288; ++s) fixedLit[s] = static_cast<std::uint8_t>(fixedLitLength(s));
+            std::array<std::uint8_t, kDistCodes> fixedDist{};
+            fixedDist.fill(5);
+            std::array<std::uint16_t, 288> litCodes{};
+            std::array<std::uint16_t, kDistCodes> distCodes{};
+            buildCodes(fixedLit.data(), 288, litCodes.data());
+            buildCodes(fixedDist.data(), kDistCodes, distCodes.data());
+            m_bits.put(0b010, 3);  // BFINAL 0, BTYPE 01
+            writeSymbols(litCodes.data(), fixedLit.data(), distCodes.data(), fixedDist.data());
+        } else {
+            std::array<std::uint16_t, kLitLenCodes> litCodes{};
+            std::array<std::uint16_t, kDistCodes> distCodes{};
+            std::array<std::uint16_t, 19> clCodes{};
+            buildCodes(litLengths.data(), kLitLenCodes, litCodes.data());
+            buildCodes(distLengths.data(), kDistCodes, distCodes.data());
+            buildCodes(clLengths.data(), 19, clCodes.data());
+            m_bits.put(0b100, 3);  // BFINAL 0, BTYPE 10
+            m_bits.put(static_cast<std::uint32_t>(hlit - 257), 5);
+            m_bits.put(static_cast<std::uint32_t>(hdist - 1), 5);
+            m_bits.put(static_cast<std::uint32_t>(hclen - 4), 4);
+            for (int i = 0; i < hclen; ++i) m_bits.put(clLengths[kCodeLengthOrder[i]], 3);
+            for (const Run& r : runs) {
+                m_bits.put(clCodes[r.symbol], clLengths[r.symbol]);
+                if (r.symbol == 16) m_bits.put(r.extra, 2);
+                if (r.symbol == 17) m_bits.put(r.extra, 3);
+                if (r.symbol == 18) m_bits.put(r.extra, 7);
+            }
+            writeSymbols(litCodes.data(), litLengths.data(), distCodes.data(), distLengths.data());
+        }
+        m_symbols.clear();
+    }
+
+    static int fixedLitLength(int symbol) {
+        return (symbol < 144) ? 8 : (symbol < 256) ? 9 : (symbol < 280) ? 7 : 8;
+    }
+
+    void writeSymbols(const std::uint16_t* litCodes, const std::uint8_t* litLengths,
+                      const std::uint16_t* distCodes, const std::uint8_t* distLengths) {
+        const CodeTables& tables = codeTables();
+        for (const Symbol& s : m_symbols) {
+            if (s.distance == 0) {
+                m_bits.put(litCodes[s.lengthOrLiteral], litLengths[s.lengthOrLiteral]);
+                continue;
+            }
+            const int lc = tables.lengthCode[s.lengthOrLiteral];
+            m_bits.put(litCodes[257 + lc], litLengths[257 + lc]);
+            m_bits.put(static_cast<std::uint32_t>(s.lengthOrLiteral - kLengthBase[lc]), kLengthExtra[lc]);
+            const int dc = tables.distanceCode(s.distance);
+            m_bits.put(distCodes[dc], distLengths[dc]);
+            m_bits.put(static_cast<std::uint32_t>(s.distance - kDistBase[dc]), kDistExtra[dc]);
+        }
+        m_bits.put(litCodes[kEndOfBlock], litLengths[kEndOfBlock]);
+    }
+
+    LevelParams m_params;
+    BitWriter m_bits;
+    std::vector<std::int32_t> m_head;
+    std::vector<std::int32_t> m_prev;
+    std::vector<Symbol> m_symbols;
+};
+
+// ---- Scanline filters (PNG 9.2) ----
+
+int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c;
+}
+
+// Filter one RGBA row against the row above (zeros for the first) into out[0] (filter type)
+// and out[1..]: the filter whose bytes, read as signed, have the smallest absolute sum.
+void filterRow(const std::uint8_t* row, const std::uint8_t* above, std::size_t rowBytes,
+               std::vector<std::uint8_t>& scratch, std::uint8_t* out) {
+    scratch.resize(rowBytes * 5);
+    std::uint8_t* candidates[5];
+    for (int f = 0; f < 5; ++f) candidates[f] = scratch.data() + rowBytes * static_cast<std::size_t>(f);
+    std::array<std::uint64_t, 5> cost{};
+    auto score = [](std::uint8_t v) { return static_cast<std::uint64_t>(v < 128 ? v : 256 - v); };
+    for (std::size_t i = 0; i < rowBytes; ++i) {
+        const int x = row[i];
+        const int a = (i >= 4) ? row[i - 4] : 0;
+        const int b = above[i];
+        const int c = (i >= 4) ? above[i - 4] : 0;
+        const std::uint8_t values[5] = {
+            static_cast<std::uint8_t>(x),
+            static_cast<std::uint8_t>(x - a),
+            static_cast<std::uint8_t>(x - b),
+            static_cast<std::uint8_t>(x - ((a + b) >> 1)),
+            static_cast<std::uint8_t>(x - paeth(a, b, c)),
+        };
+        for (int f = 0; f < 5; ++f) {
+            candidates[f][i] = values[f];
+            cost[f] += score(values[f]);
+        }
+    }
+    const int best = static_cast<int>(std::min_element(cost.begin(), cost.end()) - cost.begin());
+    out[0] = static_cast<std::uint8_t>(best);
+    std::memcpy(out + 1, candidates[best], rowBytes);
+}
+
+void copyRowRgba(const std::uint8_t* src, std::size_t pixels, ChannelOrder order, std::uint8_t* dst) {
+    std::memcpy(dst, src, pixels * 4);
+    if (order == ChannelOrder::Bgra) {
+        for (std::size_t i = 0; i < pixels; ++i) std::swap(dst[i * 4], dst[i * 4 + 2]);
+    }
+}
+
+void putBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Frame `data` as a PNG chunk of `type` at the end of `out`.
+void appendChunk(std::vector<std::uint8_t>& out, const char* type, const std::uint8_t* data, std::size_t size) {
+    putBigEndian(out, static_cast<std::uint32_t>(size));
+    const std::size_t typeAt = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size > 0) out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(0, out.data() + typeAt, size + 4));
+}
+
+} // namespace
+
+std::uint32_t adler32(std::uint32_t adler, const std::uint8_t* data, std::size_t size) {
+    constexpr std::uint32_t kBase = 65521;
+    constexpr std::size_t kMaxRun = 5552;  // longest run before the sums can overflow 32 bits
+    std::uint32_t a = adler & 0xFFFF;
+    std::uint32_t b = adler >> 16;
+    while (size > 0) {
+        const std::size_t n = std::min(size, kMaxRun);
+        for (std::size_t i = 0; i < n; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= kBase;
+        b %= kBase;
+        data += n;
+        size -= n;
+    }
+    return (b << 16) | a;
+}
+
+std::uint32_t adler32Combine(std::uint32_t first, std::uint32_t second, std::size_t secondSize) {
+    // Appending n bytes adds their sum to a, and n * a(first) - n plus the second sum to b.
+    constexpr std::uint64_t kBase = 65521;
+    const std::uint64_t rem = secondSize % kBase;
+    const std::uint64_t a1 = first & 0xFFFF;
+    const std::uint64_t b1 = first >> 16;
+    const std::uint64_t a2 = second & 0xFFFF;
+    const std::uint64_t b2 = second >> 16;
+    const std::uint64_t a = (a1 + a2 + kBase - 1) % kBase;
+    const std::uint64_t b = (rem * a1 + b1 + b2 + kBase - rem) % kBase;
+    return static_cast<std::uint32_t>((b << 16) | a);
+}
+
+std::uint32_t crc32(std::uint32_t crc, const std::uint8_t* data, std::size_t size) {
+    const CrcTable& table = crcTable();
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// One deflate chunk of a band: its rows, filtered data, dictionary and framed IDAT chunk.
+struct PngEncoder::Chunk {
+    int firstRow = 0;  // in the band
+    int rows = 0;
+    std::vector<std::uint8_t> input;  // dictionary, then the filtered rows
+    std::size_t dictionarySize = 0;
+    std::vector<std::uint8_t> compressed;
+    std::vector<std::uint8_t> idat;
+    std::uint32_t adler = 1;
+};
+
+PngEncoder::PngEncoder(int width, int height, ChannelOrder order, PngLevel level, Sink sink)
+    : m_width(std::max(1, width)),
+      m_height(std::max(1, height)),
+      m_order(order),
+      m_level(level),
+      m_sink(std::move(sink)),
+      m_previousRow(static_cast<std::size_t>(m_width) * 4, 0) {}
+
+PngEncoder::~PngEncoder() = default;
+
+bool PngEncoder::emit(const std::uint8_t* data, std::size_t size) {
+    if (!m_failed && !m_sink(data, size)) {
+        m_failed = true;
+    }
+    return !m_failed;
+}
+
+bool PngEncoder::writeHeader() {
+    static const std::uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<std::uint8_t> header(kSignature, kSignature + 8);
+    std::vector<std::uint8_t> ihdr;
+    putBigEndian(ihdr, static_cast<std::uint32_t>(m_width));
+    putBigEndian(ihdr, static_cast<std::uint32_t>(m_height));
+    ihdr.insert(ihdr.end(), { 8, 6, 0, 0, 0 });  // 8-bit RGBA, deflate, adaptive filters, no interlace
+    appendChunk(header, "IHDR", ihdr.data(), ihdr.size());
+    return emit(header.data(), header.size());
+}
+
+bool PngEncoder::writeRows(const std::uint8_t* pixels, int rows) {
+    if (m_failed || rows <= 0) {
+        return !m_failed;
+    }
+    if (rows > m_height - m_rowsWritten) {
+        m_failed = true;
+        return false;
+    }
+    if (!m_started) {
+        m_started = true;
+        if (!writeHeader()) return false;
+    }
+
+    const std::size_t rowBytes = static_cast<std::size_t>(m_width) * 4;
+    const std::size_t lineBytes = rowBytes + 1;
+    const int rowsPerChunk = static_cast<int>(std::max<std::size_t>(1, kChunkBytes / lineBytes));
+    const int chunkCount = (rows + rowsPerChunk - 1) / rowsPerChunk;
+    const int groupSize = static_cast<int>(Core::TaskPool::shared().workerCount() + 1) * 2;
+    const LevelParams params = levelParams(m_level);
+
+    for (int group = 0; group < chunkCount; group += groupSize) {
+        const int count = std::min(groupSize, chunkCount - group);
+        m_chunks.resize(static_cast<std::size_t>(count));
+
+        // Filter each chunk's rows. A chunk's first row is predicted from the row above it,
+        // which may be in the previous chunk or band.
+        Core::TaskPool::shared().parallelFor(static_cast<std::size_t>(count), [&](std::size_t i) {
+            Chunk& chunk = m_chunks[i];
+            chunk.firstRow = (group + static_cast<int>(i)) * rowsPerChunk;
+            chunk.rows = std::min(rowsPerChunk, rows - chunk.firstRow);
+            chunk.dictionarySize = 0;
+            chunk.input.resize(static_cast<std::size_t>(chunk.rows) * lineBytes);
+            std::vector<std::uint8_t> above(rowBytes);
+            std::vector<std::uint8_t> current(rowBytes);
+            std::vector<std::uint8_t> scratch;
+            if (chunk.firstRow == 0) {
+                above = m_previousRow;
+            } else {
+                copyRowRgba(pixels + static_cast<std::size_t>(chunk.firstRow - 1) * rowBytes,
+                            static_cast<std::size_t>(m_width), m_order, above.data());
+            }
+            for (int r = 0; r < chunk.rows; ++r) {
+                copyRowRgba(pixels + static_cast<std::size_t>(chunk.firstRow + r) * rowBytes,
+                            static_cast<std::size_t>(m_width), m_order, current.data());
+                filterRow(current.data(), above.data(), rowBytes, scratch,
+                          chunk.input.data() + static_cast<std::size_t>(r) * lineBytes);
+                std::swap(above, current);
+            }
+            chunk.adler = adler32(1, chunk.input.data(), chunk.input.size());
+        });
+
+        // Prime every chunk with the 32 KB of filtered data before it.
+        for (Chunk& chunk : m_chunks) {
+            const std::vector<std::uint8_t> data(chunk.input.begin(), chunk.input.end());
+            chunk.input.assign(m_dictionary.begin(), m_dictionary.end());
+            chunk.dictionarySize = chunk.input.size();
+            chunk.input.insert(chunk.input.end(), data.begin(), data.end());
+            const std::size_t keep = std::min(kWindow, chunk.input.size());
+            m_dictionary.assign(chunk.input.end() - static_cast<std::ptrdiff_t>(keep), chunk.input.end());
+        }
+
+        const bool streamStart = (m_rowsWritten == 0 && group == 0);
+        Core::TaskPool::shared().parallelFor(static_cast<std::size_t>(count), [&](std::size_t i) {
+            Chunk& chunk = m_chunks[i];
+            chunk.compressed.clear();
+            if (streamStart && i == 0) {
+                // zlib header: deflate with a 32 KB window, FLEVEL 1 (fast) or 3 (maximum).
+                chunk.compressed.push_back(0x78);
+                chunk.compressed.push_back(m_level == PngLevel::Fast ? 0x5E : 0xDA);
+            }
+            Deflater deflater(params, chunk.compressed);
+            deflater.compress(chunk.input.data(), chunk.dictionarySize, chunk.input.size());
+            chunk.idat.clear();
+            appendChunk(chunk.idat, "IDAT", chunk.compressed.data(), chunk.compressed.size());
+        });
+
+        for (const Chunk& chunk : m_chunks) {
+            m_adler = adler32Combine(m_adler, chunk.adler, chunk.input.size() - chunk.dictionarySize);
+            if (!emit(chunk.idat.data(), chunk.idat.size())) return false;
+        }
+    }
+
+    copyRowRgba(pixels + static_cast<std::size_t>(rows - 1) * rowBytes, static_cast<std::size_t>(m_width),
+                m_order, m_previousRow.data());
+    m_rowsWritten += rows;
+    return true;
+}
+
+bool PngEncoder::finish() {
+    if (m_failed || m_rowsWritten != m_height) {
+        m_failed = true;
+        return false;
+    }
+    // Final empty stored block, then the Adler-32 of all filtered rows.
+    std::vector<std::uint8_t> tail = { 0x01, 0x00, 0x00, 0xFF, 0xFF };
+    putBigEndian(tail, m_adler);
+    std::vector<std::uint8_t> out;
+    appendChunk(out, "IDAT", tail.data(), tail.size());
+    appendChunk(out, "IEND", nullptr, 0);
+    return emit(out.data(), out.size());
+}
+
+std::vector<std::uint8_t> encodePng(const std::uint8_t* pixels, int width, int height,
+                                    ChannelOrder order, PngLevel level) {
+    std::vector<std::uint8_t> file;
+    PngEncoder encoder(width, height, order, level, [&](const std::uint8_t* data, std::size_t size) {
+        file.insert(file.end(), data, data + size);
+        return true;
+    });
+    if (!encoder.writeRows(pixels, height) || !encoder.finish()) {
+        file.clear();
+    }
+    return file;
+}
+
+} // namespace XpressFormula::Imaging
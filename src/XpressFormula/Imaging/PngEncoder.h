@@ -0,0 +1,77 @@
+// PngEncoder.h - Portable PNG encoder with adaptive scanline filters and parallel deflate.
+#pragma once
+
+#include "PixelOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace XpressFormula::Imaging {
+
+enum class PngLevel {
+    /// Greedy LZ77 matching over short hash chains. Several times faster than Small; files are
+    /// somewhat larger.
+    Fast,
+    /// Lazy LZ77 matching over long hash chains, for the smallest files.
+    Small,
+};
+
+/// Writes an 8-bit RGBA PNG (colour type 6) from bands of rows, so an image never has to be
+/// held as a whole. Each row gets the filter (None, Sub, Up, Average or Paeth) whose output has
+/// the smallest sum of absolute byte values.
+///
+/// The filtered rows are cut into chunks of about 256 KB that are deflated independently on
+/// Core::TaskPool::shared(). Each chunk is primed with the 32 KB of filtered data before it, as
+/// a preset dictionary, so matches still reach back across chunk borders. A chunk ends with an
+/// empty stored block, which byte-aligns it, and becomes one IDAT chunk. The IDAT chunks together
+/// form one zlib stream, whose Adler-32 is combined from the per-chunk checksums. The output
+/// depends on the band sizes, but not on the number of threads.
+class PngEncoder {
+public:
+    /// Receives the file in order; returning false aborts the encoding.
+    using Sink = std::function<bool(const std::uint8_t* data, std::size_t size)>;
+
+    PngEncoder(int width, int height, ChannelOrder order, PngLevel level, Sink sink);
+    ~PngEncoder();
+    PngEncoder(const PngEncoder&) = delete;
+    PngEncoder& operator=(const PngEncoder&) = delete;
+
+    /// Encode the next `rows` rows: 4 bytes per pixel in the encoder's channel order, straight
+    /// alpha, rows packed. The first call writes the PNG header.
+    bool writeRows(const std::uint8_t* pixels, int rows);
+    /// End the zlib stream and the file. Fails unless exactly `height` rows were written.
+    bool finish();
+
+private:
+    struct Chunk;
+
+    bool emit(const std::uint8_t* data, std::size_t size);
+    bool writeHeader();
+
+    int m_width;
+    int m_height;
+    ChannelOrder m_order;
+    PngLevel m_level;
+    Sink m_sink;
+    int m_rowsWritten = 0;
+    bool m_started = false;
+    bool m_failed = false;
+    std::uint32_t m_adler = 1;                 // of all filtered rows so far
+    std::vector<std::uint8_t> m_previousRow;   // last row written, as RGBA
+    std::vector<std::uint8_t> m_dictionary;    // last 32 KB of filtered rows
+    std::vector<Chunk> m_chunks;
+};
+
+/// Encode a whole image: `pixels` holds width x height pixels in `order`, rows packed.
+std::vector<std::uint8_t> encodePng(const std::uint8_t* pixels, int width, int height,
+                                    ChannelOrder order, PngLevel level);
+
+/// Adler-32 of `size` bytes continuing from `adler` (1 for a new checksum).
+std::uint32_t adler32(std::uint32_t adler, const std::uint8_t* data, std::size_t size);
+/// Adler-32 of two byte ranges back to back, from their checksums and the second one's length.
+std::uint32_t adler32Combine(std::uint32_t first, std::uint32_t second, std::size_t secondSize);
+/// CRC-32 (as in PNG and zlib) of `size` bytes continuing from `crc` (0 for a new checksum).
+std::uint32_t crc32(std::uint32_t crc, const std::uint8_t* data, std::size_t size);
+
+} // namespace XpressFormula::Imaging
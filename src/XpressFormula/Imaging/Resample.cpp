@@ -0,0 +1,477 @@
+// Resample.cpp - Bilinear and Lanczos resizing: weight tables plus scalar, SSE2 and AVX2 kernels.
+#include "Resample.h"
+#include "Simd.h"
+#include "../Core/MathConstants.h"
+#include "../Core/TaskPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace XpressFormula::Imaging {
+
+namespace {
+
+constexpr int kRowsPerTask = 16;
+
+// Bilinear: weights in kBilinearBits; horizontally filtered rows are kept as int16 with
+// kIntermediateBits of fraction (255 << 7 still fits), then blended vertically.
+constexpr int kBilinearBits = 11;
+constexpr int kIntermediateBits = 7;
+constexpr int kBlendShift = kIntermediateBits + kBilinearBits;
+
+// Lanczos: weights in kLanczosBits, applied horizontally into an 8-bit image, then vertically.
+constexpr int kLanczosBits = 14;
+constexpr double kLanczosRadius = 3.0;
+
+struct LinearTap {
+    int first = 0;
+    int second = 0;
+    std::int16_t w0 = 0;
+    std::int16_t w1 = 0;
+};
+
+// Filter taps of every output position along one axis for a sinc-windowed kernel.
+struct KernelTable {
+    int stride = 0;                     // weights per position, some unused
+    std::vector<int> first;             // first source index
+    std::vector<int> count;             // source indices used
+    std::vector<std::int16_t> weights;  // position * stride + tap
+};
+
+inline std::size_t rowBytes(int width) {
+    return static_cast<std::size_t>(width) * 4u;
+}
+
+// Two int16 weights as one madd operand: w0 applies to the even lane, w1 to the odd one.
+inline int pairWeights(int w0, int w1) {
+    return static_cast<int>((static_cast<std::uint32_t>(static_cast<std::uint16_t>(w1)) << 16) |
+                            static_cast<std::uint16_t>(w0));
+}
+
+inline std::uint8_t clampByte(int value) {
+    return static_cast<std::uint8_t>(std::clamp(value, 0, 255));
+}
+
+std::vector<LinearTap> linearTaps(int srcSize, int dstSize) {
+    std::vector<LinearTap> taps(static_cast<std::size_t>(dstSize));
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    for (int d = 0; d < dstSize; ++d) {
+        const double s = (d + 0.5) * scale - 0.5;
+        const double whole = std::floor(s);
+        int first = static_cast<int>(whole);
+        int w1 = static_cast<int>(std::lround((s - whole) * (1 << kBilinearBits)));
+        if (first < 0) {
+            first = 0;
+            w1 = 0;
+        } else if (first >= srcSize - 1) {
+            first = srcSize - 1;
+            w1 = 0;
+        }
+        LinearTap& tap = taps[static_cast<std::size_t>(d)];
+        tap.first = first;
+        tap.second = std::min(first + 1, srcSize - 1);
+        tap.w0 = static_cast<std::int16_t>((1 << kBilinearBits) - w1);
+        tap.w1 = static_cast<std::int16_t>(w1);
+    }
+    return taps;
+}
+
+double lanczos3(double x) {
+    x = std::abs(x);
+    if (x < 1e-9) return 1.0;
+    if (x >= kLanczosRadius) return 0.0;
+    const double px = Core::PI * x;
+    return kLanczosRadius * std::sin(px) * std::sin(px / kLanczosRadius) / (px * px);
+}
+
+KernelTable lanczosTable(int srcSize, int dstSize) {
+    const double scale = static_cast<double>(srcSize) / dstSize;
+    const double stretch = std::max(1.0, scale);
+    const double support = kLanczosRadius * stretch;
+    KernelTable table;
+    table.stride = static_cast<int>(std::ceil(support)) * 2 + 1;
+    table.first.resize(static_cast<std::size_t>(dstSize));
+    table.count.resize(static_cast<std::size_t>(dstSize));
+    table.weights.assign(static_cast<std::size_t>(dstSize) * table.stride, 0);
+    std::vector<double> exact(static_cast<std::size_t>(table.stride));
+    for (int d = 0; d < dstSize; ++d) {
+        const double centre = (d + 0.5) * scale;
+        const int first = std::max(0, static_cast<int>(centre - support + 0.5));
+        const int last = std::min(srcSize, static_cast<int>(centre + support + 0.5));
+        const int count = std::min(last - first, table.stride);
+        double total = 0.0;
+        for (int k = 0; k < count; ++k) {
+            exact[k] = lanczos3((first + k + 0.5 - centre) / stretch);
+            total += exact[k];
+        }
+        // Quantise, then give the rounding error to the largest weight so they sum to one.
+        std::int16_t* weights = &table.weights[static_cast<std::size_t>(d) * table.stride];
+        int sum = 0;
+        int largest = 0;
+        for (int k = 0; k < count; ++k) {
+            weights[k] = static_cast<std::int16_t>(std::lround(exact[k] / total * (1 << kLanczosBits)));
+            sum += weights[k];
+            if (weights[k] > weights[largest]) largest = k;
+        }
+        weights[largest] = static_cast<std::int16_t>(weights[largest] + (1 << kLanczosBits) - sum);
+        table.first[static_cast<std::size_t>(d)] = first;
+        table.count[static_cast<std::size_t>(d)] = count;
+    }
+    return table;
+}
+
+// Run body(firstRow, endRow) over bands of kRowsPerTask rows in parallel.
+template <typename Body>
+void forEachRowBand(int rows, const Body& body) {
+    const std::size_t bands = (static_cast<std::size_t>(rows) + kRowsPerTask - 1) / kRowsPerTask;
+    Core::TaskPool::shared().parallelFor(bands, [&](std::size_t band) {
+        const int first = static_cast<int>(band) * kRowsPerTask;
+        body(first, std::min(rows, first + kRowsPerTask));
+    });
+}
+
+// ---- Scalar kernels: the reference, and the tail after the last full vector ----
+
+void filterRowLinearScalar(const std::uint8_t* row, const LinearTap* taps, int width, std::int16_t* out) {
+    constexpr int shift = kBilinearBits - kIntermediateBits;
+    for (int x = 0; x < width; ++x, out += 4) {
+        const std::uint8_t* a = row + taps[x].first * 4;
+        const std::uint8_t* b = row + taps[x].second * 4;
+        for (int c = 0; c < 4; ++c) {
+            const int sum = a[c] * taps[x].w0 + b[c] * taps[x].w1;
+            out[c] = static_cast<std::int16_t>((sum + (1 << (shift - 1))) >> shift);
+        }
+    }
+}
+
+void blendRowsScalar(const std::int16_t* upper, const std::int16_t* lower, int w0, int w1,
+                     std::uint8_t* out, std::size_t values) {
+    for (std::size_t i = 0; i < values; ++i) {
+        out[i] = clampByte((upper[i] * w0 + lower[i] * w1 + (1 << (kBlendShift - 1))) >> kBlendShift);
+    }
+}
+
+void convolveRowScalar(const std::uint8_t* row, const KernelTable& table, int width, std::uint8_t* out) {
+    for (int x = 0; x < width; ++x, out += 4) {
+        const std::uint8_t* at = row + table.first[x] * 4;
+        const std::int16_t* weights = &table.weights[static_cast<std::size_t>(x) * table.stride];
+        int sum[4] = { 1 << (kLanczosBits - 1), 1 << (kLanczosBits - 1),
+                       1 << (kLanczosBits - 1), 1 << (kLanczosBits - 1) };
+        for (int k = 0; k < table.count[x]; ++k, at += 4) {
+            for (int c = 0; c < 4; ++c) sum[c] += at[c] * weights[k];
+        }
+        for (int c = 0; c < 4; ++c) out[c] = clampByte(sum[c] >> kLanczosBits);
+    }
+}
+
+void convolveColumnsScalar(const std::uint8_t* column, std::size_t stride, int count,
+                           const std::int16_t* weights, std::uint8_t* out, std::size_t values) {
+    for (std::size_t i = 0; i < values; ++i) {
+        int sum = 1 << (kLanczosBits - 1);
+        const std::uint8_t* at = column + i;
+        for (int k = 0; k < count; ++k, at += stride) sum += *at * weights[k];
+        out[i] = clampByte(sum >> kLanczosBits);
+    }
+}
+
+#ifdef XF_IMAGING_SSE2
+
+// The horizontal passes gather source pixels one by one, which dominates their cost, so they
+// stop at SSE2. The vertical passes stream whole rows and have AVX2 versions.
+
+inline __m128i loadPixel(const std::uint8_t* at) {
+    std::uint32_t value;
+    std::memcpy(&value, at, sizeof(value));
+    return _mm_cvtsi32_si128(static_cast<int>(value));
+}
+
+void filterRowLinearSse2(const std::uint8_t* row, const LinearTap* taps, int width, std::int16_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (kBilinearBits - kIntermediateBits - 1));
+    // Interleaving the two source pixels pairs each channel with its neighbour for madd.
+    auto filtered = [&](const LinearTap& tap) {
+        const __m128i pair = _mm_unpacklo_epi8(
+            _mm_unpacklo_epi8(loadPixel(row + tap.first * 4), loadPixel(row + tap.second * 4)), zero);
+        const __m128i sum = _mm_madd_epi16(pair, _mm_set1_epi32(pairWeights(tap.w0, tap.w1)));
+        return _mm_srai_epi32(_mm_add_epi32(sum, round), kBilinearBits - kIntermediateBits);
+    };
+    int x = 0;
+    for (; x + 2 <= width; x += 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4),
+                         _mm_packs_epi32(filtered(taps[x]), filtered(taps[x + 1])));
+    }
+    if (x < width) {
+        const __m128i last = filtered(taps[x]);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packs_epi32(last, last));
+    }
+}
+
+std::size_t blendRowsSse2(const std::int16_t* upper, const std::int16_t* lower, int w0, int w1,
+                          std::uint8_t* out, std::size_t values) {
+    const __m128i weights = _mm_set1_epi32(pairWeights(w0, w1));
+    const __m128i round = _mm_set1_epi32(1 << (kBlendShift - 1));
+    std::size_t i = 0;
+    for (; i + 8 <= values; i += 8) {
+        const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + i));
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + i));
+        const __m128i a = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(u, l), weights), round), kBlendShift);
+        const __m128i b = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(u, l), weights), round), kBlendShift);
+        const __m128i packed = _mm_packs_epi32(a, b);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(packed, packed));
+    }
+    return i;
+}
+
+XF_TARGET_AVX2 std::size_t blendRowsAvx2(const std::int16_t* upper, const std::int16_t* lower, int w0, int w1,
+                                         std::uint8_t* out, std::size_t values) {
+    const __m256i weights = _mm256_set1_epi32(pairWeights(w0, w1));
+    const __m256i round = _mm256_set1_epi32(1 << (kBlendShift - 1));
+    std::size_t i = 0;
+    for (; i + 16 <= values; i += 16) {
+        const __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(upper + i));
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lower + i));
+        const __m256i a = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(u, l), weights), round), kBlendShift);
+        const __m256i b = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(u, l), weights), round), kBlendShift);
+        // Unpack and pack both stay within 128-bit lanes, so each lane holds 8 values in order;
+        // the permute joins the two lanes' bytes.
+        const __m256i packed = _mm256_packs_epi32(a, b);
+        const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(packed, packed), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(bytes));
+    }
+    return i;
+}
+
+void convolveRowSse2(const std::uint8_t* row, const KernelTable& table, int width, std::uint8_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (kLanczosBits - 1));
+    for (int x = 0; x < width; ++x, out += 4) {
+        const std::uint8_t* at = row + table.first[x] * 4;
+        const std::int16_t* weights = &table.weights[static_cast<std::size_t>(x) * table.stride];
+        const int count = table.count[x];
+        __m128i sum = round;
+        int k = 0;
+        for (; k + 2 <= count; k += 2) {
+            // Two neighbouring pixels, interleaved channel by channel into int16 pairs.
+            const __m128i two = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(at + k * 4));
+            const __m128i pair = _mm_unpacklo_epi8(_mm_unpacklo_epi8(two, _mm_srli_si128(two, 4)), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, _mm_set1_epi32(pairWeights(weights[k], weights[k + 1]))));
+        }
+        if (k < count) {
+            const __m128i single = _mm_unpacklo_epi16(_mm_unpacklo_epi8(loadPixel(at + k * 4), zero), zero);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(single, _mm_set1_epi32(pairWeights(weights[k], 0))));
+        }
+        const __m128i words = _mm_packs_epi32(_mm_srai_epi32(sum, kLanczosBits), zero);
+        const int pixel = _mm_cvtsi128_si32(_mm_packus_epi16(words, zero));
+        std::memcpy(out, &pixel, sizeof(pixel));
+    }
+}
+
+std::size_t convolveColumnsSse2(const std::uint8_t* column, std::size_t stride, int count,
+                                const std::int16_t* weights, std::uint8_t* out, std::size_t values) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (kLanczosBits - 1));
+    std::size_t i = 0;
+    for (; i + 16 <= values; i += 16) {
+        __m128i sum[4] = { round, round, round, round };
+        const std::uint8_t* at = column + i;
+        // Two source rows per step: interleaving their bytes pairs each value with the one below.
+        auto accumulate = [&](__m128i a, __m128i b, int w) {
+            const __m128i wv = _mm_set1_epi32(w);
+            const __m128i lo = _mm_unpacklo_epi8(a, b);
+            const __m128i hi = _mm_unpackhi_epi8(a, b);
+            sum[0] = _mm_add_epi32(sum[0], _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), wv));
+            sum[1] = _mm_add_epi32(sum[1], _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), wv));
+            sum[2] = _mm_add_epi32(sum[2], _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), wv));
+            sum[3] = _mm_add_epi32(sum[3], _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), wv));
+        };
+        int k = 0;
+        for (; k + 2 <= count; k += 2, at += 2 * stride) {
+            accumulate(_mm_loadu_si128(reinterpret_cast<const __m128i*>(at)),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(at + stride)),
+                       pairWeights(weights[k], weights[k + 1]));
+        }
+        if (k < count) {
+            accumulate(_mm_loadu_si128(reinterpret_cast<const __m128i*>(at)), zero, pairWeights(weights[k], 0));
+        }
+        for (__m128i& s : sum) s = _mm_srai_epi32(s, kLanczosBits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packus_epi16(_mm_packs_epi32(sum[0], sum[1]), _mm_packs_epi32(sum[2], sum[3])));
+    }
+    return i;
+}
+
+XF_TARGET_AVX2 inline void accumulateColumnsAvx2(__m256i* sum, __m256i a, __m256i b, int w) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wv = _mm256_set1_epi32(w);
+    const __m256i lo = _mm256_unpacklo_epi8(a, b);
+    const __m256i hi = _mm256_unpackhi_epi8(a, b);
+    sum[0] = _mm256_add_epi32(sum[0], _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), wv));
+    sum[1] = _mm256_add_epi32(sum[1], _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), wv));
+    sum[2] = _mm256_add_epi32(sum[2], _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), wv));
+    sum[3] = _mm256_add_epi32(sum[3], _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), wv));
+}
+
+// The same steps as the SSE2 version within each 128-bit lane; the packs undo the unpacks
+// lane by lane, so the 32 bytes come out in order.
+XF_TARGET_AVX2 std::size_t convolveColumnsAvx2(const std::uint8_t* column, std::size_t stride, int count,
+                                               const std::int16_t* weights, std::uint8_t* out, std::size_t values) {
+    const __m256i round = _mm256_set1_epi32(1 << (kLanczosBits - 1));
+    std::size_t i = 0;
+    for (; i + 32 <= values; i += 32) {
+        __m256i sum[4] = { round, round, round, round };
+        const std::uint8_t* at = column + i;
+        int k = 0;
+        for (; k + 2 <= count; k += 2, at += 2 * stride) {
+            accumulateColumnsAvx2(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at)),
+                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at + stride)),
+                                  pairWeights(weights[k], weights[k + 1]));
+        }
+        if (k < count) {
+            accumulateColumnsAvx2(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at)),
+                                  _mm256_setzero_si256(), pairWeights(weights[k], 0));
+        }
+        for (int s = 0; s < 4; ++s) sum[s] = _mm256_srai_epi32(sum[s], kLanczosBits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_packus_epi16(_mm256_packs_epi32(sum[0], sum[1]), _mm256_packs_epi32(sum[2], sum[3])));
+    }
+    return i;
+}
+
+#endif // XF_IMAGING_SSE2
+
+// ---- Dispatch ----
+
+void filterRowLinear(SimdLevel level, const std::uint8_t* row, const LinearTap* taps, int width, std::int16_t* out) {
+#ifdef XF_IMAGING_SSE2
+    if (level != SimdLevel::Scalar) {
+        filterRowLinearSse2(row, taps, width, out);
+        return;
+    }
+#else
+    (void)level;
+#endif
+    filterRowLinearScalar(row, taps, width, out);
+}
+
+void blendRows(SimdLevel level, const std::int16_t* upper, const std::int16_t* lower, int w0, int w1,
+               std::uint8_t* out, std::size_t values) {
+    std::size_t done = 0;
+#ifdef XF_IMAGING_SSE2
+    if (level == SimdLevel::Avx2) done = blendRowsAvx2(upper, lower, w0, w1, out, values);
+    else if (level == SimdLevel::Sse2) done = blendRowsSse2(upper, lower, w0, w1, out, values);
+#else
+    (void)level;
+#endif
+    blendRowsScalar(upper + done, lower + done, w0, w1, out + done, values - done);
+}
+
+void convolveRow(SimdLevel level, const std::uint8_t* row, const KernelTable& table, int width, std::uint8_t* out) {
+#ifdef XF_IMAGING_SSE2
+    if (level != SimdLevel::Scalar) {
+        convolveRowSse2(row, table, width, out);
+        return;
+    }
+#else
+    (void)level;
+#endif
+    convolveRowScalar(row, table, width, out);
+}
+
+void convolveColumns(SimdLevel level, const std::uint8_t* column, std::size_t stride, int count,
+                     const std::int16_t* weights, std::uint8_t* out, std::size_t values) {
+    std::size_t done = 0;
+#ifdef XF_IMAGING_SSE2
+    if (level == SimdLevel::Avx2) done = convolveColumnsAvx2(column, stride, count, weights, out, values);
+    else if (level == SimdLevel::Sse2) done = convolveColumnsSse2(column, stride, count, weights, out, values);
+#else
+    (void)level;
+#endif
+    convolveColumnsScalar(column + done, stride, count, weights, out + done, values - done);
+}
+
+// ---- Whole-image passes ----
+
+void resizeBilinear(const std::uint8_t* src, int srcWidth, int srcHeight,
+                    std::uint8_t* dst, int dstWidth, int dstHeight) {
+    const std::vector<LinearTap> columns = linearTaps(srcWidth, dstWidth);
+    const std::vector<LinearTap> rows = linearTaps(srcHeight, dstHeight);
+    const SimdLevel level = simdLevel();
+    const std::size_t values = rowBytes(dstWidth);
+    forEachRowBand(dstHeight, [&](int firstRow, int endRow) {
+        // Horizontally filtered source rows, reused while consecutive output rows share them.
+        std::vector<std::int16_t> upper(values);
+        std::vector<std::int16_t> lower(values);
+        int upperRow = -1;
+        int lowerRow = -1;
+        for (int y = firstRow; y < endRow; ++y) {
+            const LinearTap& tap = rows[static_cast<std::size_t>(y)];
+            if (upperRow != tap.first) {
+                if (lowerRow == tap.first) {
+                    std::swap(upper, lower);
+                    std::swap(upperRow, lowerRow);
+                } else {
+                    filterRowLinear(level, src + tap.first * rowBytes(srcWidth), columns.data(), dstWidth, upper.data());
+                    upperRow = tap.first;
+                }
+            }
+            if (lowerRow != tap.second) {
+                filterRowLinear(level, src + tap.second * rowBytes(srcWidth), columns.data(), dstWidth, lower.data());
+                lowerRow = tap.second;
+            }
+            blendRows(level, upper.data(), lower.data(), tap.w0, tap.w1, dst + y * values, values);
+        }
+    });
+}
+
+void convolveHorizontally(const std::uint8_t* src, int srcWidth, int height, std::uint8_t* dst, int dstWidth) {
+    const KernelTable table = lanczosTable(srcWidth, dstWidth);
+    const SimdLevel level = simdLevel();
+    forEachRowBand(height, [&](int firstRow, int endRow) {
+        for (int y = firstRow; y < endRow; ++y) {
+            convolveRow(level, src + y * rowBytes(srcWidth), table, dstWidth, dst + y * rowBytes(dstWidth));
+        }
+    });
+}
+
+void convolveVertically(const std::uint8_t* src, int width, int srcHeight, std::uint8_t* dst, int dstHeight) {
+    const KernelTable table = lanczosTable(srcHeight, dstHeight);
+    const SimdLevel level = simdLevel();
+    const std::size_t values = rowBytes(width);
+    forEachRowBand(dstHeight, [&](int firstRow, int endRow) {
+        for (int y = firstRow; y < endRow; ++y) {
+            convolveColumns(level, src + table.first[y] * values, values, table.count[y],
+                            &table.weights[static_cast<std::size_t>(y) * table.stride], dst + y * values, values);
+        }
+    });
+}
+
+} // namespace
+
+void resize(const std::uint8_t* src, int srcWidth, int srcHeight,
+            std::uint8_t* dst, int dstWidth, int dstHeight, ResampleFilter filter) {
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) {
+        return;
+    }
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        std::memcpy(dst, src, rowBytes(srcWidth) * srcHeight);
+        return;
+    }
+    if (filter == ResampleFilter::Bilinear) {
+        resizeBilinear(src, srcWidth, srcHeight, dst, dstWidth, dstHeight);
+        return;
+    }
+    if (srcHeight == dstHeight) {
+        convolveHorizontally(src, srcWidth, srcHeight, dst, dstWidth);
+    } else if (srcWidth == dstWidth) {
+        convolveVertically(src, srcWidth, srcHeight, dst, dstHeight);
+    } else {
+        std::vector<std::uint8_t> columnsDone(rowBytes(dstWidth) * srcHeight);
+        convolveHorizontally(src, srcWidth, srcHeight, columnsDone.data(), dstWidth);
+        convolveVertically(columnsDone.data(), dstWidth, srcHeight, dst, dstHeight);
+    }
+}
+
+} // namespace XpressFormula::Imaging
@@ -0,0 +1,28 @@
+// Resample.h - Resizing of 8-bit, 4-channel images with fixed-point filters.
+#pragma once
+
+#include <cstdint>
+
+namespace XpressFormula::Imaging {
+
+enum class ResampleFilter {
+    /// Interpolates the 2x2 nearest source pixels. Cheap; blurs when enlarging and aliases when
+    /// shrinking by more than half.
+    Bilinear,
+    /// Separable Lanczos window of radius 3, widened by the shrink factor when shrinking so
+    /// every source pixel contributes. Sharp in both directions, with faint ringing at edges.
+    Lanczos3,
+};
+
+/// Resize `src` (srcWidth x srcHeight pixels, 4 bytes each, rows packed) into `dst`, which must
+/// hold dstWidth x dstHeight pixels. Pixel centres map onto each other, so the image keeps its
+/// position. All four channels are filtered alike: filter premultiplied colour, not straight.
+///
+/// Weights are 11-bit (bilinear) or 14-bit (Lanczos) fixed point, summing exactly to one, so
+/// flat areas stay flat. Output rows are split into bands processed on
+/// Core::TaskPool::shared(), each with the widest kernel simdLevel() allows; every kernel
+/// produces the same bytes as the scalar code.
+void resize(const std::uint8_t* src, int srcWidth, int srcHeight,
+            std::uint8_t* dst, int dstWidth, int dstHeight, ResampleFilter filter);
+
+} // namespace XpressFormula::Imaging
@@ -0,0 +1,51 @@
+// Simd.cpp - CPU feature detection for the imaging kernels.
+#include "Simd.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(XF_IMAGING_SSE2) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace XpressFormula::Imaging {
+
+namespace {
+
+SimdLevel detect() {
+#if !defined(XF_IMAGING_SSE2)
+    return SimdLevel::Scalar;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 0);
+    if (info[0] < 7) return SimdLevel::Sse2;
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                            (_xgetbv(0) & 6) == 6;
+    if (!osSavesYmm) return SimdLevel::Sse2;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0 ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#endif
+}
+
+std::atomic<int> g_limit{ static_cast<int>(SimdLevel::Avx2) };
+
+} // namespace
+
+SimdLevel supportedSimdLevel() {
+    static const SimdLevel supported = detect();
+    return supported;
+}
+
+SimdLevel simdLevel() {
+    return static_cast<SimdLevel>(std::min(static_cast<int>(supportedSimdLevel()),
+                                           g_limit.load(std::memory_order_relaxed)));
+}
+
+void setSimdLevel(SimdLevel level) {
+    g_limit.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+} // namespace XpressFormula::Imaging
@@ -0,0 +1,36 @@
+// Simd.h - Instruction-set selection shared by the imaging kernels.
+#pragma once
+
+// XF_IMAGING_SSE2: SSE2 kernels are compiled in (every x64 build, and 32-bit builds targeting SSE2).
+// XF_TARGET_AVX2: marks a function whose body uses AVX2, so GCC/Clang emit it without building the
+// whole file with -mavx2; MSVC accepts the intrinsics anywhere. Callers reach those functions only
+// when simdLevel() is Avx2.
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define XF_IMAGING_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define XF_TARGET_AVX2
+#else
+#define XF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace XpressFormula::Imaging {
+
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+/// Widest instruction set this CPU and build can run.
+SimdLevel supportedSimdLevel();
+
+/// Instruction set the kernels use: supportedSimdLevel() unless lowered by setSimdLevel().
+SimdLevel simdLevel();
+
+/// Use at most `level` (clamped to what is supported), so tests and benchmarks can compare the
+/// kernels against the scalar code. Not meant to change while a kernel runs.
+void setSimdLevel(SimdLevel level);
+
+} // namespace XpressFormula::Imaging
@@ -0,0 +1,177 @@
+// ContourLines.cpp - Multi-level marching squares over an already sampled value grid.
+#include "ContourLines.h"
+#include <algorithm>
+#include <cmath>
+
+namespace XpressFormula::Plotting {
+
+ContourLines::ContourLines(std::pmr::memory_resource* resource)
+    : m_points(resource), m_polylines(resource), m_segments(resource), m_ends(resource),
+      m_links(resource), m_visited(resource) {}
+
+void ContourLines::evenLevels(double lo, double hi, int count, double* out) {
+    const double step = (hi - lo) / (count + 1);
+    for (int k = 0; k < count; ++k) {
+        out[k] = lo + (k + 1) * step;
+    }
+}
+
+void ContourLines::extract(const double* values, int nx, int ny, const double* levels, int levelCount) {
+    m_points.clear();
+    m_polylines.clear();
+    m_segments.clear();
+    if (nx < 2 || ny < 2 || levelCount <= 0) {
+        return;
+    }
+
+    // Edge ids: horizontal edges (ix, iy)-(ix+1, iy) first, then vertical (ix, iy)-(ix, iy+1).
+    const std::uint64_t horizontalEdges = static_cast<std::uint64_t>(nx - 1) * ny;
+    const std::uint64_t edgeCount = horizontalEdges + static_cast<std::uint64_t>(nx) * (ny - 1);
+    auto horizontal = [&](int ix, int iy) { return static_cast<std::uint64_t>(iy) * (nx - 1) + ix; };
+    auto vertical = [&](int ix, int iy) { return horizontalEdges + static_cast<std::uint64_t>(iy) * nx + ix; };
+
+    // One sweep over the cells; each emits at most two segments per level it spans.
+    for (int iy = 0; iy + 1 < ny; ++iy) {
+        const double* row = values + static_cast<size_t>(iy) * nx;
+        const double* next = row + nx;
+        for (int ix = 0; ix + 1 < nx; ++ix) {
+            const double v[4] = { row[ix], row[ix + 1], next[ix + 1], next[ix] };
+            if (!std::isfinite(v[0]) || !std::isfinite(v[1]) || !std::isfinite(v[2]) || !std::isfinite(v[3])) {
+                continue;
+            }
+            // A level L is crossed when some corner is above it and some is not: lo <= L < hi.
+            const double lo = std::min(std::min(v[0], v[1]), std::min(v[2], v[3]));
+            const double hi = std::max(std::max(v[0], v[1]), std::max(v[2], v[3]));
+            const int first = static_cast<int>(std::lower_bound(levels, levels + levelCount, lo) - levels);
+            const int last = static_cast<int>(std::lower_bound(levels + first, levels + levelCount, hi) - levels);
+            if (first == last) {
+                continue;
+            }
+
+            // Cell edges: bottom, right, top, left.
+            const std::uint64_t edges[4] = { horizontal(ix, iy), vertical(ix + 1, iy),
+                                             horizontal(ix, iy + 1), vertical(ix, iy) };
+            const double mean = 0.25 * (v[0] + v[1] + v[2] + v[3]);
+            for (int level = first; level < last; ++level) {
+                const double value = levels[level];
+                const int mask = (v[0] > value ? 1 : 0) | (v[1] > value ? 2 : 0) |
+                                 (v[2] > value ? 4 : 0) | (v[3] > value ? 8 : 0);
+                const std::uint64_t base = static_cast<std::uint64_t>(level) * edgeCount;
+                auto emit = [&](int a, int b) {
+                    m_segments.push_back(base + edges[a]);
+                    m_segments.push_back(base + edges[b]);
+                };
+                if (mask == 5 || mask == 10) {
+                    // Saddle: the mean decides which pair of opposite corners is connected.
+                    if ((mask == 5) == (mean > value)) {
+                        emit(0, 1);  // cut off corners 1 and 3
+                        emit(2, 3);
+                    } else {
+                        emit(3, 0);  // cut off corners 0 and 2
+                        emit(1, 2);
+                    }
+                    continue;
+                }
+                int crossed[2];
+                int count = 0;
+                for (int e = 0; e < 4; ++e) {
+                    const bool above = (mask >> e) & 1;
+                    const bool nextAbove = (mask >> ((e + 1) & 3)) & 1;
+                    if (above != nextAbove) {
+                        crossed[count++] = e;
+                    }
+                }
+                emit(crossed[0], crossed[1]);
+            }
+        }
+    }
+
+    const size_t segmentCount = m_segments.size() / 2;
+    if (segmentCount == 0) {
+        return;
+    }
+
+    // Join segment ends that share a crossing: each edge borders two cells, so a key occurs
+    // at most twice.
+    m_ends.resize(m_segments.size());
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        m_ends[i] = { m_segments[i], static_cast<std::uint32_t>(i) };
+    }
+    std::sort(m_ends.begin(), m_ends.end(), [](const SegmentEnd& a, const SegmentEnd& b) {
+        return (a.key != b.key) ? a.key < b.key : a.end < b.end;
+    });
+    m_links.assign(m_segments.size(), -1);
+    for (size_t i = 0; i + 1 < m_ends.size(); ++i) {
+        if (m_ends[i].key == m_ends[i + 1].key) {
+            m_links[m_ends[i].end] = m_ends[i + 1].end;
+            m_links[m_ends[i + 1].end] = m_ends[i].end;
+            ++i;
+        }
+    }
+
+    auto crossing = [&](std::uint64_t key) {
+        const auto level = static_cast<int>(key / edgeCount);
+        const std::uint64_t edge = key % edgeCount;
+        int ix0, iy0, ix1, iy1;
+        if (edge < horizontalEdges) {
+            iy0 = iy1 = static_cast<int>(edge / (nx - 1));
+            ix0 = static_cast<int>(edge % (nx - 1));
+            ix1 = ix0 + 1;
+        } else {
+            iy0 = static_cast<int>((edge - horizontalEdges) / nx);
+            ix0 = ix1 = static_cast<int>((edge - horizontalEdges) % nx);
+            iy1 = iy0 + 1;
+        }
+        const double v0 = values[static_cast<size_t>(iy0) * nx + ix0];
+        const double v1 = values[static_cast<size_t>(iy1) * nx + ix1];
+        // The ends lie on opposite sides of the level, so v0 != v1.
+        const double t = std::clamp((levels[level] - v0) / (v1 - v0), 0.0, 1.0);
+        return Core::Vec2(static_cast<float>(ix0 + (ix1 - ix0) * t),
+                          static_cast<float>(iy0 + (iy1 - iy0) * t));
+    };
+
+    // Walk from `end` (a segment end already emitted) along the chain of joined segments.
+    m_visited.assign(segmentCount, false);
+    auto walk = [&](std::int64_t end, Polyline& line) {
+        for (std::int64_t joined = m_links[end]; joined >= 0; joined = m_links[end]) {
+            const std::int64_t segment = joined / 2;
+            if (m_visited[segment]) {
+                // Back at the first segment: its start point was just emitted again.
+                m_points.pop_back();
+                --line.count;
+                line.closed = true;
+                return;
+            }
+            m_visited[segment] = true;
+            end = joined ^ 1;
+            m_points.push_back(crossing(m_segments[end]));
+            ++line.count;
+        }
+    };
+    auto trace = [&](size_t segment, int startEnd) {
+        Polyline line;
+        line.level = static_cast<int>(m_segments[segment * 2] / edgeCount);
+        line.first = static_cast<std::uint32_t>(m_points.size());
+        m_visited[segment] = true;
+        const std::int64_t start = static_cast<std::int64_t>(segment * 2) + startEnd;
+        m_points.push_back(crossing(m_segments[start]));
+        m_points.push_back(crossing(m_segments[start ^ 1]));
+        line.count = 2;
+        walk(start ^ 1, line);
+        m_polylines.push_back(line);
+    };
+
+    // Open lines first, from their free ends; every segment left after that lies on a loop.
+    for (size_t s = 0; s < segmentCount; ++s) {
+        if (!m_visited[s] && (m_links[s * 2] < 0 || m_links[s * 2 + 1] < 0)) {
+            trace(s, (m_links[s * 2] < 0) ? 0 : 1);
+        }
+    }
+    for (size_t s = 0; s < segmentCount; ++s) {
+        if (!m_visited[s]) {
+            trace(s, 0);
+        }
+    }
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,60 @@
+// ContourLines.h - Multi-level marching squares over an already sampled value grid.
+#pragma once
+
+#include "../Core/ViewTransform.h"
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Iso-lines of a sampled grid at many levels, extracted in one sweep and stitched into
+/// polylines.
+///
+/// Each cell of the grid is visited once. Its corner values bound the levels it can cross,
+/// so a binary search over the sorted levels gives the (usually short) range of levels to
+/// run marching squares for, and cells that cross none cost four compares. Saddle cells
+/// are resolved with the cell's mean value. Cells with a NaN/Inf corner are skipped, which
+/// breaks the lines there.
+///
+/// Crossings are keyed by (level, grid edge), so the two segments that meet on an edge share
+/// its key. Sorting the segment ends by key joins them into polylines: open ones end at the
+/// grid border or at a gap, and closed loops are flagged instead of repeating their first point.
+class ContourLines {
+public:
+    struct Polyline {
+        int level = 0;             // index into the levels passed to extract()
+        std::uint32_t first = 0;   // first point in points()
+        std::uint32_t count = 0;   // number of points
+        bool closed = false;       // the last point joins the first
+    };
+
+    /// Scratch and output storage come from `resource` (for example a FrameArena).
+    explicit ContourLines(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /// Extract the iso-lines of the nx*ny grid `values` (row-major, y rows) at `levels`, which
+    /// must be sorted ascending. Replaces the previous result.
+    void extract(const double* values, int nx, int ny, const double* levels, int levelCount);
+
+    /// Points in grid coordinates: (ix, iy) is sample ix of row iy, fractions lie between.
+    const std::pmr::vector<Core::Vec2>& points() const { return m_points; }
+    const std::pmr::vector<Polyline>& polylines() const { return m_polylines; }
+
+    /// `count` levels evenly spaced strictly inside (lo, hi), written to `out`.
+    static void evenLevels(double lo, double hi, int count, double* out);
+
+private:
+    struct SegmentEnd {
+        std::uint64_t key = 0;   // level * edgeCount + edge
+        std::uint32_t end = 0;   // segment * 2 + (0 or 1)
+    };
+
+    std::pmr::vector<Core::Vec2> m_points;
+    std::pmr::vector<Polyline> m_polylines;
+    std::pmr::vector<std::uint64_t> m_segments;  // two crossing keys per segment
+    std::pmr::vector<SegmentEnd> m_ends;         // sorted by key
+    std::pmr::vector<std::int64_t> m_links;      // segment end -> joined segment end, or -1
+    std::pmr::vector<bool> m_visited;
+};
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,316 @@
+// CurveAnalysis.cpp - Background roots, extrema and intersections of sampled 2D curves.
+#include "CurveAnalysis.h"
+#include "../Core/Evaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+bool sameFormulas(const std::vector<CurveAnalysis::Curve>& a, const std::vector<CurveAnalysis::Curve>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const CurveAnalysis::Curve& l, const CurveAnalysis::Curve& r) {
+                          return l.branches == r.branches;
+                      });
+}
+
+bool sameSamples(const std::vector<CurveAnalysis::Curve>& a, const std::vector<CurveAnalysis::Curve>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const CurveAnalysis::Curve& l, const CurveAnalysis::Curve& r) {
+                          return l.branches == r.branches && l.samples == r.samples;
+                      });
+}
+
+bool sameGrid(const CurveAnalysis::Samples& a, const CurveAnalysis::Samples& b) {
+    return a.xMin == b.xMin && a.dx == b.dx && !a.branches.empty() && !b.branches.empty() &&
+           a.branches.front().size() == b.branches.front().size();
+}
+
+// Isolated exact zero at sample i (a curve that is zero over a whole run has no single root).
+bool isolatedZero(const std::vector<double>& v, size_t i) {
+    return v[i] == 0.0 && (i == 0 || v[i - 1] != 0.0) && (i + 1 == v.size() || v[i + 1] != 0.0);
+}
+
+bool opposite(double a, double b) {
+    return (a < 0.0 && b > 0.0) || (a > 0.0 && b < 0.0);
+}
+
+} // namespace
+
+std::shared_ptr<const CurveAnalysis::Result> CurveAnalysis::request(const std::vector<Curve>& curves) {
+    if (curves.empty()) {
+        m_task.cancel();
+        m_curves.clear();
+        m_hasRequest = false;
+        m_ready.reset();
+        return nullptr;
+    }
+    if (m_hasRequest && sameSamples(curves, m_curves)) {
+        if (!m_current && m_task.finished()) {
+            m_ready = m_task.take();
+            m_current = true;
+        }
+        return m_ready;
+    }
+
+    m_task.cancel();
+    if (!sameFormulas(curves, m_curves)) {
+        m_ready.reset();
+    }
+    m_curves = curves;
+    m_hasRequest = true;
+    m_current = false;
+    // The worker analyses its own copy: the formulas and samples stay alive until it finishes.
+    m_task.start([curves](const std::atomic<bool>* cancel) { return analyze(curves, cancel); });
+    return m_ready;
+}
+
+std::shared_ptr<const CurveAnalysis::Result> CurveAnalysis::analyze(const std::vector<Curve>& curves,
+                                                                    const std::atomic<bool>* cancel) {
+    auto result = std::make_shared<Result>();
+    auto cancelled = [cancel]() { return cancel && cancel->load(std::memory_order_relaxed); };
+    auto add = [&](Kind kind, double x, double y, int curve, int other) {
+        if (result->features.size() >= kMaxFeatures) {
+            result->truncated = true;
+            return false;
+        }
+        result->features.push_back({ kind, x, y, curve, other });
+        return true;
+    };
+
+    Core::Evaluator::Variables vars;
+    auto evaluate = [&vars](const Core::ASTNodePtr& g, double x) {
+        vars["x"] = x;
+        return Core::Evaluator::evaluate(g, vars);
+    };
+
+    for (size_t c = 0; c < curves.size(); ++c) {
+        const Curve& curve = curves[c];
+        if (!curve.samples || curve.samples->branches.size() != curve.branches.size()) {
+            continue;
+        }
+        const Samples& samples = *curve.samples;
+        const double tolerance = std::abs(samples.dx) * 1e-9;
+        auto xAt = [&samples](size_t i) { return samples.xMin + static_cast<double>(i) * samples.dx; };
+
+        for (size_t b = 0; b < curve.branches.size(); ++b) {
+            const Core::ASTNodePtr& g = curve.branches[b];
+            const std::vector<double>& v = samples.branches[b];
+            auto f = [&](double x) { return evaluate(g, x); };
+
+            // Roots: sign changes between neighbouring samples. A pole changes sign too, but
+            // there |g| grows instead of shrinking towards the refined point.
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (cancelled()) return nullptr;
+                if (isolatedZero(v, i)) {
+                    if (!add(Kind::Root, xAt(i), 0.0, static_cast<int>(c), -1)) return result;
+                    continue;
+                }
+                if (i + 1 == v.size() || !opposite(v[i], v[i + 1])) continue;
+                const double x = findRoot(f, xAt(i), xAt(i + 1), v[i], v[i + 1], tolerance);
+                const double y = f(x);
+                if (std::isfinite(y) && std::abs(y) < std::min(std::abs(v[i]), std::abs(v[i + 1]))) {
+                    if (!add(Kind::Root, x, 0.0, static_cast<int>(c), -1)) return result;
+                }
+            }
+
+            // Extrema: the sampled slope changes sign around sample i. The refined value may
+            // exceed the sample by at most a fraction of the neighbouring drop for a smooth
+            // peak; far more means the bracket straddles a pole.
+            for (size_t i = 1; i + 1 < v.size(); ++i) {
+                if (cancelled()) return nullptr;
+                const double before = v[i] - v[i - 1];
+                const double after = v[i + 1] - v[i];
+                if (!std::isfinite(before) || !std::isfinite(after) || !opposite(before, after)) continue;
+                const bool maximum = before > 0.0;
+                const double sign = maximum ? -1.0 : 1.0;
+                const double x = findMinimum([&](double t) { return sign * f(t); },
+                                             xAt(i - 1), xAt(i + 1), tolerance);
+                const double y = f(x);
+                const double drop = std::max(std::abs(before), std::abs(after));
+                if (std::isfinite(y) && sign * (v[i] - y) <= drop) {
+                    if (!add(maximum ? Kind::Maximum : Kind::Minimum, x, y, static_cast<int>(c), -1)) {
+                        return result;
+                    }
+                }
+            }
+        }
+    }
+
+    // Intersections: sign changes of the difference of two curves' branches on the shared grid.
+    for (size_t c1 = 0; c1 < curves.size(); ++c1) {
+        for (size_t c2 = c1 + 1; c2 < curves.size(); ++c2) {
+            const Curve& first = curves[c1];
+            const Curve& second = curves[c2];
+            if (!first.samples || !second.samples || !sameGrid(*first.samples, *second.samples) ||
+                first.samples->branches.size() != first.branches.size() ||
+                second.samples->branches.size() != second.branches.size()) {
+                continue;
+            }
+            const Samples& samples = *first.samples;
+            const double tolerance = std::abs(samples.dx) * 1e-9;
+            for (size_t b1 = 0; b1 < first.branches.size(); ++b1) {
+                for (size_t b2 = 0; b2 < second.branches.size(); ++b2) {
+                    if (cancelled()) return nullptr;
+                    const std::vector<double>& v1 = samples.branches[b1];
+                    const std::vector<double>& v2 = second.samples->branches[b2];
+                    std::vector<double> h(v1.size());
+                    for (size_t i = 0; i < h.size(); ++i) h[i] = v1[i] - v2[i];
+                    auto difference = [&](double x) {
+                        return evaluate(first.branches[b1], x) - evaluate(second.branches[b2], x);
+                    };
+                    for (size_t i = 0; i < h.size(); ++i) {
+                        const double x0 = samples.xMin + static_cast<double>(i) * samples.dx;
+                        if (isolatedZero(h, i)) {
+                            if (!add(Kind::Intersection, x0, v1[i], static_cast<int>(c1), static_cast<int>(c2))) {
+                                return result;
+                            }
+                            continue;
+                        }
+                        if (i + 1 == h.size() || !opposite(h[i], h[i + 1])) continue;
+                        const double x = findRoot(difference, x0, x0 + samples.dx, h[i], h[i + 1], tolerance);
+                        const double d = difference(x);
+                        if (std::isfinite(d) && std::abs(d) < std::min(std::abs(h[i]), std::abs(h[i + 1]))) {
+                            const double y = evaluate(first.branches[b1], x);
+                            if (!add(Kind::Intersection, x, y, static_cast<int>(c1), static_cast<int>(c2))) {
+                                return result;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+double CurveAnalysis::findRoot(const std::function<double(double)>& f, double a, double b,
+                               double fa, double fb, double tolerance) {
+    constexpr double kEpsilon = std::numeric_limits<double>::epsilon();
+    double c = b;
+    double fc = fb;
+    double d = b - a;
+    double e = d;
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        if ((fb > 0.0) == (fc > 0.0)) {
+            // Keep the root between b and c.
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (std::abs(fc) < std::abs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+        const double tol = 2.0 * kEpsilon * std::abs(b) + 0.5 * tolerance;
+        const double mid = 0.5 * (c - b);
+        if (std::abs(mid) <= tol || fb == 0.0) {
+            return b;
+        }
+        if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) {
+            // Inverse quadratic interpolation (secant when only two points are distinct).
+            const double s = fb / fa;
+            double p;
+            double q;
+            if (a == c) {
+                p = 2.0 * mid * s;
+                q = 1.0 - s;
+            } else {
+                const double qa = fa / fc;
+                const double r = fb / fc;
+                p = s * (2.0 * mid * qa * (qa - r) - (b - a) * (r - 1.0));
+                q = (qa - 1.0) * (r - 1.0) * (s - 1.0);
+            }
+            if (p > 0.0) q = -q;
+            p = std::abs(p);
+            if (2.0 * p < std::min(3.0 * mid * q - std::abs(tol * q), std::abs(e * q))) {
+                e = d;
+                d = p / q;
+            } else {
+                d = mid;
+                e = d;
+            }
+        } else {
+            d = mid;
+            e = d;
+        }
+        a = b;
+        fa = fb;
+        b += (std::abs(d) > tol) ? d : std::copysign(tol, mid);
+        fb = f(b);
+        if (!std::isfinite(fb)) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return b;
+}
+
+double CurveAnalysis::findMinimum(const std::function<double(double)>& f, double a, double b,
+                                  double tolerance) {
+    constexpr double kGolden = 0.3819660112501051;  // (3 - sqrt(5)) / 2
+    const double relative = std::sqrt(std::numeric_limits<double>::epsilon());
+    auto value = [&f](double x) {
+        const double y = f(x);
+        return std::isnan(y) ? std::numeric_limits<double>::infinity() : y;
+    };
+    if (a > b) std::swap(a, b);
+    double x = a + kGolden * (b - a);
+    double w = x;
+    double v = x;
+    double fx = value(x);
+    double fw = fx;
+    double fv = fx;
+    double d = 0.0;
+    double e = 0.0;
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        const double mid = 0.5 * (a + b);
+        const double tol1 = relative * std::abs(x) + tolerance;
+        const double tol2 = 2.0 * tol1;
+        if (std::abs(x - mid) <= tol2 - 0.5 * (b - a)) {
+            break;
+        }
+        bool golden = true;
+        if (std::abs(e) > tol1) {
+            // Parabola through x, w and v.
+            const double r = (x - w) * (fx - fv);
+            double q = (x - v) * (fx - fw);
+            double p = (x - v) * q - (x - w) * r;
+            q = 2.0 * (q - r);
+            if (q > 0.0) p = -p;
+            q = std::abs(q);
+            const double previous = e;
+            e = d;
+            if (std::abs(p) < std::abs(0.5 * q * previous) && p > q * (a - x) && p < q * (b - x)) {
+                d = p / q;
+                const double u = x + d;
+                if (u - a < tol2 || b - u < tol2) d = std::copysign(tol1, mid - x);
+                golden = false;
+            }
+        }
+        if (golden) {
+            e = (x >= mid) ? a - x : b - x;
+            d = kGolden * e;
+        }
+        const double u = (std::abs(d) >= tol1) ? x + d : x + std::copysign(tol1, d);
+        const double fu = value(u);
+        if (fu <= fx) {
+            (u >= x ? a : b) = x;
+            v = w; fv = fw;
+            w = x; fw = fx;
+            x = u; fx = fu;
+        } else {
+            (u < x ? a : b) = u;
+            if (fu <= fw || w == x) {
+                v = w; fv = fw;
+                w = u; fw = fu;
+            } else if (fu <= fv || v == x || v == w) {
+                v = u; fv = fu;
+            }
+        }
+    }
+    return x;
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,88 @@
+// CurveAnalysis.h - Background roots, extrema and intersections of sampled 2D curves.
+#pragma once
+
+#include "../Core/ASTNode.h"
+#include "../Core/BackgroundTask.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Finds the zeros, local extrema and pairwise intersections of the visible y = g(x) curves.
+/// Brackets come from the samples drawCurve2D already took for the view (sign changes of g,
+/// of the sampled slope, and of the difference of two curves); each bracket is then refined
+/// with Brent's method on the formula itself, so a feature costs a few dozen evaluations rather
+/// than a denser resampling. Analysis runs on a background thread and is redone only when the
+/// samples change.
+class CurveAnalysis {
+public:
+    /// Values of each branch of a curve at x = xMin + i * dx (NaN where undefined). Every
+    /// curve drawn for the same view shares the grid.
+    struct Samples {
+        double xMin = 0.0;
+        double dx = 0.0;
+        std::vector<std::vector<double>> branches;
+    };
+
+    struct Curve {
+        std::vector<Core::ASTNodePtr> branches;  // y = g(x), parallel to samples->branches
+        std::shared_ptr<const Samples> samples;
+    };
+
+    enum class Kind : std::uint8_t { Root, Minimum, Maximum, Intersection };
+
+    struct Feature {
+        Kind kind = Kind::Root;
+        double x = 0.0;
+        double y = 0.0;
+        int curve = 0;   // index into the analysed curves
+        int other = -1;  // second curve of an intersection
+    };
+
+    struct Result {
+        std::vector<Feature> features;
+        bool truncated = false;  // stopped at kMaxFeatures
+    };
+
+    /// Most features one analysis reports (a fast oscillation can have thousands of extrema).
+    static constexpr size_t kMaxFeatures = 2048;
+
+    CurveAnalysis() = default;
+    CurveAnalysis(const CurveAnalysis&) = delete;
+    CurveAnalysis& operator=(const CurveAnalysis&) = delete;
+
+    /// Features of `curves`. New samples start a new pass and cancel the one in flight; until it
+    /// finishes, the previous result is returned when it was computed for the same formulas
+    /// (features are in world coordinates, so they stay valid while only the view moves), and
+    /// null otherwise.
+    std::shared_ptr<const Result> request(const std::vector<Curve>& curves);
+
+    /// True while the result for the latest request is still being computed.
+    bool pending() const { return m_hasRequest && !m_current; }
+
+    /// Analyse synchronously. Returns null when `cancel` becomes true before completion.
+    static std::shared_ptr<const Result> analyze(const std::vector<Curve>& curves,
+                                                 const std::atomic<bool>* cancel = nullptr);
+
+    /// Zero of f in [a, b], given f(a) = fa and f(b) = fb of opposite signs, by Brent's method
+    /// (inverse quadratic interpolation and secant steps, falling back to bisection).
+    static double findRoot(const std::function<double(double)>& f, double a, double b,
+                           double fa, double fb, double tolerance);
+
+    /// Local minimum of f in [a, b] by Brent's method (parabolic steps, falling back to golden
+    /// section). NaN values count as +infinity.
+    static double findMinimum(const std::function<double(double)>& f, double a, double b,
+                              double tolerance);
+
+private:
+    std::vector<Curve> m_curves;
+    bool m_hasRequest = false;
+    bool m_current = false;  // m_ready belongs to m_curves
+    std::shared_ptr<const Result> m_ready;
+    Core::BackgroundTask<Result> m_task;
+};
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,95 @@
+// CurveIndex.cpp - Uniform-grid index over the screen-space segments of a sampled 2D curve.
+#include "CurveIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace XpressFormula::Plotting {
+
+CurveIndex::CurveIndex(std::vector<Segment> segments, float left, float top, float width, float height)
+    : m_segments(std::move(segments)),
+      m_left(left),
+      m_top(top),
+      m_cols(std::max(1, static_cast<int>(std::ceil(width / kCellSize)))),
+      m_rows(std::max(1, static_cast<int>(std::ceil(height / kCellSize)))) {
+    // Counting sort of (cell, segment) pairs: count per cell, prefix-sum, then scatter.
+    const size_t cellCount = static_cast<size_t>(m_cols) * m_rows;
+    m_cellStart.assign(cellCount + 1, 0);
+    auto forEachCell = [&](const Segment& s, auto&& visit) {
+        const int cx0 = cellX(std::min(s.x0, s.x1));
+        const int cx1 = cellX(std::max(s.x0, s.x1));
+        const int cy0 = cellY(std::min(s.y0, s.y1));
+        const int cy1 = cellY(std::max(s.y0, s.y1));
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                visit(static_cast<size_t>(cy) * m_cols + cx);
+            }
+        }
+    };
+    for (const Segment& s : m_segments) {
+        forEachCell(s, [&](size_t cell) { ++m_cellStart[cell + 1]; });
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        m_cellStart[c + 1] += m_cellStart[c];
+    }
+    m_cellSegments.resize(m_cellStart[cellCount]);
+    std::vector<std::uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        forEachCell(m_segments[i], [&](size_t cell) {
+            m_cellSegments[fill[cell]++] = static_cast<std::uint32_t>(i);
+        });
+    }
+}
+
+int CurveIndex::cellX(float x) const {
+    const float c = std::floor((x - m_left) / kCellSize);
+    return static_cast<int>(std::clamp(c, 0.0f, static_cast<float>(m_cols - 1)));
+}
+
+int CurveIndex::cellY(float y) const {
+    const float c = std::floor((y - m_top) / kCellSize);
+    return static_cast<int>(std::clamp(c, 0.0f, static_cast<float>(m_rows - 1)));
+}
+
+bool CurveIndex::nearest(float x, float y, float radius, Hit& hit) const {
+    if (m_segments.empty() || !std::isfinite(x) || !std::isfinite(y)) {
+        return false;
+    }
+    float best = radius * radius;
+    bool found = false;
+    const int cx0 = cellX(x - radius);
+    const int cx1 = cellX(x + radius);
+    const int cy0 = cellY(y - radius);
+    const int cy1 = cellY(y + radius);
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            const size_t cell = static_cast<size_t>(cy) * m_cols + cx;
+            for (std::uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                const std::uint32_t i = m_cellSegments[k];
+                const Segment& s = m_segments[i];
+                const float dx = s.x1 - s.x0;
+                const float dy = s.y1 - s.y0;
+                const float lengthSq = dx * dx + dy * dy;
+                float t = (lengthSq > 0.0f) ? ((x - s.x0) * dx + (y - s.y0) * dy) / lengthSq : 0.0f;
+                t = std::clamp(t, 0.0f, 1.0f);
+                const float px = s.x0 + t * dx;
+                const float py = s.y0 + t * dy;
+                const float distSq = (px - x) * (px - x) + (py - y) * (py - y);
+                // Segments in several cells are seen more than once; the result is the same.
+                if (distSq <= best) {
+                    best = distSq;
+                    hit.segment = i;
+                    hit.branch = s.branch;
+                    hit.x = px;
+                    hit.y = py;
+                    found = true;
+                }
+            }
+        }
+    }
+    if (found) {
+        hit.distance = std::sqrt(best);
+    }
+    return found;
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,56 @@
+// CurveIndex.h - Uniform-grid index over the screen-space segments of a sampled 2D curve.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Answers "which segment of this curve is nearest to the cursor" without scanning every
+/// sample. Segments are bucketed into square screen cells of kCellSize pixels (a segment goes
+/// into every cell its bounding box overlaps), stored as one flat array with per-cell offsets.
+/// A query visits only the cells within its search radius, so its cost follows the curve's
+/// density near the cursor rather than its sample count.
+class CurveIndex {
+public:
+    struct Segment {
+        float x0;
+        float y0;
+        float x1;
+        float y1;
+        std::uint32_t branch;  // solution branch the segment belongs to
+    };
+
+    struct Hit {
+        std::uint32_t segment = 0;
+        std::uint32_t branch = 0;
+        float distance = 0.0f;  // pixels from the query point to the segment
+        float x = 0.0f;         // closest point on the segment
+        float y = 0.0f;
+    };
+
+    static constexpr float kCellSize = 16.0f;
+
+    /// Index `segments` over the screen rectangle [left, left + width) x [top, top + height).
+    /// Segments outside the rectangle are kept but clamped into its border cells.
+    CurveIndex(std::vector<Segment> segments, float left, float top, float width, float height);
+
+    /// Nearest segment within `radius` pixels of (x, y). Returns false when there is none.
+    bool nearest(float x, float y, float radius, Hit& hit) const;
+
+    const std::vector<Segment>& segments() const { return m_segments; }
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+
+    std::vector<Segment> m_segments;
+    float m_left = 0.0f;
+    float m_top = 0.0f;
+    int m_cols = 1;
+    int m_rows = 1;
+    std::vector<std::uint32_t> m_cellStart;  // m_cols * m_rows + 1 offsets into m_cellSegments
+    std::vector<std::uint32_t> m_cellSegments;
+};
+
+} // namespace XpressFormula::Plotting
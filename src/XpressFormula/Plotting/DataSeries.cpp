@@ -0,0 +1,285 @@
+// DataSeries.cpp - Measured y(x) series with a min/max pyramid for per-pixel decimation.
+#include "DataSeries.h"
+#include "SeriesDecimation.h"
+#include "../Core/TaskPool.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+// Text is split into chunks of about this many bytes, parsed in parallel.
+constexpr std::size_t kParseChunkBytes = 1u << 20;
+// Level-0 pyramid blocks built per parallel task.
+constexpr std::size_t kBuildBlocksPerTask = 1u << 14;
+
+bool isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+// Parse "x<sep>y..." lines of [begin, end) into xs/ys, skipping lines without two numbers.
+void parseLines(const char* begin, const char* end, std::vector<double>& xs, std::vector<double>& ys) {
+    const char* p = begin;
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        while (p < lineEnd && (*p == ' ' || *p == '\t')) ++p;
+        double x = 0.0;
+        double y = 0.0;
+        auto parsedX = std::from_chars(p, lineEnd, x);
+        if (parsedX.ec == std::errc() && parsedX.ptr < lineEnd && isSeparator(*parsedX.ptr)) {
+            p = parsedX.ptr;
+            while (p < lineEnd && isSeparator(*p)) ++p;
+            auto parsedY = std::from_chars(p, lineEnd, y);
+            if (parsedY.ec == std::errc()) {
+                xs.push_back(x);
+                ys.push_back(y);
+            }
+        }
+        p = lineEnd + 1;
+    }
+}
+
+bool hasExtension(const std::string& path, const char* extension) {
+    const std::size_t length = std::strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    return std::equal(path.end() - static_cast<std::ptrdiff_t>(length), path.end(), extension,
+                      [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+}
+
+} // namespace
+
+DataSeries::Summary DataSeries::Summary::combine(const Summary& first, const Summary& second) {
+    if (first.empty()) return second;
+    if (second.empty()) return first;
+    const bool minFromFirst = first.yMin <= second.yMin;
+    const bool maxFromFirst = first.yMax >= second.yMax;
+    Summary s;
+    s.yMin = minFromFirst ? first.yMin : second.yMin;
+    s.yMax = maxFromFirst ? first.yMax : second.yMax;
+    if (minFromFirst == maxFromFirst) {
+        s.minFirst = minFromFirst ? first.minFirst : second.minFirst;
+    } else {
+        s.minFirst = minFromFirst;
+    }
+    return s;
+}
+
+std::shared_ptr<const DataSeries> DataSeries::fromPoints(std::vector<double> xs, std::vector<double> ys) {
+    std::shared_ptr<DataSeries> series(new DataSeries());
+    const std::size_t count = std::min(xs.size(), ys.size());
+    xs.resize(count);
+    ys.resize(count);
+    // NaN x compares false both ways, so is_sorted alone would not reject it.
+    const bool ordered = std::is_sorted(xs.begin(), xs.end()) &&
+                         std::none_of(xs.begin(), xs.end(), [](double v) { return std::isnan(v); });
+    if (!ordered) {
+        std::vector<std::size_t> order;
+        order.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!std::isnan(xs[i])) order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::size_t a, std::size_t b) { return xs[a] < xs[b]; });
+        series->m_ownedX.resize(order.size());
+        series->m_ownedY.resize(order.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            series->m_ownedX[i] = xs[order[i]];
+            series->m_ownedY[i] = ys[order[i]];
+        }
+    } else {
+        series->m_ownedX = std::move(xs);
+        series->m_ownedY = std::move(ys);
+    }
+    series->setPoints(series->m_ownedX.data(), series->m_ownedY.data(), series->m_ownedX.size(), 1);
+    return series;
+}
+
+std::shared_ptr<const DataSeries> DataSeries::load(const std::string& path, std::string& error) {
+    // Text and unsorted binary files are copied out and the mapping is released with this
+    // object; sorted binary files are read through it for the life of the series.
+    std::shared_ptr<DataSeries> series(new DataSeries());
+    if (!series->m_file.open(path, error)) {
+        return nullptr;
+    }
+    const std::size_t bytes = series->m_file.size();
+
+    if (hasExtension(path, ".bin") || hasExtension(path, ".f64")) {
+        if constexpr (std::endian::native != std::endian::little) {
+            error = "Binary series need a little-endian host.";
+            return nullptr;
+        }
+        if (bytes % (2 * sizeof(double)) != 0) {
+            error = "Binary series must hold float64 (x, y) pairs (size is not a multiple of 16 bytes).";
+            return nullptr;
+        }
+        const std::size_t count = bytes / (2 * sizeof(double));
+        if (count == 0) {
+            error = "No data points in " + path;
+            return nullptr;
+        }
+        // The mapping is page-aligned, so the doubles can be read in place.
+        const double* values = reinterpret_cast<const double*>(series->m_file.data());
+        bool ordered = !std::isnan(values[0]);
+        for (std::size_t i = 1; i < count && ordered; ++i) {
+            ordered = values[2 * i - 2] <= values[2 * i];
+        }
+        if (!ordered) {
+            std::vector<double> xs(count);
+            std::vector<double> ys(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                xs[i] = values[2 * i];
+                ys[i] = values[2 * i + 1];
+            }
+            return fromPoints(std::move(xs), std::move(ys));
+        }
+        series->setPoints(values, values + 1, count, 2);
+        return series;
+    }
+
+    // Text: cut the file into chunks at line starts and parse them in parallel.
+    const char* text = reinterpret_cast<const char*>(series->m_file.data());
+    const std::size_t chunkCount = std::max<std::size_t>(1, bytes / kParseChunkBytes);
+    std::vector<std::size_t> starts(chunkCount + 1, bytes);
+    starts[0] = 0;
+    for (std::size_t k = 1; k < chunkCount; ++k) {
+        std::size_t start = std::max(starts[k - 1], k * bytes / chunkCount);
+        const void* newline = (start < bytes) ? std::memchr(text + start, '\n', bytes - start) : nullptr;
+        starts[k] = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - text) + 1 : bytes;
+    }
+    std::vector<std::vector<double>> chunkX(chunkCount);
+    std::vector<std::vector<double>> chunkY(chunkCount);
+    Core::TaskPool::shared().parallelFor(chunkCount, [&](std::size_t k) {
+        parseLines(text + starts[k], text + starts[k + 1], chunkX[k], chunkY[k]);
+    });
+    std::size_t total = 0;
+    for (const std::vector<double>& xs : chunkX) total += xs.size();
+    if (total == 0) {
+        error = "No data points in " + path;
+        return nullptr;
+    }
+    std::vector<double> xs;
+    std::vector<double> ys;
+    xs.reserve(total);
+    ys.reserve(total);
+    for (std::size_t k = 0; k < chunkCount; ++k) {
+        xs.insert(xs.end(), chunkX[k].begin(), chunkX[k].end());
+        ys.insert(ys.end(), chunkY[k].begin(), chunkY[k].end());
+    }
+    return fromPoints(std::move(xs), std::move(ys));
+}
+
+void DataSeries::setPoints(const double* x, const double* y, std::size_t count, std::size_t stride) {
+    m_x = x;
+    m_y = y;
+    m_size = count;
+    m_stride = stride;
+    buildPyramid();
+    m_bounds = summarize(0, m_size);
+}
+
+DataSeries::Summary DataSeries::item(std::size_t level, std::size_t index) const {
+    if (level > 0) {
+        return m_levels[level - 1][index];
+    }
+    const double v = y(index);
+    Summary s;
+    if (!std::isnan(v)) {
+        s.yMin = v;
+        s.yMax = v;
+    }
+    return s;
+}
+
+void DataSeries::buildPyramid() {
+    m_levels.clear();
+    std::size_t count = m_size;
+    for (std::size_t level = 0; count > 1; ++level) {
+        const std::size_t blocks = (count + kFanout - 1) / kFanout;
+        std::vector<Summary> summaries(blocks);
+        auto build = [&](std::size_t firstBlock, std::size_t lastBlock) {
+            for (std::size_t b = firstBlock; b < lastBlock; ++b) {
+                Summary s;
+                const std::size_t end = std::min(count, (b + 1) * kFanout);
+                for (std::size_t i = b * kFanout; i < end; ++i) {
+                    s = Summary::combine(s, item(level, i));
+                }
+                summaries[b] = s;
+            }
+        };
+        if (blocks > kBuildBlocksPerTask) {
+            const std::size_t tasks = (blocks + kBuildBlocksPerTask - 1) / kBuildBlocksPerTask;
+            Core::TaskPool::shared().parallelFor(tasks, [&](std::size_t t) {
+                build(t * kBuildBlocksPerTask, std::min(blocks, (t + 1) * kBuildBlocksPerTask));
+            });
+        } else {
+            build(0, blocks);
+        }
+        m_levels.push_back(std::move(summaries));
+        count = blocks;
+    }
+}
+
+std::size_t DataSeries::lowerBound(double value) const {
+    return lowerBound(value, 0, m_size);
+}
+
+std::size_t DataSeries::lowerBound(double value, std::size_t first, std::size_t last) const {
+    while (first < last) {
+        const std::size_t mid = first + (last - first) / 2;
+        if (x(mid) < value) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+std::size_t DataSeries::upperBound(double value, std::size_t first, std::size_t last) const {
+    while (first < last) {
+        const std::size_t mid = first + (last - first) / 2;
+        if (x(mid) <= value) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+DataSeries::Summary DataSeries::summarize(std::size_t first, std::size_t last) const {
+    // Walk up the pyramid: peel items off both ends until the range is block-aligned, then
+    // continue one level coarser. `left` grows rightwards and `right` leftwards, so the
+    // summaries are combined in data order.
+    Summary left;
+    Summary right;
+    std::size_t lo = first;
+    std::size_t hi = std::min(last, m_size);
+    for (std::size_t level = 0; lo < hi; ++level) {
+        if (level == m_levels.size()) {
+            for (; lo < hi; ++lo) left = Summary::combine(left, item(level, lo));
+            break;
+        }
+        while (lo < hi && lo % kFanout != 0) left = Summary::combine(left, item(level, lo++));
+        while (lo < hi && hi % kFanout != 0) right = Summary::combine(item(level, --hi), right);
+        lo /= kFanout;
+        hi /= kFanout;
+    }
+    return Summary::combine(left, right);
+}
+
+void DataSeries::decimate(const Core::ViewTransform& vt, std::pmr::vector<Core::Vec2>& out) const {
+    decimateSeries(*this, vt, out);
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,97 @@
+// DataSeries.h - Measured y(x) series with a min/max pyramid for per-pixel decimation.
+#pragma once
+
+#include "../Core/MappedFile.h"
+#include "../Core/ViewTransform.h"
+#include "FileLoader.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// A series of (x, y) points sorted by x, drawn as a polyline next to the formulas.
+///
+/// Drawing tens of millions of points as segments costs far more than the pixels they cover,
+/// so the series keeps a pyramid of y extremes: level 0 summarises blocks of kFanout points,
+/// each higher level blocks of kFanout summaries. Any index range is summarised in
+/// O(kFanout log n), and decimate() reduces the view to the minimum and maximum of each pixel
+/// column: at most two vertices per column, and the same picture as drawing every point.
+class DataSeries {
+public:
+    /// y extremes of a run of points. `minFirst` keeps their order, so the polyline through a
+    /// column's extremes runs the way the data does.
+    struct Summary {
+        double yMin = std::numeric_limits<double>::infinity();
+        double yMax = -std::numeric_limits<double>::infinity();
+        bool minFirst = true;
+
+        bool empty() const { return !(yMin <= yMax); }
+        /// Summary of `first` followed by `second`.
+        static Summary combine(const Summary& first, const Summary& second);
+    };
+
+    static constexpr std::size_t kFanout = 8;
+
+    /// Load a series from a file.
+    ///
+    /// - `.bin` / `.f64`: interleaved little-endian float64 (x, y) pairs. When x is already
+    ///   sorted the points are read in place from the memory mapping, without a copy.
+    /// - anything else is text (CSV): one point per line, x and y separated by a comma,
+    ///   semicolon, tab or spaces. Lines that do not start with two numbers (headers,
+    ///   comments) are skipped. Chunks of the file are parsed in parallel.
+    ///
+    /// Points with a NaN x are dropped, unsorted input is sorted by x, and a NaN y breaks the
+    /// line. Returns null and sets `error` on failure.
+    static std::shared_ptr<const DataSeries> load(const std::string& path, std::string& error);
+
+    /// Series over the given points (same sorting rules as load()).
+    static std::shared_ptr<const DataSeries> fromPoints(std::vector<double> xs, std::vector<double> ys);
+
+    std::size_t size() const { return m_size; }
+    double x(std::size_t i) const { return m_x[i * m_stride]; }
+    double y(std::size_t i) const { return m_y[i * m_stride]; }
+
+    /// Extremes of the whole series (empty when every y is NaN).
+    const Summary& bounds() const { return m_bounds; }
+
+    /// Index of the first point with x >= value (size() when there is none).
+    std::size_t lowerBound(double value) const;
+    /// First index in [first, last) with x >= value (last when there is none).
+    std::size_t lowerBound(double value, std::size_t first, std::size_t last) const;
+    /// First index in [first, last) with x > value (last when there is none).
+    std::size_t upperBound(double value, std::size_t first, std::size_t last) const;
+
+    /// y extremes of the points [first, last), NaN values ignored.
+    Summary summarize(std::size_t first, std::size_t last) const;
+
+    /// Screen-space polyline of the series for the view: the points themselves while there are
+    /// at most two per pixel column, otherwise each column's extremes, plus the nearest point
+    /// beyond either edge so the line reaches them. NaN vertices separate the runs to draw.
+    void decimate(const Core::ViewTransform& vt, std::pmr::vector<Core::Vec2>& out) const;
+
+private:
+    DataSeries() = default;
+    void setPoints(const double* x, const double* y, std::size_t count, std::size_t stride);
+    void buildPyramid();
+    Summary item(std::size_t level, std::size_t index) const;
+
+    Core::MappedFile m_file;  // backs m_x/m_y when read in place
+    std::vector<double> m_ownedX;
+    std::vector<double> m_ownedY;
+    const double* m_x = nullptr;
+    const double* m_y = nullptr;
+    std::size_t m_stride = 1;
+    std::size_t m_size = 0;
+    std::vector<std::vector<Summary>> m_levels;  // m_levels[k] summarises kFanout^(k+1) points
+    Summary m_bounds;
+};
+
+/// Background loads of data series files, kept while each file is unchanged.
+using DataSeriesLoader = FileLoader<DataSeries>;
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,123 @@
+// FileLoader.h - Background loading of the files named by data:/scatter: entries.
+#pragma once
+
+#include "../Core/TaskPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Loads files with `T::load(path, error)` on background threads, so entering a path never
+/// stalls the UI. A loaded value is kept while its file keeps the same size and modification
+/// time, so the same path entered again (or re-parsed after an unrelated edit) is not read
+/// twice. Used from the UI thread only.
+template <typename T>
+class FileLoader {
+public:
+    /// One load of a file. `value` and `error` are written before `done` is set.
+    struct Load {
+        std::atomic<bool> done{ false };
+        std::shared_ptr<const T> value;
+        std::string error;
+    };
+
+    FileLoader() = default;
+    ~FileLoader() {  // waits for the loads in flight
+        for (Worker& worker : m_workers) {
+            worker.thread.join();
+        }
+    }
+    FileLoader(const FileLoader&) = delete;
+    FileLoader& operator=(const FileLoader&) = delete;
+
+    static FileLoader& shared() {
+        Core::TaskPool::shared();  // constructed first so it outlives the loads joined at exit
+        static FileLoader loader;
+        return loader;
+    }
+
+    /// The load of `path` as the file is now: the kept one, or a new one started in the
+    /// background. Poll `done` before reading the result.
+    std::shared_ptr<const Load> request(const std::string& path);
+
+private:
+    // Finished loads kept while no formula shows their value.
+    static constexpr std::size_t kMaxKept = 8;
+
+    struct Entry {
+        std::filesystem::file_time_type modified;
+        std::uintmax_t size = 0;
+        std::shared_ptr<Load> load;
+        std::uint64_t lastUse = 0;
+    };
+    struct Worker {
+        std::thread thread;
+        std::shared_ptr<const Load> load;
+    };
+
+    std::unordered_map<std::string, Entry> m_entries;
+    std::vector<Worker> m_workers;
+    std::uint64_t m_requests = 0;
+};
+
+template <typename T>
+std::shared_ptr<const typename FileLoader<T>::Load> FileLoader<T>::request(const std::string& path) {
+    std::erase_if(m_workers, [](Worker& worker) {
+        if (!worker.load->done.load(std::memory_order_acquire)) {
+            return false;
+        }
+        worker.thread.join();
+        return true;
+    });
+
+    // A file that cannot be inspected is loaded like any other, so the load reports why; it
+    // is kept until the file appears.
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    const std::uintmax_t size = ec ? 0 : std::filesystem::file_size(path, ec);
+
+    Entry& entry = m_entries[path];
+    entry.lastUse = ++m_requests;
+    if (entry.load && entry.modified == modified && entry.size == size) {
+        return entry.load;
+    }
+    entry.modified = modified;
+    entry.size = size;
+    entry.load = std::make_shared<Load>();
+    std::shared_ptr<Load> load = entry.load;
+    m_workers.push_back({ std::thread([load, path]() {
+                              load->value = T::load(path, load->error);
+                              load->done.store(true, std::memory_order_release);
+                          }),
+                          load });
+
+    // Forget the least recently requested finished loads whose value nothing else holds.
+    auto unused = [](const Entry& kept) {
+        return kept.load->done.load(std::memory_order_acquire) && kept.load->value.use_count() <= 1;
+    };
+    std::size_t unusedCount = 0;
+    for (const auto& [key, kept] : m_entries) {
+        unusedCount += unused(kept);
+    }
+    for (; unusedCount > kMaxKept; --unusedCount) {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (unused(it->second) && (oldest == m_entries.end() || it->second.lastUse < oldest->second.lastUse)) {
+                oldest = it;
+            }
+        }
+        m_entries.erase(oldest);
+    }
+    return load;
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,70 @@
+// FrameArena.cpp - Frame-scoped monotonic allocator implementation.
+#include "FrameArena.h"
+#include <algorithm>
+
+namespace XpressFormula::Plotting {
+
+FrameArena::FrameArena(std::size_t initialBytes) {
+    if (initialBytes > 0) {
+        addBlock(initialBytes);
+    }
+}
+
+std::size_t FrameArena::capacity() const {
+    std::size_t total = 0;
+    for (const Block& block : m_blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+void FrameArena::addBlock(std::size_t minimumBytes) {
+    // Grow geometrically so a frame that overflows badly still needs only a few blocks.
+    const std::size_t previous = m_blocks.empty() ? 0 : m_blocks.back().size;
+    const std::size_t size = std::max({ minimumBytes, previous * 2, std::size_t(4096) });
+    m_blocks.push_back(Block{ std::make_unique_for_overwrite<std::byte[]>(size), size });
+    ++m_blockAllocations;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    bytes = std::max<std::size_t>(bytes, 1);
+    for (;;) {
+        if (m_blockIndex < m_blocks.size()) {
+            Block& block = m_blocks[m_blockIndex];
+            const auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+            const std::uintptr_t cursor = base + m_offset;
+            const std::uintptr_t aligned = (cursor + (alignment - 1)) & ~std::uintptr_t(alignment - 1);
+            const std::size_t end = static_cast<std::size_t>(aligned - base) + bytes;
+            if (end <= block.size) {
+                m_bytesInUse += end - m_offset;
+                m_highWaterMark = std::max(m_highWaterMark, m_bytesInUse);
+                m_offset = end;
+                return reinterpret_cast<void*>(aligned);
+            }
+            // The remainder of this block is skipped; move on to the next retained block.
+            if (m_blockIndex + 1 < m_blocks.size()) {
+                m_bytesInUse += block.size - m_offset;
+                ++m_blockIndex;
+                m_offset = 0;
+                continue;
+            }
+            m_bytesInUse += block.size - m_offset;
+        }
+        addBlock(bytes + alignment);
+        m_blockIndex = m_blocks.size() - 1;
+        m_offset = 0;
+    }
+}
+
+void FrameArena::reset() {
+    if (m_blocks.size() > 1) {
+        const std::size_t total = std::max(capacity(), m_highWaterMark);
+        m_blocks.clear();
+        addBlock(total);
+    }
+    m_blockIndex = 0;
+    m_offset = 0;
+    m_bytesInUse = 0;
+}
+
+} // namespace XpressFormula::Plotting
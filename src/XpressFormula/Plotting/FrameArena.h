@@ -0,0 +1,67 @@
+// FrameArena.h - Frame-scoped monotonic allocator for renderer temporaries.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Bump allocator for per-frame scratch buffers (sampled values, projected vertices,
+/// depth-sorted faces). Allocation advances a pointer through retained blocks, deallocation is
+/// a no-op, and reset() rewinds everything at once. Blocks survive reset(), so once the arena
+/// has grown to the steady-state working set, the scratch it serves needs no heap allocations
+/// and reuses the same (cache-warm) memory.
+///
+/// Use it through std::pmr containers, e.g. `std::pmr::vector<double> v(&arena);`. Containers
+/// allocated from the arena must not outlive the next reset(). Not thread-safe.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t kDefaultBlockBytes = std::size_t(1) << 20;
+
+    explicit FrameArena(std::size_t initialBytes = kDefaultBlockBytes);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /// Release every allocation made since the previous reset. If the last frame overflowed
+    /// into additional blocks, they are coalesced into one block sized for the high-water mark
+    /// so the next frame is served from a single contiguous region.
+    void reset();
+
+    /// Bytes handed out (including alignment padding) since the last reset().
+    std::size_t bytesInUse() const { return m_bytesInUse; }
+
+    /// Largest bytesInUse() observed in any frame.
+    std::size_t highWaterMark() const { return m_highWaterMark; }
+
+    /// Total size of the retained blocks.
+    std::size_t capacity() const;
+
+    /// Number of blocks obtained from the heap so far; constant in steady state.
+    std::uint64_t blockAllocations() const { return m_blockAllocations; }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size = 0;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void  do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void addBlock(std::size_t minimumBytes);
+
+    std::vector<Block> m_blocks;
+    std::size_t   m_blockIndex = 0;   // block currently being carved
+    std::size_t   m_offset = 0;       // bytes used in m_blocks[m_blockIndex]
+    std::size_t   m_bytesInUse = 0;
+    std::size_t   m_highWaterMark = 0;
+    std::uint64_t m_blockAllocations = 0;
+};
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,131 @@
+// ImageTexture.cpp - CPU-written RGBA image uploaded to the GPU through the ImGui renderer backend.
+#include "ImageTexture.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+// Textures waiting for the backend to destroy their GPU copy. The backend may still be drawing
+// them in an in-flight frame, so they stay registered until it reports them destroyed.
+std::vector<ImTextureData*> g_retiredTextures;
+std::uint64_t g_nextTextureId = 1;
+
+void freeTexture(ImTextureData* tex) {
+    if (ImGui::GetCurrentContext() != nullptr) {
+        ImGui::UnregisterUserTexture(tex);
+    }
+    IM_DELETE(tex);
+}
+
+void collectRetiredTextures() {
+    std::erase_if(g_retiredTextures, [](ImTextureData* tex) {
+        if (ImGui::GetCurrentContext() != nullptr && tex->Status != ImTextureStatus_Destroyed) {
+            return false;
+        }
+        freeTexture(tex);
+        return true;
+    });
+}
+
+void retireTexture(ImTextureData* tex) {
+    if (ImGui::GetCurrentContext() == nullptr || tex->TexID == ImTextureID_Invalid) {
+        // Never reached the backend (or the context is gone): nothing to release on the GPU.
+        freeTexture(tex);
+        return;
+    }
+    tex->SetStatus(ImTextureStatus_WantDestroy);
+    tex->UnusedFrames = 1;
+    g_retiredTextures.push_back(tex);
+}
+
+} // namespace
+
+ImageTexture::~ImageTexture() {
+    release();
+}
+
+void ImageTexture::release() {
+    if (m_texture) {
+        retireTexture(m_texture);
+        m_texture = nullptr;
+        m_id = 0;
+    }
+}
+
+bool ImageTexture::resize(int width, int height) {
+    collectRetiredTextures();
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (m_texture && m_texture->Width == width && m_texture->Height == height) {
+        return false;
+    }
+
+    release();
+    m_texture = IM_NEW(ImTextureData)();
+    m_texture->Create(ImTextureFormat_RGBA32, width, height);
+    m_texture->UseColors = true;
+    ImGui::RegisterUserTexture(m_texture);
+    m_id = g_nextTextureId++;
+    return true;
+}
+
+void ImageTexture::upload(const std::uint32_t* pixels, int top, int bottom) {
+    collectRetiredTextures();
+    if (!m_texture) {
+        return;
+    }
+    top = std::clamp(top, 0, m_texture->Height);
+    bottom = std::clamp(bottom, top, m_texture->Height);
+    if (top == bottom) {
+        return;
+    }
+
+    ImTextureData* tex = m_texture;
+    std::memcpy(tex->GetPixelsAt(0, top), pixels + static_cast<size_t>(top) * tex->Width,
+                static_cast<size_t>(bottom - top) * tex->GetPitch());
+
+    // Same bookkeeping as the font atlas: a texture the backend has not created yet uploads
+    // everything on creation, otherwise the rows are queued as an update rectangle.
+    if (tex->Status == ImTextureStatus_OK) {
+        tex->Updates.resize(0);
+        tex->UpdateRect.x = tex->UpdateRect.y = static_cast<unsigned short>(~0);
+        tex->UpdateRect.w = tex->UpdateRect.h = 0;
+    }
+    const ImTextureRect rect = { 0, static_cast<unsigned short>(top),
+                                 static_cast<unsigned short>(tex->Width),
+                                 static_cast<unsigned short>(bottom - top) };
+    tex->UsedRect = { 0, 0, static_cast<unsigned short>(tex->Width),
+                      static_cast<unsigned short>(tex->Height) };
+    if (tex->Status == ImTextureStatus_OK || tex->Status == ImTextureStatus_WantUpdates) {
+        const int x1 = tex->Width;
+        const int y1 = std::max(tex->UpdateRect.h == 0 ? 0 : tex->UpdateRect.y + tex->UpdateRect.h,
+                                bottom);
+        tex->UpdateRect.x = 0;
+        tex->UpdateRect.y = std::min<unsigned short>(tex->UpdateRect.y, rect.y);
+        tex->UpdateRect.w = static_cast<unsigned short>(x1);
+        tex->UpdateRect.h = static_cast<unsigned short>(y1 - tex->UpdateRect.y);
+        tex->Updates.push_back(rect);
+        tex->Status = ImTextureStatus_WantUpdates;
+    }
+}
+
+void ImageTexture::draw(ImDrawList* dl, float x0, float y0, float x1, float y1) const {
+    if (m_texture) {
+        dl->AddImage(m_texture->GetTexRef(), ImVec2(x0, y0), ImVec2(x1, y1));
+    }
+}
+
+int ImageTexture::width() const {
+    return m_texture ? m_texture->Width : 0;
+}
+
+int ImageTexture::height() const {
+    return m_texture ? m_texture->Height : 0;
+}
+
+} // namespace XpressFormula::Plotting
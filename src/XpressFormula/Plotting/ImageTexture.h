@@ -0,0 +1,46 @@
+// ImageTexture.h - CPU-written RGBA image uploaded to the GPU through the ImGui renderer backend.
+#pragma once
+
+#include <cstdint>
+
+struct ImDrawList;
+struct ImTextureData;
+
+namespace XpressFormula::Plotting {
+
+/// A user texture registered with the current ImGui context. Pixels are written on the CPU and
+/// uploaded by the renderer backend (ImGuiBackendFlags_RendererHasTextures), row ranges at a
+/// time. Replaced textures are handed back to the backend for destruction and freed once it has
+/// released them. Use from the UI thread only.
+class ImageTexture {
+public:
+    ImageTexture() = default;
+    ~ImageTexture();
+    ImageTexture(const ImageTexture&) = delete;
+    ImageTexture& operator=(const ImageTexture&) = delete;
+
+    /// Make the texture `width` x `height` (RGBA32). Returns true when a new, fully transparent
+    /// texture was created; false when the size was already current.
+    bool resize(int width, int height);
+
+    /// Copy rows [top, bottom) of a width*height RGBA32 image (IM_COL32 byte order) into the
+    /// texture and queue them for upload.
+    void upload(const std::uint32_t* pixels, int top, int bottom);
+
+    /// Draw the whole texture stretched over the given screen rectangle.
+    void draw(ImDrawList* dl, float x0, float y0, float x1, float y1) const;
+
+    int width() const;
+    int height() const;
+
+    /// Unique per created texture (0 = none), so callers can tell a replaced texture apart.
+    std::uint64_t id() const { return m_id; }
+
+private:
+    void release();
+
+    ImTextureData* m_texture = nullptr;
+    std::uint64_t m_id = 0;
+};
+
+} // namespace XpressFormula::Plotting
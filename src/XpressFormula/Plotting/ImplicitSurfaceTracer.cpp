@@ -0,0 +1,234 @@
+// ImplicitSurfaceTracer.cpp - Progressive multithreaded CPU ray tracer for F(x,y,z) = 0 surfaces.
+#include "ImplicitSurfaceTracer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+constexpr int kInitialSegments = 16;    // first segment is 1/16 of the clipped ray
+constexpr int kNewtonIterations = 8;
+
+// Same view-space light as the implicit mesh.
+constexpr double kLight[3] = { -0.35, -0.45, 0.82 };
+
+bool opposite(double a, double b) {
+    return (a <= 0.0 && b >= 0.0) || (a >= 0.0 && b <= 0.0);
+}
+
+} // namespace
+
+void ImplicitSurfaceTracer::setScene(const Core::ASTNodePtr& ast, const Bounds& bounds,
+                                     const Camera& camera, const Shading& shading,
+                                     int imageWidth, int imageHeight) {
+    imageWidth = std::max(imageWidth, 1);
+    imageHeight = std::max(imageHeight, 1);
+    const bool astChanged = (ast != m_ast);
+    const bool sizeChanged = (imageWidth != m_image.width() || imageHeight != m_image.height());
+    if (!astChanged && !sizeChanged && bounds == m_bounds && camera == m_camera &&
+        shading == m_shading) {
+        return;
+    }
+
+    m_ast = ast;
+    m_bounds = bounds;
+    m_camera = camera;
+    m_shading = shading;
+    m_image.resize(imageWidth, imageHeight);
+    if (astChanged) {
+        m_evaluator = m_ast ? std::make_unique<Core::IntervalEvaluator>(m_ast) : nullptr;
+    }
+    m_image.restart(m_camera);
+
+    if (!m_evaluator || std::abs(m_camera.zScale) < 1e-6f || m_camera.scale <= 0.0 ||
+        !(m_bounds.xMax > m_bounds.xMin) || !(m_bounds.yMax > m_bounds.yMin) ||
+        !(m_bounds.zMax > m_bounds.zMin)) {
+        m_image.clear();
+        return;
+    }
+
+    // Dividing the z components of the camera basis by zScale turns the ray into world
+    // coordinates.
+    m_view = m_camera.basis();
+    const double invZScale = 1.0 / static_cast<double>(m_camera.zScale);
+    for (int a = 0; a < 3; ++a) {
+        const double toWorld = (a == 2) ? invZScale : 1.0;
+        m_right[a] = m_view[0][a] * toWorld;
+        m_up[a] = m_view[1][a] * toWorld;
+        m_dir[a] = m_view[2][a] * toWorld;
+    }
+    const double pixelWorld = std::max(static_cast<double>(m_camera.width) / imageWidth,
+                                       static_cast<double>(m_camera.height) / imageHeight) /
+                              m_camera.scale;
+    m_minSegment = 0.5 * pixelWorld;
+}
+
+bool ImplicitSurfaceTracer::refine(Core::TaskPool& pool, double budgetMs,
+                                   int& dirtyTop, int& dirtyBottom) {
+    return m_image.refine<Core::IntervalEvaluator::Scratch>(
+        pool, budgetMs, dirtyTop, dirtyBottom,
+        [this](double xProj, double yProj, Core::IntervalEvaluator::Scratch& scratch,
+               std::uint64_t& evaluations) { return tracePixel(xProj, yProj, scratch, evaluations); });
+}
+
+std::uint32_t ImplicitSurfaceTracer::tracePixel(double xProj, double yProj,
+                                                Core::IntervalEvaluator::Scratch& scratch,
+                                                std::uint64_t& evaluations) const {
+    double origin[3];
+    for (int a = 0; a < 3; ++a) {
+        origin[a] = xProj * m_right[a] + yProj * m_up[a];
+    }
+
+    // Clip the ray against the box.
+    const double lower[3] = { m_bounds.xMin, m_bounds.yMin, m_bounds.zMin };
+    const double upper[3] = { m_bounds.xMax, m_bounds.yMax, m_bounds.zMax };
+    double tLo = -std::numeric_limits<double>::infinity();
+    double tHi = std::numeric_limits<double>::infinity();
+    for (int a = 0; a < 3; ++a) {
+        if (std::abs(m_dir[a]) < 1e-12) {
+            if (origin[a] < lower[a] || origin[a] > upper[a]) {
+                return 0u;
+            }
+            continue;
+        }
+        const double t1 = (lower[a] - origin[a]) / m_dir[a];
+        const double t2 = (upper[a] - origin[a]) / m_dir[a];
+        tLo = std::max(tLo, std::min(t1, t2));
+        tHi = std::min(tHi, std::max(t1, t2));
+    }
+    if (!(tHi > tLo) || !std::isfinite(tHi - tLo)) {
+        return 0u;
+    }
+
+    const Core::IntervalEvaluator& f = *m_evaluator;
+    auto at = [&](double t) {
+        ++evaluations;
+        return f.evaluate(origin[0] + t * m_dir[0], origin[1] + t * m_dir[1],
+                          origin[2] + t * m_dir[2], scratch);
+    };
+
+    // Walk from the near end (large t) towards the far end. [t0, t1] is the segment under test.
+    double t1 = tHi;
+    double f1 = std::numeric_limits<double>::quiet_NaN();
+    bool f1Known = false;
+    double segment = (tHi - tLo) / kInitialSegments;
+    double hit = std::numeric_limits<double>::quiet_NaN();
+    bool grow = true;  // false right after a split, so a cleared half is not retried doubled
+    while (t1 > tLo) {
+        const double t0 = std::max(tLo, t1 - segment);
+        if (!(t0 < t1)) {
+            break;  // segments below the resolution of t
+        }
+        Core::Interval box[3];
+        for (int a = 0; a < 3; ++a) {
+            const double p0 = origin[a] + t0 * m_dir[a];
+            const double p1 = origin[a] + t1 * m_dir[a];
+            box[a] = { std::min(p0, p1), std::max(p0, p1) };
+        }
+        ++evaluations;
+        if (!f.evaluate(box[0], box[1], box[2], scratch).contains(0.0)) {
+            // No root anywhere in the segment: skip it and try a longer one, unless it was
+            // just split (the doubled length is the one that failed).
+            t1 = t0;
+            f1Known = false;
+            if (grow) {
+                segment *= 2.0;
+            }
+            grow = true;
+            continue;
+        }
+        if (t1 - t0 > m_minSegment) {
+            segment = 0.5 * (t1 - t0);
+            grow = false;
+            continue;
+        }
+
+        if (!f1Known) {
+            f1 = at(t1);
+        }
+        const double f0 = at(t0);
+        if (std::isfinite(f0) && std::isfinite(f1) && opposite(f0, f1)) {
+            // Newton steps from the near end, falling back to bisection when a step leaves
+            // the bracket [a, b].
+            double a = t0;
+            double fa = f0;
+            double b = t1;
+            double t = t1;
+            double ft = f1;
+            const double tolerance = 1e-3 * m_minSegment;
+            for (int i = 0; i < kNewtonIterations && ft != 0.0 && b - a > tolerance; ++i) {
+                const double h = 0.5 * tolerance;
+                const double slope = (at(t + h) - at(t - h)) / (2.0 * h);
+                double next = t - ft / slope;
+                if (!(next > a && next < b)) {
+                    next = 0.5 * (a + b);
+                }
+                t = next;
+                ft = at(t);
+                if (!std::isfinite(ft)) {
+                    break;
+                }
+                if ((ft < 0.0) != (fa < 0.0)) {
+                    b = t;
+                } else {
+                    a = t;
+                    fa = ft;
+                }
+            }
+            hit = t;
+            break;
+        }
+        t1 = t0;
+        f1 = f0;
+        f1Known = true;
+    }
+    if (std::isnan(hit)) {
+        return 0u;
+    }
+
+    // Shade from the gradient of F, taken in (x, y, z * zScale) space like the mesh normals.
+    const double px = origin[0] + hit * m_dir[0];
+    const double py = origin[1] + hit * m_dir[1];
+    const double pz = origin[2] + hit * m_dir[2];
+    const double h = 0.25 * m_minSegment;
+    evaluations += 6;
+    const double gradient[3] = {
+        (f.evaluate(px + h, py, pz, scratch) - f.evaluate(px - h, py, pz, scratch)) / (2.0 * h),
+        (f.evaluate(px, py + h, pz, scratch) - f.evaluate(px, py - h, pz, scratch)) / (2.0 * h),
+        (f.evaluate(px, py, pz + h, scratch) - f.evaluate(px, py, pz - h, scratch)) /
+            (2.0 * h * static_cast<double>(m_camera.zScale)),
+    };
+    double shade = 0.6;
+    const double length = std::sqrt(gradient[0] * gradient[0] + gradient[1] * gradient[1] +
+                                     gradient[2] * gradient[2]);
+    if (std::isfinite(length) && length > 0.0) {
+        const double lightLength = std::sqrt(kLight[0] * kLight[0] + kLight[1] * kLight[1] +
+                                             kLight[2] * kLight[2]);
+        double ndotl = 0.0;
+        for (int v = 0; v < 3; ++v) {
+            const double n = m_view[v][0] * gradient[0] + m_view[v][1] * gradient[1] +
+                             m_view[v][2] * gradient[2];
+            ndotl += n * kLight[v];
+        }
+        ndotl /= length * lightLength;
+        shade = std::clamp(0.28 + 0.72 * std::abs(ndotl), 0.18, 1.0);
+    }
+
+    // Same palette as the implicit mesh: the formula colour mixed with a z gradient over the
+    // box, darkened by the shade.
+    const double zt = std::clamp((pz - m_bounds.zMin) / (m_bounds.zMax - m_bounds.zMin), 0.0, 1.0);
+    const double gradientColor[3] = { 0.18 + 0.76 * zt, 0.28 + 0.48 * (1.0 - std::abs(2.0 * zt - 1.0)),
+                                      0.95 - 0.72 * zt };
+    const double shadeMix = 0.52 + 0.48 * shade;
+    std::uint32_t rgba = 0u;
+    for (int c = 0; c < 3; ++c) {
+        const double base = std::clamp(0.58 * m_shading.color[c] + 0.42 * gradientColor[c], 0.0, 1.0);
+        rgba |= static_cast<std::uint32_t>(std::clamp(base * shadeMix, 0.0, 1.0) * 255.0) << (8 * c);
+    }
+    const double alpha = std::clamp(static_cast<double>(m_shading.opacity), 0.12, 1.0);
+    return rgba | (static_cast<std::uint32_t>(alpha * 255.0) << 24);
+}
+
+} // namespace XpressFormula::Plotting
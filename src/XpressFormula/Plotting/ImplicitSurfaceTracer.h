@@ -0,0 +1,90 @@
+// ImplicitSurfaceTracer.h - Progressive multithreaded CPU ray tracer for F(x,y,z) = 0 surfaces.
+#pragma once
+
+#include "ProgressiveImage.h"
+#include "../Core/ASTNode.h"
+#include "../Core/IntervalEvaluator.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Renders the zero set of F(x, y, z) per pixel, without building a mesh. The cost scales with
+/// the image size instead of the cube of the mesh resolution, and silhouettes and intersections
+/// are exact to the pixel.
+///
+/// Each ray is clipped to the sampling box and walked from the viewer with interval bounds:
+/// a ray segment whose box-wide range of F (see Core::IntervalEvaluator) excludes zero cannot
+/// hold the surface and is skipped whole, and the next segment is twice as long (except right
+/// after a split). Segments that may hold it are halved down to about half a pixel. The first
+/// one where F changes sign is refined with Newton steps kept inside the bracket, and the hit
+/// is shaded from the gradient of F. Tangential touches without a sign change are not found.
+///
+/// Like VolumeRaymarcher, the image is refined coarse-to-fine over successive refine() calls
+/// (see ProgressiveImage).
+class ImplicitSurfaceTracer {
+public:
+    /// Same orthographic, world-origin anchored camera as the volume ray-marcher.
+    using Camera = ProgressiveImage::Camera;
+
+    /// World-space box the surface is traced in.
+    struct Bounds {
+        double xMin = -1.0;
+        double xMax = 1.0;
+        double yMin = -1.0;
+        double yMax = 1.0;
+        double zMin = -1.0;
+        double zMax = 1.0;
+
+        bool operator==(const Bounds&) const = default;
+    };
+
+    struct Shading {
+        std::array<float, 4> color = { 1.0f, 1.0f, 1.0f, 1.0f };  // base colour, mixed with a z gradient
+        float opacity = 1.0f;
+
+        bool operator==(const Shading&) const = default;
+    };
+
+    /// Set what to render. Anything that differs from the previous scene restarts refinement;
+    /// the previous image stays visible until it is overwritten.
+    void setScene(const Core::ASTNodePtr& ast, const Bounds& bounds, const Camera& camera,
+                  const Shading& shading, int imageWidth, int imageHeight);
+
+    /// See ProgressiveImage::refine.
+    bool refine(Core::TaskPool& pool, double budgetMs, int& dirtyTop, int& dirtyBottom);
+
+    /// Image state and pixels: see ProgressiveImage.
+    bool hasImage() const { return m_image.hasImage(); }
+    bool converged() const { return m_image.converged(); }
+    int width() const { return m_image.width(); }
+    int height() const { return m_image.height(); }
+    const std::uint32_t* pixels() const { return m_image.pixels(); }
+
+    /// Point plus interval evaluations of F since the last scene change (diagnostics).
+    std::uint64_t evaluations() const { return m_image.work(); }
+
+private:
+    std::uint32_t tracePixel(double xProj, double yProj, Core::IntervalEvaluator::Scratch& scratch,
+                             std::uint64_t& evaluations) const;
+
+    Core::ASTNodePtr m_ast;
+    std::unique_ptr<Core::IntervalEvaluator> m_evaluator;
+    Bounds m_bounds;
+    Camera m_camera;
+    Shading m_shading;
+    ProgressiveImage m_image;
+
+    // Ray through projected point (xProj, yProj) in world space: xProj * m_right +
+    // yProj * m_up + t * m_dir, with larger t nearer the viewer and t in scaled (z * zScale)
+    // units. m_view holds the camera basis for shading.
+    std::array<double, 3> m_right = {};
+    std::array<double, 3> m_up = {};
+    std::array<double, 3> m_dir = {};
+    std::array<std::array<double, 3>, 3> m_view = {};
+    double m_minSegment = 0.0;  // finest ray segment, about half an image pixel
+};
+
+} // namespace XpressFormula::Plotting
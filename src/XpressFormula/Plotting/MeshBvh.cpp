@@ -0,0 +1,375 @@
+// MeshBvh.cpp - Bounding volume hierarchy over a world-space triangle mesh for ray picking.
+#include "MeshBvh.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+constexpr int kBinCount = 16;
+// Below this depth nodes are split at their median: at most 32 more levels for 2^32 triangles.
+constexpr int kMedianSplitDepth = MeshBvh::kMaxDepth - 32;
+
+struct Box {
+    double lo[3] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                     std::numeric_limits<double>::infinity() };
+    double hi[3] = { -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                     -std::numeric_limits<double>::infinity() };
+
+    void grow(const double p[3]) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], p[a]);
+            hi[a] = std::max(hi[a], p[a]);
+        }
+    }
+    void grow(const Box& b) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], b.lo[a]);
+            hi[a] = std::max(hi[a], b.hi[a]);
+        }
+    }
+    double halfArea() const {
+        const double ex = hi[0] - lo[0];
+        const double ey = hi[1] - lo[1];
+        const double ez = hi[2] - lo[2];
+        return (ex < 0.0) ? 0.0 : ex * ey + ey * ez + ez * ex;
+    }
+};
+
+struct TriangleInfo {
+    Box bounds;
+    double centroid[3];
+    std::uint32_t index;  // into the mesh
+};
+
+// Entry and exit distance of the ray through the box, clipped to [tMin, tMax].
+bool rayBox(const double lo[3], const double hi[3], const double origin[3], const double invDir[3],
+            double tMin, double tMax, double& tEnter) {
+    for (int a = 0; a < 3; ++a) {
+        if (std::isinf(invDir[a])) {
+            // Parallel to this slab pair: inside or missed entirely.
+            if (origin[a] < lo[a] || origin[a] > hi[a]) {
+                return false;
+            }
+            continue;
+        }
+        double t0 = (lo[a] - origin[a]) * invDir[a];
+        double t1 = (hi[a] - origin[a]) * invDir[a];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) {
+            return false;
+        }
+    }
+    tEnter = tMin;
+    return true;
+}
+
+// Moller-Trumbore, both faces. Returns the ray parameter or NaN on a miss.
+double rayTriangle(const MeshBvh::Triangle& tri, const MeshBvh::Vec3& o, const MeshBvh::Vec3& d) {
+    const double e1x = tri.p1.x - tri.p0.x, e1y = tri.p1.y - tri.p0.y, e1z = tri.p1.z - tri.p0.z;
+    const double e2x = tri.p2.x - tri.p0.x, e2y = tri.p2.y - tri.p0.y, e2z = tri.p2.z - tri.p0.z;
+    const double px = d.y * e2z - d.z * e2y;
+    const double py = d.z * e2x - d.x * e2z;
+    const double pz = d.x * e2y - d.y * e2x;
+    const double det = e1x * px + e1y * py + e1z * pz;
+    const double scale = std::abs(e1x) + std::abs(e1y) + std::abs(e1z) +
+                         std::abs(e2x) + std::abs(e2y) + std::abs(e2z);
+    if (!(std::abs(det) > 1e-14 * scale * scale)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const double invDet = 1.0 / det;
+    const double sx = o.x - tri.p0.x, sy = o.y - tri.p0.y, sz = o.z - tri.p0.z;
+    const double u = (sx * px + sy * py + sz * pz) * invDet;
+    if (u < 0.0 || u > 1.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const double qx = sy * e1z - sz * e1y;
+    const double qy = sz * e1x - sx * e1z;
+    const double qz = sx * e1y - sy * e1x;
+    const double v = (d.x * qx + d.y * qy + d.z * qz) * invDet;
+    if (v < 0.0 || u + v > 1.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return (e2x * qx + e2y * qy + e2z * qz) * invDet;
+}
+
+} // namespace
+
+MeshBvh::Mesh MeshBvh::HeightGrid::triangulate() const {
+    Mesh mesh;
+    if (nx < 1 || ny < 1 || layers < 1 ||
+        values.size() < static_cast<size_t>(layers) * (nx + 1) * (ny + 1)) {
+        return mesh;
+    }
+    const size_t gridSize = static_cast<size_t>(nx + 1) * (ny + 1);
+    const double dx = (xMax - xMin) / nx;
+    const double dy = (yMax - yMin) / ny;
+    auto clipped = [&](double z0, double z1, double z2) {
+        return std::max({ z0, z1, z2 }) < zClipMin || std::min({ z0, z1, z2 }) > zClipMax;
+    };
+    mesh.reserve(static_cast<size_t>(layers) * nx * ny * 2);
+    for (int layer = 0; layer < layers; ++layer) {
+        const double* z = values.data() + layer * gridSize;
+        for (int iy = 0; iy < ny; ++iy) {
+            const double y0 = yMin + iy * dy;
+            const double y1 = yMin + (iy + 1) * dy;
+            for (int ix = 0; ix < nx; ++ix) {
+                const size_t i00 = static_cast<size_t>(iy) * (nx + 1) + ix;
+                const size_t i10 = i00 + 1;
+                const size_t i01 = i00 + (nx + 1);
+                const size_t i11 = i01 + 1;
+                if (!std::isfinite(z[i00]) || !std::isfinite(z[i10]) ||
+                    !std::isfinite(z[i11]) || !std::isfinite(z[i01])) {
+                    continue;
+                }
+                const double x0 = xMin + ix * dx;
+                const double x1 = xMin + (ix + 1) * dx;
+                const Vec3 v00{ x0, y0, z[i00] };
+                const Vec3 v10{ x1, y0, z[i10] };
+                const Vec3 v11{ x1, y1, z[i11] };
+                const Vec3 v01{ x0, y1, z[i01] };
+                if (!clipped(z[i00], z[i10], z[i11])) {
+                    mesh.push_back({ v00, v10, v11 });
+                }
+                if (!clipped(z[i00], z[i11], z[i01])) {
+                    mesh.push_back({ v00, v11, v01 });
+                }
+            }
+        }
+    }
+    return mesh;
+}
+
+std::shared_ptr<const MeshBvh> MeshBvh::build(std::shared_ptr<const Mesh> mesh,
+                                              const std::atomic<bool>* cancel) {
+    if (!mesh || mesh->empty()) {
+        return nullptr;
+    }
+    const Mesh& tris = *mesh;
+    const size_t count = tris.size();
+
+    std::vector<TriangleInfo> info(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Vec3* verts[3] = { &tris[i].p0, &tris[i].p1, &tris[i].p2 };
+        for (const Vec3* v : verts) {
+            const double p[3] = { v->x, v->y, v->z };
+            info[i].bounds.grow(p);
+        }
+        for (int a = 0; a < 3; ++a) {
+            info[i].centroid[a] = 0.5 * (info[i].bounds.lo[a] + info[i].bounds.hi[a]);
+        }
+        info[i].index = static_cast<std::uint32_t>(i);
+    }
+
+    auto bvh = std::make_shared<MeshBvh>();
+    bvh->m_mesh = std::move(mesh);
+    bvh->m_nodes.reserve(2 * count);
+    bvh->m_nodes.emplace_back();
+
+    struct Task {
+        std::uint32_t node;
+        std::uint32_t begin;
+        std::uint32_t end;
+        int depth;
+    };
+    std::vector<Task> stack;
+    stack.push_back({ 0, 0, static_cast<std::uint32_t>(count), 0 });
+    // The triangle records themselves are partitioned (not an index array into them), so every
+    // pass over a node reads memory in order.
+    TriangleInfo* tri = info.data();
+    size_t processed = 0;
+
+    while (!stack.empty()) {
+        const Task task = stack.back();
+        stack.pop_back();
+        if (cancel && (++processed & 1023) == 0 && cancel->load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        Box bounds;
+        Box centroids;
+        for (std::uint32_t i = task.begin; i < task.end; ++i) {
+            bounds.grow(tri[i].bounds);
+            centroids.grow(tri[i].centroid);
+        }
+        Node& node = bvh->m_nodes[task.node];
+        for (int a = 0; a < 3; ++a) {
+            node.lo[a] = bounds.lo[a];
+            node.hi[a] = bounds.hi[a];
+        }
+        const std::uint32_t n = task.end - task.begin;
+        if (n <= static_cast<std::uint32_t>(kMaxLeafTriangles)) {
+            node.first = task.begin;
+            node.count = n;
+            continue;
+        }
+
+        int widest = 0;
+        for (int a = 1; a < 3; ++a) {
+            if (centroids.hi[a] - centroids.lo[a] > centroids.hi[widest] - centroids.lo[widest]) {
+                widest = a;
+            }
+        }
+
+        // Small nodes get fewer bins: the sweeps would otherwise cost more than the triangles.
+        const int binCount = std::min(kBinCount, static_cast<int>(n));
+        double toBin[3];
+        for (int a = 0; a < 3; ++a) {
+            const double extent = centroids.hi[a] - centroids.lo[a];
+            toBin[a] = (extent > 0.0) ? binCount / extent : 0.0;
+        }
+        auto binOf = [&](const TriangleInfo& t, int axis) {
+            return std::min(binCount - 1, static_cast<int>((t.centroid[axis] - centroids.lo[axis]) * toBin[axis]));
+        };
+
+        // Surface area heuristic over centroid bins on every axis, binned in one pass.
+        int splitAxis = -1;
+        int splitBin = 0;  // bins [0, splitBin) go left
+        if (task.depth < kMedianSplitDepth) {
+            std::array<std::array<Box, kBinCount>, 3> bins;
+            std::array<std::array<std::uint32_t, kBinCount>, 3> binCounts = {};
+            for (std::uint32_t i = task.begin; i < task.end; ++i) {
+                const TriangleInfo& t = tri[i];
+                for (int a = 0; a < 3; ++a) {
+                    const int b = binOf(t, a);
+                    bins[a][b].grow(t.bounds);
+                    ++binCounts[a][b];
+                }
+            }
+            double bestCost = std::numeric_limits<double>::infinity();
+            for (int a = 0; a < 3; ++a) {
+                if (toBin[a] == 0.0) {
+                    continue;
+                }
+                // Sweep right to left for the right-hand areas, then left to right.
+                std::array<double, kBinCount> rightArea = {};
+                std::array<std::uint32_t, kBinCount> rightCount = {};
+                Box accum;
+                std::uint32_t accumCount = 0;
+                for (int b = binCount - 1; b > 0; --b) {
+                    accum.grow(bins[a][b]);
+                    accumCount += binCounts[a][b];
+                    rightArea[b] = accum.halfArea();
+                    rightCount[b] = accumCount;
+                }
+                accum = Box();
+                accumCount = 0;
+                for (int b = 0; b < binCount - 1; ++b) {
+                    accum.grow(bins[a][b]);
+                    accumCount += binCounts[a][b];
+                    if (accumCount == 0 || rightCount[b + 1] == 0) {
+                        continue;
+                    }
+                    const double cost = accum.halfArea() * accumCount + rightArea[b + 1] * rightCount[b + 1];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        splitAxis = a;
+                        splitBin = b + 1;
+                    }
+                }
+            }
+        }
+
+        std::uint32_t mid = task.begin;
+        if (splitAxis >= 0) {
+            TriangleInfo* split = std::partition(tri + task.begin, tri + task.end,
+                [&](const TriangleInfo& t) { return binOf(t, splitAxis) < splitBin; });
+            mid = static_cast<std::uint32_t>(split - tri);
+        }
+        if (mid == task.begin || mid == task.end) {
+            mid = task.begin + n / 2;
+            std::nth_element(tri + task.begin, tri + mid, tri + task.end,
+                             [&](const TriangleInfo& l, const TriangleInfo& r) {
+                                 return l.centroid[widest] < r.centroid[widest];
+                             });
+        }
+
+        const std::uint32_t left = static_cast<std::uint32_t>(bvh->m_nodes.size());
+        bvh->m_nodes[task.node].first = left;
+        bvh->m_nodes[task.node].count = 0;
+        bvh->m_nodes.emplace_back();
+        bvh->m_nodes.emplace_back();
+        stack.push_back({ left, task.begin, mid, task.depth + 1 });
+        stack.push_back({ left + 1, mid, task.end, task.depth + 1 });
+    }
+    bvh->m_order.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        bvh->m_order[i] = info[i].index;
+    }
+    return bvh;
+}
+
+bool MeshBvh::intersect(const Vec3& origin, const Vec3& direction, Hit& hit,
+                        double tMin, double tMax) const {
+    const double o[3] = { origin.x, origin.y, origin.z };
+    const double invDir[3] = { 1.0 / direction.x, 1.0 / direction.y, 1.0 / direction.z };
+    const Mesh& tris = *m_mesh;
+
+    double closest = tMax;
+    bool found = false;
+    // Deferred children with their entry distance. Each level defers at most one child.
+    struct Pending {
+        std::uint32_t node;
+        double enter;
+    };
+    std::array<Pending, kMaxDepth + 1> stack;
+    int top = 0;
+    double enter = 0.0;
+    if (!rayBox(m_nodes[0].lo, m_nodes[0].hi, o, invDir, tMin, closest, enter)) {
+        return false;
+    }
+    stack[top++] = { 0, enter };
+    while (top > 0) {
+        const Pending pending = stack[--top];
+        if (pending.enter > closest) {
+            continue;  // starts beyond a hit found since it was deferred
+        }
+        const Node& node = m_nodes[pending.node];
+        if (node.count > 0) {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+                const double t = rayTriangle(tris[m_order[i]], origin, direction);
+                if (t >= tMin && t <= closest) {
+                    closest = t;
+                    hit.triangle = m_order[i];
+                    found = true;
+                }
+            }
+            continue;
+        }
+        const Node& a = m_nodes[node.first];
+        const Node& b = m_nodes[node.first + 1];
+        double enterA = 0.0;
+        double enterB = 0.0;
+        const bool hitA = rayBox(a.lo, a.hi, o, invDir, tMin, closest, enterA);
+        const bool hitB = rayBox(b.lo, b.hi, o, invDir, tMin, closest, enterB);
+        if (hitA && hitB) {
+            // Visit the nearer child first: push the farther one beneath it.
+            if (enterA <= enterB) {
+                stack[top++] = { node.first + 1, enterB };
+                stack[top++] = { node.first, enterA };
+            } else {
+                stack[top++] = { node.first, enterA };
+                stack[top++] = { node.first + 1, enterB };
+            }
+        } else if (hitA) {
+            stack[top++] = { node.first, enterA };
+        } else if (hitB) {
+            stack[top++] = { node.first + 1, enterB };
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    hit.t = closest;
+    hit.point = { origin.x + closest * direction.x, origin.y + closest * direction.y,
+                  origin.z + closest * direction.z };
+    return true;
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,38 @@
+// MeshBvhCache.cpp - Background-built ray-picking hierarchy for the latest mesh of a surface.
+#include "MeshBvhCache.h"
+
+namespace XpressFormula::Plotting {
+
+template <typename Build>
+std::shared_ptr<const MeshBvh> MeshBvhCache::request(std::shared_ptr<const void> source, Build build) {
+    if (source == m_source) {
+        if (m_source && !m_ready && !m_failed && m_task.finished()) {
+            m_ready = m_task.take();
+            m_failed = !m_ready;
+        }
+        return m_ready;
+    }
+
+    m_task.cancel();
+    m_source = std::move(source);
+    m_ready.reset();
+    m_failed = false;
+    if (!m_source) {
+        return nullptr;
+    }
+    m_task.start(std::move(build));
+    return nullptr;
+}
+
+std::shared_ptr<const MeshBvh> MeshBvhCache::request(const std::shared_ptr<const MeshBvh::Mesh>& mesh) {
+    // The worker holds its own reference, so a replaced mesh stays alive until it is cancelled.
+    return request(mesh, [mesh](const std::atomic<bool>* cancel) { return MeshBvh::build(mesh, cancel); });
+}
+
+std::shared_ptr<const MeshBvh> MeshBvhCache::request(const std::shared_ptr<const MeshBvh::HeightGrid>& grid) {
+    return request(grid, [grid](const std::atomic<bool>* cancel) {
+        return MeshBvh::build(std::make_shared<const MeshBvh::Mesh>(grid->triangulate()), cancel);
+    });
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,39 @@
+// MeshBvhCache.h - Background-built ray-picking hierarchy for the latest mesh of a surface.
+#pragma once
+
+#include "MeshBvh.h"
+#include "../Core/BackgroundTask.h"
+#include <memory>
+
+namespace XpressFormula::Plotting {
+
+/// Builds a MeshBvh on a background thread whenever the requested mesh changes, so a newly
+/// extracted surface never stalls the frame that first hovers it. Picks simply miss the surface
+/// until its hierarchy is ready (a few milliseconds for 100k triangles).
+class MeshBvhCache {
+public:
+    MeshBvhCache() = default;
+    MeshBvhCache(const MeshBvhCache&) = delete;
+    MeshBvhCache& operator=(const MeshBvhCache&) = delete;
+
+    /// Return the hierarchy over `mesh` once built, or null while it is being built (or for a
+    /// null or empty mesh). A different mesh cancels the build in flight and starts a new one.
+    std::shared_ptr<const MeshBvh> request(const std::shared_ptr<const MeshBvh::Mesh>& mesh);
+
+    /// The same for a sampled z = f(x, y) grid, which the background build triangulates first.
+    std::shared_ptr<const MeshBvh> request(const std::shared_ptr<const MeshBvh::HeightGrid>& grid);
+
+    /// True while a requested hierarchy is still being built.
+    bool pending() const { return m_source && !m_ready && !m_failed; }
+
+private:
+    template <typename Build>
+    std::shared_ptr<const MeshBvh> request(std::shared_ptr<const void> source, Build build);
+
+    std::shared_ptr<const void> m_source;  // the mesh or grid requested last
+    std::shared_ptr<const MeshBvh> m_ready;
+    bool m_failed = false;  // the mesh was empty
+    Core::BackgroundTask<MeshBvh> m_task;
+};
+
+} // namespace XpressFormula::Plotting
@@ -1,17 +1,237 @@
 // PlotRenderer.cpp - Rendering implementation for grids, axes, and curves.
 #include "PlotRenderer.h"
+#include "ContourLines.h"
+#include "FrameArena.h"
+#include "Qef.h"
+#include "../Core/EquationSolver.h"
 #include "../Core/Evaluator.h"
+#include "../Core/GridEvaluator.h"
+#include "../Core/IntervalEvaluator.h"
+#include "../Core/Symmetry.h"
 #include "imgui.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <vector>
 
 namespace XpressFormula::Plotting {
 
+// A curve's index and samples, and a surface's mesh, as a draw call published them.
+struct PlotRenderer::PublishedCurve {
+    Core::ASTNodePtr owner;  // the key: the AST, or the solution's first branch
+    Core::ViewTransform view;
+    std::vector<CurveIndex::Segment> segments;
+    std::shared_ptr<const CurveAnalysis::Samples> samples;  // null unless captured for analysis
+    // Built from `segments` by the first hover query (under g_curveIndexMutex).
+    mutable std::shared_ptr<const CurveIndex> index;
+};
+
+struct PlotRenderer::PublishedSurface {
+    Core::ASTNodePtr owner;
+    std::shared_ptr<const MeshBvh::Mesh> mesh;        // implicit surfaces
+    std::shared_ptr<const MeshBvh::HeightGrid> grid;  // z=f(x,y) surfaces, triangulated when picked
+    // z=f(x,y) surfaces: sampled x/y range, z clip window and grid size of `grid`.
+    std::array<double, 6> domain = {};
+    int resolution = 0;
+};
+
 // ---- helpers ----------------------------------------------------------------
 
+namespace {
+
+// Relaxed atomics: the counters are statistics only and must stay cheap on the hot path.
+// Each draw call adds its evaluation count once rather than once per sample.
+std::atomic<std::uint64_t> g_statEvaluations{ 0 };
+std::atomic<std::uint64_t> g_statMeshCacheHits{ 0 };
+std::atomic<std::uint64_t> g_statMeshCacheMisses{ 0 };
+
+// Per-call temporaries come from the caller's frame arena when one is supplied; otherwise they
+// fall back to the default (heap) resource so standalone callers keep working unchanged.
+std::pmr::memory_resource* scratchResource(FrameArena* arena) {
+    return arena ? static_cast<std::pmr::memory_resource*>(arena) : std::pmr::get_default_resource();
+}
+
+// Latest world-space mesh of each drawn 3D surface, most recently published first. Surfaces are
+// drawn on worker threads and their geometry is replayed while unchanged, so the mesh is kept
+// here rather than handed back to the caller. Entries hold the AST they are keyed by, so its
+// address cannot be reused by another formula while the entry exists.
+std::mutex g_surfaceMeshMutex;
+std::vector<std::shared_ptr<const PlotRenderer::PublishedSurface>> g_surfaceMeshes;
+constexpr size_t kSurfaceMeshCapacity = 16;
+
+// Screen-space index and world samples of each drawn 2D curve, most recently published first.
+// Like the surface meshes, curves are drawn on worker threads and replayed from the geometry
+// cache, so what sampling produced is kept here for hover and analysis rather than returned.
+std::mutex g_curveIndexMutex;
+std::vector<std::shared_ptr<const PlotRenderer::PublishedCurve>> g_curveIndexes;
+constexpr size_t kCurveIndexCapacity = 64;
+
+// Make `entry` the most recent of `entries`, replacing the one under the same key.
+template <typename Entry>
+void publishEntry(std::vector<std::shared_ptr<const Entry>>& entries, std::shared_ptr<const Entry> entry,
+                  size_t capacity) {
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](const std::shared_ptr<const Entry>& e) { return e->owner == entry->owner; });
+    if (it != entries.end()) {
+        if (*it == entry) {
+            std::rotate(entries.begin(), it, it + 1);
+            return;
+        }
+        entries.erase(it);
+    }
+    entries.insert(entries.begin(), std::move(entry));
+    if (entries.size() > capacity) {
+        entries.resize(capacity);
+    }
+}
+
+template <typename Entry>
+std::shared_ptr<const Entry> findEntry(const std::vector<std::shared_ptr<const Entry>>& entries,
+                                       const void* key) {
+    for (const std::shared_ptr<const Entry>& entry : entries) {
+        if (entry->owner.get() == key) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+void publishSurfaceMesh(PlotRenderer::PublishedSurface entry) {
+    std::lock_guard<std::mutex> lock(g_surfaceMeshMutex);
+    // The below- and above-plane passes publish the same mesh; keep the entry they share.
+    auto held = findEntry(g_surfaceMeshes, entry.owner.get());
+    if (held && held->mesh == entry.mesh && held->grid == entry.grid) {
+        publishEntry(g_surfaceMeshes, std::move(held), kSurfaceMeshCapacity);
+        return;
+    }
+    publishEntry(g_surfaceMeshes, std::make_shared<const PlotRenderer::PublishedSurface>(std::move(entry)),
+                 kSurfaceMeshCapacity);
+}
+
+bool hasSurfaceMesh(const void* key, const std::array<double, 6>& domain, int resolution) {
+    std::lock_guard<std::mutex> lock(g_surfaceMeshMutex);
+    auto held = findEntry(g_surfaceMeshes, key);
+    return held && held->domain == domain && held->resolution == resolution;
+}
+
+// What a curve drawn under `key` for `vt` already has published for that view, if anything.
+std::shared_ptr<const PlotRenderer::PublishedCurve> publishedCurve(const void* key,
+                                                                   const Core::ViewTransform& vt) {
+    std::lock_guard<std::mutex> lock(g_curveIndexMutex);
+    auto held = findEntry(g_curveIndexes, key);
+    return held && held->view == vt ? held : nullptr;
+}
+
+void publishCurve(std::shared_ptr<const PlotRenderer::PublishedCurve> entry) {
+    std::lock_guard<std::mutex> lock(g_curveIndexMutex);
+    publishEntry(g_curveIndexes, std::move(entry), kCurveIndexCapacity);
+}
+
+} // namespace
+
+PlotRenderer::RenderStats PlotRenderer::stats() {
+    RenderStats result;
+    result.evaluations = g_statEvaluations.load(std::memory_order_relaxed);
+    result.meshCacheHits = g_statMeshCacheHits.load(std::memory_order_relaxed);
+    result.meshCacheMisses = g_statMeshCacheMisses.load(std::memory_order_relaxed);
+    return result;
+}
+
+void PlotRenderer::resetStats() {
+    g_statEvaluations.store(0, std::memory_order_relaxed);
+    g_statMeshCacheHits.store(0, std::memory_order_relaxed);
+    g_statMeshCacheMisses.store(0, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const MeshBvh::Mesh> PlotRenderer::surfaceMesh(const void* key) {
+    std::lock_guard<std::mutex> lock(g_surfaceMeshMutex);
+    auto held = findEntry(g_surfaceMeshes, key);
+    return held ? held->mesh : nullptr;
+}
+
+std::shared_ptr<const MeshBvh::HeightGrid> PlotRenderer::surfaceGrid(const void* key) {
+    std::lock_guard<std::mutex> lock(g_surfaceMeshMutex);
+    auto held = findEntry(g_surfaceMeshes, key);
+    return held ? held->grid : nullptr;
+}
+
+std::shared_ptr<const CurveIndex> PlotRenderer::curveIndex(const void* key,
+                                                          const Core::ViewTransform& vt) {
+    std::lock_guard<std::mutex> lock(g_curveIndexMutex);
+    auto held = findEntry(g_curveIndexes, key);
+    if (!held || !(held->view == vt)) {
+        return nullptr;
+    }
+    if (!held->index) {
+        held->index = std::make_shared<const CurveIndex>(held->segments, vt.screenOriginX, vt.screenOriginY,
+                                                         vt.screenWidth, vt.screenHeight);
+    }
+    return held->index;
+}
+
+std::shared_ptr<const CurveAnalysis::Samples> PlotRenderer::curveSamples(const void* key,
+                                                                         const Core::ViewTransform& vt) {
+    std::lock_guard<std::mutex> lock(g_curveIndexMutex);
+    auto held = findEntry(g_curveIndexes, key);
+    return held && held->view == vt ? held->samples : nullptr;
+}
+
+PlotRenderer::Published PlotRenderer::published(const void* key) {
+    Published result;
+    {
+        std::lock_guard<std::mutex> lock(g_curveIndexMutex);
+        result.curve = findEntry(g_curveIndexes, key);
+    }
+    std::lock_guard<std::mutex> lock(g_surfaceMeshMutex);
+    result.surface = findEntry(g_surfaceMeshes, key);
+    return result;
+}
+
+void PlotRenderer::republish(const Published& published) {
+    if (published.curve) {
+        std::lock_guard<std::mutex> lock(g_curveIndexMutex);
+        publishEntry(g_curveIndexes, published.curve, kCurveIndexCapacity);
+    }
+    if (published.surface) {
+        std::lock_guard<std::mutex> lock(g_surfaceMeshMutex);
+        publishEntry(g_surfaceMeshes, published.surface, kSurfaceMeshCapacity);
+    }
+}
+
+void PlotRenderer::pickRay3D(const Core::ViewTransform& vt, const Surface3DOptions& options,
+                             float screenX, float screenY,
+                             MeshBvh::Vec3& origin, MeshBvh::Vec3& direction) {
+    // Inverse of the surface projection: (x, y, z * zScale) rotated into (xProj, yProj, depth)
+    // by an orthonormal basis, so the screen point lifts to xProj * R + yProj * U and the ray
+    // runs along -F (away from the viewer). Dividing by zScale returns to world z.
+    const double azimuth = static_cast<double>(options.azimuthDeg) * 3.14159265358979323846 / 180.0;
+    const double elevation = static_cast<double>(options.elevationDeg) * 3.14159265358979323846 / 180.0;
+    const double cosA = std::cos(azimuth);
+    const double sinA = std::sin(azimuth);
+    const double cosE = std::cos(elevation);
+    const double sinE = std::sin(elevation);
+    const double scale = std::max(1e-6, std::min(vt.scaleX, vt.scaleY));
+    const Core::Vec2 center = vt.worldToScreen(0.0, 0.0);
+    const double xProj = (screenX - center.x) / scale;
+    const double yProj = (center.y - screenY) / scale;
+    const double invZScale = 1.0 / std::max(1e-6, static_cast<double>(options.zScale));
+
+    origin = { xProj * cosA + yProj * cosE * sinA,
+               -xProj * sinA + yProj * cosE * cosA,
+               -yProj * sinE * invZScale };
+    direction = { -sinE * sinA, -sinE * cosA, -cosE * invZScale };
+}
+
+void PlotRenderer::recordEvaluations(std::uint64_t count) {
+    g_statEvaluations.fetch_add(count, std::memory_order_relaxed);
+}
+
 unsigned int PlotRenderer::colorU32(const float c[4]) {
     return IM_COL32(
         std::clamp(static_cast<int>(c[0] * 255), 0, 255),
@@ -460,10 +680,23 @@ void PlotRenderer::drawAxisLabels(ImDrawList* dl, const Core::ViewTransform& vt)
 
 void PlotRenderer::drawCurve2D(ImDrawList* dl, const Core::ViewTransform& vt,
                                const Core::ASTNodePtr& ast,
-                               const float color[4], float thickness) {
+                               const float color[4], float thickness, FrameArena* arena,
+                               bool captureSamples) {
     if (!ast) {
         return;
     }
+    Core::EquationSolver::Solution curve;
+    curve.branches.push_back(ast);
+    drawCurve2D(dl, vt, curve, color, thickness, arena, captureSamples);
+}
+
+void PlotRenderer::drawCurve2D(ImDrawList* dl, const Core::ViewTransform& vt,
+                               const Core::EquationSolver::Solution& solution,
+                               const float color[4], float thickness, FrameArena* arena,
+                               bool captureSamples) {
+    if (solution.branches.empty()) {
+        return;
+    }
 
     Core::Evaluator::Variables vars;
     const double xMin = vt.worldXMin();
@@ -483,45 +716,193 @@ void PlotRenderer::drawCurve2D(ImDrawList* dl, const Core::ViewTransform& vt,
         float y;
         bool valid;
     };
-    std::vector<Point> points;
+    std::pmr::vector<Point> points(scratchResource(arena));
     points.reserve(numSamples + 1);
+    std::uint64_t evaluations = 0;
+    // Hover state is only captured when nothing is published for this view yet (a redraw of an
+    // unchanged view republishes what it has). Segments go to the scratch arena and are copied
+    // out once; the hover index over them is built by the first query (see curveIndex). The
+    // analysis samples are only kept when asked for, and likewise once per view.
+    std::shared_ptr<const PublishedCurve> held = publishedCurve(solution.branches.front().get(), vt);
+    const bool capture = !held;
+    std::pmr::vector<CurveIndex::Segment> segments(scratchResource(arena));
+    std::shared_ptr<CurveAnalysis::Samples> samples;
+    if (capture) {
+        segments.reserve(static_cast<size_t>(numSamples) * solution.branches.size());
+    }
+    if (captureSamples && !(held && held->samples)) {
+        samples = std::make_shared<CurveAnalysis::Samples>();
+        samples->xMin = xMin;
+        samples->dx = dx;
+        samples->branches.reserve(solution.branches.size());
+    }
+    std::uint32_t branchIndex = 0;
+
+    // Last x on the real side of the discriminant between a sample where it holds and one
+    // where it does not (bisection; the branch ends there).
+    auto branchEnd = [&](double inside, double outside) {
+        for (int i = 0; i < 30; ++i) {
+            const double mid = 0.5 * (inside + outside);
+            vars["x"] = mid;
+            (Core::Evaluator::evaluate(solution.discriminant, vars) >= 0.0 ? inside : outside) = mid;
+        }
+        evaluations += 30;
+        return inside;
+    };
 
-    for (int i = 0; i <= numSamples; ++i) {
-        const double wx = xMin + i * dx;
-        vars["x"] = wx;
-        const double wy = Core::Evaluator::evaluate(ast, vars);
+    const float maxPixelJump = vt.screenHeight * 2.0f;
+    auto addSegment = [&](const Point& a, const Point& b) {
+        if (std::abs(b.y - a.y) > maxPixelJump) {
+            return; // likely a discontinuity
+        }
+        dl->AddLine(ImVec2(a.x, a.y), ImVec2(b.x, b.y), col, thickness);
+        if (capture) {
+            segments.push_back({ a.x, a.y, b.x, b.y, branchIndex });
+        }
+    };
+
+    // Samples mirrored about x = 0 take their partner's value when the branch is even or odd.
+    std::pmr::vector<double> xs(numSamples + 1, scratchResource(arena));
+    std::pmr::vector<double> wys(numSamples + 1, scratchResource(arena));
+    std::pmr::vector<int> source(numSamples + 1, scratchResource(arena));
+    for (int i = 0; i <= numSamples; ++i) xs[i] = xMin + i * dx;
 
-        if (std::isfinite(wy)) {
-            Core::Vec2 sp = vt.worldToScreen(wx, wy);
-            points.push_back({ sp.x, sp.y, true });
+    for (const Core::ASTNodePtr& branch : solution.branches) {
+        const Core::Parity parity = Core::Symmetry::parity(branch, "x");
+        if (parity == Core::Parity::None) {
+            for (int i = 0; i <= numSamples; ++i) source[i] = i;
         } else {
-            points.push_back({ 0.0f, 0.0f, false });
+            Core::Symmetry::mirrorSamples(xs.data(), numSamples + 1, source.data());
         }
-    }
+        for (int i = 0; i <= numSamples; ++i) {
+            if (source[i] == i) {
+                vars["x"] = xs[i];
+                wys[i] = Core::Evaluator::evaluate(branch, vars);
+            }
+        }
+        evaluations += static_cast<std::uint64_t>(numSamples) + 1u;
+
+        points.clear();
+        double* values = samples ? samples->branches.emplace_back(numSamples + 1).data() : nullptr;
+        for (int i = 0; i <= numSamples; ++i) {
+            const double wx = xs[i];
+            const double wy = (source[i] == i) ? wys[i]
+                            : (parity == Core::Parity::Odd) ? -wys[source[i]] : wys[source[i]];
+            if (values) {
+                values[i] = wy;
+            }
 
-    // Draw connected segments, breaking at NaN/Inf and large jumps
-    const float maxPixelJump = vt.screenHeight * 2.0f;
-    for (size_t i = 1; i < points.size(); ++i) {
-        if (!points[i].valid || !points[i - 1].valid) {
-            continue;
+            if (std::isfinite(wy)) {
+                Core::Vec2 sp = vt.worldToScreen(wx, wy);
+                points.push_back({ sp.x, sp.y, true });
+            } else {
+                points.push_back({ 0.0f, 0.0f, false });
+            }
+        }
+
+        // Draw connected segments, breaking at NaN/Inf and large jumps
+        for (size_t i = 1; i < points.size(); ++i) {
+            if (points[i].valid && points[i - 1].valid) {
+                addSegment(points[i - 1], points[i]);
+                continue;
+            }
+            if (!solution.discriminant || points[i].valid == points[i - 1].valid) {
+                continue;
+            }
+            // The branch turns complex between these samples: close it at the boundary.
+            const size_t valid = points[i].valid ? i : i - 1;
+            const double inside = xMin + static_cast<double>(valid) * dx;
+            const double outside = xMin + static_cast<double>(points[i].valid ? i - 1 : i) * dx;
+            vars["x"] = outside;
+            if (Core::Evaluator::evaluate(solution.discriminant, vars) >= 0.0) {
+                continue; // invalid for another reason (pole, function domain)
+            }
+            const double wx = branchEnd(inside, outside);
+            vars["x"] = wx;
+            const double wy = Core::Evaluator::evaluate(branch, vars);
+            evaluations += 2;
+            if (std::isfinite(wy)) {
+                const Core::Vec2 sp = vt.worldToScreen(wx, wy);
+                addSegment(points[valid], Point{ sp.x, sp.y, true });
+            }
         }
-        const float dy = std::abs(points[i].y - points[i - 1].y);
-        if (dy > maxPixelJump) {
-            continue; // likely a discontinuity
+        ++branchIndex;
+    }
+    recordEvaluations(evaluations);
+    if (capture || samples) {
+        auto entry = std::make_shared<PublishedCurve>();
+        entry->owner = solution.branches.front();
+        entry->view = vt;
+        if (capture) {
+            entry->segments.assign(segments.begin(), segments.end());
+        } else {
+            entry->segments = held->segments;  // analysis switched on over an unchanged view
         }
-        dl->AddLine(ImVec2(points[i - 1].x, points[i - 1].y),
-                    ImVec2(points[i].x, points[i].y),
-                    col, thickness);
+        entry->samples = std::move(samples);
+        held = std::move(entry);
     }
+    publishCurve(std::move(held));
 
     dl->PopClipRect();
 }
 
+// ---- measured data series -------------------------------------------------
+
+namespace {
+
+// Stroke a decimated series polyline, clipped to the plot. NaN vertices separate the runs; a
+// lone point is drawn as a dot.
+void strokeSeries(ImDrawList* dl, const Core::ViewTransform& vt, const std::pmr::vector<Core::Vec2>& points,
+                  ImU32 col, float thickness) {
+    if (points.empty()) {
+        return;
+    }
+    dl->PushClipRect(ImVec2(vt.screenOriginX, vt.screenOriginY),
+                     ImVec2(vt.screenOriginX + vt.screenWidth, vt.screenOriginY + vt.screenHeight), true);
+    auto flush = [&]() {
+        if (dl->_Path.Size == 1) {
+            const ImVec2 dot = dl->_Path[0];
+            dl->PathClear();
+            dl->AddCircleFilled(dot, thickness, col);
+        } else {
+            dl->PathStroke(col, 0, thickness);
+        }
+    };
+    for (const Core::Vec2& p : points) {
+        if (std::isnan(p.x)) {
+            flush();
+        } else {
+            dl->PathLineTo(ImVec2(p.x, p.y));
+        }
+    }
+    flush();
+    dl->PopClipRect();
+}
+
+} // namespace
+
+void PlotRenderer::drawDataSeries(ImDrawList* dl, const Core::ViewTransform& vt,
+                                  const DataSeries& series,
+                                  const float color[4], float thickness, FrameArena* arena) {
+    std::pmr::vector<Core::Vec2> points(scratchResource(arena));
+    series.decimate(vt, points);
+    strokeSeries(dl, vt, points, colorU32(color), thickness);
+}
+
+void PlotRenderer::drawStreamSeries(ImDrawList* dl, const Core::ViewTransform& vt,
+                                    const StreamSeries& series,
+                                    const float color[4], float thickness, FrameArena* arena) {
+    std::pmr::vector<Core::Vec2> points(scratchResource(arena));
+    series.decimate(vt, points);
+    strokeSeries(dl, vt, points, colorU32(color), thickness);
+}
+
 // ---- heat-map for f(x,y) ---------------------------------------------------
 
 void PlotRenderer::drawHeatmap(ImDrawList* dl, const Core::ViewTransform& vt,
                                const Core::ASTNodePtr& ast,
-                               const float tint[4], float alpha) {
+                               const float tint[4], float alpha, int contourLevels,
+                               FrameArena* arena) {
     if (!ast) {
         return;
     }
@@ -536,49 +917,30 @@ void PlotRenderer::drawHeatmap(ImDrawList* dl, const Core::ViewTransform& vt,
     const double dy = (yMax - yMin) / resY;
 
     // First pass: evaluate and find range
-    std::vector<double> values(resX * resY);
+    std::pmr::vector<double> values(resX * resY, scratchResource(arena));
     double lo = std::numeric_limits<double>::max();
     double hi = std::numeric_limits<double>::lowest();
-    Core::Evaluator::Variables vars;
-
-    for (int iy = 0; iy < resY; ++iy) {
-        vars["y"] = yMin + (iy + 0.5) * dy;
-        for (int ix = 0; ix < resX; ++ix) {
-            vars["x"] = xMin + (ix + 0.5) * dx;
-            const double value = Core::Evaluator::evaluate(ast, vars);
-            values[iy * resX + ix] = value;
-            if (std::isfinite(value)) {
-                lo = std::min(lo, value);
-                hi = std::max(hi, value);
-            }
+    std::pmr::vector<double> xs(resX, scratchResource(arena));
+    std::pmr::vector<double> ys(resY, scratchResource(arena));
+    for (int ix = 0; ix < resX; ++ix) xs[ix] = xMin + (ix + 0.5) * dx;
+    for (int iy = 0; iy < resY; ++iy) ys[iy] = yMin + (iy + 0.5) * dy;
+    Core::GridEvaluator(ast).evaluate(xs.data(), resX, ys.data(), resY, values.data(),
+                                      scratchResource(arena));
+    for (const double value : values) {
+        if (std::isfinite(value)) {
+            lo = std::min(lo, value);
+            hi = std::max(hi, value);
         }
     }
+    recordEvaluations(static_cast<std::uint64_t>(resX) * resY);
     if (lo >= hi) {
         lo = -1.0;
         hi = 1.0;
     }
 
-    // Clip
-    ImVec2 clipMin(vt.screenOriginX, vt.screenOriginY);
-    ImVec2 clipMax(vt.screenOriginX + vt.screenWidth,
-                   vt.screenOriginY + vt.screenHeight);
-    dl->PushClipRect(clipMin, clipMax, true);
-
     // Second pass: draw rectangles
-    for (int iy = 0; iy < resY; ++iy) {
-        const double wy = yMin + iy * dy;
-        for (int ix = 0; ix < resX; ++ix) {
-            const double wx = xMin + ix * dx;
-            const double value = values[iy * resX + ix];
-
-            Core::Vec2 tl = vt.worldToScreen(wx, wy + dy);
-            Core::Vec2 br = vt.worldToScreen(wx + dx, wy);
-            const ImU32 color = heatColor(value, lo, hi, tint, alpha);
-            dl->AddRectFilled(ImVec2(tl.x, tl.y), ImVec2(br.x, br.y), color);
-        }
-    }
-
-    dl->PopClipRect();
+    drawHeatCells(dl, vt, values.data(), resX, resY, xMin, yMin, dx, dy, lo, hi, tint, alpha,
+                  contourLevels, arena);
 }
 
 // ---- cross-section for f(x,y,z) at fixed z ---------------------------------
@@ -586,13 +948,14 @@ void PlotRenderer::drawHeatmap(ImDrawList* dl, const Core::ViewTransform& vt,
 void PlotRenderer::drawCrossSection(ImDrawList* dl, const Core::ViewTransform& vt,
                                     const Core::ASTNodePtr& ast,
                                     float zSlice,
-                                    const float tint[4], float alpha) {
+                                    const float tint[4], float alpha, int contourLevels,
+                                    FrameArena* arena) {
     if (!ast) {
         return;
     }
 
-    const int resX = 200;
-    const int resY = 150;
+    const int resX = kCrossSectionResX;
+    const int resY = kCrossSectionResY;
     const double xMin = vt.worldXMin();
     const double xMax = vt.worldXMax();
     const double yMin = vt.worldYMin();
@@ -600,29 +963,58 @@ void PlotRenderer::drawCrossSection(ImDrawList* dl, const Core::ViewTransform& v
     const double dx = (xMax - xMin) / resX;
     const double dy = (yMax - yMin) / resY;
 
-    std::vector<double> values(resX * resY);
+    std::pmr::vector<double> values(resX * resY, scratchResource(arena));
     double lo = std::numeric_limits<double>::max();
     double hi = std::numeric_limits<double>::lowest();
     Core::Evaluator::Variables vars;
     vars["z"] = static_cast<double>(zSlice);
 
-    for (int iy = 0; iy < resY; ++iy) {
-        vars["y"] = yMin + (iy + 0.5) * dy;
-        for (int ix = 0; ix < resX; ++ix) {
-            vars["x"] = xMin + (ix + 0.5) * dx;
-            const double value = Core::Evaluator::evaluate(ast, vars);
-            values[iy * resX + ix] = value;
-            if (std::isfinite(value)) {
-                lo = std::min(lo, value);
-                hi = std::max(hi, value);
-            }
+    std::pmr::vector<double> xs(resX, scratchResource(arena));
+    std::pmr::vector<double> ys(resY, scratchResource(arena));
+    for (int ix = 0; ix < resX; ++ix) xs[ix] = xMin + (ix + 0.5) * dx;
+    for (int iy = 0; iy < resY; ++iy) ys[iy] = yMin + (iy + 0.5) * dy;
+    Core::GridEvaluator(ast, vars).evaluate(xs.data(), resX, ys.data(), resY, values.data(),
+                                            scratchResource(arena));
+    for (const double value : values) {
+        if (std::isfinite(value)) {
+            lo = std::min(lo, value);
+            hi = std::max(hi, value);
         }
     }
+    recordEvaluations(static_cast<std::uint64_t>(resX) * resY);
     if (lo >= hi) {
         lo = -1.0;
         hi = 1.0;
     }
 
+    drawHeatCells(dl, vt, values.data(), resX, resY, xMin, yMin, dx, dy, lo, hi, tint, alpha,
+                  contourLevels, arena);
+}
+
+void PlotRenderer::drawCrossSection(ImDrawList* dl, const Core::ViewTransform& vt,
+                                    const VolumeCache::Volume& volume,
+                                    float zSlice,
+                                    const float tint[4], float alpha, int contourLevels,
+                                    FrameArena* arena) {
+    const VolumeCache::Domain& domain = volume.domain;
+    if (volume.values.empty()) {
+        return;
+    }
+
+    std::pmr::vector<double> values(static_cast<size_t>(domain.nx) * domain.ny,
+                                    scratchResource(arena));
+    volume.slice(zSlice, values.data());
+
+    drawHeatCells(dl, vt, values.data(), domain.nx, domain.ny, domain.xMin, domain.yMin,
+                  (domain.xMax - domain.xMin) / domain.nx, (domain.yMax - domain.yMin) / domain.ny,
+                  volume.lo, volume.hi, tint, alpha, contourLevels, arena);
+}
+
+void PlotRenderer::drawHeatCells(ImDrawList* dl, const Core::ViewTransform& vt,
+                                 const double* values, int resX, int resY,
+                                 double xMin, double yMin, double dx, double dy,
+                                 double lo, double hi, const float tint[4], float alpha,
+                                 int contourLevels, FrameArena* arena) {
     ImVec2 clipMin(vt.screenOriginX, vt.screenOriginY);
     ImVec2 clipMax(vt.screenOriginX + vt.screenWidth,
                    vt.screenOriginY + vt.screenHeight);
@@ -640,6 +1032,32 @@ void PlotRenderer::drawCrossSection(ImDrawList* dl, const Core::ViewTransform& v
         }
     }
 
+    // Iso-lines through the cell-centre samples, all levels in one sweep.
+    contourLevels = std::min(contourLevels, kMaxContourLevels);
+    if (contourLevels > 0 && lo < hi) {
+        double levels[kMaxContourLevels];
+        ContourLines::evenLevels(lo, hi, contourLevels, levels);
+        ContourLines contours(scratchResource(arena));
+        contours.extract(values, resX, resY, levels, contourLevels);
+
+        const ImU32 lineColor = IM_COL32(static_cast<int>(tint[0] * 0.25f * 255.0f),
+                                         static_cast<int>(tint[1] * 0.25f * 255.0f),
+                                         static_cast<int>(tint[2] * 0.25f * 255.0f),
+                                         static_cast<int>(std::clamp(alpha + 0.25f, 0.0f, 1.0f) * 255.0f));
+        std::pmr::vector<ImVec2> screen(scratchResource(arena));
+        const std::pmr::vector<Core::Vec2>& points = contours.points();
+        for (const ContourLines::Polyline& line : contours.polylines()) {
+            screen.clear();
+            for (std::uint32_t i = line.first; i < line.first + line.count; ++i) {
+                const Core::Vec2 sp = vt.worldToScreen(xMin + (points[i].x + 0.5) * dx,
+                                                       yMin + (points[i].y + 0.5) * dy);
+                screen.emplace_back(sp.x, sp.y);
+            }
+            dl->AddPolyline(screen.data(), static_cast<int>(screen.size()), lineColor,
+                            line.closed ? ImDrawFlags_Closed : ImDrawFlags_None, 1.0f);
+        }
+    }
+
     dl->PopClipRect();
 }
 
@@ -648,18 +1066,23 @@ void PlotRenderer::drawCrossSection(ImDrawList* dl, const Core::ViewTransform& v
 void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
                                  const Core::ASTNodePtr& ast,
                                  const float color[4],
-                                 const Surface3DOptions& options) {
+                                 const Surface3DOptions& options, FrameArena* arena) {
     if (!ast) {
         return;
     }
+    Core::EquationSolver::Solution surface;
+    surface.branches.push_back(ast);
+    drawSurface3D(dl, vt, surface, color, options, arena);
+}
+
+void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
+                                 const Core::EquationSolver::Solution& solution,
+                                 const float color[4],
+                                 const Surface3DOptions& options, FrameArena* arena) {
+    if (solution.branches.empty()) {
+        return;
+    }
 
-    struct Vertex {
-        double xProj;
-        double yProj;
-        double depth;
-        double value;
-        bool valid;
-    };
     struct ScreenVertex {
         float x;
         float y;
@@ -690,26 +1113,47 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
     const double yMax = vt.worldYMax();
     const double dx = (xMax - xMin) / nx;
     const double dy = (yMax - yMin) / ny;
-    std::vector<double> values((nx + 1) * (ny + 1), std::numeric_limits<double>::quiet_NaN());
+    const size_t gridSize = static_cast<size_t>(nx + 1) * (ny + 1);
+    const size_t branchCount = solution.branches.size();
+    std::pmr::vector<double> values(branchCount * gridSize, std::numeric_limits<double>::quiet_NaN(),
+                                    scratchResource(arena));
     double zMin = std::numeric_limits<double>::max();
     double zMax = std::numeric_limits<double>::lowest();
 
-    Core::Evaluator::Variables vars;
-    for (int iy = 0; iy <= ny; ++iy) {
-        const double wy = yMin + iy * dy;
-        vars["y"] = wy;
-        for (int ix = 0; ix <= nx; ++ix) {
-            const double wx = xMin + ix * dx;
-            vars["x"] = wx;
-            const double z = Core::Evaluator::evaluate(ast, vars);
-            values[iy * (nx + 1) + ix] = z;
-            if (std::isfinite(z)) {
-                zMin = std::min(zMin, z);
-                zMax = std::max(zMax, z);
-            }
+    std::pmr::vector<double> xs(nx + 1, scratchResource(arena));
+    std::pmr::vector<double> ys(ny + 1, scratchResource(arena));
+    for (int ix = 0; ix <= nx; ++ix) xs[ix] = xMin + ix * dx;
+    for (int iy = 0; iy <= ny; ++iy) ys[iy] = yMin + iy * dy;
+    for (size_t b = 0; b < branchCount; ++b) {
+        Core::GridEvaluator(solution.branches[b]).evaluate(xs.data(), nx + 1, ys.data(), ny + 1,
+                                                           values.data() + b * gridSize,
+                                                           scratchResource(arena));
+    }
+    std::pmr::vector<double> domain(scratchResource(arena));
+    if (solution.discriminant) {
+        domain.resize(gridSize);
+        Core::GridEvaluator(solution.discriminant).evaluate(xs.data(), nx + 1, ys.data(), ny + 1,
+                                                            domain.data(), scratchResource(arena));
+    }
+    int validPointCount = 0;
+    for (const double z : values) {
+        if (std::isfinite(z)) {
+            zMin = std::min(zMin, z);
+            zMax = std::max(zMax, z);
+            validPointCount++;
         }
     }
+    std::uint64_t evaluations = static_cast<std::uint64_t>(branchCount + (domain.empty() ? 0 : 1)) * gridSize;
+    if (validPointCount == 0) {
+        recordEvaluations(evaluations);
+        return;
+    }
 
+    const bool clipZ = std::isfinite(options.zClipMin) || std::isfinite(options.zClipMax);
+    if (clipZ) {
+        zMin = std::max(zMin, options.zClipMin);
+        zMax = std::min(zMax, options.zClipMax);
+    }
     if (zMin >= zMax) {
         zMin = -1.0;
         zMax = 1.0;
@@ -722,45 +1166,6 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
     const double cosE = std::cos(elevation);
     const double sinE = std::sin(elevation);
 
-    std::vector<Vertex> projected((nx + 1) * (ny + 1));
-    int validPointCount = 0;
-
-    for (int iy = 0; iy <= ny; ++iy) {
-        const double wy = yMin + iy * dy;
-        for (int ix = 0; ix <= nx; ++ix) {
-            const double wx = xMin + ix * dx;
-            const double z = values[iy * (nx + 1) + ix];
-            Vertex& v = projected[iy * (nx + 1) + ix];
-
-            if (!std::isfinite(z)) {
-                v.valid = false;
-                continue;
-            }
-
-            // Keep X/Y in world coordinates so the projected 3D geometry remains anchored to the
-            // same origin used by the 2D grid/axes (ViewTransform). Subtracting the current view
-            // center here would re-center the mesh every frame and cause visible "swimming".
-            const double x = wx;
-            const double y = wy;
-            const double zWorld = z * options.zScale;
-
-            const double xYaw = cosA * x - sinA * y;
-            const double yYaw = sinA * x + cosA * y;
-
-            v.xProj = xYaw;
-            v.yProj = cosE * yYaw - sinE * zWorld;
-            v.depth = sinE * yYaw + cosE * zWorld;
-            v.value = z;
-            v.valid = true;
-            validPointCount++;
-
-        }
-    }
-
-    if (validPointCount == 0) {
-        return;
-    }
-
     // Anchor 3D projection to the world origin so the 3D scene stays aligned with the 2D axes/grid
     // while panning/zooming. Previously this auto-centered to the visible surface bounds, which made
     // the 3D scene appear to "swim" relative to the 2D coordinates.
@@ -770,25 +1175,64 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
     const float sxCenter = vt.worldToScreen(0.0, 0.0).x;
     const float syCenter = vt.worldToScreen(0.0, 0.0).y;
 
-    std::vector<ScreenVertex> screenVerts((nx + 1) * (ny + 1));
-    for (size_t i = 0; i < projected.size(); ++i) {
-        const Vertex& v = projected[i];
-        ScreenVertex& s = screenVerts[i];
-        if (!v.valid) {
-            s.valid = false;
-            continue;
+    // Keep X/Y in world coordinates so the projected 3D geometry remains anchored to the
+    // same origin used by the 2D grid/axes (ViewTransform). Subtracting the current view
+    // center here would re-center the mesh every frame and cause visible "swimming".
+    auto project = [&](double x, double y, double z) {
+        const double zWorld = z * options.zScale;
+        const double xYaw = cosA * x - sinA * y;
+        const double yYaw = sinA * x + cosA * y;
+        const double xProj = xYaw;
+        const double yProj = cosE * yYaw - sinE * zWorld;
+        return ScreenVertex{
+            sxCenter + static_cast<float>(xProj * scale),
+            syCenter - static_cast<float>(yProj * scale),
+            sinE * yYaw + cosE * zWorld,
+            z,
+            true
+        };
+    };
+
+    // Publish the sampled grid for cursor picking unless this grid is already held (the below-
+    // and above-plane passes of one frame sample the same grid). Only the values are copied
+    // here; the triangles and their hierarchy are built off the render path by the first pick.
+    const std::array<double, 6> meshDomain = { xMin, xMax, yMin, yMax, options.zClipMin, options.zClipMax };
+    const void* meshKey = solution.branches.front().get();
+    if (!hasSurfaceMesh(meshKey, meshDomain, resolution)) {
+        auto grid = std::make_shared<MeshBvh::HeightGrid>();
+        grid->xMin = xMin;
+        grid->xMax = xMax;
+        grid->yMin = yMin;
+        grid->yMax = yMax;
+        grid->zClipMin = options.zClipMin;
+        grid->zClipMax = options.zClipMax;
+        grid->nx = nx;
+        grid->ny = ny;
+        grid->layers = static_cast<int>(branchCount);
+        grid->values.assign(values.begin(), values.end());
+        publishSurfaceMesh({ solution.branches.front(), nullptr, std::move(grid), meshDomain, resolution });
+    }
+
+    std::pmr::vector<ScreenVertex> screenVerts(branchCount * gridSize, scratchResource(arena));
+    for (size_t b = 0; b < branchCount; ++b) {
+        for (int iy = 0; iy <= ny; ++iy) {
+            const double wy = yMin + iy * dy;
+            for (int ix = 0; ix <= nx; ++ix) {
+                const size_t i = b * gridSize + static_cast<size_t>(iy) * (nx + 1) + ix;
+                const double z = values[i];
+                if (!std::isfinite(z)) {
+                    screenVerts[i].valid = false;
+                    continue;
+                }
+                screenVerts[i] = project(xMin + ix * dx, wy, z);
+            }
         }
-        s.x = sxCenter + static_cast<float>(v.xProj * scale);
-        s.y = syCenter - static_cast<float>(v.yProj * scale);
-        s.depth = v.depth;
-        s.value = v.value;
-        s.valid = true;
     }
 
     const bool usePlaneSplitPass = (options.planePass != SurfacePlanePass3D::All);
     const double planeZ = options.gridPlaneZ;
-    std::vector<Face> faces;
-    faces.reserve(static_cast<size_t>(nx * ny * (usePlaneSplitPass ? 4 : 2)));
+    std::pmr::vector<Face> faces(scratchResource(arena));
+    faces.reserve(branchCount * static_cast<size_t>(nx * ny * (usePlaneSplitPass ? 4 : 2)));
 
     auto pushFaceRaw = [&](const ClipVertex& a,
                            const ClipVertex& b,
@@ -802,11 +1246,11 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
         });
     };
 
-    auto clipIntersect = [&](const ClipVertex& a, const ClipVertex& b) -> ClipVertex {
+    auto clipIntersect = [&](const ClipVertex& a, const ClipVertex& b, double bound) -> ClipVertex {
         const double denom = (b.value - a.value);
         double t = 0.0;
         if (std::abs(denom) > 1e-12) {
-            t = (planeZ - a.value) / denom;
+            t = (bound - a.value) / denom;
         }
         t = std::clamp(t, 0.0, 1.0);
         return ClipVertex{
@@ -817,38 +1261,14 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
         };
     };
 
-    auto pushFace = [&](const ScreenVertex& a,
-                        const ScreenVertex& b,
-                        const ScreenVertex& c) {
-        if (!a.valid || !b.valid || !c.valid) {
-            return;
-        }
-
-        if (!usePlaneSplitPass) {
-            pushFaceRaw(
-                ClipVertex{ a.x, a.y, a.depth, a.value },
-                ClipVertex{ b.x, b.y, b.depth, b.value },
-                ClipVertex{ c.x, c.y, c.depth, c.value });
-            return;
-        }
-
+    // Sutherland-Hodgman step: keeps the part of `input` with value >= bound (keepAbove) or
+    // value <= bound. A convex polygon gains at most one vertex per step.
+    auto clipPolygon = [&](const ClipVertex* input, int inputCount, ClipVertex* output,
+                           double bound, bool keepAbove) {
         const auto isInside = [&](const ClipVertex& v) {
-            if (options.planePass == SurfacePlanePass3D::BelowGridPlane) {
-                return v.value <= planeZ;
-            }
-            return v.value >= planeZ;
+            return keepAbove ? v.value >= bound : v.value <= bound;
         };
-
-        ClipVertex input[4] = {
-            { a.x, a.y, a.depth, a.value },
-            { b.x, b.y, b.depth, b.value },
-            { c.x, c.y, c.depth, c.value },
-            {}
-        };
-        int inputCount = 3;
-        ClipVertex output[8] = {};
         int outputCount = 0;
-
         for (int i = 0; i < inputCount; ++i) {
             const ClipVertex& curr = input[i];
             const ClipVertex& prev = input[(i + inputCount - 1) % inputCount];
@@ -857,34 +1277,163 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
 
             if (currInside) {
                 if (!prevInside) {
-                    output[outputCount++] = clipIntersect(prev, curr);
+                    output[outputCount++] = clipIntersect(prev, curr, bound);
                 }
                 output[outputCount++] = curr;
             } else if (prevInside) {
-                output[outputCount++] = clipIntersect(prev, curr);
+                output[outputCount++] = clipIntersect(prev, curr, bound);
             }
         }
+        return outputCount;
+    };
 
-        if (outputCount < 3) {
+    auto pushFace = [&](const ScreenVertex& a,
+                        const ScreenVertex& b,
+                        const ScreenVertex& c) {
+        if (!a.valid || !b.valid || !c.valid) {
             return;
         }
 
-        for (int i = 1; i + 1 < outputCount; ++i) {
+        if (!usePlaneSplitPass && !clipZ) {
+            pushFaceRaw(
+                ClipVertex{ a.x, a.y, a.depth, a.value },
+                ClipVertex{ b.x, b.y, b.depth, b.value },
+                ClipVertex{ c.x, c.y, c.depth, c.value });
+            return;
+        }
+
+        ClipVertex polygon[2][8] = {
+            {
+                { a.x, a.y, a.depth, a.value },
+                { b.x, b.y, b.depth, b.value },
+                { c.x, c.y, c.depth, c.value }
+            },
+            {}
+        };
+        int count = 3;
+        int current = 0;
+        auto clipStep = [&](double bound, bool keepAbove) {
+            count = clipPolygon(polygon[current], count, polygon[1 - current], bound, keepAbove);
+            current = 1 - current;
+        };
+        if (usePlaneSplitPass) {
+            clipStep(planeZ, options.planePass == SurfacePlanePass3D::AboveGridPlane);
+        }
+        if (std::isfinite(options.zClipMin) && count >= 3) {
+            clipStep(options.zClipMin, true);
+        }
+        if (std::isfinite(options.zClipMax) && count >= 3) {
+            clipStep(options.zClipMax, false);
+        }
+        if (count < 3) {
+            return;
+        }
+
+        const ClipVertex* output = polygon[current];
+        for (int i = 1; i + 1 < count; ++i) {
             pushFaceRaw(output[0], output[i], output[i + 1]);
         }
     };
 
+    // Point on the cell edge from grid vertex `inside` (discriminant >= 0) towards `outside`
+    // (discriminant < 0) where the branches stop being real, found by bisection.
+    Core::Evaluator::Variables vars;
+    auto rimPoint = [&](size_t inside, size_t outside, double& wx, double& wy) {
+        const double x0 = xMin + static_cast<double>(inside % (nx + 1)) * dx;
+        const double y0 = yMin + static_cast<double>(inside / (nx + 1)) * dy;
+        const double x1 = xMin + static_cast<double>(outside % (nx + 1)) * dx;
+        const double y1 = yMin + static_cast<double>(outside / (nx + 1)) * dy;
+        double lo = 0.0;
+        double hi = 1.0;
+        for (int i = 0; i < 24; ++i) {
+            const double mid = 0.5 * (lo + hi);
+            vars["x"] = x0 + (x1 - x0) * mid;
+            vars["y"] = y0 + (y1 - y0) * mid;
+            (Core::Evaluator::evaluate(solution.discriminant, vars) >= 0.0 ? lo : hi) = mid;
+        }
+        evaluations += 24;
+        wx = x0 + (x1 - x0) * lo;
+        wy = y0 + (y1 - y0) * lo;
+    };
+
     for (int iy = 0; iy < ny; ++iy) {
         for (int ix = 0; ix < nx; ++ix) {
-            const ScreenVertex& v00 = screenVerts[iy * (nx + 1) + ix];
-            const ScreenVertex& v10 = screenVerts[iy * (nx + 1) + (ix + 1)];
-            const ScreenVertex& v01 = screenVerts[(iy + 1) * (nx + 1) + ix];
-            const ScreenVertex& v11 = screenVerts[(iy + 1) * (nx + 1) + (ix + 1)];
+            // Cell corners in loop order: v00, v10, v11, v01.
+            const size_t corner[4] = {
+                static_cast<size_t>(iy) * (nx + 1) + ix,
+                static_cast<size_t>(iy) * (nx + 1) + (ix + 1),
+                static_cast<size_t>(iy + 1) * (nx + 1) + (ix + 1),
+                static_cast<size_t>(iy + 1) * (nx + 1) + ix
+            };
+            bool rimResolved = false;
+            double rimX[4] = {};
+            double rimY[4] = {};
+
+            for (size_t b = 0; b < branchCount; ++b) {
+                const ScreenVertex* verts = screenVerts.data() + b * gridSize;
+                const ScreenVertex& v00 = verts[corner[0]];
+                const ScreenVertex& v10 = verts[corner[1]];
+                const ScreenVertex& v11 = verts[corner[2]];
+                const ScreenVertex& v01 = verts[corner[3]];
+                if (v00.valid && v10.valid && v11.valid && v01.valid) {
+                    pushFace(v00, v10, v11);
+                    pushFace(v00, v11, v01);
+                    continue;
+                }
+                if (domain.empty()) {
+                    continue;
+                }
 
-            pushFace(v00, v10, v11);
-            pushFace(v00, v11, v01);
+                // Trim a cell the discriminant boundary crosses once: its real corners plus the
+                // two boundary points. Corners invalid for any other reason leave the cell empty.
+                int crossings = 0;
+                bool anyValid = false;
+                bool trimmable = true;
+                for (int k = 0; k < 4; ++k) {
+                    const bool valid = verts[corner[k]].valid;
+                    const bool real = domain[corner[k]] >= 0.0;
+                    trimmable = trimmable && (valid == real);
+                    anyValid = anyValid || valid;
+                    crossings += (valid != verts[corner[(k + 1) % 4]].valid) ? 1 : 0;
+                }
+                if (!trimmable || !anyValid || crossings != 2) {
+                    continue;
+                }
+                if (!rimResolved) {
+                    for (int k = 0; k < 4; ++k) {
+                        const size_t a = corner[k];
+                        const size_t c = corner[(k + 1) % 4];
+                        if (verts[a].valid != verts[c].valid) {
+                            rimPoint(verts[a].valid ? a : c, verts[a].valid ? c : a, rimX[k], rimY[k]);
+                        }
+                    }
+                    rimResolved = true;
+                }
+
+                ScreenVertex polygon[6];
+                int count = 0;
+                bool complete = true;
+                for (int k = 0; k < 4 && complete; ++k) {
+                    const ScreenVertex& a = verts[corner[k]];
+                    if (a.valid) {
+                        polygon[count++] = a;
+                    }
+                    if (a.valid != verts[corner[(k + 1) % 4]].valid) {
+                        vars["x"] = rimX[k];
+                        vars["y"] = rimY[k];
+                        const double z = Core::Evaluator::evaluate(solution.branches[b], vars);
+                        ++evaluations;
+                        complete = std::isfinite(z);
+                        polygon[count++] = project(rimX[k], rimY[k], z);
+                    }
+                }
+                for (int i = 1; complete && i + 1 < count; ++i) {
+                    pushFace(polygon[0], polygon[i], polygon[i + 1]);
+                }
+            }
         }
     }
+    recordEvaluations(evaluations);
 
     std::sort(faces.begin(), faces.end(),
               [](const Face& a, const Face& b) { return a.depth < b.depth; });
@@ -971,7 +1520,7 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
             { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
         };
 
-        std::vector<EnvelopeEdge> edges;
+        std::pmr::vector<EnvelopeEdge> edges(scratchResource(arena));
         edges.reserve(12);
         double edgeDepthMin = std::numeric_limits<double>::max();
         double edgeDepthMax = std::numeric_limits<double>::lowest();
@@ -1016,19 +1565,24 @@ void PlotRenderer::drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
 
 // ---- implicit 3D surface F(x,y,z)=0 ----------------------------------------
 
+void PlotRenderer::implicitZRange(const Core::ViewTransform& vt, float zCenter,
+                                  double& zMin, double& zMax) {
+    const double xySpan = std::max(std::max(1e-6, vt.worldXMax() - vt.worldXMin()),
+                                   std::max(1e-6, vt.worldYMax() - vt.worldYMin()));
+    const double zHalfSpan = std::max(1.0, xySpan * 0.5);
+    zMin = static_cast<double>(zCenter) - zHalfSpan;
+    zMax = static_cast<double>(zCenter) + zHalfSpan;
+}
+
 void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
                                          const Core::ASTNodePtr& ast,
                                          const float color[4],
-                                         const Surface3DOptions& options) {
+                                         const Surface3DOptions& options, FrameArena* arena) {
     if (!ast) {
         return;
     }
 
-    struct Point3 {
-        double x;
-        double y;
-        double z;
-    };
+    using Point3 = MeshBvh::Vec3;
     struct ProjectedVertex {
         double wx;
         double wy;
@@ -1061,11 +1615,7 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
     };
     // Stored in world coordinates so we can reuse the extracted mesh across camera changes
     // (azimuth/elevation/zScale/opacity/wireframe) and only re-project when needed.
-    struct WorldFace {
-        Point3 p0;
-        Point3 p1;
-        Point3 p2;
-    };
+    using WorldFace = MeshBvh::Triangle;
     // Cache invalidation is intentionally tied to AST identity + sampling domain + grid size.
     // Camera and visual styling are excluded because they only affect projection/shading.
     struct MeshCacheKey {
@@ -1078,10 +1628,12 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
         double zCenter;
         double zMinDomain;
         double zMaxDomain;
+        bool sharpFeatures;
     };
     struct MeshCacheData {
         MeshCacheKey key{};
-        std::vector<WorldFace> faces;
+        Core::ASTNodePtr ast;  // keeps key.astPtr from being reused by another formula
+        MeshBvh::Mesh faces;
         // Bounds of the extracted surface (not the whole sampling box). Used for envelope box
         // and to stabilize z-based coloring without rescanning all triangles every frame.
         double surfXMin = 0.0;
@@ -1090,7 +1642,6 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
         double surfYMax = 0.0;
         double surfZMin = 0.0;
         double surfZMax = 0.0;
-        bool valid = false;
     };
     struct EnvelopePoint {
         ImVec2 screen;
@@ -1120,11 +1671,10 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
     // The implicit surface is sampled only inside the current view domain.
     // This means a valid shape (e.g. a sphere) can appear "cut open" if the current x/y range
     // clips it; the mesh is built only for the sampled box.
-    const double xySpan = std::max(std::max(1e-6, xMax - xMin), std::max(1e-6, yMax - yMin));
     const double zCenter = static_cast<double>(options.implicitZCenter);
-    const double zHalfSpan = std::max(1.0, xySpan * 0.5);
-    const double zMinDomain = zCenter - zHalfSpan;
-    const double zMaxDomain = zCenter + zHalfSpan;
+    double zMinDomain = 0.0;
+    double zMaxDomain = 0.0;
+    implicitZRange(vt, options.implicitZCenter, zMinDomain, zMaxDomain);
     const double dz = std::max(1e-6, (zMaxDomain - zMinDomain) / nz);
 
     auto gridIndex = [&](int ix, int iy, int iz) -> size_t {
@@ -1133,19 +1683,36 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
     // Rebuild the implicit mesh only when the sampled field/domain changes.
     const MeshCacheKey cacheKey{
         ast.get(), gridRes,
-        xMin, xMax, yMin, yMax, zCenter, zMinDomain, zMaxDomain
+        xMin, xMax, yMin, yMax, zCenter, zMinDomain, zMaxDomain, options.sharpFeatures
     };
-    static MeshCacheData s_meshCache;
-    const bool cacheHit = s_meshCache.valid &&
-        s_meshCache.key.astPtr == cacheKey.astPtr &&
-        s_meshCache.key.gridRes == cacheKey.gridRes &&
-        s_meshCache.key.xMin == cacheKey.xMin &&
-        s_meshCache.key.xMax == cacheKey.xMax &&
-        s_meshCache.key.yMin == cacheKey.yMin &&
-        s_meshCache.key.yMax == cacheKey.yMax &&
-        s_meshCache.key.zCenter == cacheKey.zCenter &&
-        s_meshCache.key.zMinDomain == cacheKey.zMinDomain &&
-        s_meshCache.key.zMaxDomain == cacheKey.zMaxDomain;
+    // One cached mesh per implicit formula, most recently used first. Formulas may be drawn
+    // concurrently (PlotPanel builds formula geometry on worker threads), so the list is guarded
+    // and entries are immutable shared snapshots that stay alive while a draw still uses them.
+    static std::mutex s_meshCacheMutex;
+    static std::vector<std::shared_ptr<const MeshCacheData>> s_meshCache;
+    constexpr size_t kMeshCacheCapacity = 8;
+    std::shared_ptr<const MeshCacheData> cachedMesh;
+    {
+        std::lock_guard<std::mutex> lock(s_meshCacheMutex);
+        for (auto it = s_meshCache.begin(); it != s_meshCache.end(); ++it) {
+            const MeshCacheKey& key = (*it)->key;
+            if (key.astPtr == cacheKey.astPtr &&
+                key.gridRes == cacheKey.gridRes &&
+                key.xMin == cacheKey.xMin &&
+                key.xMax == cacheKey.xMax &&
+                key.yMin == cacheKey.yMin &&
+                key.yMax == cacheKey.yMax &&
+                key.zCenter == cacheKey.zCenter &&
+                key.zMinDomain == cacheKey.zMinDomain &&
+                key.zMaxDomain == cacheKey.zMaxDomain &&
+                key.sharpFeatures == cacheKey.sharpFeatures) {
+                cachedMesh = *it;
+                std::rotate(s_meshCache.begin(), it, it + 1);
+                break;
+            }
+        }
+    }
+    const bool cacheHit = (cachedMesh != nullptr);
 
     const double azimuth = static_cast<double>(options.azimuthDeg) * 3.14159265358979323846 / 180.0;
     const double elevation = static_cast<double>(options.elevationDeg) * 3.14159265358979323846 / 180.0;
@@ -1189,10 +1756,8 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
         bool active;
     };
 
-    std::vector<WorldFace> worldFaces;
-    std::vector<ProjectedFace> projectedFaces;
-    worldFaces.reserve(static_cast<size_t>(nx) * static_cast<size_t>(ny) *
-                       static_cast<size_t>(nz) * 2u);
+    std::pmr::vector<WorldFace> worldFaces(scratchResource(arena));
+    std::pmr::vector<ProjectedFace> projectedFaces(scratchResource(arena));
     const std::vector<WorldFace>* meshFaces = nullptr;
 
     double surfXMin = std::numeric_limits<double>::max();
@@ -1287,35 +1852,70 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
         }
     };
 
+    (cacheHit ? g_statMeshCacheHits : g_statMeshCacheMisses).fetch_add(1, std::memory_order_relaxed);
     if (cacheHit) {
         // Fast path: reuse previously extracted mesh and its bounds. This avoids re-evaluating
         // the scalar field on the 3D grid and re-running the surface extraction.
-        meshFaces = &s_meshCache.faces;
-        surfXMin = s_meshCache.surfXMin;
-        surfXMax = s_meshCache.surfXMax;
-        surfYMin = s_meshCache.surfYMin;
-        surfYMax = s_meshCache.surfYMax;
-        surfZMin = s_meshCache.surfZMin;
-        surfZMax = s_meshCache.surfZMax;
+        meshFaces = &cachedMesh->faces;
+        surfXMin = cachedMesh->surfXMin;
+        surfXMax = cachedMesh->surfXMax;
+        surfYMin = cachedMesh->surfYMin;
+        surfYMax = cachedMesh->surfYMax;
+        surfZMin = cachedMesh->surfZMin;
+        surfZMax = cachedMesh->surfZMax;
     } else {
         // Slow path: sample F(x,y,z) over the current 3D grid. This is the dominant cost and is
         // intentionally skipped on cache hits (camera/style changes only).
-        std::vector<double> values(static_cast<size_t>(nx + 1) * (ny + 1) * (nz + 1),
-                                   std::numeric_limits<double>::quiet_NaN());
+        std::pmr::vector<double> values(static_cast<size_t>(nx + 1) * (ny + 1) * (nz + 1),
+                                        std::numeric_limits<double>::quiet_NaN(),
+                                        scratchResource(arena));
+        // One x/y plane per z: subtrees without x or y are evaluated once per plane, and x-only
+        // or y-only subtrees once per column or row of it.
+        std::pmr::vector<double> xs(nx + 1, scratchResource(arena));
+        std::pmr::vector<double> ys(ny + 1, scratchResource(arena));
+        for (int ix = 0; ix <= nx; ++ix) xs[ix] = xMin + ix * dx;
+        for (int iy = 0; iy <= ny; ++iy) ys[iy] = yMin + iy * dy;
+        // A z-even or z-odd field sampled over a window centred on z = 0 only needs the planes
+        // at z >= 0; the others are mirrored copies.
+        std::pmr::vector<double> zs(nz + 1, scratchResource(arena));
+        std::pmr::vector<int> zSource(nz + 1, scratchResource(arena));
+        for (int iz = 0; iz <= nz; ++iz) zs[iz] = zMinDomain + iz * dz;
+        const Core::Parity zParity = Core::Symmetry::parity(ast, "z");
+        if (zParity == Core::Parity::None) {
+            for (int iz = 0; iz <= nz; ++iz) zSource[iz] = iz;
+        } else {
+            Core::Symmetry::mirrorSamples(zs.data(), nz + 1, zSource.data());
+        }
         Core::Evaluator::Variables vars;
         for (int iz = 0; iz <= nz; ++iz) {
-            vars["z"] = zMinDomain + iz * dz;
-            for (int iy = 0; iy <= ny; ++iy) {
-                vars["y"] = yMin + iy * dy;
-                for (int ix = 0; ix <= nx; ++ix) {
-                    vars["x"] = xMin + ix * dx;
-                    values[gridIndex(ix, iy, iz)] = Core::Evaluator::evaluate(ast, vars);
-                }
+            if (zSource[iz] != iz) {
+                continue;
             }
+            vars["z"] = zs[iz];
+            Core::GridEvaluator(ast, vars).evaluate(xs.data(), nx + 1, ys.data(), ny + 1,
+                                                    &values[gridIndex(0, 0, iz)],
+                                                    scratchResource(arena));
         }
-
-        std::vector<CellVertex> cellVertices(static_cast<size_t>(nx) * ny * nz,
-                                             CellVertex{ Point3{ 0.0, 0.0, 0.0 }, false });
+        for (int iz = 0; iz <= nz; ++iz) {
+            if (zSource[iz] == iz) {
+                continue;
+            }
+            const double* src = &values[gridIndex(0, 0, zSource[iz])];
+            double* dst = &values[gridIndex(0, 0, iz)];
+            for (size_t i = 0, n = static_cast<size_t>(nx + 1) * (ny + 1); i < n; ++i) {
+                dst[i] = (zParity == Core::Parity::Odd) ? -src[i] : src[i];
+            }
+        }
+        recordEvaluations(static_cast<std::uint64_t>(nx + 1) * (ny + 1) * (nz + 1));
+
+        std::pmr::vector<CellVertex> cellVertices(static_cast<size_t>(nx) * ny * nz,
+                                                  CellVertex{ Point3{ 0.0, 0.0, 0.0 }, false },
+                                                  scratchResource(arena));
+        // Surface-nets output grows with surface area (~N^2), not volume. Reserving for the
+        // box's surface keeps typical meshes to one allocation without pinning an N^3 buffer
+        // in the frame arena.
+        worldFaces.reserve((static_cast<size_t>(nx) * ny + static_cast<size_t>(ny) * nz +
+                            static_cast<size_t>(nx) * nz) * 4u);
         auto cellIndex = [&](int ix, int iy, int iz) -> size_t {
             return static_cast<size_t>(((iz * ny) + iy) * nx + ix);
         };
@@ -1356,10 +1956,34 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
             emitQuad(ca.p, cb.p, cc.p, cd.p);
         };
 
+        // Dual contouring needs the field gradient at each crossing: central differences on
+        // the compiled formula, with steps far below the cell size so a crease next to the
+        // crossing does not blur its normal.
+        std::unique_ptr<Core::IntervalEvaluator> gradientField;
+        Core::IntervalEvaluator::Scratch gradientScratch;
+        std::uint64_t gradientEvaluations = 0;
+        if (options.sharpFeatures) {
+            gradientField = std::make_unique<Core::IntervalEvaluator>(ast);
+        }
+        const double hx = dx * 1e-3;
+        const double hy = dy * 1e-3;
+        const double hz = dz * 1e-3;
+        auto fieldGradient = [&](const Point3& p) -> Qef::Vec3 {
+            const Core::IntervalEvaluator& f = *gradientField;
+            gradientEvaluations += 6;
+            return {
+                (f.evaluate(p.x + hx, p.y, p.z, gradientScratch) - f.evaluate(p.x - hx, p.y, p.z, gradientScratch)) / (2.0 * hx),
+                (f.evaluate(p.x, p.y + hy, p.z, gradientScratch) - f.evaluate(p.x, p.y - hy, p.z, gradientScratch)) / (2.0 * hy),
+                (f.evaluate(p.x, p.y, p.z + hz, gradientScratch) - f.evaluate(p.x, p.y, p.z - hz, gradientScratch)) / (2.0 * hz)
+            };
+        };
+
         // Pass 1 (surface nets):
         // For each voxel cell that contains a sign change, compute one representative vertex
         // by averaging all F=0 edge intersections in that cell. This creates a more uniform
         // vertex distribution than tetrahedra-based triangulation for smooth shapes.
+        // With sharpFeatures the vertex is instead the QEF minimizer of the planes through the
+        // crossings (dual contouring), clamped to the cell, which lands on creases and corners.
         for (int iz = 0; iz < nz; ++iz) {
             for (int iy = 0; iy < ny; ++iy) {
                 for (int ix = 0; ix < nx; ++ix) {
@@ -1393,6 +2017,7 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
 
                     Point3 sum{ 0.0, 0.0, 0.0 };
                     int intersectionCount = 0;
+                    Qef qef;
                     for (const auto& edge : kCubeEdges) {
                         Point3 ip{};
                         if (!interpolateIso(corners[edge[0]], cornerValues[edge[0]],
@@ -1403,6 +2028,9 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
                         sum.y += ip.y;
                         sum.z += ip.z;
                         ++intersectionCount;
+                        if (gradientField) {
+                            qef.add({ ip.x, ip.y, ip.z }, fieldGradient(ip));
+                        }
                     }
 
                     if (intersectionCount < 3) {
@@ -1413,10 +2041,20 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
                     const double inv = 1.0 / static_cast<double>(intersectionCount);
                     cv.p = Point3{ sum.x * inv, sum.y * inv, sum.z * inv };
                     cv.active = true;
+                    if (qef.count() >= 2) {
+                        const Qef::Vec3 p = qef.solve();
+                        const Point3& lo = corners[0];
+                        const Point3& hi = corners[6];
+                        cv.p = Point3{ std::clamp(p[0], lo.x, hi.x),
+                                       std::clamp(p[1], lo.y, hi.y),
+                                       std::clamp(p[2], lo.z, hi.z) };
+                    }
                 }
             }
         }
 
+        recordEvaluations(gradientEvaluations);
+
         // Pass 2:
         // Stitch the per-cell vertices into quads around sign-changing grid edges, then split
         // each quad into two triangles. This yields far fewer triangles than tetrahedra output.
@@ -1471,25 +2109,38 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
             }
         }
 
-        // Publish cache only after a full successful extraction.
-        s_meshCache.key = cacheKey;
-        s_meshCache.faces = worldFaces;
-        s_meshCache.surfXMin = surfXMin;
-        s_meshCache.surfXMax = surfXMax;
-        s_meshCache.surfYMin = surfYMin;
-        s_meshCache.surfYMax = surfYMax;
-        s_meshCache.surfZMin = surfZMin;
-        s_meshCache.surfZMax = surfZMax;
-        s_meshCache.valid = true;
-        meshFaces = &s_meshCache.faces;
+        // Publish cache only after a full successful extraction. The new mesh replaces any
+        // older mesh of the same formula (stale domain/resolution).
+        auto mesh = std::make_shared<MeshCacheData>();
+        mesh->key = cacheKey;
+        mesh->ast = ast;
+        mesh->faces.assign(worldFaces.begin(), worldFaces.end());
+        mesh->surfXMin = surfXMin;
+        mesh->surfXMax = surfXMax;
+        mesh->surfYMin = surfYMin;
+        mesh->surfYMax = surfYMax;
+        mesh->surfZMin = surfZMin;
+        mesh->surfZMax = surfZMax;
+        cachedMesh = mesh;
+        meshFaces = &cachedMesh->faces;
+        {
+            std::lock_guard<std::mutex> lock(s_meshCacheMutex);
+            s_meshCache.erase(std::remove_if(s_meshCache.begin(), s_meshCache.end(),
+                [&](const std::shared_ptr<const MeshCacheData>& entry) {
+                    return entry->key.astPtr == cacheKey.astPtr;
+                }), s_meshCache.end());
+            s_meshCache.insert(s_meshCache.begin(), cachedMesh);
+            if (s_meshCache.size() > kMeshCacheCapacity) {
+                s_meshCache.resize(kMeshCacheCapacity);
+            }
+        }
     }
 
-    if (meshFaces == nullptr) {
-        meshFaces = &worldFaces;
-    }
-    if (meshFaces->empty()) {
+    if (meshFaces == nullptr || meshFaces->empty()) {
         return;
     }
+    // The picking mesh shares the cache entry's faces.
+    publishSurfaceMesh({ ast, std::shared_ptr<const MeshBvh::Mesh>(cachedMesh, &cachedMesh->faces), nullptr });
 
     // Lighting is evaluated after projection from cached world triangles so visual changes
     // (camera angle / zScale) update correctly without rebuilding the mesh.
@@ -1549,7 +2200,7 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
 
     const bool usePlaneSplitPass = (options.planePass != SurfacePlanePass3D::All);
     const double planeZ = options.gridPlaneZ;
-    std::vector<ScreenFace> screenFaces;
+    std::pmr::vector<ScreenFace> screenFaces(scratchResource(arena));
     screenFaces.reserve(projectedFaces.size() * (usePlaneSplitPass ? 2u : 1u));
 
     auto pushScreenFaceRaw = [&](const ClipProjectedVertex& a,
@@ -1726,7 +2377,7 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
             { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
         };
 
-        std::vector<EnvelopeEdge> edges;
+        std::pmr::vector<EnvelopeEdge> edges(scratchResource(arena));
         edges.reserve(12);
         double edgeDepthMin = std::numeric_limits<double>::max();
         double edgeDepthMax = std::numeric_limits<double>::lowest();
@@ -1773,7 +2424,7 @@ void PlotRenderer::drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransfo
 
 void PlotRenderer::drawImplicitContour2D(ImDrawList* dl, const Core::ViewTransform& vt,
                                          const Core::ASTNodePtr& ast,
-                                         const float color[4], float thickness) {
+                                         const float color[4], float thickness, FrameArena* arena) {
     if (!ast) {
         return;
     }
@@ -1791,16 +2442,15 @@ void PlotRenderer::drawImplicitContour2D(ImDrawList* dl, const Core::ViewTransfo
         return iy * (resX + 1) + ix;
     };
 
-    std::vector<double> values((resX + 1) * (resY + 1), std::numeric_limits<double>::quiet_NaN());
-    Core::Evaluator::Variables vars;
-
-    for (int iy = 0; iy <= resY; ++iy) {
-        vars["y"] = yMin + iy * dy;
-        for (int ix = 0; ix <= resX; ++ix) {
-            vars["x"] = xMin + ix * dx;
-            values[indexOf(ix, iy)] = Core::Evaluator::evaluate(ast, vars);
-        }
-    }
+    std::pmr::vector<double> values((resX + 1) * (resY + 1), std::numeric_limits<double>::quiet_NaN(),
+                                    scratchResource(arena));
+    std::pmr::vector<double> xs(resX + 1, scratchResource(arena));
+    std::pmr::vector<double> ys(resY + 1, scratchResource(arena));
+    for (int ix = 0; ix <= resX; ++ix) xs[ix] = xMin + ix * dx;
+    for (int iy = 0; iy <= resY; ++iy) ys[iy] = yMin + iy * dy;
+    Core::GridEvaluator(ast).evaluate(xs.data(), resX + 1, ys.data(), resY + 1, values.data(),
+                                      scratchResource(arena));
+    recordEvaluations(static_cast<std::uint64_t>(resX + 1) * (resY + 1));
 
     // Interpolate along a cell edge to find the zero-crossing between two sample values.
     // Returns true (and fills 'out' with the screen-space point) when the edge crosses zero.
@@ -3,11 +3,23 @@
 
 #include "../Core/ViewTransform.h"
 #include "../Core/ASTNode.h"
+#include "../Core/EquationSolver.h"
+#include "CurveAnalysis.h"
+#include "CurveIndex.h"
+#include "DataSeries.h"
+#include "StreamSeries.h"
+#include "MeshBvh.h"
+#include "VolumeCache.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
 
 struct ImDrawList;
 
 namespace XpressFormula::Plotting {
 
+class FrameArena;
+
 class PlotRenderer {
 public:
     enum class SurfacePlanePass3D {
@@ -24,6 +36,10 @@ public:
         // Used by implicit F(x,y,z)=0 extraction. Kept separate because implicit meshing
         // is O(N^3) and usually needs a different quality/perf tradeoff than z=f(x,y).
         int   implicitResolution = 64;
+        // Implicit extraction: place each cell vertex by dual contouring (a QEF over the
+        // crossings and their field gradients) instead of averaging the crossings, so
+        // creases and corners of min/max/abs shapes stay sharp at low resolution.
+        bool  sharpFeatures = false;
         float opacity = 0.82f;
         float wireThickness = 1.0f;
         bool  showEnvelope = true;
@@ -36,8 +52,25 @@ public:
         // Used to render: geometry below plane -> grid -> geometry above plane.
         SurfacePlanePass3D planePass = SurfacePlanePass3D::All;
         double gridPlaneZ = 0.0;
+        // Optional z window for z=f(x,y) surfaces: faces are clipped to [zClipMin, zClipMax].
+        // Solved implicit equations use it to match the z range the implicit mesher samples.
+        double zClipMin = -std::numeric_limits<double>::infinity();
+        double zClipMax = std::numeric_limits<double>::infinity();
+
+        bool operator==(const Surface3DOptions&) const = default;
     };
 
+    /// Cumulative work counters since the last resetStats(). Used by the benchmark runner and
+    /// diagnostics to relate frame cost to the number of formula evaluations performed.
+    struct RenderStats {
+        std::uint64_t evaluations = 0;
+        std::uint64_t meshCacheHits = 0;
+        std::uint64_t meshCacheMisses = 0;
+    };
+
+    static RenderStats stats();
+    static void resetStats();
+
     /// Draw grid lines (major and minor).
     static void drawGrid(ImDrawList* dl, const Core::ViewTransform& vt);
 
@@ -55,43 +88,154 @@ public:
     static void drawAxes3D(ImDrawList* dl, const Core::ViewTransform& vt,
                            const Surface3DOptions& options);
 
-    /// Plot a 2D curve f(x).
+    // The formula draw calls below take an optional FrameArena for their per-call scratch
+    // buffers (sample grids, projected vertices, sorted faces). Without one they use the heap.
+
+    /// Plot a 2D curve f(x). With `captureSamples`, its world-space samples are also published
+    /// for curve analysis (see curveSamples).
     static void drawCurve2D(ImDrawList* dl, const Core::ViewTransform& vt,
                             const Core::ASTNodePtr& ast,
-                            const float color[4], float thickness = 2.0f);
+                            const float color[4], float thickness = 2.0f,
+                            FrameArena* arena = nullptr, bool captureSamples = false);
+
+    /// Plot the branches y = g(x) of an F(x,y)=0 equation solved for y. When the solution has
+    /// a discriminant, each branch is extended to the x where it turns complex, so the two
+    /// halves of a circle meet instead of stopping one sample short.
+    static void drawCurve2D(ImDrawList* dl, const Core::ViewTransform& vt,
+                            const Core::EquationSolver::Solution& solution,
+                            const float color[4], float thickness = 2.0f,
+                            FrameArena* arena = nullptr, bool captureSamples = false);
+
+    /// Plot a measured data series, decimated to at most two vertices per pixel column (see
+    /// DataSeries::decimate), so the cost follows the plot width rather than the point count.
+    static void drawDataSeries(ImDrawList* dl, const Core::ViewTransform& vt,
+                               const DataSeries& series,
+                               const float color[4], float thickness = 1.5f,
+                               FrameArena* arena = nullptr);
+
+    /// Plot the current window of a live series the same way.
+    static void drawStreamSeries(ImDrawList* dl, const Core::ViewTransform& vt,
+                                 const StreamSeries& series,
+                                 const float color[4], float thickness = 1.5f,
+                                 FrameArena* arena = nullptr);
+
+    /// Screen-space segments of the curve last drawn by drawCurve2D under `key` (the AST, or the
+    /// first branch of the solution), indexed for nearest-segment queries. Null when the curve
+    /// has not been drawn or was last drawn for a different view than `vt`. Drawing only keeps
+    /// the segments; the first query for a view builds the index.
+    static std::shared_ptr<const CurveIndex> curveIndex(const void* key, const Core::ViewTransform& vt);
+
+    /// World-space samples of the same curve (every branch at each sampled x), for the same
+    /// key and view rules as curveIndex. Null unless the curve was drawn with captureSamples.
+    static std::shared_ptr<const CurveAnalysis::Samples> curveSamples(const void* key,
+                                                                      const Core::ViewTransform& vt);
+
+    // The heat-map calls below also draw `contourLevels` iso-lines, evenly spaced over the
+    // colour range, traced from the same samples (see ContourLines).
 
     /// Plot a heat-map for f(x,y).
     static void drawHeatmap(ImDrawList* dl, const Core::ViewTransform& vt,
                             const Core::ASTNodePtr& ast,
-                            const float tint[4], float alpha = 0.6f);
+                            const float tint[4], float alpha = 0.6f,
+                            int contourLevels = 0, FrameArena* arena = nullptr);
 
     /// Plot a heat-map cross-section for f(x,y,z) at a given z slice.
     static void drawCrossSection(ImDrawList* dl, const Core::ViewTransform& vt,
                                  const Core::ASTNodePtr& ast,
                                  float zSlice,
-                                 const float tint[4], float alpha = 0.6f);
+                                 const float tint[4], float alpha = 0.6f,
+                                 int contourLevels = 0, FrameArena* arena = nullptr);
+
+    /// Plot the z slice of a pre-sampled f(x,y,z) volume without evaluating the formula. Colours
+    /// use the volume's global value range, so scrubbing z keeps a stable scale.
+    static void drawCrossSection(ImDrawList* dl, const Core::ViewTransform& vt,
+                                 const VolumeCache::Volume& volume,
+                                 float zSlice,
+                                 const float tint[4], float alpha = 0.6f,
+                                 int contourLevels = 0, FrameArena* arena = nullptr);
+
+    /// Most iso-lines a heat map draws.
+    static constexpr int kMaxContourLevels = 64;
+
+    /// Cross-section heat-map grid (cells across the visible x/y range).
+    static constexpr int kCrossSectionResX = 200;
+    static constexpr int kCrossSectionResY = 150;
 
     /// Plot a 3D z=f(x,y) surface using an isometric-style projection.
     static void drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
                               const Core::ASTNodePtr& ast, const float color[4],
-                              const Surface3DOptions& options);
+                              const Surface3DOptions& options,
+                              FrameArena* arena = nullptr);
+
+    /// Plot the branches z = g(x,y) of an F(x,y,z)=0 equation solved for z as one depth-sorted
+    /// surface. Grid cells crossed by the discriminant's zero set are trimmed to it, so the
+    /// branches of a sphere close along its equator.
+    static void drawSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
+                              const Core::EquationSolver::Solution& solution, const float color[4],
+                              const Surface3DOptions& options,
+                              FrameArena* arena = nullptr);
 
     /// Plot the implicit 3D surface F(x,y,z)=0 using a cached surface-nets style mesh,
     /// then project/draw it as depth-sorted triangles in ImGui.
     static void drawImplicitSurface3D(ImDrawList* dl, const Core::ViewTransform& vt,
                                       const Core::ASTNodePtr& ast, const float color[4],
-                                      const Surface3DOptions& options);
+                                      const Surface3DOptions& options,
+                                      FrameArena* arena = nullptr);
+
+    /// z range drawImplicitSurface3D samples around `zCenter` for the current view.
+    static void implicitZRange(const Core::ViewTransform& vt, float zCenter,
+                               double& zMin, double& zMax);
+
+    /// World-space triangles of the implicit surface last drawn under `key` (the AST passed to
+    /// drawImplicitSurface3D), or null when none is held.
+    static std::shared_ptr<const MeshBvh::Mesh> surfaceMesh(const void* key);
+
+    /// Sampled grid of the z=f(x,y) surface last drawn under `key` (the first branch of the
+    /// solution passed to drawSurface3D, the AST itself for a plain z=f(x,y)), or null. Its
+    /// triangles cover the full grid cells only; cells trimmed at a discriminant boundary are
+    /// left out.
+    static std::shared_ptr<const MeshBvh::HeightGrid> surfaceGrid(const void* key);
+
+    struct PublishedCurve;
+    struct PublishedSurface;
+    /// What the last draw call under a key published for hover and picking: a curve's index
+    /// and samples, or a surface's mesh. The renderer keeps a bounded number of these, so a
+    /// caller that replays recorded geometry instead of drawing republishes what it captured,
+    /// keeping it current for the replayed view.
+    struct Published {
+        std::shared_ptr<const PublishedCurve> curve;
+        std::shared_ptr<const PublishedSurface> surface;
+    };
+    static Published published(const void* key);
+    static void republish(const Published& published);
+
+    /// World-space ray under the screen point for the 3D camera in `options` (azimuth,
+    /// elevation, zScale). The direction points away from the viewer, so the nearest surface
+    /// hit has the smallest ray parameter; the origin lies on the plane through the world
+    /// origin facing the camera, so hits in front of it have negative parameters.
+    static void pickRay3D(const Core::ViewTransform& vt, const Surface3DOptions& options,
+                          float screenX, float screenY,
+                          MeshBvh::Vec3& origin, MeshBvh::Vec3& direction);
 
     /// Plot the zero contour F(x,y)=0 for implicit equations.
     static void drawImplicitContour2D(ImDrawList* dl, const Core::ViewTransform& vt,
                                       const Core::ASTNodePtr& ast,
-                                      const float color[4], float thickness = 2.0f);
+                                      const float color[4], float thickness = 2.0f,
+                                      FrameArena* arena = nullptr);
 
-private:
+    /// Heat-map colour (IM_COL32) of `value` within [lo, hi], blended with `tint`.
     static unsigned int heatColor(double value, double lo, double hi,
                                   const float tint[4], float alpha);
+
+private:
     static unsigned int colorU32(const float c[4]);
     static void         formatLabel(char* buf, size_t len, double v);
+    static void         recordEvaluations(std::uint64_t count);
+    static void         drawHeatCells(ImDrawList* dl, const Core::ViewTransform& vt,
+                                      const double* values, int resX, int resY,
+                                      double xMin, double yMin, double dx, double dy,
+                                      double lo, double hi, const float tint[4], float alpha,
+                                      int contourLevels, FrameArena* arena);
 };
 
 } // namespace XpressFormula::Plotting
@@ -0,0 +1,43 @@
+// ProgressiveImage.cpp - Coarse-to-fine per-pixel image refinement shared by the CPU ray tracers.
+#include "ProgressiveImage.h"
+#include "../Core/MathConstants.h"
+#include <cmath>
+
+namespace XpressFormula::Plotting {
+
+std::array<std::array<double, 3>, 3> ProgressiveImage::Camera::basis() const {
+    const double azimuth = static_cast<double>(azimuthDeg) * Core::PI / 180.0;
+    const double elevation = static_cast<double>(elevationDeg) * Core::PI / 180.0;
+    const double cA = std::cos(azimuth);
+    const double sA = std::sin(azimuth);
+    const double cE = std::cos(elevation);
+    const double sE = std::sin(elevation);
+    return { { { cA, -sA, 0.0 }, { cE * sA, cE * cA, -sE }, { sE * sA, sE * cA, cE } } };
+}
+
+bool ProgressiveImage::resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == m_width && height == m_height) {
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height, 0u);
+    m_hasImage = false;
+    return true;
+}
+
+void ProgressiveImage::restart(const Camera& camera) {
+    m_camera = camera;
+    m_step = kCoarsestStep;
+    m_nextRow = 0;
+    m_work.store(0, std::memory_order_relaxed);
+}
+
+void ProgressiveImage::clear() {
+    m_step = 0;
+    m_hasImage = false;
+}
+
+} // namespace XpressFormula::Plotting
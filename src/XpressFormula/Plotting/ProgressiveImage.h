@@ -0,0 +1,156 @@
+// ProgressiveImage.h - Coarse-to-fine per-pixel image refinement shared by the CPU ray tracers.
+#pragma once
+
+#include "../Core/TaskPool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// The pixel buffer and pass scheduler behind VolumeRaymarcher and ImplicitSurfaceTracer. The
+/// first pass traces one pixel per kCoarsestStep x kCoarsestStep block and fills the block with
+/// it; each later pass halves the step and traces only the pixels the previous lattice missed,
+/// so a scene change shows a blocky preview at once and sharpens over the following frames.
+/// The renderer supplies the per-pixel trace; rows of a batch are traced in parallel.
+class ProgressiveImage {
+public:
+    /// Orthographic camera: world (x, y, z * zScale) rotated by azimuth/elevation, scaled by
+    /// `scale` pixels per unit and anchored at the screen position of the world origin.
+    struct Camera {
+        float azimuthDeg = 30.0f;
+        float elevationDeg = -60.0f;
+        float zScale = 1.0f;
+        double originX = 0.0;
+        double originY = 0.0;
+        double scale = 60.0;
+        // Plot rectangle in screen pixels; the image covers it exactly.
+        float left = 0.0f;
+        float top = 0.0f;
+        float width = 1.0f;
+        float height = 1.0f;
+
+        bool operator==(const Camera&) const = default;
+
+        /// Orthonormal basis in (x, y, z * zScale) space, matching the surface renderers:
+        /// rows R, U, F with xProj = R.p, yProj = U.p and depth = F.p (larger is nearer).
+        std::array<std::array<double, 3>, 3> basis() const;
+    };
+
+    static constexpr int kCoarsestStep = 8;  // pixel spacing of the first progressive pass
+
+    /// Resize the pixel buffer. Returns true, with the buffer cleared, when the size changed.
+    bool resize(int width, int height);
+    /// Start over from the coarsest pass; the current pixels stay until they are overwritten.
+    void restart(const Camera& camera);
+    /// Nothing to trace: converged, with no image.
+    void clear();
+
+    /// Trace more pixels, in batches of rows, until about `budgetMs` has been spent or the image
+    /// is complete. Returns true when pixels changed; rows [dirtyTop, dirtyBottom) changed.
+    ///
+    /// `tracePixel(xProj, yProj, state, work)` returns the RGBA colour of the ray through the
+    /// projected point (camera-plane coordinates in world units) and adds its cost to `work`.
+    /// `state` is a RowState default-constructed per row, for per-thread scratch buffers.
+    template <typename RowState, typename TracePixel>
+    bool refine(Core::TaskPool& pool, double budgetMs, int& dirtyTop, int& dirtyBottom,
+                const TracePixel& tracePixel);
+
+    /// True once the coarsest pass has covered the whole image.
+    bool hasImage() const { return m_hasImage; }
+    /// True when every pixel has been traced at full resolution (or there is nothing to trace).
+    bool converged() const { return m_step == 0; }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    /// RGBA pixels, row-major, IM_COL32 byte order, straight (non-premultiplied) alpha.
+    const std::uint32_t* pixels() const { return m_pixels.data(); }
+
+    /// Work reported by tracePixel since the last restart (diagnostics).
+    std::uint64_t work() const { return m_work.load(std::memory_order_relaxed); }
+
+private:
+    template <typename RowState, typename TracePixel>
+    void traceRow(int row, int step, const TracePixel& tracePixel);
+
+    Camera m_camera;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<std::uint32_t> m_pixels;
+
+    int m_step = 0;     // pixel step of the pass in progress (0 = converged)
+    int m_nextRow = 0;  // next row of that pass
+    bool m_hasImage = false;
+    std::atomic<std::uint64_t> m_work{ 0 };
+};
+
+template <typename RowState, typename TracePixel>
+bool ProgressiveImage::refine(Core::TaskPool& pool, double budgetMs,
+                              int& dirtyTop, int& dirtyBottom, const TracePixel& tracePixel) {
+    dirtyTop = m_height;
+    dirtyBottom = 0;
+    if (m_step == 0) {
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const int batchRows = static_cast<int>(pool.workerCount() + 1) * 2;
+    while (m_step > 0) {
+        const int step = m_step;
+        const int passRows = (m_height + step - 1) / step;
+        const int first = m_nextRow;
+        const int count = std::min(batchRows, passRows - first);
+        pool.parallelFor(static_cast<size_t>(count), [&](size_t i) {
+            traceRow<RowState>((first + static_cast<int>(i)) * step, step, tracePixel);
+        });
+        dirtyTop = std::min(dirtyTop, first * step);
+        dirtyBottom = std::max(dirtyBottom, std::min(m_height, (first + count) * step));
+
+        m_nextRow = first + count;
+        if (m_nextRow >= passRows) {
+            if (step == kCoarsestStep) {
+                m_hasImage = true;
+            }
+            m_step = step / 2;
+            m_nextRow = 0;
+        }
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        if (elapsedMs >= budgetMs) {
+            break;
+        }
+    }
+    return dirtyBottom > dirtyTop;
+}
+
+template <typename RowState, typename TracePixel>
+void ProgressiveImage::traceRow(int row, int step, const TracePixel& tracePixel) {
+    const double pixelW = static_cast<double>(m_camera.width) / m_width;
+    const double pixelH = static_cast<double>(m_camera.height) / m_height;
+    const double yProj = (m_camera.originY - (m_camera.top + (row + 0.5) * pixelH)) / m_camera.scale;
+    const bool rowDoneBefore = (step < kCoarsestStep) && (row % (2 * step) == 0);
+    const int blockBottom = std::min(row + step, m_height);
+
+    RowState state{};
+    std::uint64_t work = 0;
+    for (int px = 0; px < m_width; px += step) {
+        // Pixels on the previous pass's lattice are already traced; only their block shrinks.
+        if (rowDoneBefore && px % (2 * step) == 0) {
+            continue;
+        }
+        const double xProj = (m_camera.left + (px + 0.5) * pixelW - m_camera.originX) / m_camera.scale;
+        const std::uint32_t color = tracePixel(xProj, yProj, state, work);
+        const int blockRight = std::min(px + step, m_width);
+        for (int y = row; y < blockBottom; ++y) {
+            std::uint32_t* dst = &m_pixels[static_cast<size_t>(y) * m_width];
+            std::fill(dst + px, dst + blockRight, color);
+        }
+    }
+    m_work.fetch_add(work, std::memory_order_relaxed);
+}
+
+} // namespace XpressFormula::Plotting
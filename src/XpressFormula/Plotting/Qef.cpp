@@ -0,0 +1,107 @@
+// Qef.cpp - Quadratic error function for placing dual-contouring vertices.
+#include "Qef.h"
+#include <algorithm>
+#include <cmath>
+
+namespace XpressFormula::Plotting {
+
+void Qef::add(const Vec3& point, Vec3 normal) {
+    const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (!(length > 0.0) || !std::isfinite(length) ||
+        !std::isfinite(point[0]) || !std::isfinite(point[1]) || !std::isfinite(point[2])) {
+        return;
+    }
+    for (double& n : normal) {
+        n /= length;
+    }
+    const double d = normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2];
+    m_ata[0] += normal[0] * normal[0];
+    m_ata[1] += normal[0] * normal[1];
+    m_ata[2] += normal[0] * normal[2];
+    m_ata[3] += normal[1] * normal[1];
+    m_ata[4] += normal[1] * normal[2];
+    m_ata[5] += normal[2] * normal[2];
+    for (int i = 0; i < 3; ++i) {
+        m_atb[i] += normal[i] * d;
+        m_pointSum[i] += point[i];
+    }
+    ++m_count;
+}
+
+Qef::Vec3 Qef::massPoint() const {
+    if (m_count == 0) {
+        return {};
+    }
+    return { m_pointSum[0] / m_count, m_pointSum[1] / m_count, m_pointSum[2] / m_count };
+}
+
+Qef::Vec3 Qef::solve() const {
+    const Vec3 mass = massPoint();
+    if (m_count == 0) {
+        return mass;
+    }
+
+    // Solve A^T A y = A^T b - A^T A c for the offset y from the mass point c.
+    double a[3][3] = { { m_ata[0], m_ata[1], m_ata[2] },
+                       { m_ata[1], m_ata[3], m_ata[4] },
+                       { m_ata[2], m_ata[4], m_ata[5] } };
+    Vec3 rhs = m_atb;
+    for (int i = 0; i < 3; ++i) {
+        rhs[i] -= a[i][0] * mass[0] + a[i][1] * mass[1] + a[i][2] * mass[2];
+    }
+
+    // Cyclic Jacobi: rotate a to diagonal, accumulating the eigenvectors in the columns of v.
+    double v[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+    for (int sweep = 0; sweep < 8; ++sweep) {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (off < 1e-24 * (a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2]) || off == 0.0) {
+            break;
+        }
+        for (int p = 0; p < 2; ++p) {
+            for (int q = p + 1; q < 3; ++q) {
+                if (a[p][q] == 0.0) {
+                    continue;
+                }
+                const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                const double t = std::copysign(1.0, theta) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+                for (int k = 0; k < 3; ++k) {
+                    const double akp = a[k][p];
+                    const double akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double apk = a[p][k];
+                    const double aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double vkp = v[k][p];
+                    const double vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    // Pseudo-inverse: y = sum over kept eigenpairs of e (e . rhs) / lambda.
+    const double largest = std::max(std::max(a[0][0], a[1][1]), a[2][2]);
+    Vec3 result = mass;
+    for (int e = 0; e < 3; ++e) {
+        const double lambda = a[e][e];
+        if (!(lambda > kSingularThreshold * largest)) {
+            continue;
+        }
+        const double along = (v[0][e] * rhs[0] + v[1][e] * rhs[1] + v[2][e] * rhs[2]) / lambda;
+        for (int k = 0; k < 3; ++k) {
+            result[k] += v[k][e] * along;
+        }
+    }
+    return result;
+}
+
+} // namespace XpressFormula::Plotting
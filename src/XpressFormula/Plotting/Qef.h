@@ -0,0 +1,39 @@
+// Qef.h - Quadratic error function for placing dual-contouring vertices.
+#pragma once
+
+#include <array>
+
+namespace XpressFormula::Plotting {
+
+/// Accumulates planes (a point on the surface plus its normal) and finds the point closest to
+/// all of them in the least-squares sense: the vertex that keeps creases and corners sharp.
+///
+/// Solved around the mean of the points with a truncated pseudo-inverse. Directions in which
+/// the planes barely vary (a flat patch, or the line along a crease) are left at the mean
+/// instead of running off along a nearly singular system.
+class Qef {
+public:
+    using Vec3 = std::array<double, 3>;
+
+    /// `normal` need not be normalized; zero or non-finite normals are ignored.
+    void add(const Vec3& point, Vec3 normal);
+
+    int count() const { return m_count; }
+    Vec3 massPoint() const;
+
+    /// Minimizer of sum((n_i . (x - p_i))^2), nearest to the mean of the points. Returns the
+    /// mean when no plane was added.
+    Vec3 solve() const;
+
+    /// Eigenvalues below this fraction of the largest are treated as zero.
+    static constexpr double kSingularThreshold = 0.1;
+
+private:
+    // Upper triangle of sum(n n^T): xx, xy, xz, yy, yz, zz.
+    std::array<double, 6> m_ata = {};
+    Vec3 m_atb = {};    // sum(n (n . p))
+    Vec3 m_pointSum = {};
+    int m_count = 0;
+};
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,443 @@
+// ScatterDensity.cpp - Scattered (x, y[, value]) points binned per pixel through a count pyramid.
+#include "ScatterDensity.h"
+#include "../Core/TaskPool.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+// Points binned per parallel task (and between cancellation checks).
+constexpr std::size_t kPointsPerTask = 1u << 20;
+// Bound on the private grids of the parallel binning tasks together, in bytes.
+constexpr std::size_t kBinningBudgetBytes = std::size_t(256) << 20;
+// Coarsest finest-level resolution, so small clouds still zoom out smoothly.
+constexpr int kMinResolution = 64;
+// Pixel rows resampled per parallel task.
+constexpr int kRowsPerTask = 16;
+
+bool hasExtension(const std::string& path, const char* extension) {
+    const std::size_t length = std::strlen(extension);
+    if (path.size() < length) {
+        return false;
+    }
+    return std::equal(path.end() - static_cast<std::ptrdiff_t>(length), path.end(), extension,
+                      [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+}
+
+bool finiteRecord(const double* record, int fields) {
+    for (int f = 0; f < fields; ++f) {
+        if (!std::isfinite(record[f])) return false;
+    }
+    return true;
+}
+
+// Pixels a bin's extent [p0, p1) (in pixel units) overlaps within [0, extent), with the
+// fraction of the bin falling in each.
+struct Span {
+    int pixel;
+    float weight;
+};
+
+void appendSpans(double p0, double p1, int extent, std::vector<Span>& out) {
+    const double length = p1 - p0;
+    const int first = std::max(0, static_cast<int>(std::floor(p0)));
+    const int last = std::min(extent, static_cast<int>(std::ceil(p1)));
+    for (int p = first; p < last; ++p) {
+        const double overlap = std::min(p1, p + 1.0) - std::max(p0, static_cast<double>(p));
+        if (overlap > 0.0) {
+            out.push_back({ p, static_cast<float>(overlap / length) });
+        }
+    }
+}
+
+} // namespace
+
+std::shared_ptr<const ScatterDensity> ScatterDensity::fromRecords(std::vector<double> records, bool withValues) {
+    std::shared_ptr<ScatterDensity> points(new ScatterDensity());
+    const int fields = withValues ? 3 : 2;
+    points->m_owned = std::move(records);
+    points->setRecords(points->m_owned.data(), points->m_owned.size() / fields, fields);
+    return points;
+}
+
+std::shared_ptr<const ScatterDensity> ScatterDensity::load(const std::string& path, std::string& error) {
+    const bool withValues = hasExtension(path, ".xyv");
+    if (!withValues && !hasExtension(path, ".bin") && !hasExtension(path, ".f64")) {
+        error = "Scatter files must be binary float64 records (.bin / .f64 for x,y; .xyv for x,y,value).";
+        return nullptr;
+    }
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "Binary scatter files need a little-endian host.";
+        return nullptr;
+    }
+    std::shared_ptr<ScatterDensity> points(new ScatterDensity());
+    if (!points->m_file.open(path, error)) {
+        return nullptr;
+    }
+    const int fields = withValues ? 3 : 2;
+    const std::size_t recordBytes = fields * sizeof(double);
+    const std::size_t bytes = points->m_file.size();
+    if (bytes % recordBytes != 0) {
+        error = withValues
+            ? "Scatter file must hold float64 (x, y, value) triples (size is not a multiple of 24 bytes)."
+            : "Scatter file must hold float64 (x, y) pairs (size is not a multiple of 16 bytes).";
+        return nullptr;
+    }
+    if (bytes == 0) {
+        error = "No data points in " + path;
+        return nullptr;
+    }
+    // The mapping is page-aligned, so the records are binned in place and never copied.
+    points->setRecords(reinterpret_cast<const double*>(points->m_file.data()), bytes / recordBytes, fields);
+    if (points->m_levels.empty()) {
+        error = "No finite data points in " + path;
+        return nullptr;
+    }
+    return points;
+}
+
+void ScatterDensity::setRecords(const double* records, std::size_t count, int fields) {
+    m_records = records;
+    m_count = count;
+    m_fields = fields;
+
+    // Bounds of the finite records, per chunk in parallel.
+    struct Extent {
+        double lo[3] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity() };
+        double hi[3] = { -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                         -std::numeric_limits<double>::infinity() };
+    };
+    const std::size_t tasks = std::max<std::size_t>(1, (count + kPointsPerTask - 1) / kPointsPerTask);
+    std::vector<Extent> extents(tasks);
+    Core::TaskPool::shared().parallelFor(tasks, [&](std::size_t t) {
+        Extent& e = extents[t];
+        const std::size_t end = std::min(count, (t + 1) * kPointsPerTask);
+        for (std::size_t i = t * kPointsPerTask; i < end; ++i) {
+            const double* record = records + i * fields;
+            if (!finiteRecord(record, fields)) continue;
+            for (int f = 0; f < fields; ++f) {
+                e.lo[f] = std::min(e.lo[f], record[f]);
+                e.hi[f] = std::max(e.hi[f], record[f]);
+            }
+        }
+    });
+    Extent total;
+    for (const Extent& e : extents) {
+        for (int f = 0; f < fields; ++f) {
+            total.lo[f] = std::min(total.lo[f], e.lo[f]);
+            total.hi[f] = std::max(total.hi[f], e.hi[f]);
+        }
+    }
+    m_levels.clear();
+    if (!(total.lo[0] <= total.hi[0])) {
+        return;  // no finite record
+    }
+    // A cloud collapsed onto a line or a point still gets a unit-wide box to bin into.
+    auto widen = [](double& lo, double& hi) {
+        if (!(hi > lo)) {
+            lo -= 0.5;
+            hi += 0.5;
+        }
+    };
+    widen(total.lo[0], total.hi[0]);
+    widen(total.lo[1], total.hi[1]);
+    m_xMin = total.lo[0];
+    m_xMax = total.hi[0];
+    m_yMin = total.lo[1];
+    m_yMax = total.hi[1];
+    if (fields == 3) {
+        m_valueMin = total.lo[2];
+        m_valueMax = total.hi[2];
+    }
+    buildPyramid();
+}
+
+void ScatterDensity::buildPyramid() {
+    // About one point per finest bin, within [kMinResolution, kMaxResolution].
+    const auto side = static_cast<std::size_t>(std::sqrt(static_cast<double>(m_count)));
+    const int resolution = static_cast<int>(
+        std::clamp<std::size_t>(std::bit_ceil(std::max<std::size_t>(side, 1)), kMinResolution, kMaxResolution));
+
+    Level finest;
+    finest.resolution = resolution;
+    const Window bounds{ m_xMin, m_xMax, m_yMin, m_yMax, resolution, resolution };
+    binPoints(bounds, finest.counts, hasValues() ? &finest.sums : nullptr, nullptr);
+    m_levels.push_back(std::move(finest));
+
+    while (m_levels.back().resolution > 1) {
+        const Level& fine = m_levels.back();
+        Level coarse;
+        coarse.resolution = fine.resolution / 2;
+        const int r = coarse.resolution;
+        coarse.counts.assign(static_cast<std::size_t>(r) * r, 0);
+        if (!fine.sums.empty()) {
+            coarse.sums.assign(static_cast<std::size_t>(r) * r, 0.0);
+        }
+        for (int y = 0; y < r; ++y) {
+            for (int x = 0; x < r; ++x) {
+                const std::size_t a = static_cast<std::size_t>(2 * y) * fine.resolution + 2 * x;
+                const std::size_t b = a + fine.resolution;
+                const std::size_t out = static_cast<std::size_t>(y) * r + x;
+                coarse.counts[out] = fine.counts[a] + fine.counts[a + 1] + fine.counts[b] + fine.counts[b + 1];
+                if (!coarse.sums.empty()) {
+                    coarse.sums[out] = fine.sums[a] + fine.sums[a + 1] + fine.sums[b] + fine.sums[b + 1];
+                }
+            }
+        }
+        m_levels.push_back(std::move(coarse));
+    }
+}
+
+bool ScatterDensity::binPoints(const Window& window, std::vector<std::uint32_t>& counts,
+                               std::vector<double>* sums, const std::atomic<bool>* cancel) const {
+    const std::size_t cells = static_cast<std::size_t>(window.width) * window.height;
+    counts.assign(cells, 0);
+    if (sums) {
+        sums->assign(cells, 0.0);
+    }
+
+    // Each task bins its share of the points into a private grid; the grids are then summed.
+    // Tasks are capped so the private grids stay within the memory budget.
+    const std::size_t cellBytes = sizeof(std::uint32_t) + (sums ? sizeof(double) : 0);
+    const std::size_t budgetTasks = std::max<std::size_t>(1, kBinningBudgetBytes / (cells * cellBytes));
+    const std::size_t threads = Core::TaskPool::shared().workerCount() + 1u;
+    const std::size_t tasks = std::clamp<std::size_t>((m_count + kPointsPerTask - 1) / kPointsPerTask, 1,
+                                                      std::min(threads, budgetTasks));
+    std::vector<std::vector<std::uint32_t>> partialCounts(tasks - 1);
+    std::vector<std::vector<double>> partialSums(sums ? tasks - 1 : 0);
+
+    const double scaleX = window.width / (window.xMax - window.xMin);
+    const double scaleY = window.height / (window.yMax - window.yMin);
+    std::atomic<bool> cancelled{ false };
+    Core::TaskPool::shared().parallelFor(tasks, [&](std::size_t t) {
+        std::uint32_t* taskCounts = counts.data();
+        double* taskSums = sums ? sums->data() : nullptr;
+        if (t > 0) {
+            partialCounts[t - 1].assign(cells, 0);
+            taskCounts = partialCounts[t - 1].data();
+            if (sums) {
+                partialSums[t - 1].assign(cells, 0.0);
+                taskSums = partialSums[t - 1].data();
+            }
+        }
+        const std::size_t first = t * m_count / tasks;
+        const std::size_t last = (t + 1) * m_count / tasks;
+        for (std::size_t start = first; start < last; start += kPointsPerTask) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) {
+                cancelled.store(true, std::memory_order_relaxed);
+                return;
+            }
+            const std::size_t end = std::min(last, start + kPointsPerTask);
+            for (std::size_t i = start; i < end; ++i) {
+                const double* record = m_records + i * m_fields;
+                // Points on the right and bottom edges belong to the last column and row;
+                // NaN fails both comparisons and infinities fail the range check.
+                const double fx = (record[0] - window.xMin) * scaleX;
+                const double fy = (window.yMax - record[1]) * scaleY;
+                if (!(fx >= 0.0 && fx <= window.width && fy >= 0.0 && fy <= window.height)) continue;
+                const int ix = std::min(static_cast<int>(fx), window.width - 1);
+                const int iy = std::min(static_cast<int>(fy), window.height - 1);
+                const std::size_t cell = static_cast<std::size_t>(iy) * window.width + ix;
+                if (taskSums) {
+                    if (!std::isfinite(record[2])) continue;
+                    taskSums[cell] += record[2];
+                }
+                ++taskCounts[cell];
+            }
+        }
+    });
+    if (cancelled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    if (tasks > 1) {
+        const std::size_t rowTasks = (static_cast<std::size_t>(window.height) + kRowsPerTask - 1) / kRowsPerTask;
+        Core::TaskPool::shared().parallelFor(rowTasks, [&](std::size_t band) {
+            const std::size_t begin = band * kRowsPerTask * window.width;
+            const std::size_t end = std::min(cells, begin + static_cast<std::size_t>(kRowsPerTask) * window.width);
+            for (std::size_t p = 0; p + 1 < tasks; ++p) {
+                for (std::size_t c = begin; c < end; ++c) counts[c] += partialCounts[p][c];
+                if (sums) {
+                    for (std::size_t c = begin; c < end; ++c) (*sums)[c] += partialSums[p][c];
+                }
+            }
+        });
+    }
+    return true;
+}
+
+bool ScatterDensity::pyramidResolves(const Window& window) const {
+    if (m_levels.empty()) {
+        return true;
+    }
+    const double binWidth = (m_xMax - m_xMin) / m_levels[0].resolution;
+    const double binHeight = (m_yMax - m_yMin) / m_levels[0].resolution;
+    return binWidth <= 0.5 * (window.xMax - window.xMin) / window.width &&
+           binHeight <= 0.5 * (window.yMax - window.yMin) / window.height;
+}
+
+std::shared_ptr<const ScatterDensity::Grid> ScatterDensity::aggregate(const Window& window) const {
+    auto grid = std::make_shared<Grid>();
+    grid->window = window;
+    const std::size_t cells = static_cast<std::size_t>(window.width) * window.height;
+    grid->counts.assign(cells, 0.0f);
+    if (hasValues()) {
+        grid->sums.assign(cells, 0.0f);
+    }
+    if (m_levels.empty()) {
+        return grid;
+    }
+
+    // Coarsest level whose bins are still at most half a pixel (the finest when none is).
+    const double pixelWidth = (window.xMax - window.xMin) / window.width;
+    const double pixelHeight = (window.yMax - window.yMin) / window.height;
+    std::size_t levelIndex = 0;
+    while (levelIndex + 1 < m_levels.size() &&
+           (m_xMax - m_xMin) / m_levels[levelIndex + 1].resolution <= 0.5 * pixelWidth &&
+           (m_yMax - m_yMin) / m_levels[levelIndex + 1].resolution <= 0.5 * pixelHeight) {
+        ++levelIndex;
+    }
+    const Level& level = m_levels[levelIndex];
+    const int resolution = level.resolution;
+    const double binWidth = (m_xMax - m_xMin) / resolution;
+    const double binHeight = (m_yMax - m_yMin) / resolution;
+
+    // Bin columns in view and the pixels each overlaps; shared by every pixel row.
+    const int firstColumn = std::max(0, static_cast<int>(std::floor((window.xMin - m_xMin) / binWidth)));
+    const int lastColumn = std::min(resolution - 1, static_cast<int>(std::floor((window.xMax - m_xMin) / binWidth)));
+    if (firstColumn > lastColumn) {
+        return grid;
+    }
+    std::vector<Span> columnSpans;
+    std::vector<std::size_t> columnStart(static_cast<std::size_t>(lastColumn - firstColumn) + 2, 0);
+    for (int c = firstColumn; c <= lastColumn; ++c) {
+        const double x0 = (m_xMin + c * binWidth - window.xMin) / pixelWidth;
+        appendSpans(x0, x0 + binWidth / pixelWidth, window.width, columnSpans);
+        columnStart[c - firstColumn + 1] = columnSpans.size();
+    }
+
+    // Each pixel row gathers the bin rows overlapping it, so rows are filled independently.
+    const std::size_t rowTasks = (static_cast<std::size_t>(window.height) + kRowsPerTask - 1) / kRowsPerTask;
+    Core::TaskPool::shared().parallelFor(rowTasks, [&](std::size_t band) {
+        const int rowEnd = std::min(window.height, static_cast<int>(band + 1) * kRowsPerTask);
+        std::vector<Span> rowSpans;
+        for (int py = static_cast<int>(band) * kRowsPerTask; py < rowEnd; ++py) {
+            // Pixel row py spans [py, py + 1) in bin rows measured down from m_yMax.
+            const double top = (m_yMax - (window.yMax - py * pixelHeight)) / binHeight;
+            const double bottom = top + pixelHeight / binHeight;
+            const int firstRow = std::max(0, static_cast<int>(std::floor(top)));
+            const int lastRow = std::min(resolution - 1, static_cast<int>(std::ceil(bottom)) - 1);
+            float* counts = grid->counts.data() + static_cast<std::size_t>(py) * window.width;
+            float* sums = grid->sums.empty() ? nullptr : grid->sums.data() + static_cast<std::size_t>(py) * window.width;
+            for (int r = firstRow; r <= lastRow; ++r) {
+                const double rowWeight = std::min(bottom, r + 1.0) - std::max(top, static_cast<double>(r));
+                if (rowWeight <= 0.0) continue;
+                const std::size_t rowOffset = static_cast<std::size_t>(r) * resolution;
+                for (int c = firstColumn; c <= lastColumn; ++c) {
+                    const std::uint32_t count = level.counts[rowOffset + c];
+                    if (count == 0) continue;
+                    const float weightedCount = static_cast<float>(count * rowWeight);
+                    const float weightedSum = sums ? static_cast<float>(level.sums[rowOffset + c] * rowWeight) : 0.0f;
+                    const std::size_t spanEnd = columnStart[c - firstColumn + 1];
+                    for (std::size_t s = columnStart[c - firstColumn]; s < spanEnd; ++s) {
+                        counts[columnSpans[s].pixel] += weightedCount * columnSpans[s].weight;
+                        if (sums) {
+                            sums[columnSpans[s].pixel] += weightedSum * columnSpans[s].weight;
+                        }
+                    }
+                }
+            }
+        }
+    });
+    grid->maxCount = grid->counts.empty() ? 0.0f : *std::max_element(grid->counts.begin(), grid->counts.end());
+    return grid;
+}
+
+std::shared_ptr<const ScatterDensity::Grid> ScatterDensity::bin(const Window& window,
+                                                                const std::atomic<bool>* cancel) const {
+    if (window.width < 1 || window.height < 1 || !(window.xMax > window.xMin) || !(window.yMax > window.yMin)) {
+        return nullptr;
+    }
+    std::vector<std::uint32_t> counts;
+    std::vector<double> sums;
+    if (!binPoints(window, counts, hasValues() ? &sums : nullptr, cancel)) {
+        return nullptr;
+    }
+    auto grid = std::make_shared<Grid>();
+    grid->window = window;
+    grid->exact = true;
+    grid->counts.assign(counts.begin(), counts.end());
+    grid->sums.assign(sums.begin(), sums.end());
+    grid->maxCount = grid->counts.empty() ? 0.0f : *std::max_element(grid->counts.begin(), grid->counts.end());
+    return grid;
+}
+
+void ScatterDensity::colorize(const Grid& grid, const std::array<std::uint32_t, 256>& palette, bool logScale,
+                              std::vector<std::uint32_t>& pixels) const {
+    const std::size_t cells = grid.counts.size();
+    pixels.resize(cells);
+    const bool byValue = !grid.sums.empty();
+    const float valueScale = m_valueMax > m_valueMin ? static_cast<float>(255.0 / (m_valueMax - m_valueMin)) : 0.0f;
+    const float valueMin = static_cast<float>(m_valueMin);
+    const float densityScale = grid.maxCount <= 0.0f ? 0.0f
+        : logScale ? 255.0f / std::log1p(grid.maxCount)
+                   : 255.0f / grid.maxCount;
+
+    const std::size_t rows = static_cast<std::size_t>(std::max(grid.window.height, 1));
+    const std::size_t width = cells / rows;
+    const std::size_t rowTasks = (rows + kRowsPerTask - 1) / kRowsPerTask;
+    Core::TaskPool::shared().parallelFor(rowTasks, [&](std::size_t band) {
+        const std::size_t begin = band * kRowsPerTask * width;
+        const std::size_t end = std::min(cells, begin + kRowsPerTask * width);
+        for (std::size_t i = begin; i < end; ++i) {
+            const float count = grid.counts[i];
+            if (!(count > 0.0f)) {
+                pixels[i] = 0;
+                continue;
+            }
+            float t = 0.0f;
+            if (byValue) {
+                t = valueScale > 0.0f ? (grid.sums[i] / count - valueMin) * valueScale : 127.5f;
+            } else {
+                t = (logScale ? std::log1p(count) : count) * densityScale;
+            }
+            pixels[i] = palette[static_cast<std::size_t>(std::clamp(t + 0.5f, 0.0f, 255.0f))];
+        }
+    });
+}
+
+void ScatterDensityCache::cancel() {
+    m_task.cancel();
+    m_points.reset();
+    m_hasRequest = false;
+    m_ready.reset();
+}
+
+std::shared_ptr<const ScatterDensity::Grid> ScatterDensityCache::request(
+    const std::shared_ptr<const ScatterDensity>& points, const ScatterDensity::Window& window) {
+    if (m_hasRequest && points == m_points && window == m_window) {
+        if (!m_ready && m_task.finished()) {
+            m_ready = m_task.take();
+        }
+        return m_ready;
+    }
+
+    m_points = points;
+    m_window = window;
+    m_hasRequest = true;
+    m_ready.reset();
+    // The worker owns a reference to the points, so a removed entry cannot unmap them mid-pass.
+    m_task.start([points, window](const std::atomic<bool>* cancel) {
+        return points ? points->bin(window, cancel) : nullptr;
+    });
+    return nullptr;
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,148 @@
+// ScatterDensity.h - Scattered (x, y[, value]) points binned per pixel through a count pyramid.
+#pragma once
+
+#include "../Core/BackgroundTask.h"
+#include "../Core/MappedFile.h"
+#include "FileLoader.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// A cloud of scattered points drawn as a density image: each pixel shows how many points fall
+/// in it (or their mean value when the points carry one), never the points themselves.
+///
+/// On load the points are binned once, in parallel, into a square grid over their bounds, and
+/// coarser levels are built by summing 2x2 bins. aggregate() then produces any view from the
+/// coarsest level whose bins are at most half a pixel, at a cost proportional to the pixels
+/// rather than the points. Only views zoomed in beyond the finest level need bin() to pass over
+/// the points again, which ScatterDensityCache runs in the background.
+class ScatterDensity {
+public:
+    /// Pixel grid of a view: width*height bins over [xMin,xMax]x[yMin,yMax], row 0 at yMax.
+    struct Window {
+        double xMin = 0.0;
+        double xMax = 1.0;
+        double yMin = 0.0;
+        double yMax = 1.0;
+        int width = 1;
+        int height = 1;
+
+        bool operator==(const Window&) const = default;
+    };
+
+    /// Points (and value sums) per pixel of a window, row-major from the top row.
+    struct Grid {
+        Window window;
+        std::vector<float> counts;
+        std::vector<float> sums;  // empty when the points carry no value
+        float maxCount = 0.0f;
+        bool exact = false;       // binned from the points rather than resampled from the pyramid
+    };
+
+    /// Finest pyramid level is at most this many bins on a side.
+    static constexpr int kMaxResolution = 2048;
+
+    /// Load points from a binary file of little-endian float64 records, read in parallel
+    /// through a memory mapping:
+    ///
+    /// - `.bin` / `.f64`: (x, y) pairs
+    /// - `.xyv`: (x, y, value) triples; bins are coloured by their mean value
+    ///
+    /// Records with a non-finite field are ignored. Returns null and sets `error` on failure.
+    static std::shared_ptr<const ScatterDensity> load(const std::string& path, std::string& error);
+
+    /// Points given as (x, y) pairs, or (x, y, value) triples when `withValues` is set.
+    static std::shared_ptr<const ScatterDensity> fromRecords(std::vector<double> records, bool withValues);
+
+    std::size_t size() const { return m_count; }
+    bool hasValues() const { return m_fields == 3; }
+    /// Bounds of the points (non-finite records excluded) and the range of their values.
+    double xMin() const { return m_xMin; }
+    double xMax() const { return m_xMax; }
+    double yMin() const { return m_yMin; }
+    double yMax() const { return m_yMax; }
+    double valueMin() const { return m_valueMin; }
+    double valueMax() const { return m_valueMax; }
+
+    /// True when aggregate() resolves the window to the pixel: some pyramid level has bins no
+    /// larger than half a pixel.
+    bool pyramidResolves(const Window& window) const;
+
+    /// Window resampled from the pyramid. Each bin's points are spread over the pixels it
+    /// overlaps in proportion to the area, so a view zoomed in beyond the finest level comes out
+    /// smooth but blurred; the result is exact in total either way.
+    std::shared_ptr<const Grid> aggregate(const Window& window) const;
+
+    /// Window binned from every point, in parallel. Returns null when `cancel` becomes true.
+    std::shared_ptr<const Grid> bin(const Window& window, const std::atomic<bool>* cancel = nullptr) const;
+
+    /// Colour a grid into RGBA pixels (IM_COL32 order) through a 256-entry palette: by density,
+    /// scaled linearly or logarithmically to the busiest pixel, or by mean value over the
+    /// value range. Empty pixels are transparent.
+    void colorize(const Grid& grid, const std::array<std::uint32_t, 256>& palette, bool logScale,
+                  std::vector<std::uint32_t>& pixels) const;
+
+private:
+    struct Level {
+        int resolution = 0;
+        std::vector<std::uint32_t> counts;  // resolution^2, row 0 at yMax
+        std::vector<double> sums;
+    };
+
+    ScatterDensity() = default;
+    void setRecords(const double* records, std::size_t count, int fields);
+    void buildPyramid();
+    // Sum the points into the window's bins (top row first). Returns false when cancelled.
+    bool binPoints(const Window& window, std::vector<std::uint32_t>& counts,
+                   std::vector<double>* sums, const std::atomic<bool>* cancel) const;
+
+    Core::MappedFile m_file;  // backs m_records when read in place
+    std::vector<double> m_owned;
+    const double* m_records = nullptr;
+    std::size_t m_count = 0;
+    int m_fields = 2;
+    double m_xMin = 0.0;
+    double m_xMax = 1.0;
+    double m_yMin = 0.0;
+    double m_yMax = 1.0;
+    double m_valueMin = 0.0;
+    double m_valueMax = 1.0;
+    std::vector<Level> m_levels;  // m_levels[0] finest
+};
+
+/// Background loads of point files, kept while each file is unchanged.
+using ScatterDensityLoader = FileLoader<ScatterDensity>;
+
+/// Exact binning of one window on a background thread, for views the pyramid cannot resolve.
+class ScatterDensityCache {
+public:
+    ScatterDensityCache() = default;
+    ScatterDensityCache(const ScatterDensityCache&) = delete;
+    ScatterDensityCache& operator=(const ScatterDensityCache&) = delete;
+
+    /// Return the exact grid of (points, window) once binned, or null while the pass is in
+    /// progress. A request that differs from the previous one cancels the pass in flight.
+    std::shared_ptr<const ScatterDensity::Grid> request(const std::shared_ptr<const ScatterDensity>& points,
+                                                        const ScatterDensity::Window& window);
+
+    /// True while a requested grid is still being binned.
+    bool pending() const { return m_hasRequest && !m_ready; }
+
+    /// Stop the pass in flight, if any, and forget the request.
+    void cancel();
+
+private:
+    std::shared_ptr<const ScatterDensity> m_points;
+    ScatterDensity::Window m_window;
+    bool m_hasRequest = false;
+    std::shared_ptr<const ScatterDensity::Grid> m_ready;
+    Core::BackgroundTask<ScatterDensity::Grid> m_task;
+};
+
+} // namespace XpressFormula::Plotting
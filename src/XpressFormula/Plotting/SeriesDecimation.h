@@ -0,0 +1,82 @@
+// SeriesDecimation.h - Per-pixel-column min/max decimation shared by the measured series.
+#pragma once
+
+#include "../Core/ViewTransform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Screen-space polyline of an x-sorted series for the view: the points themselves while there
+/// are at most two per pixel column, otherwise each column's y extremes in data order, plus the
+/// nearest point beyond either edge so the line reaches them. NaN vertices separate the runs.
+///
+/// `Series` provides size(), x(i), y(i), lowerBound(value, first, last) (first x >= value),
+/// upperBound(value, first, last) (first x > value) and summarize(first, last), returning a
+/// DataSeries::Summary-like value with yMin, yMax, minFirst and empty().
+template <typename Series>
+void decimateSeries(const Series& series, const Core::ViewTransform& vt, std::pmr::vector<Core::Vec2>& out) {
+    out.clear();
+    const std::size_t size = series.size();
+    if (size == 0 || vt.screenWidth <= 0.0f) {
+        return;
+    }
+    const float gap = std::numeric_limits<float>::quiet_NaN();
+    auto pushBreak = [&]() {
+        if (!out.empty() && !std::isnan(out.back().x)) out.push_back({ gap, gap });
+    };
+    auto pushPoint = [&](std::size_t i) {
+        const double y = series.y(i);
+        if (std::isnan(y)) {
+            pushBreak();
+        } else {
+            out.push_back(vt.worldToScreen(series.x(i), y));
+        }
+    };
+    auto screenY = [&](double wy) { return vt.worldToScreen(0.0, wy).y; };
+
+    const double xMin = vt.worldXMin();
+    const double xMax = vt.worldXMax();
+    const std::size_t first = series.lowerBound(xMin, 0, size);
+    const std::size_t last = series.upperBound(xMax, first, size);
+    const int columns = std::max(1, static_cast<int>(std::ceil(vt.screenWidth)));
+
+    if (last - first <= 2 * static_cast<std::size_t>(columns)) {
+        // Sparse enough to draw as is.
+        const std::size_t begin = (first > 0) ? first - 1 : 0;
+        const std::size_t end = (last < size) ? last + 1 : size;
+        out.reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) pushPoint(i);
+        return;
+    }
+
+    out.reserve(2 * static_cast<std::size_t>(columns) + 4);
+    if (first > 0) pushPoint(first - 1);
+    const double columnWidth = 1.0 / vt.scaleX;
+    std::size_t begin = first;
+    for (int c = 0; c < columns && begin < last; ++c) {
+        const std::size_t end = (c + 1 == columns) ? last
+                              : series.lowerBound(xMin + (c + 1) * columnWidth, begin, last);
+        if (end == begin) {
+            continue;  // no point in this column: the line runs straight across
+        }
+        const auto s = series.summarize(begin, end);
+        if (s.empty()) {
+            pushBreak();
+        } else {
+            const float sx = vt.screenOriginX + static_cast<float>(c) + 0.5f;
+            out.push_back({ sx, screenY(s.minFirst ? s.yMin : s.yMax) });
+            if (s.yMin != s.yMax) {
+                out.push_back({ sx, screenY(s.minFirst ? s.yMax : s.yMin) });
+            }
+        }
+        begin = end;
+    }
+    if (last < size) pushPoint(last);
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,442 @@
+// StreamSeries.cpp - Live y(x) series read from a pipe or socket into a fixed-capacity window.
+#include "StreamSeries.h"
+#include "SeriesDecimation.h"
+#include "../Core/SpscRing.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#include <Windows.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+// Samples the reader may queue ahead of the UI thread (about 2.5 s at 100k samples/s).
+constexpr std::size_t kQueueCapacity = std::size_t(1) << 18;
+// Samples moved from the queue into the window per batch.
+constexpr std::size_t kPollBatch = 4096;
+// A partial line longer than this is not telemetry; it is discarded.
+constexpr std::size_t kMaxLineLength = 4096;
+constexpr std::size_t kReadBufferBytes = std::size_t(1) << 16;
+constexpr const char* kSocketPrefix = "unix:";
+
+bool isSeparator(char c) {
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+StreamSeries::Summary itemSummary(double y) {
+    StreamSeries::Summary s;
+    if (!std::isnan(y)) {
+        s.yMin = y;
+        s.yMax = y;
+    }
+    return s;
+}
+
+} // namespace
+
+struct StreamSeries::Reader {
+    explicit Reader(std::chrono::steady_clock::time_point epoch) : queue(kQueueCapacity), epoch(epoch) {}
+    ~Reader();
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    std::size_t feed(const char* text, std::size_t length);
+    // Reader thread body; stops at the end of the source or once `stop` is set.
+    void run();
+
+    Core::SpscRing<Sample> queue;
+    std::chrono::steady_clock::time_point epoch;  // x of lone values counts seconds from here
+    std::string partialLine;
+    std::vector<Sample> parsed;
+    std::atomic<std::uint64_t> overflowed{ 0 };
+    std::atomic<bool> stop{ false };
+    std::atomic<bool> connected{ false };
+#ifdef _WIN32
+    HANDLE pipe = nullptr;
+    SOCKET socket = INVALID_SOCKET;
+#else
+    int fd = -1;
+    bool waitForWriters = false;  // FIFO: end of data means the writer left, not the stream
+#endif
+};
+
+StreamSeries::StreamSeries(std::size_t capacity)
+    : m_reader(std::make_shared<Reader>(m_created)) {
+    const std::size_t slots = std::bit_ceil(std::max(capacity, 2 * kBlock));
+    m_x.resize(slots);
+    m_y.resize(slots);
+    m_blocks.resize(slots / kBlock);
+    m_mask = slots - 1;
+    m_pollBuffer.resize(kPollBatch);
+}
+
+StreamSeries::~StreamSeries() {
+    stopReader();
+}
+
+bool StreamSeries::connected() const {
+    return m_reader && m_reader->connected.load(std::memory_order_acquire);
+}
+
+std::uint64_t StreamSeries::dropped() const {
+    return m_overflowedBefore + m_reader->overflowed.load(std::memory_order_relaxed) + m_outOfOrder;
+}
+
+void StreamSeries::close() {
+    poll();
+    stopReader();
+    m_reader = std::make_shared<Reader>(m_created);
+}
+
+std::size_t StreamSeries::feed(const char* text, std::size_t length) {
+    return m_reader->feed(text, length);
+}
+
+std::size_t StreamSeries::Reader::feed(const char* text, std::size_t length) {
+    const double now = std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+    auto parseLine = [&](const char* p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        double first = 0.0;
+        const auto parsedFirst = std::from_chars(p, end, first);
+        if (parsedFirst.ec != std::errc()) {
+            return;  // header or comment
+        }
+        p = parsedFirst.ptr;
+        while (p < end && isSeparator(*p)) ++p;
+        if (p == end) {
+            parsed.push_back({ now, first });
+            return;
+        }
+        double second = 0.0;
+        const auto parsedSecond = std::from_chars(p, end, second);
+        if (parsedSecond.ec == std::errc() && parsedFirst.ptr != p) {
+            parsed.push_back({ first, second });
+        }
+    };
+
+    std::size_t start = 0;
+    while (start < length) {
+        const void* newline = std::memchr(text + start, '\n', length - start);
+        if (!newline) {
+            break;
+        }
+        const std::size_t end = static_cast<std::size_t>(static_cast<const char*>(newline) - text);
+        if (!partialLine.empty()) {
+            partialLine.append(text + start, end - start);
+            parseLine(partialLine.data(), partialLine.data() + partialLine.size());
+            partialLine.clear();
+        } else {
+            parseLine(text + start, text + end);
+        }
+        start = end + 1;
+    }
+    partialLine.append(text + start, length - start);
+    if (partialLine.size() > kMaxLineLength) {
+        partialLine.clear();
+    }
+
+    // Never wait for the UI: what does not fit is counted and dropped.
+    const std::size_t queued = queue.push(parsed.data(), parsed.size());
+    overflowed.fetch_add(parsed.size() - queued, std::memory_order_relaxed);
+    parsed.clear();
+    return queued;
+}
+
+std::size_t StreamSeries::poll() {
+    std::size_t added = 0;
+    while (const std::size_t count = m_reader->queue.pop(m_pollBuffer.data(), m_pollBuffer.size())) {
+        const std::uint64_t before = m_revision;
+        for (std::size_t i = 0; i < count; ++i) {
+            append(m_pollBuffer[i]);
+        }
+        added += static_cast<std::size_t>(m_revision - before);
+    }
+    return added;
+}
+
+void StreamSeries::append(const Sample& sample) {
+    if (std::isnan(sample.x) || (m_size > 0 && sample.x < x(m_size - 1))) {
+        ++m_outOfOrder;
+        return;
+    }
+    if (m_size == m_x.size()) {
+        m_start = (m_start + 1) & m_mask;  // the oldest sample drops out
+        --m_size;
+    }
+    // A block's summary restarts with its first slot, so it only ever covers samples written
+    // in the current pass; the one block holding both the newest and the oldest samples is
+    // never used whole (see summarize()).
+    const std::size_t slot = (m_start + m_size) & m_mask;
+    Summary& block = m_blocks[slot / kBlock];
+    if (slot % kBlock == 0) {
+        block = Summary();
+    }
+    m_x[slot] = sample.x;
+    m_y[slot] = sample.y;
+    block = Summary::combine(block, itemSummary(sample.y));
+    ++m_size;
+    ++m_revision;
+}
+
+std::size_t StreamSeries::lowerBound(double value, std::size_t first, std::size_t last) const {
+    while (first < last) {
+        const std::size_t mid = first + (last - first) / 2;
+        if (x(mid) < value) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+std::size_t StreamSeries::upperBound(double value, std::size_t first, std::size_t last) const {
+    while (first < last) {
+        const std::size_t mid = first + (last - first) / 2;
+        if (x(mid) <= value) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+StreamSeries::Summary StreamSeries::summarizePhysical(std::size_t first, std::size_t last) const {
+    // Peel single slots off both ends down to block boundaries; whole blocks in between.
+    Summary left;
+    Summary right;
+    while (first < last && first % kBlock != 0) left = Summary::combine(left, itemSummary(m_y[first++]));
+    while (first < last && last % kBlock != 0) right = Summary::combine(itemSummary(m_y[--last]), right);
+    for (std::size_t b = first / kBlock; b < last / kBlock; ++b) {
+        left = Summary::combine(left, m_blocks[b]);
+    }
+    return Summary::combine(left, right);
+}
+
+StreamSeries::Summary StreamSeries::summarize(std::size_t first, std::size_t last) const {
+    last = std::min(last, m_size);
+    if (first >= last) {
+        return Summary();
+    }
+    // The window wraps at most once, splitting the range into two physical runs, and the
+    // block being overwritten always straddles the split.
+    const std::size_t begin = (m_start + first) & m_mask;
+    const std::size_t count = last - first;
+    if (begin + count <= m_x.size()) {
+        return summarizePhysical(begin, begin + count);
+    }
+    return Summary::combine(summarizePhysical(begin, m_x.size()),
+                            summarizePhysical(0, begin + count - m_x.size()));
+}
+
+void StreamSeries::decimate(const Core::ViewTransform& vt, std::pmr::vector<Core::Vec2>& out) const {
+    decimateSeries(*this, vt, out);
+}
+
+#ifdef _WIN32
+
+StreamSeries::Reader::~Reader() {
+    if (socket != INVALID_SOCKET) {
+        closesocket(socket);
+        WSACleanup();
+    }
+    if (pipe) {
+        CloseHandle(pipe);
+    }
+}
+
+bool StreamSeries::open(const std::string& source, std::string& error) {
+    poll();  // keep what the previous reader queued
+    stopReader();
+    m_reader = std::make_shared<Reader>(m_created);
+    m_sourceName = source;
+    Reader& reader = *m_reader;
+    if (source.rfind(kSocketPrefix, 0) == 0) {
+        const std::string path = source.substr(std::strlen(kSocketPrefix));
+        WSADATA wsa{};
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+            error = "Cannot initialise sockets.";
+            return false;
+        }
+        SOCKADDR_UN address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            WSACleanup();
+            error = "Invalid socket path: " + path;
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        SOCKET s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s == INVALID_SOCKET ||
+            connect(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            if (s != INVALID_SOCKET) closesocket(s);
+            WSACleanup();
+            error = "Cannot connect to socket: " + path;
+            return false;
+        }
+        reader.socket = s;
+    } else {
+        const int length = MultiByteToWideChar(CP_UTF8, 0, source.c_str(), -1, nullptr, 0);
+        std::wstring widePath(length > 0 ? static_cast<size_t>(length) : 1u, L'\0');
+        if (length <= 0 ||
+            MultiByteToWideChar(CP_UTF8, 0, source.c_str(), -1, widePath.data(), length) <= 0) {
+            error = "Invalid stream path.";
+            return false;
+        }
+        HANDLE handle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                    nullptr, OPEN_EXISTING, 0, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            error = "Cannot open stream: " + source;
+            return false;
+        }
+        reader.pipe = handle;
+    }
+    reader.connected.store(true, std::memory_order_release);
+    std::thread([shared = m_reader]() { shared->run(); }).detach();
+    return true;
+}
+
+void StreamSeries::Reader::run() {
+    std::vector<char> buffer(kReadBufferBytes);
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (socket != INVALID_SOCKET) {
+            const int received = recv(socket, buffer.data(), static_cast<int>(buffer.size()), 0);
+            if (received <= 0) break;
+            feed(buffer.data(), static_cast<std::size_t>(received));
+        } else {
+            DWORD read = 0;
+            if (!ReadFile(pipe, buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) || read == 0) {
+                break;  // pipe closed, cancelled, or end of file
+            }
+            feed(buffer.data(), read);
+        }
+    }
+    connected.store(false, std::memory_order_release);
+}
+
+void StreamSeries::stopReader() {
+    std::shared_ptr<Reader> reader = std::move(m_reader);
+    if (!reader) {
+        return;
+    }
+    m_overflowedBefore += reader->overflowed.load(std::memory_order_relaxed);
+    reader->stop.store(true, std::memory_order_relaxed);
+    if (!reader->connected.load(std::memory_order_acquire)) {
+        return;
+    }
+    // Wake a reader blocked in recv() or ReadFile(). A cancellation only reaches a call already
+    // in progress, so it is retried until the reader has left, on a helper thread.
+    if (reader->socket != INVALID_SOCKET) {
+        shutdown(reader->socket, SD_BOTH);
+    }
+    std::thread([reader]() {
+        while (reader->connected.load(std::memory_order_acquire)) {
+            if (reader->pipe) CancelIoEx(reader->pipe, nullptr);
+            Sleep(1);
+        }
+    }).detach();
+}
+
+#else
+
+StreamSeries::Reader::~Reader() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool StreamSeries::open(const std::string& source, std::string& error) {
+    poll();  // keep what the previous reader queued
+    stopReader();
+    m_reader = std::make_shared<Reader>(m_created);
+    m_sourceName = source;
+    int fd = -1;
+    bool waitForWriters = false;
+    if (source.rfind(kSocketPrefix, 0) == 0) {
+        const std::string path = source.substr(std::strlen(kSocketPrefix));
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            error = "Invalid socket path: " + path;
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            error = "Cannot connect to socket: " + path + " (" + std::strerror(errno) + ")";
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+    } else {
+        // Non-blocking, so opening a FIFO does not wait for its writer.
+        fd = ::open(source.c_str(), O_RDONLY | O_NONBLOCK);
+        if (fd < 0) {
+            error = "Cannot open stream: " + source + " (" + std::strerror(errno) + ")";
+            return false;
+        }
+        struct stat info {};
+        waitForWriters = ::fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+    }
+    m_reader->fd = fd;
+    m_reader->waitForWriters = waitForWriters;
+    m_reader->connected.store(true, std::memory_order_release);
+    std::thread([shared = m_reader]() { shared->run(); }).detach();
+    return true;
+}
+
+void StreamSeries::Reader::run() {
+    std::vector<char> buffer(kReadBufferBytes);
+    while (!stop.load(std::memory_order_relaxed)) {
+        // Wait with a timeout, so a stop request is noticed without signalling the thread.
+        pollfd request{ fd, POLLIN, 0 };
+        const int ready = ::poll(&request, 1, 100);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+        const ssize_t count = ::read(fd, buffer.data(), buffer.size());
+        if (count > 0) {
+            feed(buffer.data(), static_cast<std::size_t>(count));
+        } else if (count == 0) {
+            if (!waitForWriters) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));  // until the next writer
+        } else if (errno != EAGAIN && errno != EINTR) {
+            break;
+        }
+    }
+    connected.store(false, std::memory_order_release);
+}
+
+void StreamSeries::stopReader() {
+    // The reader owns a reference and closes the descriptor when it lets go.
+    if (m_reader) {
+        m_overflowedBefore += m_reader->overflowed.load(std::memory_order_relaxed);
+        m_reader->stop.store(true, std::memory_order_relaxed);
+        m_reader.reset();
+    }
+}
+
+#endif
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,116 @@
+// StreamSeries.h - Live y(x) series read from a pipe or socket into a fixed-capacity window.
+#pragma once
+
+#include "DataSeries.h"
+#include "../Core/ViewTransform.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Telemetry arriving as text lines, plotted next to the formulas while it streams in.
+///
+/// A reader thread parses the source into samples and hands them to the UI thread through a
+/// lock-free ring, so ingestion never waits on drawing and drawing never waits on I/O. poll()
+/// moves the delivered samples into a window holding the latest `capacity` of them; older ones
+/// drop out. The window keeps y extremes per block of kBlock samples, updated as samples
+/// arrive, so decimate() reduces it to two vertices per pixel column like a DataSeries.
+///
+/// Each line holds "x y" (separated like a CSV data series) or just "y", which is then plotted
+/// at the seconds since the series was created. x must not decrease: samples going back in x
+/// are dropped and counted.
+class StreamSeries {
+public:
+    struct Sample {
+        double x = 0.0;
+        double y = 0.0;
+    };
+    using Summary = DataSeries::Summary;
+
+    static constexpr std::size_t kDefaultCapacity = std::size_t(1) << 20;
+    static constexpr std::size_t kBlock = 64;
+
+    /// Window of `capacity` samples (rounded up to a power of two, at least 2 * kBlock).
+    explicit StreamSeries(std::size_t capacity = kDefaultCapacity);
+    ~StreamSeries();
+    StreamSeries(const StreamSeries&) = delete;
+    StreamSeries& operator=(const StreamSeries&) = delete;
+
+    /// Start reading `source` on a background thread:
+    ///
+    /// - `unix:<path>`: connect to a UNIX domain stream socket
+    /// - anything else: open a named pipe (a FIFO, or `\\.\pipe\<name>` on Windows) or a file
+    ///
+    /// Returns false and sets `error` when it cannot be opened. The reader stops at the end of
+    /// a socket, pipe server or file; a FIFO keeps waiting for the next writer. Reopening keeps
+    /// the window.
+    bool open(const std::string& source, std::string& error);
+    /// Tell the reader to stop, without waiting for it: it releases the source on its own
+    /// (on POSIX within its 100 ms poll). Samples already queued are kept in the window.
+    void close();
+    /// True while the reader is running.
+    bool connected() const;
+    /// The source last passed to open().
+    const std::string& source() const { return m_sourceName; }
+
+    /// Producer side: parse complete lines of `text` into samples and queue them; a trailing
+    /// partial line is kept for the next call. Used by the reader thread, and by tests when
+    /// no source is open. Returns the samples queued.
+    std::size_t feed(const char* text, std::size_t length);
+
+    /// Consumer side (UI thread): move the queued samples into the window. Returns how many
+    /// were added.
+    std::size_t poll();
+
+    /// Samples appended to the window since creation; a change means the picture changed.
+    std::uint64_t revision() const { return m_revision; }
+    /// Samples lost because the queue was full (UI not polling) or x went backwards.
+    std::uint64_t dropped() const;
+
+    std::size_t capacity() const { return m_x.size(); }
+    std::size_t size() const { return m_size; }
+    double x(std::size_t i) const { return m_x[(m_start + i) & m_mask]; }
+    double y(std::size_t i) const { return m_y[(m_start + i) & m_mask]; }
+
+    /// First index in [first, last) with x >= value / x > value (last when there is none).
+    std::size_t lowerBound(double value, std::size_t first, std::size_t last) const;
+    std::size_t upperBound(double value, std::size_t first, std::size_t last) const;
+
+    /// y extremes of the window samples [first, last), NaN values ignored.
+    Summary summarize(std::size_t first, std::size_t last) const;
+
+    /// Screen-space polyline of the window for the view (see decimateSeries()).
+    void decimate(const Core::ViewTransform& vt, std::pmr::vector<Core::Vec2>& out) const;
+
+private:
+    // Producer side: the queue, the partial line and the open source. Shared with the reader
+    // thread, which is detached, so a closed series never waits for it.
+    struct Reader;
+
+    void append(const Sample& sample);
+    void stopReader();
+    Summary summarizePhysical(std::size_t first, std::size_t last) const;
+
+    // Window: circular x/y storage, oldest sample at m_start.
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<Summary> m_blocks;  // extremes of each kBlock slots written since the block began
+    std::size_t m_mask = 0;
+    std::size_t m_start = 0;
+    std::size_t m_size = 0;
+    std::uint64_t m_revision = 0;
+    std::uint64_t m_outOfOrder = 0;
+    std::vector<Sample> m_pollBuffer;
+
+    std::chrono::steady_clock::time_point m_created = std::chrono::steady_clock::now();
+    std::shared_ptr<Reader> m_reader;
+    std::uint64_t m_overflowedBefore = 0;  // by readers stopped earlier
+    std::string m_sourceName;
+};
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,125 @@
+// VolumeCache.cpp - Background-sampled f(x,y,z) volume for interactive cross-section slicing.
+#include "VolumeCache.h"
+#include "../Core/Evaluator.h"
+#include "../Core/GridEvaluator.h"
+#include "../Core/Symmetry.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace XpressFormula::Plotting {
+
+void VolumeCache::Volume::slice(double z, double* out) const {
+    const size_t planeSize = static_cast<size_t>(domain.nx) * domain.ny;
+    const double dz = (domain.zMax - domain.zMin) / (domain.nz - 1);
+    const double t = std::clamp((z - domain.zMin) / dz, 0.0, static_cast<double>(domain.nz - 1));
+    const int iz = std::min(static_cast<int>(t), domain.nz - 2);
+    const double w = t - iz;
+
+    const float* below = values.data() + static_cast<size_t>(iz) * planeSize;
+    const float* above = below + planeSize;
+    for (size_t i = 0; i < planeSize; ++i) {
+        out[i] = below[i] + w * (static_cast<double>(above[i]) - below[i]);
+    }
+}
+
+std::shared_ptr<const VolumeCache::Volume> VolumeCache::request(const Core::ASTNodePtr& ast,
+                                                                const Domain& domain) {
+    if (m_hasRequest && ast == m_ast && domain == m_domain) {
+        if (!m_ready && !m_failed && m_task.finished()) {
+            m_ready = m_task.take();
+            m_failed = !m_ready;
+        }
+        return m_ready;
+    }
+
+    m_ast = ast;
+    m_domain = domain;
+    m_hasRequest = true;
+    m_ready.reset();
+    m_failed = false;
+    // The worker owns a reference to the AST, so an edited formula cannot free it mid-pass.
+    m_task.start([ast, domain](const std::atomic<bool>* cancel) { return sample(ast, domain, cancel); });
+    return nullptr;
+}
+
+std::shared_ptr<const VolumeCache::Volume> VolumeCache::sample(const Core::ASTNodePtr& ast,
+                                                               const Domain& domain,
+                                                               const std::atomic<bool>* cancel) {
+    if (!ast || domain.nx < 1 || domain.ny < 1 || domain.nz < 2 ||
+        !(domain.zMax > domain.zMin)) {
+        return nullptr;
+    }
+
+    auto volume = std::make_shared<Volume>();
+    volume->domain = domain;
+    volume->values.resize(static_cast<size_t>(domain.nx) * domain.ny * domain.nz);
+
+    const double dx = (domain.xMax - domain.xMin) / domain.nx;
+    const double dy = (domain.yMax - domain.yMin) / domain.ny;
+    const double dz = (domain.zMax - domain.zMin) / (domain.nz - 1);
+    double lo = std::numeric_limits<double>::max();
+    double hi = std::numeric_limits<double>::lowest();
+    std::vector<double> xs(static_cast<size_t>(domain.nx));
+    std::vector<double> ys(static_cast<size_t>(domain.ny));
+    for (int ix = 0; ix < domain.nx; ++ix) xs[ix] = domain.xMin + (ix + 0.5) * dx;
+    for (int iy = 0; iy < domain.ny; ++iy) ys[iy] = domain.yMin + (iy + 0.5) * dy;
+    std::vector<double> plane(xs.size() * ys.size());
+    Core::Evaluator::Variables vars;
+
+    // Planes mirrored about z = 0 are copied from their partner when f is even or odd in z.
+    std::vector<double> zs(static_cast<size_t>(domain.nz));
+    std::vector<int> zSource(static_cast<size_t>(domain.nz));
+    for (int iz = 0; iz < domain.nz; ++iz) {
+        zs[iz] = domain.zMin + iz * dz;
+        zSource[iz] = iz;
+    }
+    const Core::Parity zParity = Core::Symmetry::parity(ast, "z");
+    if (zParity != Core::Parity::None) {
+        Core::Symmetry::mirrorSamples(zs.data(), domain.nz, zSource.data());
+    }
+
+    const size_t planeSize = plane.size();
+    for (int iz = 0; iz < domain.nz; ++iz) {
+        if (zSource[iz] != iz) {
+            continue;
+        }
+        // Checked once per plane so a superseded request is abandoned quickly.
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        vars["z"] = zs[iz];
+        Core::GridEvaluator(ast, vars).evaluate(xs.data(), domain.nx, ys.data(), domain.ny,
+                                                plane.data());
+        float* out = volume->values.data() + static_cast<size_t>(iz) * planeSize;
+        for (const double value : plane) {
+            *out++ = static_cast<float>(value);
+            if (std::isfinite(value)) {
+                lo = std::min(lo, value);
+                hi = std::max(hi, value);
+            }
+        }
+    }
+    for (int iz = 0; iz < domain.nz; ++iz) {
+        if (zSource[iz] == iz) {
+            continue;
+        }
+        const float* src = volume->values.data() + static_cast<size_t>(zSource[iz]) * planeSize;
+        float* dst = volume->values.data() + static_cast<size_t>(iz) * planeSize;
+        for (size_t i = 0; i < planeSize; ++i) {
+            dst[i] = (zParity == Core::Parity::Odd) ? -src[i] : src[i];
+            if (std::isfinite(dst[i])) {
+                lo = std::min(lo, static_cast<double>(dst[i]));
+                hi = std::max(hi, static_cast<double>(dst[i]));
+            }
+        }
+    }
+
+    if (lo < hi) {
+        volume->lo = lo;
+        volume->hi = hi;
+    }
+    return volume;
+}
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,73 @@
+// VolumeCache.h - Background-sampled f(x,y,z) volume for interactive cross-section slicing.
+#pragma once
+
+#include "../Core/ASTNode.h"
+#include "../Core/BackgroundTask.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace XpressFormula::Plotting {
+
+/// Samples a scalar field f(x,y,z) once over a box on a background thread, so any z
+/// cross-section can afterwards be produced by interpolation instead of re-evaluating the
+/// formula. The value range of the whole volume is recorded, giving every slice the same
+/// colour scale.
+class VolumeCache {
+public:
+    /// Sampling box: nx*ny samples at cell centres of [xMin,xMax]x[yMin,yMax] (the cross-section
+    /// heat-map grid) on each of nz planes spanning [zMin,zMax] inclusive.
+    struct Domain {
+        double xMin = 0.0;
+        double xMax = 1.0;
+        double yMin = 0.0;
+        double yMax = 1.0;
+        double zMin = -10.0;
+        double zMax = 10.0;
+        int nx = 1;
+        int ny = 1;
+        int nz = 2;
+
+        bool operator==(const Domain&) const = default;
+    };
+
+    struct Volume {
+        Domain domain;
+        std::vector<float> values;  // index: (iz * ny + iy) * nx + ix
+        double lo = -1.0;           // finite value range over the whole volume
+        double hi = 1.0;
+
+        bool containsZ(double z) const { return z >= domain.zMin && z <= domain.zMax; }
+
+        /// Write the nx*ny slice at z (row-major, y rows) to `out`, interpolating linearly
+        /// between the two nearest planes. z is clamped to the sampled range.
+        void slice(double z, double* out) const;
+    };
+
+    VolumeCache() = default;
+    VolumeCache(const VolumeCache&) = delete;
+    VolumeCache& operator=(const VolumeCache&) = delete;
+
+    /// Return the volume for (ast, domain) once it has been sampled, or null while sampling is
+    /// in progress. A request that differs from the previous one cancels the pass in flight and
+    /// starts a new one.
+    std::shared_ptr<const Volume> request(const Core::ASTNodePtr& ast, const Domain& domain);
+
+    /// True while a requested volume is still being sampled.
+    bool pending() const { return m_hasRequest && !m_ready && !m_failed; }
+
+    /// Sample synchronously. Returns null when `cancel` becomes true before completion or the
+    /// domain is degenerate.
+    static std::shared_ptr<const Volume> sample(const Core::ASTNodePtr& ast, const Domain& domain,
+                                                const std::atomic<bool>* cancel = nullptr);
+
+private:
+    Core::ASTNodePtr m_ast;
+    Domain m_domain;
+    bool m_hasRequest = false;
+    std::shared_ptr<const Volume> m_ready;
+    bool m_failed = false;  // the pass finished without a volume (degenerate domain)
+    Core::BackgroundTask<Volume> m_task;
+};
+
+} // namespace XpressFormula::Plotting
@@ -0,0 +1,218 @@
+// VolumeRaymarcher.cpp - Progressive multithreaded CPU ray-marcher for f(x,y,z) volumes.
+#include "VolumeRaymarcher.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace XpressFormula::Plotting {
+
+namespace {
+
+constexpr double kSampleSpacing = 0.5;    // march step in grid cells (along the dominant axis)
+constexpr double kOpaqueAlpha = 0.995;    // early ray termination
+constexpr float  kEmptyBrick = -1.0f;     // brick max when no node is finite
+
+} // namespace
+
+void VolumeRaymarcher::setScene(std::shared_ptr<const VolumeCache::Volume> volume,
+                                const Camera& camera, const TransferFunction& transfer,
+                                int imageWidth, int imageHeight) {
+    imageWidth = std::max(imageWidth, 1);
+    imageHeight = std::max(imageHeight, 1);
+    const bool volumeChanged = (volume != m_volume);
+    const bool sizeChanged = (imageWidth != m_image.width() || imageHeight != m_image.height());
+    if (!volumeChanged && !sizeChanged && camera == m_camera && transfer == m_transfer) {
+        return;
+    }
+
+    m_volume = std::move(volume);
+    m_camera = camera;
+    m_transfer = transfer;
+    m_image.resize(imageWidth, imageHeight);
+    if (volumeChanged) {
+        buildBricks();
+    }
+    m_image.restart(m_camera);
+
+    if (!m_volume || m_volume->domain.nx < 2 || m_volume->domain.ny < 2 ||
+        m_volume->domain.nz < 2 || std::abs(m_camera.zScale) < 1e-6f || m_camera.scale <= 0.0) {
+        m_image.clear();
+        return;
+    }
+
+    // Map the camera basis from scaled world space to grid coordinates (x/y nodes at cell
+    // centres, z planes inclusive).
+    const auto basis = m_camera.basis();
+    const VolumeCache::Domain& d = m_volume->domain;
+    const double dx = (d.xMax - d.xMin) / d.nx;
+    const double dy = (d.yMax - d.yMin) / d.ny;
+    const double dz = (d.zMax - d.zMin) / (d.nz - 1);
+    const double inv[3] = { 1.0 / dx, 1.0 / dy, 1.0 / (dz * m_camera.zScale) };
+    for (int a = 0; a < 3; ++a) {
+        m_right[a] = basis[0][a] * inv[a];
+        m_up[a] = basis[1][a] * inv[a];
+        m_dir[a] = basis[2][a] * inv[a];
+    }
+    m_base = { -(d.xMin + 0.5 * dx) / dx, -(d.yMin + 0.5 * dy) / dy, -d.zMin / dz };
+}
+
+void VolumeRaymarcher::buildBricks() {
+    m_normalized.clear();
+    m_brickMax.clear();
+    m_bricksX = m_bricksY = m_bricksZ = 0;
+    if (!m_volume) {
+        return;
+    }
+
+    const VolumeCache::Domain& d = m_volume->domain;
+    const double lo = m_volume->lo;
+    const double range = std::max(m_volume->hi - lo, 1e-12);
+    m_normalized.resize(m_volume->values.size());
+    for (size_t i = 0; i < m_normalized.size(); ++i) {
+        const float v = m_volume->values[i];
+        m_normalized[i] = std::isfinite(v)
+            ? static_cast<float>(std::clamp((v - lo) / range, 0.0, 1.0))
+            : std::numeric_limits<float>::quiet_NaN();
+    }
+
+    // Brick b covers cells [b*K, (b+1)*K), i.e. nodes [b*K, (b+1)*K] inclusive, so its maximum
+    // bounds every trilinear sample taken inside it.
+    m_bricksX = std::max(1, (d.nx - 2) / kBrickSize + 1);
+    m_bricksY = std::max(1, (d.ny - 2) / kBrickSize + 1);
+    m_bricksZ = std::max(1, (d.nz - 2) / kBrickSize + 1);
+    m_brickMax.assign(static_cast<size_t>(m_bricksX) * m_bricksY * m_bricksZ, kEmptyBrick);
+    for (int bz = 0; bz < m_bricksZ; ++bz) {
+        for (int by = 0; by < m_bricksY; ++by) {
+            for (int bx = 0; bx < m_bricksX; ++bx) {
+                float maxValue = kEmptyBrick;
+                for (int iz = bz * kBrickSize; iz <= std::min((bz + 1) * kBrickSize, d.nz - 1); ++iz) {
+                    for (int iy = by * kBrickSize; iy <= std::min((by + 1) * kBrickSize, d.ny - 1); ++iy) {
+                        const float* row = &m_normalized[(static_cast<size_t>(iz) * d.ny + iy) * d.nx];
+                        for (int ix = bx * kBrickSize; ix <= std::min((bx + 1) * kBrickSize, d.nx - 1); ++ix) {
+                            if (row[ix] > maxValue) {  // false for NaN
+                                maxValue = row[ix];
+                            }
+                        }
+                    }
+                }
+                m_brickMax[(static_cast<size_t>(bz) * m_bricksY + by) * m_bricksX + bx] = maxValue;
+            }
+        }
+    }
+}
+
+bool VolumeRaymarcher::refine(Core::TaskPool& pool, double budgetMs,
+                              int& dirtyTop, int& dirtyBottom) {
+    struct NoRowState {};
+    return m_image.refine<NoRowState>(pool, budgetMs, dirtyTop, dirtyBottom,
+                                      [this](double xProj, double yProj, NoRowState&, std::uint64_t& samples) {
+                                          return tracePixel(xProj, yProj, samples);
+                                      });
+}
+
+std::uint32_t VolumeRaymarcher::tracePixel(double xProj, double yProj,
+                                           std::uint64_t& samples) const {
+    const VolumeCache::Domain& d = m_volume->domain;
+    double g0[3];
+    for (int a = 0; a < 3; ++a) {
+        g0[a] = m_base[a] + xProj * m_right[a] + yProj * m_up[a];
+    }
+
+    // Clip the ray against the node box [0, n-1] on each axis.
+    const int n[3] = { d.nx, d.ny, d.nz };
+    double tLo = -std::numeric_limits<double>::infinity();
+    double tHi = std::numeric_limits<double>::infinity();
+    double maxDir = 0.0;
+    for (int a = 0; a < 3; ++a) {
+        const double upper = n[a] - 1;
+        if (std::abs(m_dir[a]) < 1e-12) {
+            if (g0[a] < 0.0 || g0[a] > upper) {
+                return 0u;
+            }
+            continue;
+        }
+        const double t1 = -g0[a] / m_dir[a];
+        const double t2 = (upper - g0[a]) / m_dir[a];
+        tLo = std::max(tLo, std::min(t1, t2));
+        tHi = std::min(tHi, std::max(t1, t2));
+        maxDir = std::max(maxDir, std::abs(m_dir[a]));
+    }
+    if (!(tHi > tLo) || maxDir == 0.0) {
+        return 0u;
+    }
+
+    const double dt = kSampleSpacing / maxDir;
+    const double threshold = m_transfer.threshold;
+    const double visibleRange = std::max(1e-6, 1.0 - threshold);
+    const double extinction = static_cast<double>(m_transfer.density) * kSampleSpacing;
+    const float* values = m_normalized.data();
+    const size_t strideY = static_cast<size_t>(d.nx);
+    const size_t strideZ = strideY * d.ny;
+
+    double accR = 0.0, accG = 0.0, accB = 0.0, accA = 0.0;
+    // March front to back: from the near end (large t) towards the far end.
+    for (double t = tHi - 1e-9; t >= tLo && accA < kOpaqueAlpha; t -= dt) {
+        const double gx = std::clamp(g0[0] + t * m_dir[0], 0.0, static_cast<double>(d.nx - 1));
+        const double gy = std::clamp(g0[1] + t * m_dir[1], 0.0, static_cast<double>(d.ny - 1));
+        const double gz = std::clamp(g0[2] + t * m_dir[2], 0.0, static_cast<double>(d.nz - 1));
+        const int ix = std::min(static_cast<int>(gx), d.nx - 2);
+        const int iy = std::min(static_cast<int>(gy), d.ny - 2);
+        const int iz = std::min(static_cast<int>(gz), d.nz - 2);
+
+        // Empty-space skipping: jump to where the ray leaves a brick that cannot reach the
+        // threshold.
+        const int bx = std::min(ix / kBrickSize, m_bricksX - 1);
+        const int by = std::min(iy / kBrickSize, m_bricksY - 1);
+        const int bz = std::min(iz / kBrickSize, m_bricksZ - 1);
+        if (m_brickMax[(static_cast<size_t>(bz) * m_bricksY + by) * m_bricksX + bx] <= threshold) {
+            const double g[3] = { gx, gy, gz };
+            const int b[3] = { bx, by, bz };
+            double tExit = tLo;
+            for (int a = 0; a < 3; ++a) {
+                if (m_dir[a] > 1e-12) {
+                    tExit = std::max(tExit, t - (g[a] - b[a] * kBrickSize) / m_dir[a]);
+                } else if (m_dir[a] < -1e-12) {
+                    tExit = std::max(tExit, t - ((b[a] + 1) * kBrickSize - g[a]) / -m_dir[a]);
+                }
+            }
+            // Resume just past the brick face (the loop step subtracts dt again).
+            t = std::min(tExit - 1e-6 * dt, t - 1e-3 * dt) + dt;
+            continue;
+        }
+
+        const double fx = gx - ix;
+        const double fy = gy - iy;
+        const double fz = gz - iz;
+        const float* c = values + static_cast<size_t>(iz) * strideZ + static_cast<size_t>(iy) * strideY + ix;
+        const double c00 = c[0] + (c[1] - c[0]) * fx;
+        const double c10 = c[strideY] + (c[strideY + 1] - c[strideY]) * fx;
+        const double c01 = c[strideZ] + (c[strideZ + 1] - c[strideZ]) * fx;
+        const double c11 = c[strideZ + strideY] + (c[strideZ + strideY + 1] - c[strideZ + strideY]) * fx;
+        const double v = (c00 + (c10 - c00) * fy) * (1.0 - fz) + (c01 + (c11 - c01) * fy) * fz;
+        ++samples;
+        if (!(v > threshold)) {  // also skips NaN (an undefined corner is transparent)
+            continue;
+        }
+
+        const double visible = std::min(1.0, (v - threshold) / visibleRange);
+        const double alpha = 1.0 - std::exp(-extinction * visible);
+        const std::uint32_t rgba = m_transfer.palette[static_cast<size_t>(std::clamp(v, 0.0, 1.0) * 255.0 + 0.5)];
+        const double weight = (1.0 - accA) * alpha;
+        accR += weight * static_cast<double>(rgba & 0xFFu);
+        accG += weight * static_cast<double>((rgba >> 8) & 0xFFu);
+        accB += weight * static_cast<double>((rgba >> 16) & 0xFFu);
+        accA += weight;
+    }
+
+    if (accA < 1.0 / 255.0) {
+        return 0u;
+    }
+    const auto channel = [](double value) {
+        return static_cast<std::uint32_t>(std::clamp(value + 0.5, 0.0, 255.0));
+    };
+    const double outAlpha = std::min(1.0, accA) * std::clamp(static_cast<double>(m_transfer.opacity), 0.0, 1.0);
+    return channel(accR / accA) | (channel(accG / accA) << 8) | (channel(accB / accA) << 16) |
+           (channel(outAlpha * 255.0) << 24);
+}
+
+} // namespace XpressFormula::Plotting
@@ -1,7 +1,11 @@
 // SPDX-License-Identifier: MIT
 // Application.cpp - Win32 + D3D11 + ImGui application implementation.
 #include "Application.h"
+#include "ExportTiles.h"
+#include "../Core/BackgroundTask.h"
 #include "../Core/UpdateVersionUtils.h"
+#include "../Imaging/PixelOps.h"
+#include "../Imaging/Resample.h"
 #include "../Version.h"
 #include "../resource.h"
 
@@ -20,21 +24,22 @@
 #include <shellapi.h>
 #include <tchar.h>
 #include <winhttp.h>
-#include <wincodec.h>
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <cmath>
 #include <cstring>
+#include <ctime>
 #include <cwchar>
 #include <cwctype>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <string>
+#include <utility>
 
-#pragma comment(lib, "windowscodecs.lib")
 #pragma comment(lib, "shell32.lib")
 #pragma comment(lib, "winhttp.lib")
 
@@ -200,6 +205,13 @@ XpressFormula::UI::Application::UpdateCheckResult fetchLatestReleaseFromGitHub(b
     return result;
 }
 
+bool isBmpPath(const std::wstring& path) {
+    std::wstring extension = std::filesystem::path(path).extension().wstring();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](wchar_t ch) { return static_cast<wchar_t>(std::towlower(ch)); });
+    return extension == L".bmp";
+}
+
 } // namespace
 
 static std::wstring utf8ToWide(const char* text) {
@@ -363,17 +375,20 @@ int Application::run() {
                 continue;
             }
 
-            if (formula.uses3DSurface()) {
+            if (formula.uses3DSurface(m_plotSettings.volumeRendering)) {
                 hasSurfaceFormula = true;
             }
 
             switch (formula.renderKind) {
                 case FormulaRenderKind::Curve2D:
                 case FormulaRenderKind::Implicit2D:
+                case FormulaRenderKind::DataSeries2D:
+                case FormulaRenderKind::Scatter2D:
+                case FormulaRenderKind::Stream2D:
                     has2DFormula = true;
                     break;
                 case FormulaRenderKind::ScalarField3D:
-                    if (!formula.isEquation) {
+                    if (!formula.isEquation && !m_plotSettings.volumeRendering) {
                         has2DFormula = true;
                     }
                     break;
@@ -418,7 +433,10 @@ int Application::run() {
 
         renderFrame();
         // Auto-rotate requires continuous redraws; otherwise render on demand when optimization is enabled.
-        m_redrawRequested = optimizeRendering ? continuousRender : true;
+        // While the quality governor is active, keep rendering until it restores full quality.
+        m_redrawRequested = optimizeRendering
+            ? (continuousRender || m_plotPanel.needsRefinementFrame())
+            : true;
     }
     return static_cast<int>(msg.wParam);
 }
@@ -460,6 +478,11 @@ void Application::renderFrame() {
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
 
+    // F9 toggles interaction recording (replayed headlessly by XpressFormula.Benchmarks --replay).
+    if (ImGui::IsKeyPressed(ImGuiKey_F9, false)) {
+        toggleInteractionRecording();
+    }
+
     // We fill the entire OS window with two fixed ImGui windows (sidebar + plot)
     const ImGuiViewport* viewport = ImGui::GetMainViewport();
     float totalW = viewport->WorkSize.x;
@@ -481,17 +504,20 @@ void Application::renderFrame() {
             continue;
         }
 
-        if (formula.uses3DSurface()) {
+        if (formula.uses3DSurface(m_plotSettings.volumeRendering)) {
             hasSurfaceFormula = true;
         }
 
         switch (formula.renderKind) {
             case FormulaRenderKind::Curve2D:
             case FormulaRenderKind::Implicit2D:
+            case FormulaRenderKind::DataSeries2D:
+            case FormulaRenderKind::Scatter2D:
+            case FormulaRenderKind::Stream2D:
                 has2DFormula = true;
                 break;
             case FormulaRenderKind::ScalarField3D:
-                if (!formula.isEquation) {
+                if (!formula.isEquation && !m_plotSettings.volumeRendering) {
                     has2DFormula = true;
                 }
                 break;
@@ -509,6 +535,15 @@ void Application::renderFrame() {
         m_viewTransform, m_plotSettings, has2DFormula, hasSurfaceFormula, m_exportStatus);
     m_exportDialogOpenRequested = m_exportDialogOpenRequested || actions.requestOpenExportDialog;
 
+    if (m_interactionRecorder.isRecording()) {
+        ImGui::Spacing();
+        ImGui::TextColored(ImVec4(1.0f, 0.35f, 0.35f, 1.0f), "Recording interaction (%zu frames) - F9 to stop",
+                           m_interactionRecorder.frameCount());
+    } else if (!m_recordingStatus.empty()) {
+        ImGui::Spacing();
+        ImGui::TextWrapped("%s", m_recordingStatus.c_str());
+    }
+
     ImGui::Spacing();
     ImGui::Separator();
     const bool showUpdateAlert = m_updateAvailable && !m_updateNoticeDismissed;
@@ -612,6 +647,7 @@ void Application::renderFrame() {
         exportOverrides.showAxisTriad = m_pendingExportSettings.showAxisTriad;
         exportOverrides.backgroundColor = m_pendingExportSettings.backgroundColor;
     }
+    recordInteractionFrame();
     m_plotPanel.render(m_formulas, m_viewTransform, m_plotSettings,
                        exportOverrides.active ? &exportOverrides : nullptr);
     ImGui::End();
@@ -628,6 +664,56 @@ void Application::renderFrame() {
     m_swapChainOccluded = (hr == DXGI_STATUS_OCCLUDED);
 }
 
+void Application::toggleInteractionRecording() {
+    if (!m_interactionRecorder.isRecording()) {
+        m_interactionRecorder.start(m_viewTransform, m_formulas, m_plotSettings);
+        m_recordingStartTime = std::chrono::steady_clock::now();
+        m_recordingStatus.clear();
+        return;
+    }
+
+    m_interactionRecorder.stop();
+    char fileName[64] = {};
+    const std::time_t now = std::time(nullptr);
+    std::tm localTime = {};
+    localtime_s(&localTime, &now);
+    std::strftime(fileName, sizeof(fileName), "xpressformula-%Y%m%d-%H%M%S.xfrec", &localTime);
+
+    const std::filesystem::path path = std::filesystem::current_path() / fileName;
+    std::string error;
+    if (m_interactionRecorder.save(path.string(), error)) {
+        m_recordingStatus = "Saved " + std::to_string(m_interactionRecorder.frameCount()) +
+                            " frames to " + narrowUtf8(path.wstring());
+    } else {
+        m_recordingStatus = error;
+    }
+    m_redrawRequested = true;
+}
+
+// Captures the state the plot panel is about to render with. Formula/settings edits made in
+// the sidebar this frame are included; mouse coordinates are stored relative to the plot area
+// laid out in the previous frame (the layout only changes on window resize).
+void Application::recordInteractionFrame() {
+    if (!m_interactionRecorder.isRecording()) {
+        return;
+    }
+    const ImGuiIO& io = ImGui::GetIO();
+    InteractionInput input;
+    input.plotWidth = m_viewTransform.screenWidth;
+    input.plotHeight = m_viewTransform.screenHeight;
+    input.mouseX = io.MousePos.x - m_viewTransform.screenOriginX;
+    input.mouseY = io.MousePos.y - m_viewTransform.screenOriginY;
+    input.mouseLeft = io.MouseDown[ImGuiMouseButton_Left];
+    input.mouseRight = io.MouseDown[ImGuiMouseButton_Right];
+    input.wheel = io.MouseWheel;
+    input.keyCtrl = io.KeyCtrl;
+    input.keyShift = io.KeyShift;
+
+    const double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_recordingStartTime).count();
+    m_interactionRecorder.recordFrame(elapsed, io.DeltaTime, input, m_formulas, m_plotSettings);
+}
+
 void Application::startUpdateCheck(bool manualRequest) {
     if (m_updateCheckInProgress) {
         if (manualRequest) {
@@ -795,17 +881,17 @@ void Application::renderExportDialog(float sidebarWidth, float viewportHeight) {
         const int prevHeight = (std::max)(1, height);
         bool widthChanged = ImGui::InputInt("Width", &width, 16, 128);
         bool heightChanged = ImGui::InputInt("Height", &height, 16, 128);
-        width = std::clamp(width, 16, 8192);
-        height = std::clamp(height, 16, 8192);
+        width = std::clamp(width, 16, ExportTiles::kMaxSize);
+        height = std::clamp(height, 16, ExportTiles::kMaxSize);
 
         if (m_exportDialogSettings.lockAspectRatio && widthChanged && !heightChanged) {
             height = std::clamp(static_cast<int>(std::lround(
                                     static_cast<double>(width) * prevHeight / prevWidth)),
-                                16, 8192);
+                                16, ExportTiles::kMaxSize);
         } else if (m_exportDialogSettings.lockAspectRatio && heightChanged && !widthChanged) {
             width = std::clamp(static_cast<int>(std::lround(
                                    static_cast<double>(height) * prevWidth / prevHeight)),
-                               16, 8192);
+                               16, ExportTiles::kMaxSize);
         }
 
         m_exportDialogSettings.width = width;
@@ -844,6 +930,17 @@ void Application::renderExportDialog(float sidebarWidth, float viewportHeight) {
         }
         ImGui::TextWrapped("Wires affect 3D surfaces/implicit meshes. 2D curves are always drawn.");
 
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::TextUnformatted("PNG Compression");
+        if (ImGui::RadioButton("Fast", m_exportDialogSettings.pngLevel == Imaging::PngLevel::Fast)) {
+            m_exportDialogSettings.pngLevel = Imaging::PngLevel::Fast;
+        }
+        ImGui::SameLine();
+        if (ImGui::RadioButton("Small", m_exportDialogSettings.pngLevel == Imaging::PngLevel::Small)) {
+            m_exportDialogSettings.pngLevel = Imaging::PngLevel::Small;
+        }
+
         ImGui::Spacing();
         ImGui::Separator();
         ImGui::TextUnformatted("Preview");
@@ -900,6 +997,12 @@ void Application::renderExportDialog(float sidebarWidth, float viewportHeight) {
         ImGui::Spacing();
         ImGui::Separator();
         ImGui::TextWrapped("Export uses the current formulas and view. Width/Height define the offscreen render size used for export.");
+        if (m_exportDialogSettings.width > kMaxBufferedExportSize ||
+            m_exportDialogSettings.height > kMaxBufferedExportSize) {
+            ImGui::TextWrapped("Sizes above %d px are rendered in tiles and streamed to disk: save as PNG "
+                               "(BMP files and the clipboard are limited to %d px).",
+                               kMaxBufferedExportSize, kMaxBufferedExportSize);
+        }
 
         const float buttonWidth = (ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ItemSpacing.x) * 0.5f;
         if (ImGui::Button("Copy To Clipboard", ImVec2(buttonWidth, 0.0f))) {
@@ -935,119 +1038,6 @@ void Application::renderExportDialog(float sidebarWidth, float viewportHeight) {
     }
 }
 
-void Application::resizePixelsBilinear(const std::vector<std::uint8_t>& srcPixels,
-                                       int srcWidth, int srcHeight,
-                                       int dstWidth, int dstHeight,
-                                       std::vector<std::uint8_t>& dstPixels) {
-    dstPixels.clear();
-    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) {
-        return;
-    }
-    if (srcWidth == dstWidth && srcHeight == dstHeight) {
-        dstPixels = srcPixels;
-        return;
-    }
-
-    dstPixels.resize(static_cast<size_t>(dstWidth) * static_cast<size_t>(dstHeight) * 4u);
-
-    const auto sampleIndex = [srcWidth](int x, int y) {
-        return (static_cast<size_t>(y) * static_cast<size_t>(srcWidth) +
-                static_cast<size_t>(x)) * 4u;
-    };
-
-    for (int y = 0; y < dstHeight; ++y) {
-        double srcY = ((static_cast<double>(y) + 0.5) * srcHeight / dstHeight) - 0.5;
-        int y0 = static_cast<int>(std::floor(srcY));
-        int y1 = y0 + 1;
-        double fy = srcY - y0;
-        y0 = std::clamp(y0, 0, srcHeight - 1);
-        y1 = std::clamp(y1, 0, srcHeight - 1);
-
-        for (int x = 0; x < dstWidth; ++x) {
-            double srcX = ((static_cast<double>(x) + 0.5) * srcWidth / dstWidth) - 0.5;
-            int x0 = static_cast<int>(std::floor(srcX));
-            int x1 = x0 + 1;
-            double fx = srcX - x0;
-            x0 = std::clamp(x0, 0, srcWidth - 1);
-            x1 = std::clamp(x1, 0, srcWidth - 1);
-
-            size_t outIndex = (static_cast<size_t>(y) * static_cast<size_t>(dstWidth) +
-                               static_cast<size_t>(x)) * 4u;
-            const size_t i00 = sampleIndex(x0, y0);
-            const size_t i10 = sampleIndex(x1, y0);
-            const size_t i01 = sampleIndex(x0, y1);
-            const size_t i11 = sampleIndex(x1, y1);
-
-            for (int c = 0; c < 4; ++c) {
-                const double v00 = srcPixels[i00 + c];
-                const double v10 = srcPixels[i10 + c];
-                const double v01 = srcPixels[i01 + c];
-                const double v11 = srcPixels[i11 + c];
-                const double top = v00 + (v10 - v00) * fx;
-                const double bottom = v01 + (v11 - v01) * fx;
-                const double value = top + (bottom - top) * fy;
-                dstPixels[outIndex + c] = static_cast<std::uint8_t>(
-                    std::clamp(static_cast<int>(std::lround(value)), 0, 255));
-            }
-        }
-    }
-}
-
-void Application::convertPixelsRgbaToBgra(std::vector<std::uint8_t>& pixels) {
-    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
-        std::swap(pixels[i + 0], pixels[i + 2]);
-    }
-}
-
-void Application::unpremultiplyPixels(std::vector<std::uint8_t>& pixels) {
-    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
-        const int a = pixels[i + 3];
-        if (a <= 0) {
-            pixels[i + 0] = 0;
-            pixels[i + 1] = 0;
-            pixels[i + 2] = 0;
-            continue;
-        }
-        if (a >= 255) {
-            continue;
-        }
-
-        const float scale = 255.0f / static_cast<float>(a);
-        pixels[i + 0] = static_cast<std::uint8_t>(std::clamp(
-            static_cast<int>(std::lround(pixels[i + 0] * scale)), 0, 255));
-        pixels[i + 1] = static_cast<std::uint8_t>(std::clamp(
-            static_cast<int>(std::lround(pixels[i + 1] * scale)), 0, 255));
-        pixels[i + 2] = static_cast<std::uint8_t>(std::clamp(
-            static_cast<int>(std::lround(pixels[i + 2] * scale)), 0, 255));
-    }
-}
-
-void Application::convertPixelsToGrayscale(std::vector<std::uint8_t>& pixels) {
-    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
-        const float b = static_cast<float>(pixels[i + 0]);
-        const float g = static_cast<float>(pixels[i + 1]);
-        const float r = static_cast<float>(pixels[i + 2]);
-        const std::uint8_t gray = static_cast<std::uint8_t>(std::clamp(
-            static_cast<int>(std::lround(0.114f * b + 0.587f * g + 0.299f * r)), 0, 255));
-        pixels[i + 0] = gray;
-        pixels[i + 1] = gray;
-        pixels[i + 2] = gray;
-    }
-}
-
-void Application::convertPixelsToGrayscaleRgba(std::vector<std::uint8_t>& pixels) {
-    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
-        const float r = static_cast<float>(pixels[i + 0]);
-        const float g = static_cast<float>(pixels[i + 1]);
-        const float b = static_cast<float>(pixels[i + 2]);
-        const std::uint8_t gray = static_cast<std::uint8_t>(std::clamp(
-            static_cast<int>(std::lround(0.299f * r + 0.587f * g + 0.114f * b)), 0, 255));
-        pixels[i + 0] = gray;
-        pixels[i + 1] = gray;
-        pixels[i + 2] = gray;
-    }
-}
-
 void Application::cleanupExportPreviewResources() {
     if (m_exportPreviewSrv) {
         m_exportPreviewSrv->Release();
@@ -1096,9 +1086,10 @@ bool Application::refreshExportPreviewTexture() {
         return false;
     }
 
-    unpremultiplyPixels(pixels);
+    const std::size_t pixelCount = pixels.size() / 4u;
+    Imaging::unpremultiply(pixels.data(), pixelCount);
     if (previewSettings.grayscaleOutput) {
-        convertPixelsToGrayscaleRgba(pixels);
+        Imaging::toGrayscale(pixels.data(), pixelCount, Imaging::ChannelOrder::Rgba);
     }
 
     if (renderedW <= 0 || renderedH <= 0) {
@@ -1158,26 +1149,39 @@ void Application::applyExportPostProcessing(std::vector<std::uint8_t>& pixels,
                                             int& outputWidth, int& outputHeight) {
     outputWidth = sourceWidth;
     outputHeight = sourceHeight;
-    outputPixels = pixels;
 
-    const int targetWidth = std::clamp(m_pendingExportSettings.width, 16, 8192);
-    const int targetHeight = std::clamp(m_pendingExportSettings.height, 16, 8192);
+    const int targetWidth = std::clamp(m_pendingExportSettings.width, 16, kMaxBufferedExportSize);
+    const int targetHeight = std::clamp(m_pendingExportSettings.height, 16, kMaxBufferedExportSize);
     if (targetWidth != sourceWidth || targetHeight != sourceHeight) {
-        resizePixelsBilinear(pixels, sourceWidth, sourceHeight,
-                             targetWidth, targetHeight, outputPixels);
+        // Only the window-capture fallback gets here. Lanczos keeps plot lines sharp when
+        // shrinking; bilinear avoids its ringing around lines when enlarging.
+        const bool shrinking = targetWidth <= sourceWidth && targetHeight <= sourceHeight;
+        outputPixels.resize(static_cast<size_t>(targetWidth) * static_cast<size_t>(targetHeight) * 4u);
+        Imaging::resize(pixels.data(), sourceWidth, sourceHeight,
+                        outputPixels.data(), targetWidth, targetHeight,
+                        shrinking ? Imaging::ResampleFilter::Lanczos3 : Imaging::ResampleFilter::Bilinear);
         outputWidth = targetWidth;
         outputHeight = targetHeight;
+    } else {
+        outputPixels = std::move(pixels);  // the capture is not used after post-processing
     }
 
+    convertExportPixels(outputPixels.data(), outputPixels.size() / 4u, Imaging::ChannelOrder::Bgra);
+}
+
+void Application::convertExportPixels(std::uint8_t* pixels, std::size_t pixelCount,
+                                      Imaging::ChannelOrder order) const {
     // D3D11 render-target readback for DXGI_FORMAT_R8G8B8A8_UNORM returns RGBA bytes, while
-    // file/clipboard export paths below expect BGRA. Convert once here, then normalize alpha.
-    convertPixelsRgbaToBgra(outputPixels);
+    // the BMP and clipboard paths below expect BGRA. Convert once here, then normalize alpha.
+    if (order == Imaging::ChannelOrder::Bgra) {
+        Imaging::swapRedBlue(pixels, pixelCount);
+    }
     // ImGui rendering over a transparent target stores premultiplied color in the render target.
     // PNG/clipboard consumers generally expect straight alpha color channels.
-    unpremultiplyPixels(outputPixels);
+    Imaging::unpremultiply(pixels, pixelCount);
 
     if (m_pendingExportSettings.grayscaleOutput) {
-        convertPixelsToGrayscale(outputPixels);
+        Imaging::toGrayscale(pixels, pixelCount, order);
     }
 }
 
@@ -1393,77 +1397,45 @@ bool Application::capturePlotPixels(std::vector<std::uint8_t>& pixels, int& widt
     return true;
 }
 
-bool Application::readTexturePixelsRgba(ID3D11Texture2D* sourceTexture,
-                                        std::vector<std::uint8_t>& pixels,
-                                        int& width, int& height) {
+bool Application::renderPlotPixelsOffscreen(const Application::ExportDialogSettings& settings,
+                                            std::vector<std::uint8_t>& pixels,
+                                            int& width, int& height) {
     width = 0;
     height = 0;
     pixels.clear();
 
-    if (!sourceTexture || !m_device || !m_deviceContext) {
-        return false;
-    }
-
-    D3D11_TEXTURE2D_DESC srcDesc = {};
-    sourceTexture->GetDesc(&srcDesc);
-    if (srcDesc.Width == 0 || srcDesc.Height == 0) {
-        return false;
-    }
-
-    width = static_cast<int>(srcDesc.Width);
-    height = static_cast<int>(srcDesc.Height);
-
-    D3D11_TEXTURE2D_DESC stagingDesc = srcDesc;
-    stagingDesc.BindFlags = 0;
-    stagingDesc.MiscFlags = 0;
-    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-    stagingDesc.Usage = D3D11_USAGE_STAGING;
-
-    ID3D11Texture2D* stagingTexture = nullptr;
-    if (FAILED(m_device->CreateTexture2D(&stagingDesc, nullptr, &stagingTexture)) || !stagingTexture) {
-        return false;
-    }
-
-    m_deviceContext->CopyResource(stagingTexture, sourceTexture);
-
-    D3D11_MAPPED_SUBRESOURCE mapped = {};
-    HRESULT mapResult = m_deviceContext->Map(stagingTexture, 0, D3D11_MAP_READ, 0, &mapped);
-    if (FAILED(mapResult)) {
-        stagingTexture->Release();
+    const int targetWidth = std::clamp(settings.width, 16, kMaxBufferedExportSize);
+    const int targetHeight = std::clamp(settings.height, 16, kMaxBufferedExportSize);
+    const size_t rowBytes = static_cast<size_t>(targetWidth) * 4u;
+    pixels.resize(static_cast<size_t>(targetHeight) * rowBytes);
+    const bool rendered = renderPlotTilesOffscreen(
+        settings, targetWidth, targetHeight,
+        [&](std::vector<std::uint8_t>& band, int top, int rows) {
+            std::memcpy(pixels.data() + static_cast<size_t>(top) * rowBytes, band.data(),
+                        static_cast<size_t>(rows) * rowBytes);
+            return true;
+        });
+    if (!rendered) {
+        pixels.clear();
         return false;
     }
-
-    const size_t rowBytes = static_cast<size_t>(width) * 4u;
-    pixels.resize(static_cast<size_t>(height) * rowBytes);
-    for (int y = 0; y < height; ++y) {
-        const auto* src = static_cast<const std::uint8_t*>(mapped.pData) +
-            static_cast<size_t>(y) * mapped.RowPitch;
-        auto* dst = pixels.data() + static_cast<size_t>(y) * rowBytes;
-        std::memcpy(dst, src, rowBytes);
-    }
-
-    m_deviceContext->Unmap(stagingTexture, 0);
-    stagingTexture->Release();
+    width = targetWidth;
+    height = targetHeight;
     return true;
 }
 
-bool Application::renderPlotPixelsOffscreen(const Application::ExportDialogSettings& settings,
-                                            std::vector<std::uint8_t>& pixels,
-                                            int& width, int& height) {
-    width = 0;
-    height = 0;
-    pixels.clear();
-
+bool Application::renderPlotTilesOffscreen(
+    const Application::ExportDialogSettings& settings, int width, int height,
+    const std::function<bool(std::vector<std::uint8_t>& band, int top, int rows)>& writeBand) {
     if (!m_device || !m_deviceContext) {
         return false;
     }
 
-    const int targetWidth = std::clamp(settings.width, 16, 8192);
-    const int targetHeight = std::clamp(settings.height, 16, 8192);
-
+    // One render target of the tile size, reused for every tile, and its CPU-readable copy.
+    const ExportTiles layout(width, height);
     D3D11_TEXTURE2D_DESC texDesc = {};
-    texDesc.Width = static_cast<UINT>(targetWidth);
-    texDesc.Height = static_cast<UINT>(targetHeight);
+    texDesc.Width = static_cast<UINT>(layout.tileWidth());
+    texDesc.Height = static_cast<UINT>(layout.tileHeight());
     texDesc.MipLevels = 1;
     texDesc.ArraySize = 1;
     texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -1471,8 +1443,14 @@ bool Application::renderPlotPixelsOffscreen(const Application::ExportDialogSetti
     texDesc.Usage = D3D11_USAGE_DEFAULT;
     texDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
 
+    D3D11_TEXTURE2D_DESC stagingDesc = texDesc;
+    stagingDesc.BindFlags = 0;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+
     ID3D11Texture2D* renderTexture = nullptr;
     ID3D11RenderTargetView* exportRTV = nullptr;
+    ID3D11Texture2D* stagingTexture = nullptr;
     if (FAILED(m_device->CreateTexture2D(&texDesc, nullptr, &renderTexture)) || !renderTexture) {
         return false;
     }
@@ -1480,6 +1458,11 @@ bool Application::renderPlotPixelsOffscreen(const Application::ExportDialogSetti
         renderTexture->Release();
         return false;
     }
+    if (FAILED(m_device->CreateTexture2D(&stagingDesc, nullptr, &stagingTexture)) || !stagingTexture) {
+        exportRTV->Release();
+        renderTexture->Release();
+        return false;
+    }
 
     ID3D11RenderTargetView* previousRTV = nullptr;
     ID3D11DepthStencilView* previousDSV = nullptr;
@@ -1489,81 +1472,113 @@ bool Application::renderPlotPixelsOffscreen(const Application::ExportDialogSetti
     D3D11_VIEWPORT prevViewport = {};
     m_deviceContext->RSGetViewports(&prevViewportCount, &prevViewport);
 
-    D3D11_VIEWPORT exportViewport = {};
-    exportViewport.TopLeftX = 0.0f;
-    exportViewport.TopLeftY = 0.0f;
-    exportViewport.Width = static_cast<float>(targetWidth);
-    exportViewport.Height = static_cast<float>(targetHeight);
-    exportViewport.MinDepth = 0.0f;
-    exportViewport.MaxDepth = 1.0f;
-
-    m_deviceContext->OMSetRenderTargets(1, &exportRTV, nullptr);
-    m_deviceContext->RSSetViewports(1, &exportViewport);
-    const float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-    m_deviceContext->ClearRenderTargetView(exportRTV, clear);
-
-    ImGui_ImplDX11_NewFrame();
-    ImGui_ImplWin32_NewFrame();
     ImGuiIO& io = ImGui::GetIO();
     const ImVec2 prevDisplaySize = io.DisplaySize;
     const ImVec2 prevMousePos = io.MousePos;
     const float prevMouseWheel = io.MouseWheel;
     const float prevMouseWheelH = io.MouseWheelH;
-    io.DisplaySize = ImVec2(static_cast<float>(targetWidth), static_cast<float>(targetHeight));
-    io.MousePos = ImVec2(-100000.0f, -100000.0f);
-    io.MouseWheel = 0.0f;
-    io.MouseWheelH = 0.0f;
 
-    ImGui::NewFrame();
-    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
-    ImGui::SetNextWindowSize(ImVec2(static_cast<float>(targetWidth), static_cast<float>(targetHeight)));
-    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
-    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
-    ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
-    if (ImGui::Begin("##ExportPlotOffscreen", nullptr,
-                     ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
-                     ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
-                     ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoSavedSettings |
-                     ImGuiWindowFlags_NoInputs)) {
-        Core::ViewTransform exportView = m_viewTransform;
-        PlotSettings exportSettings = m_plotSettings;
-        exportSettings.autoRotate = false;
-
-        // Preserve the same visible world-domain as the interactive plot. Export/preview size
-        // should change resolution, not crop the graph.
-        const double worldW = m_viewTransform.worldXMax() - m_viewTransform.worldXMin();
-        const double worldH = m_viewTransform.worldYMax() - m_viewTransform.worldYMin();
-        if (worldW > 1e-12) {
-            exportView.scaleX = static_cast<double>(targetWidth) / worldW;
-        }
-        if (worldH > 1e-12) {
-            exportView.scaleY = static_cast<double>(targetHeight) / worldH;
-        }
+    Core::ViewTransform exportView = m_viewTransform;
+    PlotSettings exportSettings = m_plotSettings;
+    exportSettings.autoRotate = false;
 
-        PlotRenderOverrides exportOverrides;
-        exportOverrides.active = true;
-        exportOverrides.showGrid = settings.showGrid;
-        exportOverrides.showCoordinates = settings.showCoordinates;
-        exportOverrides.showWires = settings.showWires;
-        exportOverrides.showEnvelope = settings.showEnvelope;
-        exportOverrides.showAxisTriad = settings.showAxisTriad;
-        exportOverrides.backgroundColor = settings.backgroundColor;
+    // Preserve the same visible world-domain as the interactive plot. Export/preview size
+    // should change resolution, not crop the graph.
+    const double worldW = m_viewTransform.worldXMax() - m_viewTransform.worldXMin();
+    const double worldH = m_viewTransform.worldYMax() - m_viewTransform.worldYMin();
+    if (worldW > 1e-12) {
+        exportView.scaleX = static_cast<double>(width) / worldW;
+    }
+    if (worldH > 1e-12) {
+        exportView.scaleY = static_cast<double>(height) / worldH;
+    }
+
+    // Every tile renders the whole export's plot area, moved so the tile is in the window.
+    PlotRenderOverrides exportOverrides;
+    exportOverrides.active = true;
+    exportOverrides.showGrid = settings.showGrid;
+    exportOverrides.showCoordinates = settings.showCoordinates;
+    exportOverrides.showWires = settings.showWires;
+    exportOverrides.showEnvelope = settings.showEnvelope;
+    exportOverrides.showAxisTriad = settings.showAxisTriad;
+    exportOverrides.backgroundColor = settings.backgroundColor;
+    exportOverrides.plotWidth = static_cast<float>(width);
+    exportOverrides.plotHeight = static_cast<float>(height);
+
+    m_deviceContext->OMSetRenderTargets(1, &exportRTV, nullptr);
 
-        m_plotPanel.render(m_formulas, exportView, exportSettings, &exportOverrides);
+    std::vector<std::uint8_t> band;
+    const size_t rowBytes = static_cast<size_t>(width) * 4u;
+    bool ok = true;
+    for (int b = 0; ok && b < layout.bandCount(); ++b) {
+        const ExportTiles::Tile rows = layout.band(b);
+        band.resize(static_cast<size_t>(rows.height) * rowBytes);
+
+        for (const ExportTiles::Tile& tile : layout.tiles(b)) {
+            D3D11_VIEWPORT exportViewport = {};
+            exportViewport.TopLeftX = 0.0f;
+            exportViewport.TopLeftY = 0.0f;
+            exportViewport.Width = static_cast<float>(tile.width);
+            exportViewport.Height = static_cast<float>(tile.height);
+            exportViewport.MinDepth = 0.0f;
+            exportViewport.MaxDepth = 1.0f;
+            m_deviceContext->RSSetViewports(1, &exportViewport);
+            const float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            m_deviceContext->ClearRenderTargetView(exportRTV, clear);
+
+            ImGui_ImplDX11_NewFrame();
+            ImGui_ImplWin32_NewFrame();
+            io.DisplaySize = ImVec2(static_cast<float>(tile.width), static_cast<float>(tile.height));
+            io.MousePos = ImVec2(-100000.0f, -100000.0f);
+            io.MouseWheel = 0.0f;
+            io.MouseWheelH = 0.0f;
+
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+            ImGui::SetNextWindowSize(ImVec2(static_cast<float>(tile.width), static_cast<float>(tile.height)));
+            ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+            ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+            ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
+            if (ImGui::Begin("##ExportPlotOffscreen", nullptr,
+                             ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+                             ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse |
+                             ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoSavedSettings |
+                             ImGuiWindowFlags_NoInputs)) {
+                Core::ViewTransform tileView = exportView;
+                exportOverrides.plotLeft = -static_cast<float>(tile.x);
+                exportOverrides.plotTop = -static_cast<float>(tile.y);
+                m_plotPanel.render(m_formulas, tileView, exportSettings, &exportOverrides);
+            }
+            ImGui::End();
+            ImGui::PopStyleColor();
+            ImGui::PopStyleVar(2);
+            ImGui::Render();
+            ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+
+            // Read the tile back into its columns of the band.
+            m_deviceContext->CopyResource(stagingTexture, renderTexture);
+            D3D11_MAPPED_SUBRESOURCE mapped = {};
+            if (FAILED(m_deviceContext->Map(stagingTexture, 0, D3D11_MAP_READ, 0, &mapped))) {
+                ok = false;
+                break;
+            }
+            const size_t tileBytes = static_cast<size_t>(tile.width) * 4u;
+            for (int y = 0; y < tile.height; ++y) {
+                const auto* src = static_cast<const std::uint8_t*>(mapped.pData) +
+                    static_cast<size_t>(y) * mapped.RowPitch;
+                std::memcpy(band.data() + static_cast<size_t>(y) * rowBytes + static_cast<size_t>(tile.x) * 4u,
+                            src, tileBytes);
+            }
+            m_deviceContext->Unmap(stagingTexture, 0);
+        }
+        ok = ok && writeBand(band, rows.y, rows.height);
     }
-    ImGui::End();
-    ImGui::PopStyleColor();
-    ImGui::PopStyleVar(2);
-    ImGui::Render();
-    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 
     io.DisplaySize = prevDisplaySize;
     io.MousePos = prevMousePos;
     io.MouseWheel = prevMouseWheel;
     io.MouseWheelH = prevMouseWheelH;
 
-    const bool readOk = readTexturePixelsRgba(renderTexture, pixels, width, height);
-
     if (prevViewportCount > 0) {
         m_deviceContext->RSSetViewports(1, &prevViewport);
     }
@@ -1571,19 +1586,16 @@ bool Application::renderPlotPixelsOffscreen(const Application::ExportDialogSetti
 
     if (previousDSV) previousDSV->Release();
     if (previousRTV) previousRTV->Release();
-    if (exportRTV) exportRTV->Release();
-    if (renderTexture) renderTexture->Release();
-    return readOk;
+    stagingTexture->Release();
+    exportRTV->Release();
+    renderTexture->Release();
+    return ok;
 }
 
 bool Application::saveImageToPath(const std::wstring& path,
                                   const std::vector<std::uint8_t>& pixels,
                                   int width, int height, std::string& error) {
-    std::wstring extension = std::filesystem::path(path).extension().wstring();
-    std::transform(extension.begin(), extension.end(), extension.begin(),
-                   [](wchar_t ch) { return static_cast<wchar_t>(std::towlower(ch)); });
-
-    if (extension == L".bmp") {
+    if (isBmpPath(path)) {
         return saveBmpToPath(path, pixels, width, height, error);
     }
     return savePngToPath(path, pixels, width, height, error);
@@ -1592,68 +1604,18 @@ bool Application::saveImageToPath(const std::wstring& path,
 bool Application::savePngToPath(const std::wstring& path,
                                 const std::vector<std::uint8_t>& pixels,
                                 int width, int height, std::string& error) {
-    auto formatError = [](HRESULT hr) {
-        std::ostringstream oss;
-        oss << "WIC error 0x" << std::hex << std::uppercase << static_cast<unsigned long>(hr);
-        return oss.str();
-    };
-
-    IWICImagingFactory* factory = nullptr;
-    IWICStream* stream = nullptr;
-    IWICBitmapEncoder* encoder = nullptr;
-    IWICBitmapFrameEncode* frame = nullptr;
-    IPropertyBag2* properties = nullptr;
-
-    HRESULT hr = ::CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
-                                    IID_PPV_ARGS(&factory));
-    if (FAILED(hr)) {
-        error = formatError(hr);
+    std::ofstream out(std::filesystem::path(path), std::ios::binary);
+    if (!out) {
+        error = "Failed to open output file.";
         return false;
     }
-
-    hr = factory->CreateStream(&stream);
-    if (SUCCEEDED(hr)) {
-        hr = stream->InitializeFromFilename(path.c_str(), GENERIC_WRITE);
-    }
-    if (SUCCEEDED(hr)) {
-        hr = factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder);
-    }
-    if (SUCCEEDED(hr)) {
-        hr = encoder->Initialize(stream, WICBitmapEncoderNoCache);
-    }
-    if (SUCCEEDED(hr)) {
-        hr = encoder->CreateNewFrame(&frame, &properties);
-    }
-    if (SUCCEEDED(hr)) {
-        hr = frame->Initialize(properties);
-    }
-    if (SUCCEEDED(hr)) {
-        hr = frame->SetSize(static_cast<UINT>(width), static_cast<UINT>(height));
-    }
-    WICPixelFormatGUID pixelFormat = GUID_WICPixelFormat32bppBGRA;
-    if (SUCCEEDED(hr)) {
-        hr = frame->SetPixelFormat(&pixelFormat);
-    }
-    if (SUCCEEDED(hr)) {
-        hr = frame->WritePixels(static_cast<UINT>(height), static_cast<UINT>(width * 4),
-                                static_cast<UINT>(pixels.size()),
-                                const_cast<BYTE*>(pixels.data()));
-    }
-    if (SUCCEEDED(hr)) {
-        hr = frame->Commit();
-    }
-    if (SUCCEEDED(hr)) {
-        hr = encoder->Commit();
-    }
-
-    if (properties) properties->Release();
-    if (frame) frame->Release();
-    if (encoder) encoder->Release();
-    if (stream) stream->Release();
-    if (factory) factory->Release();
-
-    if (FAILED(hr)) {
-        error = formatError(hr);
+    Imaging::PngEncoder encoder(width, height, Imaging::ChannelOrder::Bgra, m_pendingExportSettings.pngLevel,
+                                [&out](const std::uint8_t* data, std::size_t size) {
+                                    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+                                    return out.good();
+                                });
+    if (!encoder.writeRows(pixels.data(), height) || !encoder.finish()) {
+        error = "Failed while writing PNG data.";
         return false;
     }
     return true;
@@ -1769,12 +1731,9 @@ bool Application::copyPixelsToClipboard(const std::vector<std::uint8_t>& pixels,
     return true;
 }
 
-void Application::processPendingExportActions() {
-    if (!m_pendingSavePlotImage && !m_pendingCopyPlotImage) {
-        return;
-    }
-
-    std::vector<std::string> messages;
+bool Application::renderExportImage(std::vector<std::uint8_t>& outputPixels,
+                                    int& outputWidth, int& outputHeight,
+                                    std::vector<std::string>& messages) {
     std::vector<std::uint8_t> capturedPixels;
     int capturedWidth = 0;
     int capturedHeight = 0;
@@ -1782,39 +1741,131 @@ void Application::processPendingExportActions() {
                                    capturedPixels, capturedWidth, capturedHeight)) {
         // Fallback to visible backbuffer capture if offscreen rendering fails unexpectedly.
         if (!capturePlotPixels(capturedPixels, capturedWidth, capturedHeight)) {
-            messages.emplace_back("Export failed: unable to render/capture plot area.");
-            m_pendingSavePlotImage = false;
-            m_pendingCopyPlotImage = false;
-            m_redrawRequested = true;
-            m_exportStatus = messages.front();
-            return;
+            return false;
         }
         messages.emplace_back("Warning: export used fallback screen capture path.");
     }
 
-    std::vector<std::uint8_t> outputPixels;
-    int outputWidth = 0;
-    int outputHeight = 0;
     applyExportPostProcessing(capturedPixels, capturedWidth, capturedHeight,
                               outputPixels, outputWidth, outputHeight);
+    return true;
+}
+
+void Application::processPendingExportActions() {
+    if (!m_pendingSavePlotImage && !m_pendingCopyPlotImage) {
+        return;
+    }
+
+    std::vector<std::string> messages;
+    const int exportWidth = std::clamp(m_pendingExportSettings.width, 16, ExportTiles::kMaxSize);
+    const int exportHeight = std::clamp(m_pendingExportSettings.height, 16, ExportTiles::kMaxSize);
+    const bool fitsInMemory =
+        exportWidth <= kMaxBufferedExportSize && exportHeight <= kMaxBufferedExportSize;
+    const std::string tooLarge = "images above " + std::to_string(kMaxBufferedExportSize) +
+        " px can only be saved as PNG.";
 
     if (m_pendingSavePlotImage) {
         std::wstring path;
-        if (promptSaveImagePath(path)) {
+        if (!promptSaveImagePath(path)) {
+            messages.emplace_back("Save canceled.");
+        } else if (!isBmpPath(path)) {
+            // PNG: each band of tiles is converted and encoded on a worker while the next band
+            // renders here (the tiles need the device context), so the export holds at most two
+            // bands and takes about as long as the slower of the two. The renderer's band buffer
+            // is swapped with the one the worker has finished. The file is created with the
+            // first band.
+            std::ofstream out;
             std::string error;
-            if (saveImageToPath(path, outputPixels, outputWidth, outputHeight, error)) {
+            bool opened = false;
+            Imaging::PngEncoder encoder(exportWidth, exportHeight, Imaging::ChannelOrder::Rgba,
+                                        m_pendingExportSettings.pngLevel,
+                                        [&out](const std::uint8_t* data, std::size_t size) {
+                                            out.write(reinterpret_cast<const char*>(data),
+                                                      static_cast<std::streamsize>(size));
+                                            return out.good();
+                                        });
+            std::vector<std::uint8_t> encodingBand;
+            // Declared after everything it uses, so an early exit joins it first.
+            Core::BackgroundTask<bool> encodeTask;
+            bool encoding = false;
+            bool encoded = true;
+            auto waitForBand = [&]() {
+                if (encoding) {
+                    encoding = false;
+                    encoded = encodeTask.take() != nullptr;
+                }
+                return encoded;
+            };
+            const bool rendered = renderPlotTilesOffscreen(
+                m_pendingExportSettings, exportWidth, exportHeight,
+                [&](std::vector<std::uint8_t>& band, int, int rows) {
+                    if (!opened) {
+                        out.open(std::filesystem::path(path), std::ios::binary);
+                        if (!(opened = out.is_open())) {
+                            error = "Failed to open output file.";
+                            return false;
+                        }
+                    }
+                    if (!waitForBand()) {
+                        return false;
+                    }
+                    std::swap(band, encodingBand);
+                    encoding = true;
+                    encodeTask.start([this, &encoder, &encodingBand, exportWidth, rows](const std::atomic<bool>*) {
+                        convertExportPixels(encodingBand.data(),
+                                            static_cast<std::size_t>(exportWidth) * rows,
+                                            Imaging::ChannelOrder::Rgba);
+                        return encoder.writeRows(encodingBand.data(), rows)
+                            ? std::make_shared<const bool>(true) : nullptr;
+                    });
+                    return true;
+                });
+            if (!waitForBand() || (rendered && !encoder.finish())) {
+                error = "Failed while writing PNG data.";
+            }
+            std::vector<std::uint8_t> outputPixels;
+            int outputWidth = 0;
+            int outputHeight = 0;
+            if (rendered && error.empty()) {
                 messages.emplace_back("Saved plot image to: " + narrowUtf8(path));
+            } else if (!opened && error.empty() && fitsInMemory &&
+                       renderExportImage(outputPixels, outputWidth, outputHeight, messages)) {
+                if (savePngToPath(path, outputPixels, outputWidth, outputHeight, error)) {
+                    messages.emplace_back("Saved plot image to: " + narrowUtf8(path));
+                } else {
+                    messages.emplace_back("Save failed: " + error);
+                }
             } else {
-                messages.emplace_back("Save failed: " + error);
+                messages.emplace_back("Save failed: " +
+                                      (error.empty() ? std::string("unable to render/capture plot area.") : error));
             }
+        } else if (!fitsInMemory) {
+            messages.emplace_back("Save failed: " + tooLarge);
         } else {
-            messages.emplace_back("Save canceled.");
+            std::vector<std::uint8_t> outputPixels;
+            int outputWidth = 0;
+            int outputHeight = 0;
+            std::string error;
+            if (!renderExportImage(outputPixels, outputWidth, outputHeight, messages)) {
+                messages.emplace_back("Export failed: unable to render/capture plot area.");
+            } else if (saveBmpToPath(path, outputPixels, outputWidth, outputHeight, error)) {
+                messages.emplace_back("Saved plot image to: " + narrowUtf8(path));
+            } else {
+                messages.emplace_back("Save failed: " + error);
+            }
         }
     }
 
     if (m_pendingCopyPlotImage) {
+        std::vector<std::uint8_t> outputPixels;
+        int outputWidth = 0;
+        int outputHeight = 0;
         std::string error;
-        if (copyPixelsToClipboard(outputPixels, outputWidth, outputHeight, error)) {
+        if (!fitsInMemory) {
+            messages.emplace_back("Clipboard copy failed: " + tooLarge);
+        } else if (!renderExportImage(outputPixels, outputWidth, outputHeight, messages)) {
+            messages.emplace_back("Export failed: unable to render/capture plot area.");
+        } else if (copyPixelsToClipboard(outputPixels, outputWidth, outputHeight, error)) {
             messages.emplace_back("Copied plot image to clipboard.");
         } else {
             messages.emplace_back("Clipboard copy failed: " + error);
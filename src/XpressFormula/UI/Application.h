@@ -8,12 +8,16 @@
 #include "ControlPanel.h"
 #include "PlotPanel.h"
 #include "PlotSettings.h"
+#include "InteractionRecording.h"
 #include "../Core/ViewTransform.h"
+#include "../Imaging/PngEncoder.h"
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <d3d11.h>
 #include <array>
+#include <functional>
 #include <future>
 #include <string>
 #include <vector>
@@ -38,6 +42,7 @@ public:
         bool showEnvelope = true;
         bool showAxisTriad = true;
         std::array<float, 4> backgroundColor = { 0.098f, 0.098f, 0.118f, 1.0f };
+        Imaging::PngLevel pngLevel = Imaging::PngLevel::Fast;
     };
 
     struct UpdateCheckResult {
@@ -78,9 +83,12 @@ private:
     bool capturePlotPixels(std::vector<std::uint8_t>& pixels, int& width, int& height);
     bool renderPlotPixelsOffscreen(const ExportDialogSettings& settings,
                                    std::vector<std::uint8_t>& pixels, int& width, int& height);
-    bool readTexturePixelsRgba(ID3D11Texture2D* sourceTexture,
-                               std::vector<std::uint8_t>& pixels,
-                               int& width, int& height);
+    /// Render the plot at width x height in tiles (see ExportTiles), handing each finished band
+    /// of full-width RGBA rows to `writeBand` before rendering the next. Stops when it returns
+    /// false. `writeBand` may swap the buffer for another; it is resized for every band.
+    bool renderPlotTilesOffscreen(
+        const ExportDialogSettings& settings, int width, int height,
+        const std::function<bool(std::vector<std::uint8_t>& band, int top, int rows)>& writeBand);
     void renderExportDialog(float sidebarWidth, float viewportHeight);
     void initialiseExportDialogSize();
     void cleanupExportPreviewResources();
@@ -89,14 +97,12 @@ private:
                                    int sourceWidth, int sourceHeight,
                                    std::vector<std::uint8_t>& outputPixels,
                                    int& outputWidth, int& outputHeight);
-    static void resizePixelsBilinear(const std::vector<std::uint8_t>& srcPixels,
-                                     int srcWidth, int srcHeight,
-                                     int dstWidth, int dstHeight,
-                                     std::vector<std::uint8_t>& dstPixels);
-    static void convertPixelsRgbaToBgra(std::vector<std::uint8_t>& pixels);
-    static void unpremultiplyPixels(std::vector<std::uint8_t>& pixels);
-    static void convertPixelsToGrayscale(std::vector<std::uint8_t>& pixels);
-    static void convertPixelsToGrayscaleRgba(std::vector<std::uint8_t>& pixels);
+    /// RGBA readback to straight alpha in `order` (BGRA for BMP and the clipboard, RGBA for
+    /// PNG), grayscale if requested.
+    void convertExportPixels(std::uint8_t* pixels, std::size_t pixelCount, Imaging::ChannelOrder order) const;
+    /// Render the export into memory (falling back to a screen capture) and post-process it.
+    bool renderExportImage(std::vector<std::uint8_t>& outputPixels, int& outputWidth,
+                           int& outputHeight, std::vector<std::string>& messages);
     bool saveImageToPath(const std::wstring& path,
                          const std::vector<std::uint8_t>& pixels,
                          int width, int height, std::string& error);
@@ -109,6 +115,8 @@ private:
     bool copyPixelsToClipboard(const std::vector<std::uint8_t>& pixels,
                                int width, int height, std::string& error);
     void processPendingExportActions();
+    void toggleInteractionRecording();
+    void recordInteractionFrame();
     static std::string narrowUtf8(const std::wstring& text);
 
     HWND                      m_hWnd               = nullptr;
@@ -152,6 +160,9 @@ private:
     std::string               m_updateLatestTag;
     std::string               m_updateReleaseUrl = "https://github.com/russlank/XpressFormula/releases";
     std::string               m_updateStatus;
+    InteractionRecorder       m_interactionRecorder;
+    std::chrono::steady_clock::time_point m_recordingStartTime;
+    std::string               m_recordingStatus;
 
     // UI panels
     FormulaPanel  m_formulaPanel;
@@ -159,6 +170,9 @@ private:
     PlotPanel     m_plotPanel;
 
     static constexpr float kSidebarWidth = 380.0f;
+    // Largest side rendered into memory as a whole: previews, the clipboard and BMP files.
+    // Larger exports are streamed to PNG in tiles.
+    static constexpr int kMaxBufferedExportSize = 8192;
 };
 
 } // namespace XpressFormula::UI
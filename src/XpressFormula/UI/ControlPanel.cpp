@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 // ControlPanel.cpp - Sidebar view/render/export controls implementation.
 #include "ControlPanel.h"
+#include "../Plotting/PlotRenderer.h"
 #include "imgui.h"
 #include <algorithm>
 #include <cmath>
@@ -78,7 +79,12 @@ ControlPanelActions ControlPanel::render(Core::ViewTransform& vt, PlotSettings&
     ImGui::Separator();
     ImGui::TextUnformatted("Performance");
     ImGui::Checkbox("Optimize Rendering", &settings.optimizeRendering);
-    ImGui::TextWrapped("When enabled, the app stops redrawing while idle and temporarily lowers 3D quality while dragging/zooming to keep interaction responsive.");
+    ImGui::BeginDisabled(!settings.optimizeRendering);
+    ImGui::SliderFloat("Frame Budget", &settings.frameBudgetMs, 4.0f, 50.0f, "%.0f ms");
+    ImGui::EndDisabled();
+    ImGui::TextWrapped("When enabled, the app stops redrawing while idle and, while dragging/zooming/rotating, lowers each 3D formula's quality just enough to stay within the frame budget.");
+    ImGui::Checkbox("Parallel Formula Rendering", &settings.parallelFormulas);
+    ImGui::Checkbox("Cache Cross-Section Volumes", &settings.cacheCrossSectionVolumes);
 
     ImGui::Spacing();
     ImGui::Separator();
@@ -95,6 +101,8 @@ ControlPanelActions ControlPanel::render(Core::ViewTransform& vt, PlotSettings&
     if (ImGui::RadioButton("Force 2D Heatmap / Cross-Section", renderPreference == static_cast<int>(XYRenderModePreference::Force2D))) {
         settings.xyRenderModePreference = XYRenderModePreference::Force2D;
     }
+    ImGui::Checkbox("Volume Render f(x,y,z) in 3D", &settings.volumeRendering);
+    ImGui::Checkbox("Ray Trace Implicit Surfaces (F=0) in 3D", &settings.traceImplicitSurfaces);
 
     const XYRenderMode effectiveRenderMode =
         settings.resolveXYRenderMode(has2DFormula, hasSurfaceFormula);
@@ -164,7 +172,13 @@ ControlPanelActions ControlPanel::render(Core::ViewTransform& vt, PlotSettings&
         ImGui::SliderFloat("Z Scale", &settings.zScale, 0.1f, 8.0f, "%.2f");
         ImGui::SliderInt("Surface Density (z=f(x,y))", &settings.surfaceResolution, 12, 96);
         ImGui::SliderInt("Implicit Surface Quality (F=0)", &settings.implicitSurfaceResolution, 16, 96);
+        ImGui::Checkbox("Sharp Implicit Edges (dual contouring)", &settings.implicitSharpFeatures);
         ImGui::SliderFloat("Surface Opacity", &settings.surfaceOpacity, 0.25f, 1.0f, "%.2f");
+        if (settings.volumeRendering) {
+            ImGui::SliderFloat("Volume Threshold", &settings.volumeThreshold, 0.0f, 0.99f, "%.2f");
+            ImGui::SliderFloat("Volume Density", &settings.volumeDensity, 0.25f, 32.0f, "%.2f",
+                               ImGuiSliderFlags_Logarithmic);
+        }
 
         if (hasSurfaceFormula) {
             ImGui::TextWrapped("Tip: Drag in the plot to pan X/Y domain and use wheel to zoom.");
@@ -173,6 +187,10 @@ ControlPanelActions ControlPanel::render(Core::ViewTransform& vt, PlotSettings&
         }
     } else {
         ImGui::SliderFloat("Heatmap Opacity", &settings.heatmapOpacity, 0.1f, 1.0f, "%.2f");
+        ImGui::SliderInt("Contour Lines", &settings.heatmapContourLevels, 0,
+                         Plotting::PlotRenderer::kMaxContourLevels);
+        ImGui::Checkbox("Mark Roots / Extrema / Intersections", &settings.showCurveFeatures);
+        ImGui::Checkbox("Log Density Scale (scatter:)", &settings.scatterLogScale);
     }
 
     ImGui::Spacing();
@@ -0,0 +1,38 @@
+// ExportTiles.cpp - Tile and band layout of plot exports larger than one render target.
+#include "ExportTiles.h"
+#include <algorithm>
+
+namespace XpressFormula::UI {
+
+ExportTiles::ExportTiles(int width, int height, int tileWidth, int tileHeight)
+    : m_width(std::max(1, width)),
+      m_height(std::max(1, height)),
+      m_tileWidth(std::clamp(tileWidth, 1, m_width)),
+      m_tileHeight(std::clamp(tileHeight, 1, m_height)) {}
+
+int ExportTiles::bandCount() const {
+    return (m_height + m_tileHeight - 1) / m_tileHeight;
+}
+
+ExportTiles::Tile ExportTiles::band(int index) const {
+    Tile rows;
+    rows.y = index * m_tileHeight;
+    rows.width = m_width;
+    rows.height = std::min(m_tileHeight, m_height - rows.y);
+    return rows;
+}
+
+std::vector<ExportTiles::Tile> ExportTiles::tiles(int index) const {
+    const Tile rows = band(index);
+    std::vector<Tile> result;
+    result.reserve(static_cast<size_t>((m_width + m_tileWidth - 1) / m_tileWidth));
+    for (int x = 0; x < m_width; x += m_tileWidth) {
+        Tile tile = rows;
+        tile.x = x;
+        tile.width = std::min(m_tileWidth, m_width - x);
+        result.push_back(tile);
+    }
+    return result;
+}
+
+} // namespace XpressFormula::UI
@@ -0,0 +1,51 @@
+// ExportTiles.h - Tile and band layout of plot exports larger than one render target.
+#pragma once
+
+#include <vector>
+
+namespace XpressFormula::UI {
+
+/// Cuts an export into bands of full-width rows, and each band into a row of tiles. The tiles
+/// are rendered one after another into a single render target of the tile size, assembled
+/// into their band, and the band is handed to the PNG encoder, which encodes it while the next
+/// one renders. An export of any size therefore holds one tile on the GPU and two bands in
+/// memory: one being encoded, one being rendered.
+class ExportTiles {
+public:
+    /// Largest exported side. A 65536-wide band of kTileHeight rows is 256 MB, so the two bands
+    /// of a PNG export take 512 MB.
+    static constexpr int kMaxSize = 65536;
+    /// Tiles are wide and short: fewer render passes per band, and smaller bands.
+    static constexpr int kTileWidth = 4096;
+    static constexpr int kTileHeight = 1024;
+
+    struct Tile {
+        int x = 0;  // left column and top row in the whole image
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    ExportTiles(int width, int height, int tileWidth = kTileWidth, int tileHeight = kTileHeight);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    /// Size of the render target every tile fits in.
+    int tileWidth() const { return m_tileWidth; }
+    int tileHeight() const { return m_tileHeight; }
+
+    int bandCount() const;
+    /// Rows of band `index`, spanning the full width.
+    Tile band(int index) const;
+    /// Tiles of band `index`, left to right. The last column and the last band are narrower or
+    /// shorter when the size is not a multiple of the tile size.
+    std::vector<Tile> tiles(int index) const;
+
+private:
+    int m_width;
+    int m_height;
+    int m_tileWidth;
+    int m_tileHeight;
+};
+
+} // namespace XpressFormula::UI
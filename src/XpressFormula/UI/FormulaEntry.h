@@ -2,7 +2,12 @@
 #pragma once
 
 #include "../Core/ASTNode.h"
+#include "../Core/EquationSolver.h"
 #include "../Core/Parser.h"
+#include "../Plotting/DataSeries.h"
+#include "../Plotting/ScatterDensity.h"
+#include "../Plotting/StreamSeries.h"
+#include <memory>
 #include <string>
 #include <set>
 #include <cstring>
@@ -17,6 +22,9 @@ enum class FormulaRenderKind {
     Surface3D,
     Implicit2D,
     ScalarField3D,
+    DataSeries2D,
+    Scatter2D,
+    Stream2D,
     Invalid
 };
 
@@ -123,6 +131,20 @@ inline std::string unsupportedVariablesError(const std::set<std::string>& vars)
 
 } // namespace Detail
 
+/// Entries whose text starts with this prefix overlay a measured series loaded from the file
+/// named after it ("data: samples.csv") instead of a formula.
+inline constexpr const char* kDataSeriesPrefix = "data:";
+/// Entries whose text starts with this prefix overlay the density of a binary point cloud
+/// ("scatter: points.bin") instead of a formula.
+inline constexpr const char* kScatterPrefix = "scatter:";
+/// Entries whose text starts with this prefix plot a live series read from the pipe or socket
+/// named after it ("stream: unix:/tmp/telemetry.sock") instead of a formula.
+inline constexpr const char* kStreamPrefix = "stream:";
+
+/// Range of the per-formula z slider (cross-section slice / implicit sampling centre).
+inline constexpr float kZSliceMin = -10.0f;
+inline constexpr float kZSliceMax = 10.0f;
+
 /// Holds everything about one formula: the user's text, the parsed AST,
 /// detected variable count, display colour, and visibility state.
 struct FormulaEntry {
@@ -138,6 +160,21 @@ struct FormulaEntry {
     int                     variableCount = 0; // 1=curve, 2=xy surface/implicit, 3=xyz field
     bool                    isEquation = false;
     FormulaRenderKind       renderKind = FormulaRenderKind::Invalid;
+    // Implicit equations solved for y (F(x,y)=0) or z (F(x,y,z)=0) when F is linear or
+    // quadratic in it; the plot then draws the explicit branches instead of the implicit field.
+    Core::EquationSolver::Solution solution;
+    // Series loaded for a "data:" entry (DataSeries2D), and its load while still in flight.
+    std::shared_ptr<const Plotting::DataSeries> data;
+    std::shared_ptr<const Plotting::DataSeriesLoader::Load> dataLoad;
+    // Point cloud loaded for a "scatter:" entry (Scatter2D), and its load while still in flight.
+    std::shared_ptr<const Plotting::ScatterDensity> scatter;
+    std::shared_ptr<const Plotting::ScatterDensityLoader::Load> scatterLoad;
+    // Live series read for a "stream:" entry (Stream2D); polled by the plot every frame.
+    std::shared_ptr<Plotting::StreamSeries> stream;
+    // False for previews: a "stream:" entry keeps the series it already holds for the same
+    // source but never opens one, so it cannot take lines from the plotted reader, and a
+    // "scatter:" entry does not read its points file.
+    bool openSources = true;
 
     // Display settings
     float color[4]  = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -149,6 +186,13 @@ struct FormulaEntry {
         std::string text = Detail::trim(std::string(inputBuffer));
         if (text == lastParsedText) return;
         lastParsedText = text;
+        solution = {};
+        data = nullptr;
+        dataLoad = nullptr;
+        scatter = nullptr;
+        scatterLoad = nullptr;
+        std::shared_ptr<Plotting::StreamSeries> previousStream = std::move(stream);
+        stream = nullptr;
 
         if (text.empty()) {
             ast = nullptr;
@@ -162,6 +206,46 @@ struct FormulaEntry {
             return;
         }
 
+        const bool isData = text.rfind(kDataSeriesPrefix, 0) == 0;
+        const bool isStream = text.rfind(kStreamPrefix, 0) == 0;
+        const bool isScatter = text.rfind(kScatterPrefix, 0) == 0;
+        if (isData || isStream || isScatter) {
+            const char* prefix = isData ? kDataSeriesPrefix : isStream ? kStreamPrefix : kScatterPrefix;
+            ast = nullptr;
+            leftAst = nullptr;
+            rightAst = nullptr;
+            variables.clear();
+            variableCount = 0;
+            isEquation = false;
+            error.clear();
+            std::string path = Detail::trim(text.substr(std::strlen(prefix)));
+            if (path.size() >= 2 && path.front() == '"' && path.back() == '"') {
+                path = path.substr(1, path.size() - 2);
+            }
+            if (path.empty()) {
+                error = std::string("Enter a file path after '") + prefix + "'.";
+            } else if (isData) {
+                dataLoad = Plotting::DataSeriesLoader::shared().request(path);
+            } else if (isStream && previousStream && previousStream->source() == path) {
+                stream = std::move(previousStream);  // same source: keep the reader and window
+            } else if (isStream) {
+                if (openSources) {
+                    stream = std::make_shared<Plotting::StreamSeries>();
+                    if (!stream->open(path, error)) {
+                        stream = nullptr;
+                    }
+                }
+            } else if (openSources) {
+                scatterLoad = Plotting::ScatterDensityLoader::shared().request(path);
+            }
+            renderKind = !error.empty() ? FormulaRenderKind::Invalid
+                       : isData ? FormulaRenderKind::DataSeries2D
+                       : isScatter ? FormulaRenderKind::Scatter2D
+                                   : FormulaRenderKind::Stream2D;
+            updateData();  // a kept load is done already
+            return;
+        }
+
         auto applyRenderKind = [this]() {
             const bool hasX = variables.count("x") > 0;
             const bool hasY = variables.count("y") > 0;
@@ -178,9 +262,21 @@ struct FormulaEntry {
                     ast = solvedForZLeft ? rightAst : leftAst;
                     return;
                 }
+                if (hasZ) {
+                    solution = Core::EquationSolver::solve(ast, "z");
+                    if (solution.degree == 1) {
+                        // Linear in z (2*z = sin(x), x^2 + y^2 + z - 1 = 0): same as z = f(x,y).
+                        renderKind = FormulaRenderKind::Surface3D;
+                        variableCount = 2;
+                        ast = solution.branches.front();
+                        solution = {};
+                        return;
+                    }
+                }
                 if (hasX && hasY && !hasZ) {
                     renderKind = FormulaRenderKind::Implicit2D;
                     variableCount = 2;
+                    solution = Core::EquationSolver::solve(ast, "y");
                     return;
                 }
                 if (hasX && hasY && hasZ) {
@@ -190,6 +286,7 @@ struct FormulaEntry {
                 }
                 renderKind = FormulaRenderKind::Invalid;
                 variableCount = 0;
+                solution = {};
                 error = "Equation rendering supports F(x,y)=0, z=f(x,y), or F(x,y,z)=0.";
                 ast = nullptr;
                 return;
@@ -309,10 +406,37 @@ struct FormulaEntry {
         applyRenderKind();
     }
 
-    bool isValid() const { return ast != nullptr && error.empty(); }
-    bool uses3DSurface() const {
+    /// True while the file of a "data:" or "scatter:" entry is still being read.
+    bool loading() const { return dataLoad || scatterLoad; }
+
+    /// Take in the "data:" series or "scatter:" points once their background load has
+    /// finished. Returns true when the entry changed.
+    bool updateData() {
+        return takeLoad(dataLoad, data) || takeLoad(scatterLoad, scatter);
+    }
+
+    // updateData() for one kind of load: move its result (or error) into the entry.
+    template <typename T>
+    bool takeLoad(std::shared_ptr<const typename Plotting::FileLoader<T>::Load>& load,
+                  std::shared_ptr<const T>& value) {
+        if (!load || !load->done.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = load->value;
+        error = load->error;
+        load = nullptr;
+        if (!value) {
+            renderKind = FormulaRenderKind::Invalid;
+        }
+        return true;
+    }
+
+    bool isValid() const { return (ast || data || scatter || stream) && error.empty(); }
+    /// True when the formula draws in 3D mode. Scalar fields f(x,y,z) count only when they are
+    /// rendered as volumes; otherwise they are 2D cross-sections.
+    bool uses3DSurface(bool volumeRendering = false) const {
         return renderKind == FormulaRenderKind::Surface3D ||
-               (renderKind == FormulaRenderKind::ScalarField3D && isEquation);
+               (renderKind == FormulaRenderKind::ScalarField3D && (isEquation || volumeRendering));
     }
 
     const char* typeLabel() const {
@@ -321,6 +445,9 @@ struct FormulaEntry {
             case FormulaRenderKind::Surface3D:    return "z = f(x,y)";
             case FormulaRenderKind::Implicit2D:   return "F(x,y) = 0";
             case FormulaRenderKind::ScalarField3D:return isEquation ? "F(x,y,z) = 0" : "f(x,y,z)";
+            case FormulaRenderKind::DataSeries2D: return "data y(x)";
+            case FormulaRenderKind::Scatter2D:    return "density (x,y)";
+            case FormulaRenderKind::Stream2D:     return "stream y(x)";
             default:                              return "invalid";
         }
     }
@@ -150,9 +150,12 @@ void FormulaPanel::renderEditorDialog(std::vector<FormulaEntry>& formulas) {
         if (currentEditorText != m_editorPreviousText) {
             m_editorPreviousText = currentEditorText;
             m_editorPreview = FormulaEntry{};
+            m_editorPreview.openSources = false;
+            m_editorPreview.stream = formula.stream;  // kept when the source is unchanged
             strncpy_s(m_editorPreview.inputBuffer, sizeof(m_editorPreview.inputBuffer), m_editorBuffer, _TRUNCATE);
             m_editorPreview.parse();
         }
+        m_editorPreview.updateData();
         const FormulaEntry& editorPreview = m_editorPreview;
 
         ImGui::TextDisabled("Editor buffer: %zu / %zu", editorLength, sizeof(m_editorBuffer) - 1);
@@ -168,6 +171,16 @@ void FormulaPanel::renderEditorDialog(std::vector<FormulaEntry>& formulas) {
         ImGui::TextUnformatted("Live validation");
         if (editorPreview.lastParsedText.empty()) {
             ImGui::TextDisabled("Start typing to validate the formula syntax and detected plot type.");
+        } else if (editorPreview.dataLoad) {
+            ImGui::TextDisabled("Loading the data series...");
+        } else if (editorPreview.renderKind == FormulaRenderKind::Stream2D && !editorPreview.stream) {
+            ImGui::TextColored(ImVec4(0.35f, 0.9f, 0.45f, 1.0f),
+                               "Valid (%s)", editorPreview.typeLabel());
+            ImGui::TextDisabled("The source is opened when the formula is applied.");
+        } else if (editorPreview.renderKind == FormulaRenderKind::Scatter2D && !editorPreview.scatter) {
+            ImGui::TextColored(ImVec4(0.35f, 0.9f, 0.45f, 1.0f),
+                               "Valid (%s)", editorPreview.typeLabel());
+            ImGui::TextDisabled("The points file is read when the formula is applied.");
         } else if (editorPreview.isValid()) {
             ImGui::TextColored(ImVec4(0.35f, 0.9f, 0.45f, 1.0f),
                                "Valid (%s)", editorPreview.typeLabel());
@@ -248,9 +261,71 @@ void FormulaPanel::renderEditorDialog(std::vector<FormulaEntry>& formulas) {
     if (!ImGui::IsPopupOpen(kFormulaEditorPopupId)) {
         m_editorFormulaIndex = -1;
         m_focusEditorInput = false;
+        // Let go of what the preview shares with its row (a live series) once the dialog closes.
+        if (!m_editorPreviousText.empty()) {
+            m_editorPreview = FormulaEntry{};
+            m_editorPreviousText.clear();
+        }
     }
 }
 
+bool FormulaPanel::renderRow(FormulaEntry& f, int index) {
+    bool remove = false;
+    ImGui::PushID(index);
+
+    // Visibility toggle
+    ImGui::Checkbox("##vis", &f.visible);
+    ImGui::SameLine();
+
+    // Color picker
+    ImGui::ColorEdit4("##col", f.color,
+                      ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel);
+    ImGui::SameLine();
+
+    // Input field
+    ImGui::SetNextItemWidth(std::max(120.0f, ImGui::GetContentRegionAvail().x - 150.0f));
+    if (ImGui::InputText("##expr", f.inputBuffer, sizeof(f.inputBuffer))) {
+        f.parse();
+    }
+    ImGui::SameLine();
+
+    if (ImGui::SmallButton("Edit")) {
+        openEditor(f, index);
+    }
+    ImGui::SameLine();
+
+    // Type label
+    ImGui::TextUnformatted(f.typeLabel());
+    ImGui::SameLine();
+
+    // Delete button
+    if (ImGui::SmallButton("X")) {
+        remove = true;
+    }
+
+    // Error message
+    if (!f.error.empty()) {
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0.3f, 0.3f, 1));
+        ImGui::TextWrapped("  Error: %s", f.error.c_str());
+        ImGui::PopStyleColor();
+    } else if (f.loading()) {
+        ImGui::TextDisabled("  Loading...");
+    }
+
+    // Z-slice slider for scalar fields that include z.
+    if (f.renderKind == FormulaRenderKind::ScalarField3D && f.isValid()) {
+        ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+        if (f.isEquation) {
+            ImGui::SliderFloat("z slice / center", &f.zSlice, kZSliceMin, kZSliceMax, "z = %.2f");
+        } else {
+            ImGui::SliderFloat("z slice", &f.zSlice, kZSliceMin, kZSliceMax, "z = %.2f");
+        }
+    }
+
+    ImGui::PopID();
+    return remove;
+}
+
 void FormulaPanel::render(std::vector<FormulaEntry>& formulas) {
     ImGui::TextUnformatted("Formulas");
     ImGui::Separator();
@@ -275,60 +350,33 @@ void FormulaPanel::render(std::vector<FormulaEntry>& formulas) {
     ImGui::TextWrapped("Enter expressions like y=f(x), z=f(x,y), or equations like x^2+y^2=100.");
 
     // --- Formula list ---
+    // Sessions can hold hundreds of formulas, so a long list scrolls in its own region (at most
+    // half the sidebar, leaving the controls below in reach) and only the rows in view are
+    // submitted; the rest are stood in for by spacers of their last measured height.
+    const ImGuiStyle& style = ImGui::GetStyle();
     int removeIndex = -1;
-    for (int i = 0; i < static_cast<int>(formulas.size()); ++i) {
-        ImGui::PushID(i);
-        FormulaEntry& f = formulas[i];
-
-        // Visibility toggle
-        ImGui::Checkbox("##vis", &f.visible);
-        ImGui::SameLine();
-
-        // Color picker
-        ImGui::ColorEdit4("##col", f.color,
-                          ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel);
-        ImGui::SameLine();
-
-        // Input field
-        ImGui::SetNextItemWidth(std::max(120.0f, ImGui::GetContentRegionAvail().x - 150.0f));
-        if (ImGui::InputText("##expr", f.inputBuffer, sizeof(f.inputBuffer))) {
-            f.parse();
+    m_rows.resize(formulas.size());
+    m_rows.setDefaultHeight(ImGui::GetFrameHeightWithSpacing());
+    const float listHeight = std::max(1.0f, std::min(m_rows.totalHeight(),
+        std::max(ImGui::GetFrameHeightWithSpacing() * 4.0f, ImGui::GetWindowHeight() * 0.5f)));
+    if (ImGui::BeginChild("##FormulaList", ImVec2(0.0f, listHeight), false)) {
+        const VirtualList::Range range = m_rows.visibleRange(ImGui::GetScrollY(), ImGui::GetWindowHeight());
+        // Dummy adds item spacing after itself, which the measured heights already include.
+        if (range.before > 0.0f) {
+            ImGui::Dummy(ImVec2(0.0f, std::max(0.0f, range.before - style.ItemSpacing.y)));
         }
-        ImGui::SameLine();
-
-        if (ImGui::SmallButton("Edit")) {
-            openEditor(f, i);
-        }
-        ImGui::SameLine();
-
-        // Type label
-        ImGui::TextUnformatted(f.typeLabel());
-        ImGui::SameLine();
-
-        // Delete button
-        if (ImGui::SmallButton("X")) {
-            removeIndex = i;
-        }
-
-        // Error message
-        if (!f.error.empty()) {
-            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0.3f, 0.3f, 1));
-            ImGui::TextWrapped("  Error: %s", f.error.c_str());
-            ImGui::PopStyleColor();
-        }
-
-        // Z-slice slider for scalar fields that include z.
-        if (f.renderKind == FormulaRenderKind::ScalarField3D && f.isValid()) {
-            ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
-            if (f.isEquation) {
-                ImGui::SliderFloat("z slice / center", &f.zSlice, -10.0f, 10.0f, "z = %.2f");
-            } else {
-                ImGui::SliderFloat("z slice", &f.zSlice, -10.0f, 10.0f, "z = %.2f");
+        for (size_t i = range.first; i < range.last; ++i) {
+            const float top = ImGui::GetCursorPosY();
+            if (renderRow(formulas[i], static_cast<int>(i))) {
+                removeIndex = static_cast<int>(i);
             }
+            m_rows.setHeight(i, ImGui::GetCursorPosY() - top);
+        }
+        if (range.after > 0.0f) {
+            ImGui::Dummy(ImVec2(0.0f, std::max(0.0f, range.after - style.ItemSpacing.y)));
         }
-
-        ImGui::PopID();
     }
+    ImGui::EndChild();
 
     if (removeIndex >= 0) {
         if (m_editorFormulaIndex == removeIndex) {
@@ -337,6 +385,7 @@ void FormulaPanel::render(std::vector<FormulaEntry>& formulas) {
             --m_editorFormulaIndex;
         }
         formulas.erase(formulas.begin() + removeIndex);
+        m_rows.erase(static_cast<size_t>(removeIndex));
     }
 
     ImGui::Separator();
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "FormulaEntry.h"
+#include "VirtualList.h"
 #include <string>
 #include <vector>
 
@@ -17,6 +18,11 @@ public:
 private:
     void openEditor(const FormulaEntry& formula, int formulaIndex);
     void renderEditorDialog(std::vector<FormulaEntry>& formulas);
+    /// One formula row. Returns true when its delete button was pressed.
+    bool renderRow(FormulaEntry& f, int index);
+
+    // Scrolled formula list: only rows in view are submitted.
+    VirtualList m_rows;
 
     int m_nextColorIndex = 0;
     bool m_openEditorPopupNextFrame = false;
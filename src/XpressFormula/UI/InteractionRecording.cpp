@@ -0,0 +1,355 @@
+// InteractionRecording.cpp - Text serialization for interaction recordings.
+//
+// Script format (one record per line, '#' starts a comment):
+//   xfrec 1
+//   view <centerX> <centerY> <scaleX> <scaleY>
+//   setting <name> <value>                                  (applies to the next frame)
+//   formulas <count>                                        (applies to the next frame)
+//   formula <index> <visible> <r> <g> <b> <a> <zSlice> <text...>
+//   frame <t> <dt> <plotW> <plotH> <mouseX> <mouseY> <buttons> <wheel> <mods>
+// buttons: bit0 = left, bit1 = right. mods: bit0 = Ctrl, bit1 = Shift.
+#include "InteractionRecording.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace XpressFormula::UI {
+
+namespace {
+
+constexpr int kScriptVersion = 1;
+// Most formulas a script may declare or address; bounds the list a replay allocates.
+constexpr int kMaxFormulas = 4096;
+
+struct SettingField {
+    const char* name;
+    double (*get)(const PlotSettings&);
+    void (*set)(PlotSettings&, double);
+};
+
+#define XF_SETTING_BOOL(field) \
+    { #field, [](const PlotSettings& s) { return s.field ? 1.0 : 0.0; }, \
+              [](PlotSettings& s, double v) { s.field = (v != 0.0); } }
+#define XF_SETTING_FLOAT(field) \
+    { #field, [](const PlotSettings& s) { return static_cast<double>(s.field); }, \
+              [](PlotSettings& s, double v) { s.field = static_cast<float>(v); } }
+#define XF_SETTING_INT(field) \
+    { #field, [](const PlotSettings& s) { return static_cast<double>(s.field); }, \
+              [](PlotSettings& s, double v) { s.field = static_cast<int>(v); } }
+
+const SettingField kSettingFields[] = {
+    { "xyRenderModePreference",
+      [](const PlotSettings& s) { return static_cast<double>(static_cast<int>(s.xyRenderModePreference)); },
+      [](PlotSettings& s, double v) {
+          s.xyRenderModePreference = static_cast<XYRenderModePreference>(static_cast<int>(v));
+      } },
+    XF_SETTING_BOOL(optimizeRendering),
+    XF_SETTING_FLOAT(frameBudgetMs),
+    XF_SETTING_BOOL(parallelFormulas),
+    XF_SETTING_BOOL(cacheCrossSectionVolumes),
+    XF_SETTING_BOOL(showGrid),
+    XF_SETTING_BOOL(showCoordinates),
+    XF_SETTING_BOOL(showWires),
+    XF_SETTING_FLOAT(azimuthDeg),
+    XF_SETTING_FLOAT(elevationDeg),
+    XF_SETTING_FLOAT(zScale),
+    XF_SETTING_INT(surfaceResolution),
+    XF_SETTING_INT(implicitSurfaceResolution),
+    XF_SETTING_BOOL(implicitSharpFeatures),
+    XF_SETTING_FLOAT(surfaceOpacity),
+    XF_SETTING_FLOAT(wireThickness),
+    XF_SETTING_BOOL(showSurfaceEnvelope),
+    XF_SETTING_FLOAT(envelopeThickness),
+    XF_SETTING_BOOL(showAxisTriad),
+    XF_SETTING_BOOL(autoRotate),
+    XF_SETTING_FLOAT(autoRotateSpeedDegPerSec),
+    XF_SETTING_FLOAT(heatmapOpacity),
+    XF_SETTING_INT(heatmapContourLevels),
+    XF_SETTING_BOOL(showCurveFeatures),
+    XF_SETTING_BOOL(scatterLogScale),
+    XF_SETTING_BOOL(volumeRendering),
+    XF_SETTING_FLOAT(volumeThreshold),
+    XF_SETTING_FLOAT(volumeDensity),
+    XF_SETTING_BOOL(traceImplicitSurfaces),
+};
+
+#undef XF_SETTING_BOOL
+#undef XF_SETTING_FLOAT
+#undef XF_SETTING_INT
+
+InteractionFormulaState snapshotFormula(int index, const FormulaEntry& entry) {
+    InteractionFormulaState state;
+    state.index = index;
+    // Every edit re-parses, so the parsed text is the trimmed buffer without re-scanning it.
+    state.text = entry.lastParsedText;
+    state.visible = entry.visible;
+    for (int i = 0; i < 4; ++i) {
+        state.color[i] = entry.color[i];
+    }
+    state.zSlice = entry.zSlice;
+    return state;
+}
+
+bool sameFormulaState(const FormulaEntry& a, const InteractionFormulaState& b) {
+    return a.lastParsedText == b.text && a.visible == b.visible && a.zSlice == b.zSlice &&
+           a.color[0] == b.color[0] && a.color[1] == b.color[1] &&
+           a.color[2] == b.color[2] && a.color[3] == b.color[3];
+}
+
+} // namespace
+
+// ---- settings ----------------------------------------------------------------
+
+std::vector<std::pair<std::string, double>> InteractionRecorder::settingValues(
+    const PlotSettings& settings) {
+    std::vector<std::pair<std::string, double>> values;
+    values.reserve(sizeof(kSettingFields) / sizeof(kSettingFields[0]));
+    for (const SettingField& field : kSettingFields) {
+        values.emplace_back(field.name, field.get(settings));
+    }
+    return values;
+}
+
+bool InteractionRecorder::applySetting(PlotSettings& settings, const std::string& name, double value) {
+    for (const SettingField& field : kSettingFields) {
+        if (name == field.name) {
+            field.set(settings, value);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---- recorder ----------------------------------------------------------------
+
+void InteractionRecorder::start(const Core::ViewTransform& view,
+                                const std::vector<FormulaEntry>& formulas,
+                                const PlotSettings& settings) {
+    m_recording = true;
+    m_frameCount = 0;
+    m_text.clear();
+    m_lastFormulas.clear();
+    m_lastSettings.clear();
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "# XpressFormula interaction recording\nxfrec %d\n", kScriptVersion);
+    m_text += line;
+    std::snprintf(line, sizeof(line), "view %.17g %.17g %.17g %.17g\n",
+                  view.centerX, view.centerY, view.scaleX, view.scaleY);
+    m_text += line;
+    writeSettingDiffs(settings, true);
+    writeFormulaDiffs(formulas, true);
+}
+
+void InteractionRecorder::recordFrame(double timeSeconds, float deltaTime,
+                                      const InteractionInput& input,
+                                      const std::vector<FormulaEntry>& formulas,
+                                      const PlotSettings& settings) {
+    if (!m_recording) {
+        return;
+    }
+    writeSettingDiffs(settings, false);
+    writeFormulaDiffs(formulas, false);
+
+    const int buttons = (input.mouseLeft ? 1 : 0) | (input.mouseRight ? 2 : 0);
+    const int mods = (input.keyCtrl ? 1 : 0) | (input.keyShift ? 2 : 0);
+    char line[256];
+    std::snprintf(line, sizeof(line), "frame %.6f %.9g %.9g %.9g %.9g %.9g %d %.9g %d\n",
+                  timeSeconds, deltaTime, input.plotWidth, input.plotHeight,
+                  input.mouseX, input.mouseY, buttons, input.wheel, mods);
+    m_text += line;
+    ++m_frameCount;
+}
+
+void InteractionRecorder::writeSettingDiffs(const PlotSettings& settings, bool force) {
+    const auto values = settingValues(settings);
+    char line[128];
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!force && i < m_lastSettings.size() && m_lastSettings[i].second == values[i].second) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "setting %s %.9g\n",
+                      values[i].first.c_str(), values[i].second);
+        m_text += line;
+    }
+    m_lastSettings = values;
+}
+
+void InteractionRecorder::writeFormulaDiffs(const std::vector<FormulaEntry>& formulas, bool force) {
+    char line[160];
+    if (force || formulas.size() != m_lastFormulas.size()) {
+        std::snprintf(line, sizeof(line), "formulas %zu\n", formulas.size());
+        m_text += line;
+        m_lastFormulas.resize(formulas.size());
+        force = true;
+    }
+    for (size_t i = 0; i < formulas.size(); ++i) {
+        // Compared in place: with hundreds of formulas, nothing is copied on unchanged frames.
+        if (!force && sameFormulaState(formulas[i], m_lastFormulas[i])) {
+            continue;
+        }
+        const InteractionFormulaState state = snapshotFormula(static_cast<int>(i), formulas[i]);
+        std::snprintf(line, sizeof(line), "formula %d %d %.9g %.9g %.9g %.9g %.9g ",
+                      state.index, state.visible ? 1 : 0,
+                      state.color[0], state.color[1], state.color[2], state.color[3],
+                      state.zSlice);
+        m_text += line;
+        m_text += state.text;
+        m_text += '\n';
+        m_lastFormulas[i] = state;
+    }
+}
+
+bool InteractionRecorder::save(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "Could not open " + path + " for writing.";
+        return false;
+    }
+    out << m_text;
+    if (!out) {
+        error = "Could not write " + path + ".";
+        return false;
+    }
+    return true;
+}
+
+// ---- script ------------------------------------------------------------------
+
+bool InteractionScript::read(std::istream& in, InteractionScript& script, std::string& error) {
+    script = InteractionScript{};
+    InteractionFrame pending;
+    bool sawHeader = false;
+    std::string line;
+    int lineNumber = 0;
+    int formulaCount = -1;  // list size after the last 'formulas' record
+
+    auto fail = [&](const char* message) {
+        error = "Line " + std::to_string(lineNumber) + ": " + message;
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        if (!sawHeader) {
+            int version = 0;
+            if (kind != "xfrec" || !(fields >> version)) {
+                return fail("missing 'xfrec' header.");
+            }
+            if (version != kScriptVersion) {
+                return fail("unsupported recording version.");
+            }
+            sawHeader = true;
+            continue;
+        }
+
+        if (kind == "view") {
+            Core::ViewTransform& vt = script.initialView;
+            if (!(fields >> vt.centerX >> vt.centerY >> vt.scaleX >> vt.scaleY)) {
+                return fail("malformed 'view' record.");
+            }
+        } else if (kind == "setting") {
+            std::string name;
+            double value = 0.0;
+            if (!(fields >> name >> value)) {
+                return fail("malformed 'setting' record.");
+            }
+            pending.settingChanges.emplace_back(name, value);
+        } else if (kind == "formulas") {
+            int count = 0;
+            if (!(fields >> count) || count < 0 || count > kMaxFormulas) {
+                return fail("malformed 'formulas' record.");
+            }
+            pending.formulaCount = count;
+            formulaCount = count;
+        } else if (kind == "formula") {
+            InteractionFormulaState state;
+            int visible = 1;
+            if (!(fields >> state.index >> visible >> state.color[0] >> state.color[1] >>
+                  state.color[2] >> state.color[3] >> state.zSlice) || state.index < 0 ||
+                state.index >= (formulaCount >= 0 ? formulaCount : kMaxFormulas)) {
+                return fail("malformed 'formula' record.");
+            }
+            state.visible = (visible != 0);
+            std::getline(fields, state.text);
+            state.text = Detail::trim(state.text);
+            pending.formulaChanges.push_back(std::move(state));
+        } else if (kind == "frame") {
+            int buttons = 0;
+            int mods = 0;
+            InteractionInput& input = pending.input;
+            if (!(fields >> pending.timeSeconds >> pending.deltaTime >>
+                  input.plotWidth >> input.plotHeight >> input.mouseX >> input.mouseY >>
+                  buttons >> input.wheel >> mods)) {
+                return fail("malformed 'frame' record.");
+            }
+            input.mouseLeft = (buttons & 1) != 0;
+            input.mouseRight = (buttons & 2) != 0;
+            input.keyCtrl = (mods & 1) != 0;
+            input.keyShift = (mods & 2) != 0;
+            script.frames.push_back(std::move(pending));
+            pending = InteractionFrame{};
+        } else {
+            return fail("unknown record type.");
+        }
+    }
+
+    if (!sawHeader) {
+        error = "Empty recording.";
+        return false;
+    }
+    error.clear();
+    return true;
+}
+
+bool InteractionScript::load(const std::string& path, InteractionScript& script, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Could not open " + path + ".";
+        return false;
+    }
+    return read(in, script, error);
+}
+
+void InteractionScript::applyFrameState(const InteractionFrame& frame,
+                                        std::vector<FormulaEntry>& formulas,
+                                        PlotSettings& settings) {
+    for (const auto& change : frame.settingChanges) {
+        InteractionRecorder::applySetting(settings, change.first, change.second);
+    }
+    if (frame.formulaCount >= 0) {
+        formulas.resize(static_cast<size_t>(frame.formulaCount));
+    }
+    for (const InteractionFormulaState& state : frame.formulaChanges) {
+        if (state.index >= static_cast<int>(formulas.size())) {
+            formulas.resize(static_cast<size_t>(state.index) + 1);
+        }
+        FormulaEntry& entry = formulas[static_cast<size_t>(state.index)];
+        std::snprintf(entry.inputBuffer, sizeof(entry.inputBuffer), "%s", state.text.c_str());
+        entry.visible = state.visible;
+        for (int i = 0; i < 4; ++i) {
+            entry.color[i] = state.color[i];
+        }
+        entry.zSlice = state.zSlice;
+        entry.parse();
+        // Replays draw the same frames every run, so a loaded file is in place before the next.
+        while (entry.loading() && !entry.updateData()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+} // namespace XpressFormula::UI
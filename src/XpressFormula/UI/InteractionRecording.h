@@ -0,0 +1,99 @@
+// InteractionRecording.h - Records plot interaction (input, formula edits, settings changes)
+//                          to a text script and loads it back for deterministic replay.
+#pragma once
+
+#include "FormulaEntry.h"
+#include "PlotSettings.h"
+#include "../Core/ViewTransform.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace XpressFormula::UI {
+
+/// Input state captured once per frame. Mouse coordinates are relative to the top-left of the
+/// plot area so a recording replays identically regardless of the sidebar/window layout.
+struct InteractionInput {
+    float plotWidth = 0.0f;
+    float plotHeight = 0.0f;
+    float mouseX = 0.0f;
+    float mouseY = 0.0f;
+    bool  mouseLeft = false;
+    bool  mouseRight = false;
+    float wheel = 0.0f;
+    bool  keyCtrl = false;
+    bool  keyShift = false;
+};
+
+/// Formula state as seen by the plot (text plus the display fields PlotPanel reads).
+struct InteractionFormulaState {
+    int         index = 0;
+    std::string text;
+    bool        visible = true;
+    float       color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float       zSlice = 0.0f;
+};
+
+/// One recorded frame. State changes are applied before the frame's input.
+struct InteractionFrame {
+    double timeSeconds = 0.0;  // since the start of the recording
+    float  deltaTime = 0.0f;   // ImGuiIO::DeltaTime of the frame (drives auto-rotate)
+    InteractionInput input;
+    int    formulaCount = -1;  // >= 0 when the formula list was resized before this frame
+    std::vector<InteractionFormulaState> formulaChanges;
+    std::vector<std::pair<std::string, double>> settingChanges;
+};
+
+/// A loaded recording: initial view plus the frame sequence.
+struct InteractionScript {
+    Core::ViewTransform initialView;
+    std::vector<InteractionFrame> frames;
+
+    /// Parse a script written by InteractionRecorder. Returns false and sets `error`
+    /// (with the offending line number) on malformed input.
+    static bool read(std::istream& in, InteractionScript& script, std::string& error);
+    static bool load(const std::string& path, InteractionScript& script, std::string& error);
+
+    /// Apply the frame's formula/settings changes. Formulas are re-parsed only when changed.
+    static void applyFrameState(const InteractionFrame& frame,
+                                std::vector<FormulaEntry>& formulas,
+                                PlotSettings& settings);
+};
+
+/// Captures frames while active and serializes them as a line-oriented text script.
+/// Only differences are written for formulas and settings, so long idle recordings stay small.
+class InteractionRecorder {
+public:
+    void start(const Core::ViewTransform& view,
+               const std::vector<FormulaEntry>& formulas,
+               const PlotSettings& settings);
+    void stop() { m_recording = false; }
+    bool isRecording() const { return m_recording; }
+    size_t frameCount() const { return m_frameCount; }
+
+    /// Append one frame. `timeSeconds` is measured from start().
+    void recordFrame(double timeSeconds, float deltaTime, const InteractionInput& input,
+                     const std::vector<FormulaEntry>& formulas,
+                     const PlotSettings& settings);
+
+    const std::string& text() const { return m_text; }
+    bool save(const std::string& path, std::string& error) const;
+
+    /// Name/value access to every PlotSettings field that affects rendering.
+    static std::vector<std::pair<std::string, double>> settingValues(const PlotSettings& settings);
+    static bool applySetting(PlotSettings& settings, const std::string& name, double value);
+
+private:
+    void writeFormulaDiffs(const std::vector<FormulaEntry>& formulas, bool force);
+    void writeSettingDiffs(const PlotSettings& settings, bool force);
+
+    bool m_recording = false;
+    size_t m_frameCount = 0;
+    std::string m_text;
+    std::vector<InteractionFormulaState> m_lastFormulas;
+    std::vector<std::pair<std::string, double>> m_lastSettings;
+};
+
+} // namespace XpressFormula::UI
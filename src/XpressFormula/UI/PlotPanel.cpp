@@ -1,10 +1,578 @@
 // PlotPanel.cpp - Interactive plot panel implementation.
 #include "PlotPanel.h"
+#include "../Core/Evaluator.h"
+#include "../Core/TaskPool.h"
 #include "../Plotting/PlotRenderer.h"
 #include "imgui.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace XpressFormula::UI {
 
+struct PlotPanel::FormulaDrawSlot {
+    FormulaDrawSlot() : drawList(&sharedData), arena(64 * 1024) {}
+
+    // Private copy of the context's shared draw data: ImDrawList uses its TempBuffer as
+    // scratch for polylines and convex fills, so lists built concurrently cannot share it.
+    ImDrawListSharedData sharedData;
+    ImDrawList drawList;
+    Plotting::FrameArena arena;
+
+    // Starts an empty recording that inherits the window list's per-frame draw state.
+    void begin(const ImDrawList& window);
+};
+
+namespace {
+
+// z planes of a cached cross-section volume: 0.25 steps over the z slider range.
+constexpr int kVolumeDepth = 81;
+
+// Ray-marched volume and ray-traced surface images are traced at half the plot resolution
+// and stretched over it.
+constexpr int kVolumeImageDivisor = 2;
+
+// Camera of the per-pixel 3D renderers: the 3D view settings over the whole plot area, with
+// the image covering the screen rectangle (left, top, width, height) of it.
+Plotting::VolumeRaymarcher::Camera imageCamera(const Core::ViewTransform& vt,
+                                               const PlotSettings& settings,
+                                               float left, float top, float width, float height) {
+    Plotting::VolumeRaymarcher::Camera camera;
+    camera.azimuthDeg = settings.azimuthDeg;
+    camera.elevationDeg = settings.elevationDeg;
+    camera.zScale = settings.zScale;
+    const Core::Vec2 origin = vt.worldToScreen(0.0, 0.0);
+    camera.originX = origin.x;
+    camera.originY = origin.y;
+    camera.scale = std::max(1e-6, std::min(vt.scaleX, vt.scaleY));
+    camera.left = left;
+    camera.top = top;
+    camera.width = width;
+    camera.height = height;
+    return camera;
+}
+
+// Key under which PlotRenderer publishes the formula's 3D mesh (see collectFormulaJobs), or
+// null when the formula draws no mesh in 3D mode.
+const void* surfaceMeshKey(const FormulaEntry& f, const PlotSettings& settings) {
+    if (f.renderKind == FormulaRenderKind::Surface3D) {
+        return f.ast.get();
+    }
+    if (f.renderKind == FormulaRenderKind::ScalarField3D && f.isEquation &&
+        !settings.traceImplicitSurfaces) {
+        return f.solution.solved() ? f.solution.branches.front().get() : f.ast.get();
+    }
+    return nullptr;
+}
+
+// Key under which drawCurve2D publishes the formula's curve index and samples (see
+// collectFormulaJobs), or null when the formula is not drawn as y = g(x) branches in 2D.
+const void* curveKey(const FormulaEntry& f) {
+    if (f.renderKind == FormulaRenderKind::Curve2D) {
+        return f.ast.get();
+    }
+    if (f.renderKind == FormulaRenderKind::Implicit2D && f.solution.solved()) {
+        return f.solution.branches.front().get();
+    }
+    return nullptr;
+}
+
+int imageExtent(float screenExtent) {
+    return std::max(1, (static_cast<int>(std::ceil(screenExtent)) + kVolumeImageDivisor - 1) /
+                           kVolumeImageDivisor);
+}
+
+// Copies the per-frame state (font, atlas UVs, tessellation settings, flags) from the
+// context's shared draw data, leaving dst's own scratch buffer and list registry untouched.
+void syncSharedData(ImDrawListSharedData& dst, const ImDrawListSharedData& src) {
+    dst.TexUvWhitePixel = src.TexUvWhitePixel;
+    dst.TexUvLines = src.TexUvLines;
+    dst.FontAtlas = src.FontAtlas;
+    dst.Font = src.Font;
+    dst.FontSize = src.FontSize;
+    dst.FontScale = src.FontScale;
+    dst.CurveTessellationTol = src.CurveTessellationTol;
+    dst.SetCircleTessellationMaxError(src.CircleSegmentMaxError);
+    dst.InitialFringeScale = src.InitialFringeScale;
+    dst.InitialFlags = src.InitialFlags;
+    dst.ClipRectFullscreen = src.ClipRectFullscreen;
+    dst.Context = src.Context;
+}
+
+// Appends the geometry recorded in `src` to `dst`, command by command, preserving each
+// command's texture and clip rect. Indices are rebased onto dst's current vertex range (PrimReserve starts
+// a new vertex offset when a 16-bit index range would overflow).
+void appendDrawList(ImDrawList* dst, const ImDrawList& src) {
+    for (const ImDrawCmd& cmd : src.CmdBuffer) {
+        if (cmd.ElemCount == 0 || cmd.UserCallback != nullptr) {
+            continue;
+        }
+        const ImDrawIdx* indices = src.IdxBuffer.Data + cmd.IdxOffset;
+        unsigned int minIndex = UINT_MAX;
+        unsigned int maxIndex = 0;
+        for (unsigned int i = 0; i < cmd.ElemCount; ++i) {
+            minIndex = std::min<unsigned int>(minIndex, indices[i]);
+            maxIndex = std::max<unsigned int>(maxIndex, indices[i]);
+        }
+        const int vtxCount = static_cast<int>(maxIndex - minIndex + 1);
+
+        dst->PushTexture(cmd.TexRef);
+        dst->PushClipRect(ImVec2(cmd.ClipRect.x, cmd.ClipRect.y),
+                          ImVec2(cmd.ClipRect.z, cmd.ClipRect.w));
+        dst->PrimReserve(static_cast<int>(cmd.ElemCount), vtxCount);
+        std::memcpy(dst->_VtxWritePtr, src.VtxBuffer.Data + cmd.VtxOffset + minIndex,
+                    static_cast<size_t>(vtxCount) * sizeof(ImDrawVert));
+        const unsigned int base = dst->_VtxCurrentIdx;
+        for (unsigned int i = 0; i < cmd.ElemCount; ++i) {
+            dst->_IdxWritePtr[i] = static_cast<ImDrawIdx>(base + (indices[i] - minIndex));
+        }
+        dst->_VtxWritePtr += vtxCount;
+        dst->_IdxWritePtr += cmd.ElemCount;
+        dst->_VtxCurrentIdx += static_cast<unsigned int>(vtxCount);
+        dst->PopClipRect();
+        dst->PopTexture();
+    }
+}
+
+} // namespace
+
+void PlotPanel::FormulaDrawSlot::begin(const ImDrawList& window) {
+    syncSharedData(sharedData, *window._Data);
+    drawList._ResetForNewFrame();
+    drawList.PushTexture(window._CmdHeader.TexRef);
+    drawList.PushClipRect(window.GetClipRectMin(), window.GetClipRectMax());
+    arena.reset();
+}
+
+PlotPanel::PlotPanel() = default;
+PlotPanel::~PlotPanel() = default;
+
+std::shared_ptr<const Plotting::VolumeCache::Volume> PlotPanel::crossSectionVolume(
+    const Core::ASTNodePtr& ast, const Core::ViewTransform& vt) {
+    // The volume covers the cross-section grid of the current view over the z-slice slider
+    // range; panning or zooming re-requests it, and slices fall back to direct evaluation
+    // until the new volume is ready.
+    Plotting::VolumeCache::Domain domain;
+    domain.xMin = vt.worldXMin();
+    domain.xMax = vt.worldXMax();
+    domain.yMin = vt.worldYMin();
+    domain.yMax = vt.worldYMax();
+    domain.zMin = kZSliceMin;
+    domain.zMax = kZSliceMax;
+    domain.nx = Plotting::PlotRenderer::kCrossSectionResX;
+    domain.ny = Plotting::PlotRenderer::kCrossSectionResY;
+    domain.nz = kVolumeDepth;
+
+    auto it = std::find_if(m_volumes.begin(), m_volumes.end(),
+                           [&](const CrossSectionVolume& v) { return v.ast == ast; });
+    if (it == m_volumes.end()) {
+        m_volumes.push_back({ ast, std::make_unique<Plotting::VolumeCache>(), false });
+        it = std::prev(m_volumes.end());
+    }
+    it->used = true;
+    return it->cache->request(ast, domain);
+}
+
+bool PlotPanel::volumeSamplingPending() const {
+    return std::any_of(m_volumes.begin(), m_volumes.end(),
+                       [](const CrossSectionVolume& v) { return v.cache->pending(); });
+}
+
+const Plotting::ImageTexture* PlotPanel::updateVolumeView(const FormulaEntry& formula,
+                                                       const Core::ViewTransform& vt,
+                                                       const ImageArea& area,
+                                                       const PlotSettings& settings,
+                                                       bool forExport) {
+    auto it = std::find_if(m_volumeViews.begin(), m_volumeViews.end(),
+                           [&](const std::unique_ptr<VolumeView>& v) {
+                               return v->ast == formula.ast && v->forExport == forExport;
+                           });
+    if (it == m_volumeViews.end()) {
+        m_volumeViews.push_back(std::make_unique<VolumeView>());
+        it = std::prev(m_volumeViews.end());
+        (*it)->ast = formula.ast;
+        (*it)->forExport = forExport;
+    }
+    VolumeView& view = **it;
+    view.used = true;
+
+    // Same box as the implicit surface mesher.
+    const int resolution = std::clamp(settings.implicitSurfaceResolution, 16, 96);
+    Plotting::VolumeCache::Domain domain;
+    domain.xMin = vt.worldXMin();
+    domain.xMax = vt.worldXMax();
+    domain.yMin = vt.worldYMin();
+    domain.yMax = vt.worldYMax();
+    Plotting::PlotRenderer::implicitZRange(vt, formula.zSlice, domain.zMin, domain.zMax);
+    domain.nx = resolution;
+    domain.ny = resolution;
+    domain.nz = resolution + 1;
+
+    // While a new volume is sampled in the background the previous one keeps being shown.
+    if (forExport) {
+        if (!view.volume || !(view.volume->domain == domain)) {
+            view.volume = Plotting::VolumeCache::sample(formula.ast, domain);
+        }
+    } else if (auto sampled = view.cache.request(formula.ast, domain)) {
+        view.volume = std::move(sampled);
+    }
+
+    Plotting::VolumeRaymarcher::TransferFunction transfer;
+    transfer.threshold = settings.volumeThreshold;
+    transfer.density = settings.volumeDensity;
+    transfer.opacity = settings.surfaceOpacity;
+    for (size_t i = 0; i < transfer.palette.size(); ++i) {
+        transfer.palette[i] = Plotting::PlotRenderer::heatColor(
+            static_cast<double>(i) / 255.0, 0.0, 1.0, formula.color, 1.0f);
+    }
+
+    const int imageWidth = imageExtent(area.width);
+    const int imageHeight = imageExtent(area.height);
+    view.raymarcher.setScene(view.volume,
+                             imageCamera(vt, settings, area.left, area.top, area.width, area.height),
+                             transfer, imageWidth, imageHeight);
+    view.texture.resize(imageWidth, imageHeight);
+
+    int dirtyTop = 0;
+    int dirtyBottom = 0;
+    const double budgetMs = forExport ? std::numeric_limits<double>::infinity()
+                                      : static_cast<double>(settings.frameBudgetMs);
+    if (view.raymarcher.refine(Core::TaskPool::shared(), budgetMs, dirtyTop, dirtyBottom)) {
+        view.texture.upload(view.raymarcher.pixels(), dirtyTop, dirtyBottom);
+    }
+    return view.raymarcher.hasImage() ? &view.texture : nullptr;
+}
+
+bool PlotPanel::volumeRenderingPending() const {
+    return std::any_of(m_volumeViews.begin(), m_volumeViews.end(),
+                       [](const std::unique_ptr<VolumeView>& v) {
+                           return !v->forExport &&
+                                  (v->cache.pending() || !v->raymarcher.converged());
+                       });
+}
+
+const Plotting::ImageTexture* PlotPanel::updateSurfaceTraceView(const FormulaEntry& formula,
+                                                               const Core::ViewTransform& vt,
+                                                               const ImageArea& area,
+                                                               const PlotSettings& settings,
+                                                               bool forExport) {
+    auto it = std::find_if(m_surfaceTraceViews.begin(), m_surfaceTraceViews.end(),
+                           [&](const std::unique_ptr<SurfaceTraceView>& v) {
+                               return v->ast == formula.ast && v->forExport == forExport;
+                           });
+    if (it == m_surfaceTraceViews.end()) {
+        m_surfaceTraceViews.push_back(std::make_unique<SurfaceTraceView>());
+        it = std::prev(m_surfaceTraceViews.end());
+        (*it)->ast = formula.ast;
+        (*it)->forExport = forExport;
+    }
+    SurfaceTraceView& view = **it;
+    view.used = true;
+
+    // Same box as the implicit surface mesher.
+    Plotting::ImplicitSurfaceTracer::Bounds bounds;
+    bounds.xMin = vt.worldXMin();
+    bounds.xMax = vt.worldXMax();
+    bounds.yMin = vt.worldYMin();
+    bounds.yMax = vt.worldYMax();
+    Plotting::PlotRenderer::implicitZRange(vt, formula.zSlice, bounds.zMin, bounds.zMax);
+
+    Plotting::ImplicitSurfaceTracer::Shading shading;
+    shading.color = { formula.color[0], formula.color[1], formula.color[2], formula.color[3] };
+    shading.opacity = settings.surfaceOpacity;
+
+    const int imageWidth = imageExtent(area.width);
+    const int imageHeight = imageExtent(area.height);
+    view.tracer.setScene(formula.ast, bounds,
+                         imageCamera(vt, settings, area.left, area.top, area.width, area.height),
+                         shading, imageWidth, imageHeight);
+    view.texture.resize(imageWidth, imageHeight);
+
+    int dirtyTop = 0;
+    int dirtyBottom = 0;
+    const double budgetMs = forExport ? std::numeric_limits<double>::infinity()
+                                      : static_cast<double>(settings.frameBudgetMs);
+    if (view.tracer.refine(Core::TaskPool::shared(), budgetMs, dirtyTop, dirtyBottom)) {
+        view.texture.upload(view.tracer.pixels(), dirtyTop, dirtyBottom);
+    }
+    return view.tracer.hasImage() ? &view.texture : nullptr;
+}
+
+bool PlotPanel::surfaceTracingPending() const {
+    return std::any_of(m_surfaceTraceViews.begin(), m_surfaceTraceViews.end(),
+                       [](const std::unique_ptr<SurfaceTraceView>& v) {
+                           return !v->forExport && !v->tracer.converged();
+                       });
+}
+
+const Plotting::ImageTexture* PlotPanel::updateScatterView(const FormulaEntry& formula,
+                                                          const Core::ViewTransform& vt,
+                                                          const ImageArea& area,
+                                                          const PlotSettings& settings,
+                                                          bool forExport) {
+    auto it = std::find_if(m_scatterViews.begin(), m_scatterViews.end(),
+                           [&](const std::unique_ptr<ScatterView>& v) {
+                               return v->points == formula.scatter && v->forExport == forExport;
+                           });
+    if (it == m_scatterViews.end()) {
+        m_scatterViews.push_back(std::make_unique<ScatterView>());
+        it = std::prev(m_scatterViews.end());
+        (*it)->points = formula.scatter;
+        (*it)->forExport = forExport;
+    }
+    ScatterView& view = **it;
+    view.used = true;
+
+    // One bin per screen pixel, from the left and top edges of the image area.
+    Plotting::ScatterDensity::Window window;
+    window.width = std::max(1, static_cast<int>(std::ceil(area.width)));
+    window.height = std::max(1, static_cast<int>(std::ceil(area.height)));
+    window.xMin = vt.worldXMin() + (area.left - vt.screenOriginX) / vt.scaleX;
+    window.xMax = window.xMin + window.width / vt.scaleX;
+    window.yMax = vt.worldYMax() - (area.top - vt.screenOriginY) / vt.scaleY;
+    window.yMin = window.yMax - window.height / vt.scaleY;
+
+    // Views the pyramid resolves are aggregated directly; closer ones are binned exactly (in
+    // the background, showing the pyramid's blurred resampling until then).
+    const bool current = view.grid && view.grid->window == window;
+    std::shared_ptr<const Plotting::ScatterDensity::Grid> grid = view.grid;
+    if (view.points->pyramidResolves(window)) {
+        view.cache.cancel();
+        if (!current) {
+            grid = view.points->aggregate(window);
+        }
+    } else if (forExport) {
+        if (!current || !view.grid->exact) {
+            grid = view.points->bin(window);
+        }
+    } else if (auto exact = view.cache.request(view.points, window)) {
+        grid = std::move(exact);
+    } else if (!current) {
+        grid = view.points->aggregate(window);
+    }
+    if (!grid) {
+        return nullptr;
+    }
+
+    std::array<std::uint32_t, 256> palette;
+    for (size_t i = 0; i < palette.size(); ++i) {
+        palette[i] = Plotting::PlotRenderer::heatColor(
+            static_cast<double>(i) / 255.0, 0.0, 1.0, formula.color, settings.heatmapOpacity);
+    }
+    const bool resized = view.texture.resize(window.width, window.height);
+    if (resized || grid != view.grid || palette != view.palette || settings.scatterLogScale != view.logScale) {
+        view.grid = std::move(grid);
+        view.palette = palette;
+        view.logScale = settings.scatterLogScale;
+        view.points->colorize(*view.grid, view.palette, view.logScale, view.pixels);
+        view.texture.upload(view.pixels.data(), 0, window.height);
+    }
+    return &view.texture;
+}
+
+bool PlotPanel::scatterBinningPending() const {
+    return std::any_of(m_scatterViews.begin(), m_scatterViews.end(),
+                       [](const std::unique_ptr<ScatterView>& v) { return v->cache.pending(); });
+}
+
+const FormulaEntry* PlotPanel::pickSurface(const std::vector<FormulaEntry>& formulas,
+                                           const Core::ViewTransform& vt,
+                                           const PlotSettings& settings,
+                                           float screenX, float screenY,
+                                           Plotting::MeshBvh::Hit& hit) {
+    Plotting::PlotRenderer::Surface3DOptions camera;
+    camera.azimuthDeg = settings.azimuthDeg;
+    camera.elevationDeg = settings.elevationDeg;
+    camera.zScale = settings.zScale;
+    Plotting::MeshBvh::Vec3 origin{};
+    Plotting::MeshBvh::Vec3 direction{};
+    Plotting::PlotRenderer::pickRay3D(vt, camera, screenX, screenY, origin, direction);
+
+    // One ray for every surface; the smallest parameter is the surface in front.
+    const FormulaEntry* picked = nullptr;
+    for (const FormulaEntry& f : formulas) {
+        const void* key = (f.visible && f.isValid()) ? surfaceMeshKey(f, settings) : nullptr;
+        if (!key) {
+            continue;
+        }
+        auto it = std::find_if(m_surfacePicks.begin(), m_surfacePicks.end(),
+                               [&](const SurfacePick& p) { return p.ast == f.ast; });
+        if (it == m_surfacePicks.end()) {
+            m_surfacePicks.push_back({ f.ast, std::make_unique<Plotting::MeshBvhCache>() });
+            it = std::prev(m_surfacePicks.end());
+        }
+        auto grid = Plotting::PlotRenderer::surfaceGrid(key);
+        auto bvh = grid ? it->cache->request(grid)
+                        : it->cache->request(Plotting::PlotRenderer::surfaceMesh(key));
+        Plotting::MeshBvh::Hit candidate;
+        if (bvh && bvh->intersect(origin, direction, candidate) && (!picked || candidate.t < hit.t)) {
+            hit = candidate;
+            picked = &f;
+        }
+    }
+    return picked;
+}
+
+bool PlotPanel::surfacePickPending() const {
+    return std::any_of(m_surfacePicks.begin(), m_surfacePicks.end(),
+                       [](const SurfacePick& p) { return p.cache->pending(); });
+}
+
+const FormulaEntry* PlotPanel::pickCurve(const std::vector<FormulaEntry>& formulas,
+                                         const Core::ViewTransform& vt,
+                                         float screenX, float screenY, double& x, double& y) {
+    const FormulaEntry* picked = nullptr;
+    Plotting::CurveIndex::Hit best;
+    for (const FormulaEntry& f : formulas) {
+        if (!f.visible || !f.isValid()) continue;
+        const void* key = curveKey(f);
+        auto index = key ? Plotting::PlotRenderer::curveIndex(key, vt) : nullptr;
+        Plotting::CurveIndex::Hit hit;
+        const float radius = picked ? best.distance : kCurvePickRadius;
+        if (index && index->nearest(screenX, screenY, radius, hit)) {
+            best = hit;
+            picked = &f;
+        }
+    }
+    if (!picked) {
+        return nullptr;
+    }
+
+    // The segments are chords between samples; evaluate the hit branch at the cursor x itself.
+    double ignored = 0.0;
+    vt.screenToWorld(screenX, screenY, x, ignored);
+    const Core::ASTNodePtr& branch = (picked->renderKind == FormulaRenderKind::Curve2D)
+        ? picked->ast
+        : picked->solution.branches[best.branch];
+    Core::Evaluator::Variables vars;
+    vars["x"] = x;
+    y = Core::Evaluator::evaluate(branch, vars);
+    if (!std::isfinite(y)) {
+        // Past a branch end or on a pole: report the nearest drawn point instead.
+        vt.screenToWorld(best.x, best.y, x, y);
+    }
+    return picked;
+}
+
+void PlotPanel::drawCurveFeatures(ImDrawList* dl, const std::vector<FormulaEntry>& formulas,
+                                  const Core::ViewTransform& vt, bool enabled) {
+    std::vector<Plotting::CurveAnalysis::Curve> curves;
+    m_curveFeatureFormulas.clear();
+    if (enabled) {
+        for (const FormulaEntry& f : formulas) {
+            const void* key = (f.visible && f.isValid()) ? curveKey(f) : nullptr;
+            auto samples = key ? Plotting::PlotRenderer::curveSamples(key, vt) : nullptr;
+            if (!samples) continue;
+            Plotting::CurveAnalysis::Curve& curve = curves.emplace_back();
+            if (f.renderKind == FormulaRenderKind::Curve2D) {
+                curve.branches.push_back(f.ast);
+            } else {
+                curve.branches = f.solution.branches;
+            }
+            curve.samples = std::move(samples);
+            m_curveFeatureFormulas.push_back(&f);
+        }
+    }
+    m_curveFeatures = m_curveAnalysis.request(curves);
+    if (!m_curveFeatures) {
+        return;
+    }
+
+    // Features are in world coordinates: a result still being replaced after a pan or zoom is
+    // drawn at its points' new screen positions. Roots are rings in the curve's colour, extrema
+    // filled dots, intersections white dots.
+    dl->PushClipRect(ImVec2(vt.screenOriginX, vt.screenOriginY),
+                     ImVec2(vt.screenOriginX + vt.screenWidth, vt.screenOriginY + vt.screenHeight), true);
+    for (const Plotting::CurveAnalysis::Feature& feature : m_curveFeatures->features) {
+        const Core::Vec2 sp = vt.worldToScreen(feature.x, feature.y);
+        const ImVec2 p(sp.x, sp.y);
+        const float* c = m_curveFeatureFormulas[feature.curve]->color;
+        const ImU32 color = ImGui::ColorConvertFloat4ToU32(ImVec4(c[0], c[1], c[2], 1.0f));
+        switch (feature.kind) {
+            case Plotting::CurveAnalysis::Kind::Root:
+                dl->AddCircle(p, 4.5f, color, 12, 2.0f);
+                break;
+            case Plotting::CurveAnalysis::Kind::Minimum:
+            case Plotting::CurveAnalysis::Kind::Maximum:
+                dl->AddCircleFilled(p, 3.5f, color, 12);
+                break;
+            case Plotting::CurveAnalysis::Kind::Intersection:
+                dl->AddCircleFilled(p, 4.0f, IM_COL32(255, 255, 255, 255), 12);
+                dl->AddCircle(p, 4.0f, IM_COL32(0, 0, 0, 200), 12, 1.0f);
+                break;
+        }
+    }
+    dl->PopClipRect();
+}
+
+const Plotting::CurveAnalysis::Feature* PlotPanel::pickCurveFeature(const Core::ViewTransform& vt,
+                                                                    float screenX, float screenY) const {
+    if (!m_curveFeatures) {
+        return nullptr;
+    }
+    const Plotting::CurveAnalysis::Feature* picked = nullptr;
+    float best = kCurvePickRadius * kCurvePickRadius;
+    for (const Plotting::CurveAnalysis::Feature& feature : m_curveFeatures->features) {
+        const Core::Vec2 sp = vt.worldToScreen(feature.x, feature.y);
+        const float dx = sp.x - screenX;
+        const float dy = sp.y - screenY;
+        if (dx * dx + dy * dy <= best) {
+            best = dx * dx + dy * dy;
+            picked = &feature;
+        }
+    }
+    return picked;
+}
+
+PlotPanel::GeometryCacheEntry& PlotPanel::geometryCacheEntry(const FormulaGeometryKey& key) {
+    // One entry per formula per grid-plane pass; the remaining key fields decide hit or miss.
+    const void* source = key.ast     ? static_cast<const void*>(key.ast.get())
+                       : key.data    ? static_cast<const void*>(key.data.get())
+                       : key.scatter ? static_cast<const void*>(key.scatter.get())
+                                     : static_cast<const void*>(key.stream.get());
+    GeometryCacheEntry& entry = m_geometryCache[{ source, static_cast<int>(key.options.planePass) }];
+    if (!entry.slot) {
+        entry.slot = std::make_unique<FormulaDrawSlot>();
+    }
+    return entry;
+}
+
+bool PlotPanel::outsideView2D(const FormulaEntry& formula, const Core::ViewTransform& vt) {
+    const bool curve = formula.renderKind == FormulaRenderKind::Curve2D;
+    if (!curve && formula.renderKind != FormulaRenderKind::Implicit2D) {
+        return false;
+    }
+    auto it = m_viewCulling.find(formula.ast.get());
+    if (it == m_viewCulling.end()) {
+        it = m_viewCulling.emplace(formula.ast.get(), ViewCulling{ Core::IntervalEvaluator(formula.ast) }).first;
+    }
+    ViewCulling& culling = it->second;
+    culling.used = true;
+    const std::array<double, 4> view{ vt.worldXMin(), vt.worldXMax(), vt.worldYMin(), vt.worldYMax() };
+    if (culling.checked && culling.view == view) {
+        return culling.outside;
+    }
+    culling.checked = true;
+    culling.view = view;
+    const Core::Interval x{ view[0], view[1] };
+    if (curve) {
+        // Keep a couple of pixels of margin for the line width and unrounded bounds.
+        const double margin = 2.0 / vt.scaleY;
+        const Core::Interval y = culling.evaluator.evaluate(x, Core::Interval::point(0.0),
+                                                            Core::Interval::point(0.0), m_cullingScratch);
+        culling.outside = y.isEmpty() || y.lo > view[3] + margin || y.hi < view[2] - margin;
+    } else {
+        const Core::Interval value = culling.evaluator.evaluate(x, Core::Interval{ view[2], view[3] },
+                                                                Core::Interval::point(0.0), m_cullingScratch);
+        culling.outside = !value.contains(0.0);
+    }
+    return culling.outside;
+}
+
 void PlotPanel::render(std::vector<FormulaEntry>& formulas,
                        Core::ViewTransform& vt,
                        PlotSettings& settings,
@@ -20,6 +588,22 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
     vt.screenWidth   = size.x;
     vt.screenHeight  = size.y;
 
+    // A tile of a larger export: the transform spans the whole plot, and per-pixel images are
+    // only computed for the part of it inside the window.
+    ImageArea imageArea{ pos.x, pos.y, size.x, size.y };
+    if (overrides && overrides->active && overrides->plotWidth > 0.0f && overrides->plotHeight > 0.0f) {
+        vt.screenOriginX = pos.x + overrides->plotLeft;
+        vt.screenOriginY = pos.y + overrides->plotTop;
+        vt.screenWidth   = overrides->plotWidth;
+        vt.screenHeight  = overrides->plotHeight;
+        const float right = std::min(pos.x + size.x, vt.screenOriginX + vt.screenWidth);
+        const float bottom = std::min(pos.y + size.y, vt.screenOriginY + vt.screenHeight);
+        imageArea.left = std::max(pos.x, vt.screenOriginX);
+        imageArea.top = std::max(pos.y, vt.screenOriginY);
+        imageArea.width = std::max(1.0f, right - imageArea.left);
+        imageArea.height = std::max(1.0f, bottom - imageArea.top);
+    }
+
     // Reserve the plot area as an invisible button so we capture mouse events
     ImGui::InvisibleButton("##plot_area", size,
                            ImGuiButtonFlags_MouseButtonLeft |
@@ -27,6 +611,24 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
     bool isHovered = ImGui::IsItemHovered();
     bool isActive  = ImGui::IsItemActive();
 
+    // Scratch memory for this frame's renderer temporaries. Everything allocated from the arena
+    // during the previous render() is dead by now, so rewinding is safe.
+    m_frameArena.reset();
+    Plotting::FrameArena* arena = &m_frameArena;
+
+    // Take in what the live series received since the last frame, shown or not, so their
+    // queues never fill up, and the data:/scatter: files whose loads have finished.
+    m_streaming = false;
+    m_loadingData = false;
+    for (FormulaEntry& f : formulas) {
+        if (f.stream) {
+            f.stream->poll();
+            m_streaming = m_streaming || (f.visible && f.stream->connected());
+        }
+        f.updateData();
+        m_loadingData = m_loadingData || f.loading();
+    }
+
     // Draw background
     ImDrawList* dl = ImGui::GetWindowDrawList();
     const bool useOverrides = (overrides && overrides->active);
@@ -49,18 +651,20 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
             continue;
         }
 
-        if (formula.renderKind == FormulaRenderKind::Surface3D ||
-            (formula.renderKind == FormulaRenderKind::ScalarField3D && formula.isEquation)) {
+        if (formula.uses3DSurface(settings.volumeRendering)) {
             hasSurface = true;
         }
 
         switch (formula.renderKind) {
             case FormulaRenderKind::Curve2D:
             case FormulaRenderKind::Implicit2D:
+            case FormulaRenderKind::DataSeries2D:
+            case FormulaRenderKind::Scatter2D:
+            case FormulaRenderKind::Stream2D:
                 has2DFormula = true;
                 break;
             case FormulaRenderKind::ScalarField3D:
-                if (!formula.isEquation) {
+                if (!formula.isEquation && !settings.volumeRendering) {
                     has2DFormula = true;
                 }
                 break;
@@ -101,48 +705,40 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
 
     const bool isDraggingLeft = isActive && ImGui::IsMouseDragging(ImGuiMouseButton_Left);
     const bool isZoomingView = isHovered && (ImGui::GetIO().MouseWheel != 0.0f);
-    const bool useInteractive3DThrottle =
-        settings.optimizeRendering && hasSurface && is3DMode && (isDraggingLeft || isZoomingView);
+    const bool isAutoRotating = hasSurface && is3DMode && settings.autoRotate;
 
     // Panning/zooming implicit F(x,y,z)=0 changes the sampled domain, which invalidates the mesh cache
-    // and can force a full O(N^3) remesh every mouse move. Temporarily lowering mesh density (and
-    // suppressing wireframe lines) keeps interaction responsive, then full quality returns on release.
-    int interactiveSurfaceResolution = settings.surfaceResolution;
-    if (useInteractive3DThrottle) {
-        if (interactiveSurfaceResolution > 24) {
-            interactiveSurfaceResolution = (interactiveSurfaceResolution * 2) / 3;
-        }
-        if (interactiveSurfaceResolution < 24) {
-            interactiveSurfaceResolution = 24;
-        }
-    }
-
-    int interactiveImplicitResolution = settings.implicitSurfaceResolution;
-    if (useInteractive3DThrottle) {
-        if (interactiveImplicitResolution > 20) {
-            interactiveImplicitResolution /= 2;
-        }
-        if (interactiveImplicitResolution > 40) {
-            interactiveImplicitResolution = 40;
-        }
-        if (interactiveImplicitResolution < 20) {
-            interactiveImplicitResolution = 20;
-        }
+    // and can force a full O(N^3) remesh every mouse move; auto-rotation re-evaluates z=f(x,y) surfaces
+    // every frame. While that happens the governor measures each 3D formula's draw time and lowers its
+    // sampling resolution (and suppresses its wires) to fit the frame budget, then full quality returns
+    // shortly after interaction stops. Export renders (overrides active) bypass the governor,
+    // always use full quality, and leave the governor state untouched.
+    QualityGovernor* governor = useOverrides ? nullptr : &m_qualityGovernor;
+    if (governor) {
+        const bool governQuality = settings.optimizeRendering && hasSurface && is3DMode;
+        governor->beginFrame(ImGui::GetTime(),
+                             governQuality && (isDraggingLeft || isZoomingView || isAutoRotating),
+                             settings.frameBudgetMs);
     }
 
-    const float interactionWireThickness = useInteractive3DThrottle ? 0.0f : effectiveWireThickness;
-
     // Helper to build Surface3DOptions from the current settings (avoids duplicating
     // the same field list for Surface3D and ScalarField3D render kinds).
-    auto make3DOptions = [&]() {
+    auto make3DOptions = [&](const void* formulaKey) {
         Plotting::PlotRenderer::Surface3DOptions options;
+        options.resolution = governor
+            ? governor->surfaceResolution(formulaKey, settings.surfaceResolution)
+            : settings.surfaceResolution;
+        options.implicitResolution = governor
+            ? governor->implicitResolution(formulaKey, settings.implicitSurfaceResolution)
+            : settings.implicitSurfaceResolution;
+        options.sharpFeatures = settings.implicitSharpFeatures;
+        options.wireThickness = (!governor || governor->wiresAllowed(formulaKey))
+            ? effectiveWireThickness
+            : 0.0f;
         options.azimuthDeg = settings.azimuthDeg;
         options.elevationDeg = settings.elevationDeg;
         options.zScale = settings.zScale;
-        options.resolution = interactiveSurfaceResolution;
-        options.implicitResolution = interactiveImplicitResolution;
         options.opacity = settings.surfaceOpacity;
-        options.wireThickness = interactionWireThickness;
         options.showEnvelope = showEnvelope;
         options.envelopeThickness = settings.envelopeThickness;
         // Axis triad is an alternative to coordinate overlays in 3D mode, so keep them
@@ -151,53 +747,313 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
         return options;
     };
 
-    auto drawFormulas = [&](Plotting::PlotRenderer::SurfacePlanePass3D planePass,
-                            bool enable3DOverlays) {
+    // Export renders use their own view and must not cancel the on-screen volume.
+    const bool useVolumeCache = settings.cacheCrossSectionVolumes && !useOverrides;
+    // 2D curves only keep their world samples while features are marked (drawCurveFeatures).
+    const bool captureCurveSamples = !is3DMode && settings.showCurveFeatures;
+
+    // Each visible formula becomes one job that draws into a target list with a scratch arena.
+    // Jobs only record their draw time; the governor is updated on this thread afterwards.
+    auto collectFormulaJobs = [&](Plotting::PlotRenderer::SurfacePlanePass3D planePass,
+                                  bool enable3DOverlays) {
+        m_formulaJobs.clear();
         for (auto& f : formulas) {
             if (!f.visible || !f.isValid()) continue;
+            if (!is3DMode && outsideView2D(f, vt)) continue;
+            FormulaDrawJob job;
+            job.key.options.planePass = planePass;
             switch (f.renderKind) {
                 case FormulaRenderKind::Curve2D:
                     if (!is3DMode) {
-                        Plotting::PlotRenderer::drawCurve2D(dl, vt, f.ast, f.color);
+                        job.draw = [&f, &vt, captureCurveSamples](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawCurve2D(target, vt, f.ast, f.color, 2.0f, scratch,
+                                                                captureCurveSamples);
+                        };
+                        job.key.curveSamples = captureCurveSamples;
                     }
                     break;
                 case FormulaRenderKind::Surface3D:
                     if (is3DMode) {
-                        auto options = make3DOptions();
+                        auto options = make3DOptions(f.ast.get());
                         options.planePass = planePass;
                         if (!enable3DOverlays) {
                             options.showEnvelope = false;
                             options.showAxisTriad = false;
                         }
-                        Plotting::PlotRenderer::drawSurface3D(dl, vt, f.ast, f.color, options);
+                        job.draw = [&f, &vt, options](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawSurface3D(target, vt, f.ast, f.color, options, scratch);
+                        };
+                        job.key.options = options;
+                        job.costKey = f.ast.get();
+                        job.costModel = QualityGovernor::CostModel::Surface;
                     } else {
-                        Plotting::PlotRenderer::drawHeatmap(
-                            dl, vt, f.ast, f.color, settings.heatmapOpacity);
+                        const float opacity = settings.heatmapOpacity;
+                        const int contours = settings.heatmapContourLevels;
+                        job.draw = [&f, &vt, opacity, contours](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawHeatmap(target, vt, f.ast, f.color, opacity, contours, scratch);
+                        };
+                        job.key.opacity = opacity;
+                        job.key.contourLevels = contours;
                     }
                     break;
                 case FormulaRenderKind::Implicit2D:
-                    if (!is3DMode) {
-                        Plotting::PlotRenderer::drawImplicitContour2D(dl, vt, f.ast, f.color, 2.0f);
+                    if (!is3DMode && f.solution.solved()) {
+                        // Solved for y: sample the explicit branches instead of the 2D field.
+                        job.draw = [&f, &vt, captureCurveSamples](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawCurve2D(target, vt, f.solution, f.color, 2.0f, scratch,
+                                                                captureCurveSamples);
+                        };
+                        job.key.curveSamples = captureCurveSamples;
+                    } else if (!is3DMode) {
+                        job.draw = [&f, &vt](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawImplicitContour2D(target, vt, f.ast, f.color, 2.0f, scratch);
+                        };
                     }
                     break;
                 case FormulaRenderKind::ScalarField3D:
-                    if (f.isEquation && is3DMode) {
-                        auto options = make3DOptions();
+                    if (f.isEquation && is3DMode && settings.traceImplicitSurfaces) {
+                        // Like the volume image, drawn once over the grid.
+                        if (planePass != Plotting::PlotRenderer::SurfacePlanePass3D::BelowGridPlane) {
+                            const Plotting::ImageTexture* texture =
+                                updateSurfaceTraceView(f, vt, imageArea, settings, useOverrides);
+                            if (texture) {
+                                job.draw = [texture, imageArea](ImDrawList* target, Plotting::FrameArena*) {
+                                    texture->draw(target, imageArea.left, imageArea.top,
+                                                  imageArea.left + imageArea.width,
+                                                  imageArea.top + imageArea.height);
+                                };
+                                job.key.imageId = texture->id();
+                            }
+                        }
+                    } else if (f.isEquation && is3DMode && f.solution.solved()) {
+                        // Solved for z: draw the branches as one z=f(x,y) surface at the implicit
+                        // x/y density, clipped to the z window the implicit mesher would sample.
+                        auto options = make3DOptions(f.ast.get());
+                        options.resolution = governor
+                            ? governor->surfaceResolution(f.ast.get(), settings.implicitSurfaceResolution)
+                            : settings.implicitSurfaceResolution;
+                        Plotting::PlotRenderer::implicitZRange(vt, f.zSlice, options.zClipMin, options.zClipMax);
+                        options.planePass = planePass;
+                        if (!enable3DOverlays) {
+                            options.showEnvelope = false;
+                            options.showAxisTriad = false;
+                        }
+                        job.draw = [&f, &vt, options](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawSurface3D(target, vt, f.solution, f.color, options, scratch);
+                        };
+                        job.key.options = options;
+                        job.costKey = f.ast.get();
+                        job.costModel = QualityGovernor::CostModel::Surface;
+                    } else if (f.isEquation && is3DMode) {
+                        auto options = make3DOptions(f.ast.get());
                         options.implicitZCenter = f.zSlice;
                         options.planePass = planePass;
                         if (!enable3DOverlays) {
                             options.showEnvelope = false;
                             options.showAxisTriad = false;
                         }
-                        Plotting::PlotRenderer::drawImplicitSurface3D(dl, vt, f.ast, f.color, options);
+                        job.draw = [&f, &vt, options](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawImplicitSurface3D(target, vt, f.ast, f.color, options, scratch);
+                        };
+                        job.key.options = options;
+                        job.costKey = f.ast.get();
+                        job.costModel = QualityGovernor::CostModel::Implicit;
+                    } else if (is3DMode && settings.volumeRendering) {
+                        // The image covers the whole plot, so it is drawn once, over the grid.
+                        if (planePass != Plotting::PlotRenderer::SurfacePlanePass3D::BelowGridPlane) {
+                            const Plotting::ImageTexture* texture =
+                                updateVolumeView(f, vt, imageArea, settings, useOverrides);
+                            if (texture) {
+                                job.draw = [texture, imageArea](ImDrawList* target, Plotting::FrameArena*) {
+                                    texture->draw(target, imageArea.left, imageArea.top,
+                                                  imageArea.left + imageArea.width,
+                                                  imageArea.top + imageArea.height);
+                                };
+                                job.key.imageId = texture->id();
+                            }
+                        }
                     } else if (!is3DMode) {
-                        Plotting::PlotRenderer::drawCrossSection(
-                            dl, vt, f.ast, f.zSlice, f.color, settings.heatmapOpacity);
+                        const float opacity = settings.heatmapOpacity;
+                        const int contours = settings.heatmapContourLevels;
+                        auto volume = useVolumeCache ? crossSectionVolume(f.ast, vt) : nullptr;
+                        if (volume && volume->containsZ(f.zSlice)) {
+                            job.draw = [&f, &vt, opacity, contours, volume](ImDrawList* target,
+                                                                            Plotting::FrameArena* scratch) {
+                                Plotting::PlotRenderer::drawCrossSection(
+                                    target, vt, *volume, f.zSlice, f.color, opacity, contours, scratch);
+                            };
+                            job.key.volume = std::move(volume);
+                        } else {
+                            job.draw = [&f, &vt, opacity, contours](ImDrawList* target,
+                                                                    Plotting::FrameArena* scratch) {
+                                Plotting::PlotRenderer::drawCrossSection(
+                                    target, vt, f.ast, f.zSlice, f.color, opacity, contours, scratch);
+                            };
+                        }
+                        job.key.opacity = opacity;
+                        job.key.contourLevels = contours;
+                    }
+                    break;
+                case FormulaRenderKind::DataSeries2D:
+                    if (!is3DMode) {
+                        job.draw = [&f, &vt](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawDataSeries(target, vt, *f.data, f.color, 1.5f, scratch);
+                        };
+                        job.key.data = f.data;
+                    }
+                    break;
+                case FormulaRenderKind::Scatter2D:
+                    if (!is3DMode) {
+                        const Plotting::ImageTexture* texture =
+                            updateScatterView(f, vt, imageArea, settings, useOverrides);
+                        if (texture) {
+                            job.draw = [texture, imageArea](ImDrawList* target, Plotting::FrameArena*) {
+                                texture->draw(target, imageArea.left, imageArea.top,
+                                              imageArea.left + static_cast<float>(texture->width()),
+                                              imageArea.top + static_cast<float>(texture->height()));
+                            };
+                            job.key.imageId = texture->id();
+                            job.key.scatter = f.scatter;
+                        }
+                    }
+                    break;
+                case FormulaRenderKind::Stream2D:
+                    if (!is3DMode) {
+                        job.draw = [&f, &vt](ImDrawList* target, Plotting::FrameArena* scratch) {
+                            Plotting::PlotRenderer::drawStreamSeries(target, vt, *f.stream, f.color, 1.5f, scratch);
+                        };
+                        job.key.stream = f.stream;
+                        job.key.streamRevision = f.stream->revision();
                     }
                     break;
                 default:
                     break;
             }
+            if (job.draw) {
+                job.publishKey = curveKey(f) ? curveKey(f) : surfaceMeshKey(f, settings);
+                job.key.ast = f.ast;
+                job.key.kind = f.renderKind;
+                job.key.color = { f.color[0], f.color[1], f.color[2], f.color[3] };
+                job.key.zSlice = f.zSlice;
+                m_formulaJobs.push_back(std::move(job));
+            }
+        }
+    };
+
+    // Retained geometry: a formula whose key (AST, options, colour, view, clip and font state)
+    // matches the previous frame's is replayed from its recorded list instead of being
+    // re-evaluated, so idle frames only pay for the copy into the window list. Export renders
+    // (overrides) and the unoptimized mode always redraw.
+    const bool useGeometryCache = settings.optimizeRendering && !useOverrides;
+    FormulaGeometryKey frameKey;
+    frameKey.view = vt;
+    const ImVec2 clipMin = dl->GetClipRectMin();
+    const ImVec2 clipMax = dl->GetClipRectMax();
+    frameKey.clipRect = { clipMin.x, clipMin.y, clipMax.x, clipMax.y };
+    frameKey.whitePixelUv = { dl->_Data->TexUvWhitePixel.x, dl->_Data->TexUvWhitePixel.y };
+    frameKey.font = dl->_Data->Font;
+    frameKey.fontSize = dl->_Data->FontSize;
+    frameKey.drawListFlags = static_cast<int>(dl->Flags);
+
+    auto drawFormulas = [&](Plotting::PlotRenderer::SurfacePlanePass3D planePass,
+                            bool enable3DOverlays) {
+        collectFormulaJobs(planePass, enable3DOverlays);
+        const size_t jobCount = m_formulaJobs.size();
+        const bool parallel = settings.parallelFormulas &&
+                              Core::TaskPool::shared().workerCount() > 0;
+
+        // Pick each job's target: its cache entry, a temporary private list when building in
+        // parallel, or the window list directly.
+        if (useGeometryCache) {
+            for (FormulaDrawJob& job : m_formulaJobs) {
+                job.key.view = frameKey.view;
+                job.key.clipRect = frameKey.clipRect;
+                job.key.whitePixelUv = frameKey.whitePixelUv;
+                job.key.font = frameKey.font;
+                job.key.fontSize = frameKey.fontSize;
+                job.key.drawListFlags = frameKey.drawListFlags;
+                GeometryCacheEntry& entry = geometryCacheEntry(job.key);
+                entry.used = true;
+                job.cached = &entry;
+                job.target = entry.slot.get();
+                job.needsDraw = !(entry.valid && entry.key == job.key);
+                if (job.needsDraw) {
+                    entry.key = job.key;
+                    entry.valid = true;
+                }
+            }
+        } else if (parallel && jobCount >= 2) {
+            while (m_drawSlots.size() < jobCount) {
+                m_drawSlots.push_back(std::make_unique<FormulaDrawSlot>());
+            }
+            for (size_t i = 0; i < jobCount; ++i) {
+                m_formulaJobs[i].target = m_drawSlots[i].get();
+            }
+        }
+
+        m_pendingJobs.clear();
+        for (size_t i = 0; i < jobCount; ++i) {
+            if (m_formulaJobs[i].needsDraw) {
+                m_pendingJobs.push_back(i);
+                if (m_formulaJobs[i].target) {
+                    m_formulaJobs[i].target->begin(*dl);
+                }
+            }
+        }
+
+        auto runJob = [&](FormulaDrawJob& job) {
+            const auto start = std::chrono::steady_clock::now();
+            if (job.target) {
+                job.draw(&job.target->drawList, &job.target->arena);
+            } else {
+                job.draw(dl, arena);
+            }
+            job.drawMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        };
+
+        if (parallel && m_pendingJobs.size() >= 2) {
+            // ImDrawList is not thread-safe, so every job records into a private list (with its
+            // own shared-data copy and scratch arena) on a worker thread. The private lists start
+            // from the window's texture and clip rect and are appended afterwards in formula
+            // order, so the result matches drawing the formulas one after another.
+            // Axis-triad labels are text: make sure their glyphs are baked before the workers
+            // read the font, since loading a glyph mutates the atlas.
+            ImGui::CalcTextSize("XYZ");
+            Core::TaskPool::shared().parallelFor(m_pendingJobs.size(), [&](size_t i) {
+                runJob(m_formulaJobs[m_pendingJobs[i]]);
+            });
+        } else {
+            for (size_t index : m_pendingJobs) {
+                runJob(m_formulaJobs[index]);
+            }
+        }
+
+        for (const FormulaDrawJob& job : m_formulaJobs) {
+            if (job.target) {
+                appendDrawList(dl, job.target->drawList);
+            }
+        }
+
+        // Replayed formulas publish their hover and picking state again: other formulas or an
+        // export may have pushed it out of the renderer since it was drawn.
+        for (const FormulaDrawJob& job : m_formulaJobs) {
+            if (!job.cached || !job.publishKey) {
+                continue;
+            }
+            if (job.needsDraw) {
+                job.cached->published = Plotting::PlotRenderer::published(job.publishKey);
+            } else {
+                Plotting::PlotRenderer::republish(job.cached->published);
+            }
+        }
+
+        if (governor) {
+            for (const FormulaDrawJob& job : m_formulaJobs) {
+                if (job.costKey && job.needsDraw) {
+                    governor->addCost(job.costKey, job.costModel, job.drawMs);
+                }
+            }
         }
     };
 
@@ -224,9 +1080,61 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
     } else {
         drawFormulas(Plotting::PlotRenderer::SurfacePlanePass3D::All, true);
     }
+    if (!useOverrides) {
+        drawCurveFeatures(dl, formulas, vt, !is3DMode && settings.showCurveFeatures);
+    }
+    if (governor) {
+        governor->endFrame();
+    }
+    if (!useOverrides) {
+        // Stop sampling volumes of formulas that no longer draw a cross-section.
+        std::erase_if(m_volumes, [](const CrossSectionVolume& v) { return !v.used; });
+        for (CrossSectionVolume& volume : m_volumes) {
+            volume.used = false;
+        }
+        // Volume renderings are dropped with their formula; export views once the export ends.
+        std::erase_if(m_volumeViews, [](const std::unique_ptr<VolumeView>& v) {
+            return !v->used || v->forExport;
+        });
+        for (const std::unique_ptr<VolumeView>& view : m_volumeViews) {
+            view->used = false;
+        }
+        std::erase_if(m_surfaceTraceViews, [](const std::unique_ptr<SurfaceTraceView>& v) {
+            return !v->used || v->forExport;
+        });
+        for (const std::unique_ptr<SurfaceTraceView>& view : m_surfaceTraceViews) {
+            view->used = false;
+        }
+        std::erase_if(m_scatterViews, [](const std::unique_ptr<ScatterView>& v) {
+            return !v->used || v->forExport;
+        });
+        for (const std::unique_ptr<ScatterView>& view : m_scatterViews) {
+            view->used = false;
+        }
+        std::erase_if(m_viewCulling, [](const auto& entry) { return !entry.second.used; });
+        for (auto& entry : m_viewCulling) {
+            entry.second.used = false;
+        }
+        // Picking hierarchies live as long as their formula is shown in 3D.
+        std::erase_if(m_surfacePicks, [&](const SurfacePick& p) {
+            return !is3DMode || std::none_of(formulas.begin(), formulas.end(), [&](const FormulaEntry& f) {
+                return f.visible && f.ast == p.ast && surfaceMeshKey(f, settings) != nullptr;
+            });
+        });
+    }
+    if (useGeometryCache) {
+        // Drop geometry of formulas that were hidden, edited (new AST) or removed this frame.
+        std::erase_if(m_geometryCache, [](const auto& slot) { return !slot.second.used; });
+        for (auto& slot : m_geometryCache) {
+            slot.second.used = false;
+        }
+    } else {
+        m_geometryCache.clear();
+    }
 
-    // Border
-    dl->AddRect(pos, ImVec2(pos.x + size.x, pos.y + size.y),
+    // Border (of the whole plot, so tiles of an export do not outline each other)
+    dl->AddRect(ImVec2(vt.screenOriginX, vt.screenOriginY),
+                ImVec2(vt.screenOriginX + vt.screenWidth, vt.screenOriginY + vt.screenHeight),
                 IM_COL32(100, 100, 100, 255));
 
     // --- Mouse interaction ---
@@ -268,7 +1176,8 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
         }
     }
 
-    // Tooltip showing 2D world coordinates or 3D view-plane coordinates (plus world domain coords).
+    // Tooltip showing the 2D curve under the cursor (else world coordinates), or in 3D the
+    // surface point under the cursor (else view-plane coordinates plus world domain coords).
     if (isHovered) {
         ImVec2 mousePos = ImGui::GetIO().MousePos;
         double wx, wy;
@@ -280,11 +1189,55 @@ void PlotPanel::render(std::vector<FormulaEntry>& formulas,
             const double viewU = (mousePos.x - originScreen.x) / safeProjectionScale;
             const double viewV = (originScreen.y - mousePos.y) / safeProjectionScale;
 
-            ImGui::SetTooltip(
-                "view u = %.4g\nview v = %.4g\nworld x = %.4g\nworld y = %.4g\n3D camera: az %.1f, el %.1f",
-                viewU, viewV, wx, wy, settings.azimuthDeg, settings.elevationDeg);
+            // No picks while the view pans or zooms: every such frame samples a new grid, and
+            // its hierarchy would be outdated before it was built.
+            Plotting::MeshBvh::Hit hit;
+            const FormulaEntry* picked = (useOverrides || isDraggingLeft || isZoomingView)
+                ? nullptr
+                : pickSurface(formulas, vt, settings, mousePos.x, mousePos.y, hit);
+            if (picked) {
+                ImGui::SetTooltip(
+                    "%s\nx = %.4g\ny = %.4g\nz = %.4g\n3D camera: az %.1f, el %.1f",
+                    picked->lastParsedText.c_str(), hit.point.x, hit.point.y, hit.point.z,
+                    settings.azimuthDeg, settings.elevationDeg);
+            } else {
+                ImGui::SetTooltip(
+                    "view u = %.4g\nview v = %.4g\nworld x = %.4g\nworld y = %.4g\n3D camera: az %.1f, el %.1f",
+                    viewU, viewV, wx, wy, settings.azimuthDeg, settings.elevationDeg);
+            }
         } else {
-            ImGui::SetTooltip("x = %.4g\ny = %.4g", wx, wy);
+            double cx = 0.0;
+            double cy = 0.0;
+            const Plotting::CurveAnalysis::Feature* feature = useOverrides
+                ? nullptr
+                : pickCurveFeature(vt, mousePos.x, mousePos.y);
+            const FormulaEntry* picked = (useOverrides || feature)
+                ? nullptr
+                : pickCurve(formulas, vt, mousePos.x, mousePos.y, cx, cy);
+            if (feature) {
+                const char* text = m_curveFeatureFormulas[feature->curve]->lastParsedText.c_str();
+                switch (feature->kind) {
+                    case Plotting::CurveAnalysis::Kind::Root:
+                        ImGui::SetTooltip("%s\nroot x = %.10g", text, feature->x);
+                        break;
+                    case Plotting::CurveAnalysis::Kind::Minimum:
+                    case Plotting::CurveAnalysis::Kind::Maximum:
+                        ImGui::SetTooltip("%s\n%s x = %.10g\ny = %.10g", text,
+                                          feature->kind == Plotting::CurveAnalysis::Kind::Minimum
+                                              ? "minimum" : "maximum",
+                                          feature->x, feature->y);
+                        break;
+                    case Plotting::CurveAnalysis::Kind::Intersection:
+                        ImGui::SetTooltip("%s\n%s\nintersection x = %.10g\ny = %.10g", text,
+                                          m_curveFeatureFormulas[feature->other]->lastParsedText.c_str(),
+                                          feature->x, feature->y);
+                        break;
+                }
+            } else if (picked) {
+                ImGui::SetTooltip("%s\nx = %.4g\ny = %.4g", picked->lastParsedText.c_str(), cx, cy);
+            } else {
+                ImGui::SetTooltip("x = %.4g\ny = %.4g", wx, wy);
+            }
         }
     }
 }
@@ -3,10 +3,27 @@
 
 #include "FormulaEntry.h"
 #include "PlotSettings.h"
+#include "QualityGovernor.h"
+#include "../Core/IntervalEvaluator.h"
 #include "../Core/ViewTransform.h"
+#include "../Plotting/FrameArena.h"
+#include "../Plotting/ImageTexture.h"
+#include "../Plotting/ImplicitSurfaceTracer.h"
+#include "../Plotting/MeshBvhCache.h"
+#include "../Plotting/PlotRenderer.h"
+#include "../Plotting/ScatterDensity.h"
+#include "../Plotting/VolumeCache.h"
+#include "../Plotting/VolumeRaymarcher.h"
 #include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+struct ImDrawList;
+
 namespace XpressFormula::UI {
 
 struct PlotRenderOverrides {
@@ -17,14 +34,251 @@ struct PlotRenderOverrides {
     bool showEnvelope = true;
     bool showAxisTriad = true;
     std::array<float, 4> backgroundColor = { 0.098f, 0.098f, 0.118f, 1.0f };
+    // Tiled export: when plotWidth/plotHeight are positive, the window shows one tile of a
+    // plotWidth x plotHeight plot whose top-left corner lies at (plotLeft, plotTop) relative
+    // to the window. The view transform spans the whole plot, so every tile projects 2D and 3D
+    // geometry exactly like one render of the full size would.
+    float plotLeft = 0.0f;
+    float plotTop = 0.0f;
+    float plotWidth = 0.0f;
+    float plotHeight = 0.0f;
 };
 
 /// Renders the main plot canvas with mouse interaction (pan & zoom).
 class PlotPanel {
 public:
+    PlotPanel();
+    ~PlotPanel();
+
     void render(std::vector<FormulaEntry>& formulas, Core::ViewTransform& vt,
                 PlotSettings& settings,
                 const PlotRenderOverrides* overrides = nullptr);
+
+    /// True while the quality governor still runs below full quality (or within its idle grace
+    /// period), while a cross-section volume is being sampled, while a volume rendering or
+    /// ray-traced surface is still being refined, while a surface's picking hierarchy is being
+    /// built, while curve features are being analysed, while a zoomed-in point cloud is being
+    /// binned, while a shown live series is connected, or while a data series is loading. The
+    /// caller should keep rendering frames so full quality (or the finished image, the hover
+    /// readout, new samples, or the loaded series) is shown.
+    bool needsRefinementFrame() const {
+        return m_qualityGovernor.isGoverning() || volumeSamplingPending() ||
+               volumeRenderingPending() || surfaceTracingPending() || surfacePickPending() ||
+               m_curveAnalysis.pending() || scatterBinningPending() || m_streaming ||
+               m_loadingData;
+    }
+
+    /// Per-frame scratch arena handed to every PlotRenderer draw call (exposed for diagnostics).
+    const Plotting::FrameArena& frameArena() const { return m_frameArena; }
+
+private:
+    // Private draw list + scratch arena used when formulas are built on worker threads or
+    // recorded for the geometry cache.
+    struct FormulaDrawSlot;
+
+    // Everything a formula's emitted geometry depends on. Holding the AST pins its address, so
+    // a re-parsed formula can never alias a cached one.
+    struct FormulaGeometryKey {
+        Core::ASTNodePtr ast;
+        FormulaRenderKind kind = FormulaRenderKind::Invalid;
+        Plotting::PlotRenderer::Surface3DOptions options;
+        std::array<float, 4> color = {};
+        float opacity = 0.0f;
+        int contourLevels = 0;  // heat-map iso-lines
+        bool curveSamples = false;  // 2D curves: samples published for curve analysis
+        float zSlice = 0.0f;
+        Core::ViewTransform view;
+        std::shared_ptr<const Plotting::VolumeCache::Volume> volume;  // cross-section source
+        std::shared_ptr<const Plotting::DataSeries> data;              // measured series (no AST)
+        std::shared_ptr<const Plotting::ScatterDensity> scatter;       // point cloud (no AST)
+        std::shared_ptr<const Plotting::StreamSeries> stream;          // live series (no AST)
+        std::uint64_t streamRevision = 0;                              // samples it had received
+        std::uint64_t imageId = 0;  // ray-marched or ray-traced image texture (0 = none)
+        std::array<float, 4> clipRect = {};
+        std::array<float, 2> whitePixelUv = {};  // moves whenever the font atlas is resized
+        const void* font = nullptr;
+        float fontSize = 0.0f;
+        int drawListFlags = 0;
+
+        bool operator==(const FormulaGeometryKey&) const = default;
+    };
+
+    // Retained geometry of one formula in one render pass, replayed while its key is unchanged.
+    struct GeometryCacheEntry {
+        FormulaGeometryKey key;
+        std::unique_ptr<FormulaDrawSlot> slot;
+        Plotting::PlotRenderer::Published published;  // hover and picking state of the draw
+        bool valid = false;
+        bool used = false;
+    };
+
+    // One formula's draw call for the current pass, plus its measured cost for the governor.
+    struct FormulaDrawJob {
+        std::function<void(ImDrawList*, Plotting::FrameArena*)> draw;
+        FormulaGeometryKey key;
+        const void* costKey = nullptr;  // non-null: report drawMs to the quality governor
+        QualityGovernor::CostModel costModel = QualityGovernor::CostModel::Surface;
+        FormulaDrawSlot* target = nullptr;     // private list to record into (null: window list)
+        GeometryCacheEntry* cached = nullptr;  // its retained geometry, when cached
+        const void* publishKey = nullptr;      // curve or surface key the draw publishes under
+        bool needsDraw = true;                 // false: target already holds this geometry
+        double drawMs = 0.0;
+    };
+
+    GeometryCacheEntry& geometryCacheEntry(const FormulaGeometryKey& key);
+
+    // Geometry cache slot: (formula AST or data series, grid-plane pass). Entries hold their
+    // source, so the pointer cannot be reused while its slot exists.
+    using GeometrySlot = std::pair<const void*, int>;
+    struct GeometrySlotHash {
+        size_t operator()(const GeometrySlot& slot) const {
+            return std::hash<const void*>()(slot.first) * 31u + static_cast<size_t>(slot.second);
+        }
+    };
+
+    // Interval bound of one 2D formula over the last view it was checked against.
+    struct ViewCulling {
+        Core::IntervalEvaluator evaluator;  // holds the formula's AST
+        std::array<double, 4> view{};       // world x/y window of `outside`
+        bool checked = false;
+        bool outside = false;
+        bool used = false;
+    };
+
+    /// True when the formula provably draws nothing in the 2D view: a curve whose value range
+    /// over the visible x interval misses the visible y interval, or an implicit F(x,y) = 0
+    /// whose range over the view excludes zero. Rechecked only when the view changes, so a
+    /// long list of off-screen formulas costs a lookup each per frame.
+    bool outsideView2D(const FormulaEntry& formula, const Core::ViewTransform& vt);
+
+    // Background-sampled f(x,y,z) volume of one cross-section formula.
+    struct CrossSectionVolume {
+        Core::ASTNodePtr ast;
+        std::unique_ptr<Plotting::VolumeCache> cache;
+        bool used = false;
+    };
+
+    std::shared_ptr<const Plotting::VolumeCache::Volume> crossSectionVolume(
+        const Core::ASTNodePtr& ast, const Core::ViewTransform& vt);
+    bool volumeSamplingPending() const;
+
+    // Screen rectangle a per-pixel image (volume rendering, ray-traced surface, point-cloud
+    // density) covers: the plot area, or only its part inside the window for a tiled export.
+    struct ImageArea {
+        float left = 0.0f;
+        float top = 0.0f;
+        float width = 1.0f;
+        float height = 1.0f;
+    };
+
+    // Ray-marched rendering of one f(x,y,z) formula: its sampled volume, the progressive image
+    // and the texture showing it. Export renders keep separate views sampled synchronously.
+    struct VolumeView {
+        Core::ASTNodePtr ast;
+        bool forExport = false;
+        Plotting::VolumeCache cache;
+        std::shared_ptr<const Plotting::VolumeCache::Volume> volume;  // last complete sample
+        Plotting::VolumeRaymarcher raymarcher;
+        Plotting::ImageTexture texture;
+        bool used = false;
+    };
+
+    /// Advance the formula's volume rendering by up to one frame budget (to completion for
+    /// export renders) and return its texture, or null while there is nothing to show yet.
+    const Plotting::ImageTexture* updateVolumeView(const FormulaEntry& formula,
+                                                   const Core::ViewTransform& vt,
+                                                   const ImageArea& area,
+                                                   const PlotSettings& settings, bool forExport);
+    bool volumeRenderingPending() const;
+
+    // Ray-traced rendering of one F(x,y,z)=0 formula: the progressive image and its texture.
+    struct SurfaceTraceView {
+        Core::ASTNodePtr ast;
+        bool forExport = false;
+        Plotting::ImplicitSurfaceTracer tracer;
+        Plotting::ImageTexture texture;
+        bool used = false;
+    };
+
+    /// Advance the formula's ray-traced surface by up to one frame budget (to completion for
+    /// export renders) and return its texture, or null while there is nothing to show yet.
+    const Plotting::ImageTexture* updateSurfaceTraceView(const FormulaEntry& formula,
+                                                         const Core::ViewTransform& vt,
+                                                         const ImageArea& area,
+                                                         const PlotSettings& settings, bool forExport);
+    bool surfaceTracingPending() const;
+
+    // Density image of one point cloud: the grid binned for the current view and its texture.
+    // Views the pyramid resolves are aggregated at once; closer views show the pyramid's
+    // resampling until the exact binning finishes in the background.
+    struct ScatterView {
+        std::shared_ptr<const Plotting::ScatterDensity> points;
+        bool forExport = false;
+        Plotting::ScatterDensityCache cache;
+        std::shared_ptr<const Plotting::ScatterDensity::Grid> grid;  // shown in the texture
+        std::array<std::uint32_t, 256> palette = {};
+        bool logScale = false;
+        std::vector<std::uint32_t> pixels;
+        Plotting::ImageTexture texture;
+        bool used = false;
+    };
+
+    /// Bring the point cloud's density image up to date with the view and return its texture.
+    const Plotting::ImageTexture* updateScatterView(const FormulaEntry& formula,
+                                                    const Core::ViewTransform& vt,
+                                                    const ImageArea& area,
+                                                    const PlotSettings& settings, bool forExport);
+    bool scatterBinningPending() const;
+
+    // Cursor picking on one formula's 3D mesh: the hierarchy over the mesh PlotRenderer last
+    // published for it, rebuilt in the background when the mesh changes.
+    struct SurfacePick {
+        Core::ASTNodePtr ast;
+        std::unique_ptr<Plotting::MeshBvhCache> cache;
+    };
+
+    /// Nearest mesh surface under the screen point among the visible 3D formulas. Returns the
+    /// formula hit (null for none) and fills `hit` in world coordinates.
+    const FormulaEntry* pickSurface(const std::vector<FormulaEntry>& formulas,
+                                    const Core::ViewTransform& vt, const PlotSettings& settings,
+                                    float screenX, float screenY, Plotting::MeshBvh::Hit& hit);
+    bool surfacePickPending() const;
+
+    /// Visible 2D curve passing nearest the screen point, within kCurvePickRadius pixels. The
+    /// curve is found through the screen-space index PlotRenderer built while sampling it; `x`
+    /// is the cursor's world x and `y` the curve's exact value there.
+    static const FormulaEntry* pickCurve(const std::vector<FormulaEntry>& formulas,
+                                         const Core::ViewTransform& vt,
+                                         float screenX, float screenY, double& x, double& y);
+    static constexpr float kCurvePickRadius = 8.0f;
+
+    /// Request the roots, extrema and intersections of the visible 2D curves for this view and
+    /// mark those found so far. m_curveFeatureFormulas maps the features' curve indices back to
+    /// their formulas for the tooltip.
+    void drawCurveFeatures(ImDrawList* dl, const std::vector<FormulaEntry>& formulas,
+                           const Core::ViewTransform& vt, bool enabled);
+    /// Feature marker within kCurvePickRadius of the screen point, or null.
+    const Plotting::CurveAnalysis::Feature* pickCurveFeature(const Core::ViewTransform& vt,
+                                                             float screenX, float screenY) const;
+
+    QualityGovernor m_qualityGovernor;
+    Plotting::FrameArena m_frameArena;
+    std::vector<FormulaDrawJob> m_formulaJobs;
+    std::vector<size_t> m_pendingJobs;
+    std::vector<std::unique_ptr<FormulaDrawSlot>> m_drawSlots;
+    std::unordered_map<GeometrySlot, GeometryCacheEntry, GeometrySlotHash> m_geometryCache;
+    std::unordered_map<const Core::ASTNode*, ViewCulling> m_viewCulling;
+    Core::IntervalEvaluator::Scratch m_cullingScratch;
+    std::vector<CrossSectionVolume> m_volumes;
+    std::vector<std::unique_ptr<VolumeView>> m_volumeViews;
+    std::vector<std::unique_ptr<SurfaceTraceView>> m_surfaceTraceViews;
+    std::vector<std::unique_ptr<ScatterView>> m_scatterViews;
+    bool m_streaming = false;  // a visible live series is connected
+    bool m_loadingData = false;  // a data: or scatter: file is loading in the background
+    std::vector<SurfacePick> m_surfacePicks;
+    Plotting::CurveAnalysis m_curveAnalysis;
+    std::shared_ptr<const Plotting::CurveAnalysis::Result> m_curveFeatures;
+    std::vector<const FormulaEntry*> m_curveFeatureFormulas;
 };
 
 } // namespace XpressFormula::UI
@@ -17,6 +17,13 @@ enum class XYRenderModePreference {
 struct PlotSettings {
     XYRenderModePreference xyRenderModePreference = XYRenderModePreference::Auto;
     bool optimizeRendering = true;
+    // Target CPU time for the plot while interacting (used by the quality governor).
+    float frameBudgetMs = 8.0f;
+    // Build each visible formula's geometry on a worker thread (merged in formula order).
+    bool parallelFormulas = true;
+    // Sample each f(x,y,z) over the z-slice range in the background and draw cross-sections
+    // from the cached volume (stable colour range, no re-evaluation while scrubbing z).
+    bool cacheCrossSectionVolumes = true;
     bool showGrid = true;
     bool showCoordinates = true;
     bool showWires = true;
@@ -56,6 +63,8 @@ struct PlotSettings {
     float zScale = 1.5f;
     int   surfaceResolution = 50;
     int   implicitSurfaceResolution = 64;
+    // Place implicit mesh vertices by dual contouring so creases and corners stay sharp.
+    bool  implicitSharpFeatures = false;
     float surfaceOpacity = 0.80f;
     float wireThickness = 2.0f;
     bool  showSurfaceEnvelope = true;
@@ -66,6 +75,20 @@ struct PlotSettings {
 
     // Heatmap and scalar-field alpha.
     float heatmapOpacity = 0.62f;
+    // Iso-lines drawn over heat maps and cross-sections, evenly spaced over the colour range.
+    int   heatmapContourLevels = 0;
+    // Mark roots, extrema and intersections of the visible 2D curves (found in the background).
+    bool  showCurveFeatures = false;
+    // Colour point-cloud densities on a logarithmic scale (linear to the busiest pixel otherwise).
+    bool  scatterLogScale = true;
+
+    // Render f(x,y,z) as a ray-marched volume in 3D mode instead of a 2D cross-section.
+    bool  volumeRendering = false;
+    float volumeThreshold = 0.5f;  // normalized field value where the volume starts to show
+    float volumeDensity = 4.0f;    // extinction per grid cell above the threshold
+
+    // Ray trace F(x,y,z)=0 surfaces per pixel in 3D mode instead of meshing them.
+    bool  traceImplicitSurfaces = false;
 };
 
 } // namespace XpressFormula::UI
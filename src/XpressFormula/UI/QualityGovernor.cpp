@@ -0,0 +1,131 @@
+// QualityGovernor.cpp - Adaptive per-formula resolution selection.
+#include "QualityGovernor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace XpressFormula::UI {
+
+void QualityGovernor::beginFrame(double nowSeconds, bool interacting, float frameBudgetMs) {
+    m_frameBudgetMs = std::max(1.0f, frameBudgetMs);
+    if (interacting) {
+        m_lastInteractionTime = nowSeconds;
+    }
+    const bool governing = (nowSeconds - m_lastInteractionTime) < kIdleGraceSeconds;
+    if (!governing) {
+        // Idle: forget measurements so the next interaction starts from full quality with
+        // fresh costs (the scene may have changed completely in the meantime).
+        m_states.clear();
+    }
+    m_governing = governing;
+    for (auto& entry : m_states) {
+        entry.second.frameMs = 0.0;
+        entry.second.seenThisFrame = false;
+    }
+}
+
+int QualityGovernor::scaledResolution(const void* key, int fullResolution, int minResolution) const {
+    const double scale = qualityScale(key);
+    if (scale >= 1.0) {
+        return fullResolution;
+    }
+    const int scaled = static_cast<int>(std::lround(fullResolution * scale));
+    return std::clamp(scaled, std::min(minResolution, fullResolution), fullResolution);
+}
+
+int QualityGovernor::surfaceResolution(const void* key, int fullResolution) const {
+    // PlotRenderer clamps z=f(x,y) resolution to at least 12.
+    return scaledResolution(key, fullResolution, 12);
+}
+
+int QualityGovernor::implicitResolution(const void* key, int fullResolution) const {
+    // PlotRenderer clamps implicit grid resolution to at least 16.
+    return scaledResolution(key, fullResolution, 16);
+}
+
+bool QualityGovernor::wiresAllowed(const void* key) const {
+    return qualityScale(key) >= 1.0;
+}
+
+double QualityGovernor::qualityScale(const void* key) const {
+    if (!m_governing) {
+        return 1.0;
+    }
+    const auto it = m_states.find(key);
+    return (it == m_states.end()) ? 1.0 : it->second.scale;
+}
+
+bool QualityGovernor::isDegraded() const {
+    if (!m_governing) {
+        return false;
+    }
+    return std::any_of(m_states.begin(), m_states.end(),
+        [](const auto& entry) { return entry.second.scale < 1.0; });
+}
+
+void QualityGovernor::addCost(const void* key, CostModel model, double milliseconds) {
+    if (!m_governing || !key) {
+        return;
+    }
+    FormulaState& state = m_states[key];
+    state.model = model;
+    state.frameMs += std::max(0.0, milliseconds);
+    state.seenThisFrame = true;
+}
+
+void QualityGovernor::endFrame() {
+    if (!m_governing) {
+        return;
+    }
+
+    // Formulas that were not drawn this frame (hidden, deleted, or edited into a new AST)
+    // are dropped so stale entries do not keep the plot in the degraded state.
+    int activeCount = 0;
+    for (auto it = m_states.begin(); it != m_states.end();) {
+        if (!it->second.seenThisFrame) {
+            it = m_states.erase(it);
+        } else {
+            ++activeCount;
+            ++it;
+        }
+    }
+    if (activeCount == 0) {
+        return;
+    }
+
+    const double targetMs = static_cast<double>(m_frameBudgetMs) / activeCount;
+    for (auto& entry : m_states) {
+        FormulaState& state = entry.second;
+        state.smoothedMs = (state.smoothedMs < 0.0)
+            ? state.frameMs
+            : state.smoothedMs * 0.6 + state.frameMs * 0.4;
+
+        const double exponent = (state.model == CostModel::Implicit) ? 3.0 : 2.0;
+        const double fullCostMs = state.smoothedMs / std::pow(state.scale, exponent);
+        if (!(fullCostMs > 0.0) || !std::isfinite(fullCostMs)) {
+            continue;
+        }
+        const double desired = std::clamp(std::pow(targetMs / fullCostMs, 1.0 / exponent),
+                                          kMinScale, 1.0);
+
+        if (desired < state.scale * kDowngradeMargin) {
+            // Over budget: jump straight to the predicted scale.
+            state.smoothedMs = fullCostMs * std::pow(desired, exponent);
+            state.scale = desired;
+            state.stableFrames = 0;
+        } else if (state.scale < 1.0 &&
+                   (desired > state.scale * kUpgradeMargin || desired >= 1.0)) {
+            // Headroom (or full quality fits again): only step up after it has persisted
+            // for several frames.
+            if (++state.stableFrames >= kUpgradeStableFrames) {
+                const double next = std::min({ desired, state.scale * kMaxUpgradeStep, 1.0 });
+                state.smoothedMs = fullCostMs * std::pow(next, exponent);
+                state.scale = next;
+                state.stableFrames = 0;
+            }
+        } else {
+            state.stableFrames = 0;
+        }
+    }
+}
+
+} // namespace XpressFormula::UI
@@ -0,0 +1,75 @@
+// QualityGovernor.h - Frame-time-driven quality control for interactive 3D rendering.
+#pragma once
+
+#include <unordered_map>
+
+namespace XpressFormula::UI {
+
+/// Chooses per-formula sampling resolution and wire visibility so that, while the user is
+/// interacting, each visible 3D formula fits its share of a frame budget.
+///
+/// Costs are measured per formula every frame and mapped through a simple cost model
+/// (z=f(x,y) surfaces scale with resolution^2, implicit F(x,y,z)=0 meshes with resolution^3)
+/// to predict the resolution that meets the budget. Downgrades apply immediately; upgrades
+/// wait for several consecutive frames with headroom and then step up gradually, which keeps
+/// the resolution (and the implicit mesh cache) from oscillating. Once interaction has been
+/// idle for a short grace period, every formula returns to full quality.
+class QualityGovernor {
+public:
+    enum class CostModel {
+        Surface,   // cost ~ resolution^2
+        Implicit   // cost ~ resolution^3
+    };
+
+    /// Start a frame. `interacting` is true while dragging, wheel-zooming, or auto-rotating.
+    void beginFrame(double nowSeconds, bool interacting, float frameBudgetMs);
+
+    /// Resolution to use this frame for the formula identified by `key`.
+    int surfaceResolution(const void* key, int fullResolution) const;
+    int implicitResolution(const void* key, int fullResolution) const;
+
+    /// Wires are suppressed while a formula runs below full quality.
+    bool wiresAllowed(const void* key) const;
+
+    /// Accumulate measured draw time for a formula (may be called once per render pass).
+    void addCost(const void* key, CostModel model, double milliseconds);
+
+    /// Update every formula's quality from this frame's measured costs.
+    void endFrame();
+
+    /// True while interaction is active or within the idle grace period; callers should keep
+    /// rendering so full quality is restored once the grace period expires.
+    bool isGoverning() const { return m_governing; }
+
+    /// True when any formula is currently below full quality.
+    bool isDegraded() const;
+
+    /// Current quality scale (0..1] of a formula's resolution; 1 when not governed.
+    double qualityScale(const void* key) const;
+
+    static constexpr double kIdleGraceSeconds = 0.35;
+    static constexpr double kMinScale = 0.25;
+    static constexpr int    kUpgradeStableFrames = 8;
+    static constexpr double kDowngradeMargin = 0.90;  // act when predicted scale < 90% of current
+    static constexpr double kUpgradeMargin = 1.15;    // headroom required before stepping up
+    static constexpr double kMaxUpgradeStep = 1.25;   // largest single upgrade factor
+
+private:
+    struct FormulaState {
+        double scale = 1.0;
+        double smoothedMs = -1.0;    // EMA of cost at the current scale (-1 = no sample yet)
+        double frameMs = 0.0;        // cost accumulated during the current frame
+        CostModel model = CostModel::Surface;
+        int stableFrames = 0;
+        bool seenThisFrame = false;
+    };
+
+    int scaledResolution(const void* key, int fullResolution, int minResolution) const;
+
+    std::unordered_map<const void*, FormulaState> m_states;
+    double m_lastInteractionTime = -1.0e9;
+    float  m_frameBudgetMs = 8.0f;
+    bool   m_governing = false;
+};
+
+} // namespace XpressFormula::UI
@@ -0,0 +1,71 @@
+// VirtualList.cpp - Variable-height row virtualisation for long ImGui lists.
+#include "VirtualList.h"
+#include <algorithm>
+
+namespace XpressFormula::UI {
+
+void VirtualList::resize(size_t count) {
+    if (count != m_heights.size()) {
+        m_heights.resize(count, -1.0f);
+        m_offsetsValid = false;
+    }
+}
+
+void VirtualList::erase(size_t index) {
+    if (index < m_heights.size()) {
+        m_heights.erase(m_heights.begin() + static_cast<std::ptrdiff_t>(index));
+        m_offsetsValid = false;
+    }
+}
+
+void VirtualList::setDefaultHeight(float height) {
+    if (height != m_defaultHeight) {
+        m_defaultHeight = height;
+        m_offsetsValid = false;
+    }
+}
+
+void VirtualList::setHeight(size_t index, float height) {
+    if (index < m_heights.size() && m_heights[index] != height) {
+        m_heights[index] = height;
+        m_offsetsValid = false;
+    }
+}
+
+float VirtualList::totalHeight() const {
+    updateOffsets();
+    return m_offsets.back();
+}
+
+void VirtualList::updateOffsets() const {
+    if (m_offsetsValid) {
+        return;
+    }
+    m_offsets.resize(m_heights.size() + 1);
+    float top = 0.0f;
+    for (size_t i = 0; i < m_heights.size(); ++i) {
+        m_offsets[i] = top;
+        top += (m_heights[i] < 0.0f) ? m_defaultHeight : m_heights[i];
+    }
+    m_offsets.back() = top;
+    m_offsetsValid = true;
+}
+
+VirtualList::Range VirtualList::visibleRange(float scrollY, float viewHeight) const {
+    updateOffsets();
+    Range range;
+    const size_t count = m_heights.size();
+    // First row whose bottom lies below scrollY, and the first row starting at or after the
+    // viewport's bottom edge.
+    const auto begin = m_offsets.begin();
+    range.first = static_cast<size_t>(std::upper_bound(begin + 1, m_offsets.end(), scrollY) - begin) - 1;
+    range.first = std::min(range.first, count);
+    range.last = static_cast<size_t>(std::lower_bound(begin + range.first, begin + count,
+                                                      scrollY + viewHeight) - begin);
+    range.last = std::max(range.last, range.first);
+    range.before = m_offsets[range.first];
+    range.after = m_offsets[count] - m_offsets[range.last];
+    return range;
+}
+
+} // namespace XpressFormula::UI
@@ -0,0 +1,47 @@
+// VirtualList.h - Variable-height row virtualisation for long ImGui lists.
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace XpressFormula::UI {
+
+/// Remembers each row's height from the last frame it was drawn, so a scrolled list submits
+/// only the rows inside the viewport and stands in a spacer for the rest. ImGuiListClipper
+/// does the same for rows of one fixed height; formula rows grow when they show an error or a
+/// z slider, so the offsets here come from a prefix sum over the measured heights (rows never
+/// drawn use the default estimate).
+class VirtualList {
+public:
+    struct Range {
+        size_t first = 0;     // rows [first, last) intersect the viewport
+        size_t last = 0;
+        float before = 0.0f;  // height of the rows above `first`
+        float after = 0.0f;   // height of the rows from `last` on
+    };
+
+    /// Match the row count. Rows added at the end start at the default height.
+    void resize(size_t count);
+    /// Remove one row, shifting the heights of the rows after it.
+    void erase(size_t index);
+
+    void setDefaultHeight(float height);
+    /// Record a row's drawn height (including the spacing after it).
+    void setHeight(size_t index, float height);
+
+    size_t size() const { return m_heights.size(); }
+    float totalHeight() const;
+
+    /// Rows overlapping [scrollY, scrollY + viewHeight), in O(log n).
+    Range visibleRange(float scrollY, float viewHeight) const;
+
+private:
+    void updateOffsets() const;
+
+    std::vector<float> m_heights;  // negative: not measured yet (default height)
+    float m_defaultHeight = 24.0f;
+    mutable std::vector<float> m_offsets;  // m_offsets[i] = top of row i; size() + 1 entries
+    mutable bool m_offsetsValid = false;
+};
+
+} // namespace XpressFormula::UI